@@ -14,7 +14,20 @@ CONFIG(debug, debug|release) {
 
 HEADERS += CommonTypes.h \
     FrameworkSpecificTypes.h \
-    tools.h
+    HedgedRequest.h \
+    LatencyHistogram.h \
+    SingleFlight.h \
+    tools.h \
+    Utf16.h
 
 SOURCES += \
-    tools.cpp
+    LatencyHistogram.cpp \
+    tools.cpp \
+    Utf16.cpp
+
+# CONFIG+=avx2 converts UTF-16 licenses 16 code units at a time instead of 8,
+# the SDK then only runs on processors with AVX2
+avx2 {
+    win32:QMAKE_CXXFLAGS += /arch:AVX2
+    else:QMAKE_CXXFLAGS  += -mavx2
+}
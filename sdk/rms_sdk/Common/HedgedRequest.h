@@ -0,0 +1,167 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef _RMS_LIB_HEDGEDREQUEST_H_
+#define _RMS_LIB_HEDGEDREQUEST_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../ModernAPI/RMSExceptions.h"
+
+namespace rmscore {
+namespace common {
+/*!
+ * Runs a request against a primary endpoint and, if it has not answered
+ * within the budget, sends the same request to an alternate endpoint and
+ * takes whichever answers first. A primary that fails before the budget
+ * expires falls back to the alternate right away, like a sequential retry.
+ *
+ * An answer which is not accepted, e.g. a 5xx the alternate may not give,
+ * counts as a failure too. If both attempts fail, the primary's outcome is
+ * what Run returns or throws.
+ *
+ * Each attempt runs on its own detached thread with its own cancel flag, not
+ * on the caller's; whatever it calls back, e.g. the application's
+ * authentication callback, is called on that thread, possibly concurrently
+ * with the other attempt. The flag of the attempt that lost is set when Run
+ * returns, but the attempt may still be running at that point, so it must
+ * not reference the caller's stack.
+ */
+template<typename T>
+class HedgedRequest {
+public:
+
+  typedef std::function<T(std::shared_ptr<std::atomic<bool> >)> Attempt;
+
+  // whether an answer is final, all of them are when it is empty
+  typedef std::function<bool(const T&)> Accept;
+
+  enum Winner { Primary = 0, Alternate = 1 };
+
+  static T Run(Attempt                            primary,
+               Attempt                            alternate,
+               std::chrono::milliseconds          budget,
+               std::shared_ptr<std::atomic<bool> >cancelState,
+               Winner                            *pWinner = nullptr,
+               Accept                             accept  = Accept())
+  {
+    auto state = std::make_shared<State>();
+
+    Launch(state, Primary, primary, accept);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    auto hedgeAt = std::chrono::steady_clock::now() + budget;
+
+    // wait for the primary until the budget expires
+    while (!state->value && !state->failed[Primary] &&
+           (std::chrono::steady_clock::now() < hedgeAt)) {
+      WaitSlice(state, lock, cancelState);
+    }
+
+    if (!state->value) {
+      lock.unlock();
+      Launch(state, Alternate, alternate, accept);
+      lock.lock();
+
+      // first answer wins, or both fail
+      while (!state->value &&
+             !(state->failed[Primary] && state->failed[Alternate])) {
+        WaitSlice(state, lock, cancelState);
+      }
+    }
+
+    Abandon(state);
+
+    if (!state->value) {
+      if (state->rejected[Primary]) {
+        if (pWinner != nullptr) *pWinner = Primary;
+        return *state->rejected[Primary];
+      }
+      std::rethrow_exception(state->error[Primary]);
+    }
+
+    if (pWinner != nullptr) *pWinner = state->winner;
+    return *state->value;
+  }
+
+private:
+
+  struct State {
+    std::mutex                          mutex;
+    std::condition_variable             changed;
+    std::unique_ptr<T>                  value;
+    Winner                              winner;
+    bool                                failed[2] = { false, false };
+    std::exception_ptr                  error[2];
+    std::unique_ptr<T>                  rejected[2];
+    std::shared_ptr<std::atomic<bool> > cancel[2] = {
+      std::make_shared<std::atomic<bool> >(false),
+      std::make_shared<std::atomic<bool> >(false)
+    };
+  };
+
+  static void Launch(const std::shared_ptr<State>& state,
+                     Winner                        which,
+                     Attempt                       attempt,
+                     Accept                        accept)
+  {
+    std::thread([state, which, attempt, accept]() {
+        try {
+          T value = attempt(state->cancel[which]);
+          bool bAccepted = !accept || accept(value);
+
+          std::lock_guard<std::mutex> lock(state->mutex);
+
+          if (!bAccepted) {
+            state->failed[which] = true;
+            state->rejected[which].reset(new T(std::move(value)));
+          } else if (!state->value) {
+            state->value.reset(new T(std::move(value)));
+            state->winner = which;
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(state->mutex);
+
+          state->failed[which] = true;
+          state->error[which]  = std::current_exception();
+        }
+        state->changed.notify_all();
+      }).detach();
+  }
+
+  static void WaitSlice(const std::shared_ptr<State>             & state,
+                        std::unique_lock<std::mutex>             & lock,
+                        const std::shared_ptr<std::atomic<bool> >& cancelState)
+  {
+    state->changed.wait_for(lock, std::chrono::milliseconds(10));
+
+    if ((cancelState != nullptr) && cancelState->load()) {
+      lock.unlock();
+      Abandon(state);
+      throw exceptions::RMSNetworkException(
+              "Network operation was cancelled by user",
+              exceptions::RMSNetworkException::CancelledByUser);
+    }
+  }
+
+  // cancels whatever is still running
+  static void Abandon(const std::shared_ptr<State>& state)
+  {
+    state->cancel[Primary]->store(true);
+    state->cancel[Alternate]->store(true);
+  }
+};
+} // namespace common
+} // namespace rmscore
+#endif // _RMS_LIB_HEDGEDREQUEST_H_
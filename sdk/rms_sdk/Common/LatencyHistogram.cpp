@@ -0,0 +1,100 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include "LatencyHistogram.h"
+
+using namespace std;
+
+namespace rmscore {
+namespace common {
+const int LatencyHistogram::BucketCount;
+
+// upper bounds, in milliseconds; the last bucket takes everything above 30 s
+const int64_t LatencyHistogram::s_bucketBounds[BucketCount] = {
+  5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 30000, LLONG_MAX
+};
+
+LatencyHistogram::LatencyHistogram() : m_count(0), m_max(0)
+{
+  fill(begin(m_counts), end(m_counts), 0);
+}
+
+void LatencyHistogram::Record(int64_t msecs)
+{
+  msecs = max<int64_t>(msecs, 0);
+  auto bucket = lower_bound(begin(s_bucketBounds), end(s_bucketBounds), msecs);
+
+  MutexLocker lock(&m_mutex);
+
+  ++m_counts[bucket - begin(s_bucketBounds)];
+  ++m_count;
+  m_max = max(m_max, msecs);
+}
+
+int64_t LatencyHistogram::Count()
+{
+  MutexLocker lock(&m_mutex);
+
+  return m_count;
+}
+
+int64_t LatencyHistogram::Percentile(double p)
+{
+  MutexLocker lock(&m_mutex);
+
+  return PercentileLocked(p);
+}
+
+int64_t LatencyHistogram::PercentileLocked(double p)
+{
+  if (m_count == 0) return 0;
+
+  auto rank = static_cast<int64_t>(ceil(min(max(p, 0.0), 1.0) * m_count));
+  rank = max<int64_t>(rank, 1);
+
+  int64_t seen = 0;
+
+  for (int i = 0; i < BucketCount; ++i) {
+    seen += m_counts[i];
+
+    // the open ended bucket is reported as the largest sample
+    if (seen >= rank) return min(s_bucketBounds[i], m_max);
+  }
+  return m_max;
+}
+
+string LatencyHistogram::Summary()
+{
+  MutexLocker lock(&m_mutex);
+
+  return "n=" + to_string(m_count) +
+         " p50=" + to_string(PercentileLocked(0.50)) +
+         " p95=" + to_string(PercentileLocked(0.95)) +
+         " p99=" + to_string(PercentileLocked(0.99)) +
+         " max=" + to_string(m_max);
+}
+
+shared_ptr<LatencyHistogram> LatencyHistogram::ForEndpoint(const string& endpoint)
+{
+  // NOTE: the registry is leaked deliberately, the histograms are recorded
+  // until the end of the process.
+  static Mutex *mutex = new Mutex();
+  static map<string, shared_ptr<LatencyHistogram> > *histograms =
+    new map<string, shared_ptr<LatencyHistogram> >();
+
+  MutexLocker lock(mutex);
+  auto& histogram = (*histograms)[endpoint];
+
+  if (!histogram) histogram.reset(new LatencyHistogram());
+  return histogram;
+}
+} // namespace common
+} // namespace rmscore
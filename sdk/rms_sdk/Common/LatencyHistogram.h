@@ -0,0 +1,61 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef _RMS_LIB_LATENCYHISTOGRAM_H_
+#define _RMS_LIB_LATENCYHISTOGRAM_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include "FrameworkSpecificTypes.h"
+
+namespace rmscore {
+namespace common {
+/*!
+ * Latency distribution of the requests sent to one endpoint, in fixed
+ * buckets from 5 ms to 30 s. The percentiles are the upper bound of the
+ * bucket they fall in, which is precise enough to choose a hedging budget.
+ */
+class LatencyHistogram {
+public:
+
+  LatencyHistogram();
+
+  void    Record(int64_t msecs);
+  int64_t Count();
+
+  // p in [0, 1]; 0 when nothing was recorded
+  int64_t Percentile(double p);
+
+  // "n=120 p50=100 p95=500 p99=1000 max=2000"
+  std::string Summary();
+
+  // the histogram of an endpoint, created on first use
+  static std::shared_ptr<LatencyHistogram> ForEndpoint(const std::string& endpoint);
+
+  static const int BucketCount = 13;
+
+private:
+
+  // undefined copy constructor and assignment operator
+  LatencyHistogram(const LatencyHistogram&);
+  LatencyHistogram& operator=(const LatencyHistogram&);
+
+  int64_t PercentileLocked(double p);
+
+  static const int64_t s_bucketBounds[BucketCount];
+
+  Mutex   m_mutex;
+  int64_t m_counts[BucketCount];
+  int64_t m_count;
+  int64_t m_max;
+};
+} // namespace common
+} // namespace rmscore
+#endif // _RMS_LIB_LATENCYHISTOGRAM_H_
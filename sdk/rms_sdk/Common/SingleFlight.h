@@ -0,0 +1,122 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef _RMS_LIB_SINGLEFLIGHT_H_
+#define _RMS_LIB_SINGLEFLIGHT_H_
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include "FrameworkSpecificTypes.h"
+#include "../ModernAPI/RMSExceptions.h"
+
+namespace rmscore {
+namespace common {
+/*!
+ * Deduplicates concurrent calls for the same key. The first caller (the
+ * leader) runs the operation, every caller that arrives while it is still in
+ * flight waits on the leader's shared future and gets the same result or
+ * exception. Waiters observe their own cancelState while waiting.
+ */
+template<typename T>
+class SingleFlight {
+public:
+
+  template<typename Fn>
+  T Do(const std::string                 & key,
+       std::shared_ptr<std::atomic<bool> >cancelState,
+       Fn                                 fn)
+  {
+    for (;;) {
+      std::shared_ptr<std::promise<T> > promise;
+      std::shared_future<T> future;
+      {
+        MutexLocker lock(&m_mutex);
+        auto i = m_inFlight.find(key);
+
+        if (i == m_inFlight.end()) {
+          promise = std::make_shared<std::promise<T> >();
+          future  = promise->get_future().share();
+          m_inFlight[key] = future;
+        } else {
+          future = i->second;
+        }
+      }
+
+      if (promise) {
+        // we are the leader, run the operation and publish its outcome
+        try {
+          T value = fn();
+          Complete(key);
+          promise->set_value(value);
+          return value;
+        } catch (...) {
+          Complete(key);
+          promise->set_exception(std::current_exception());
+          throw;
+        }
+      }
+
+      Wait(future, cancelState);
+
+      try {
+        return future.get();
+      } catch (exceptions::RMSNetworkException& e) {
+        // the leader was cancelled by its own caller, but this waiter was not,
+        // so retry (and most likely become the leader)
+        if ((e.reason() == exceptions::RMSNetworkException::CancelledByUser) &&
+            !IsCancelled(cancelState)) {
+          continue;
+        }
+        throw;
+      }
+    }
+  }
+
+  size_t InFlight() {
+    MutexLocker lock(&m_mutex);
+
+    return m_inFlight.size();
+  }
+
+private:
+
+  void Complete(const std::string& key) {
+    MutexLocker lock(&m_mutex);
+
+    m_inFlight.erase(key);
+  }
+
+  static bool IsCancelled(const std::shared_ptr<std::atomic<bool> >& cancelState)
+  {
+    return (cancelState != nullptr) && cancelState->load();
+  }
+
+  static void Wait(const std::shared_future<T>                & future,
+                   const std::shared_ptr<std::atomic<bool> >& cancelState)
+  {
+    const std::chrono::milliseconds slice(50);
+
+    while (future.wait_for(slice) != std::future_status::ready) {
+      if (IsCancelled(cancelState)) {
+        throw exceptions::RMSNetworkException(
+                "Network operation was cancelled by user",
+                exceptions::RMSNetworkException::CancelledByUser);
+      }
+    }
+  }
+
+  Mutex m_mutex;
+  std::map<std::string, std::shared_future<T> > m_inFlight;
+};
+} // namespace common
+} // namespace rmscore
+#endif // _RMS_LIB_SINGLEFLIGHT_H_
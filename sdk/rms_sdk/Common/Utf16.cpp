@@ -0,0 +1,144 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <stdint.h>
+#include "Utf16.h"
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+#endif // if defined(__AVX2__)
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# include <emmintrin.h>
+# define RMS_UTF16_SSE2
+#endif // if defined(__SSE2__) ...
+
+using namespace std;
+
+namespace rmscore {
+namespace common {
+// code units the scalar loop converts before the vector loops are tried again
+static const size_t SCALAR_RUN = 16;
+
+static inline uint32_t Unit(const uint8_t *in, size_t i)
+{
+  return static_cast<uint32_t>(in[2 * i]) |
+         (static_cast<uint32_t>(in[2 * i + 1]) << 8);
+}
+
+// converts the leading ASCII units of in, a vector at a time, and returns
+// how many it converted
+static size_t ConvertAscii(const uint8_t *in, size_t count, char *out)
+{
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  const __m256i nonAscii256 = _mm256_set1_epi16(static_cast<short>(0xff80));
+
+  for (; i + 16 <= count; i += 16) {
+    __m256i units = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(in + 2 * i));
+
+    if (!_mm256_testz_si256(units, nonAscii256)) break;
+
+    // the pack works within each 128 bit lane, the permutation brings the
+    // bytes of both lanes together in the low half
+    __m256i packed = _mm256_permute4x64_epi64(
+      _mm256_packus_epi16(units, units), 0xd8);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm256_castsi256_si128(packed));
+  }
+#endif // if defined(__AVX2__)
+
+#if defined(RMS_UTF16_SSE2)
+  const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xff80));
+  const __m128i zero     = _mm_setzero_si128();
+
+  for (; i + 8 <= count; i += 8) {
+    __m128i units = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(in + 2 * i));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, nonAscii),
+                                          zero)) != 0xffff) break;
+
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i),
+                     _mm_packus_epi16(units, units));
+  }
+#endif // if defined(RMS_UTF16_SSE2)
+
+#if !defined(__AVX2__) && !defined(RMS_UTF16_SSE2)
+  (void)in;
+  (void)count;
+  (void)out;
+#endif // if !defined(__AVX2__) && !defined(RMS_UTF16_SSE2)
+
+  return i;
+}
+
+size_t Utf16LEToUtf8(const void *pbUtf16, size_t count, char *pbUtf8)
+{
+  auto  in  = static_cast<const uint8_t *>(pbUtf16);
+  char *out = pbUtf8;
+  size_t i  = 0;
+
+  while (i < count) {
+    size_t ascii = ConvertAscii(in + 2 * i, count - i, out);
+
+    i   += ascii;
+    out += ascii;
+
+    for (size_t end = min(count, i + SCALAR_RUN); i < end;) {
+      uint32_t c = Unit(in, i++);
+
+      if (c < 0x80) {
+        *out++ = static_cast<char>(c);
+        continue;
+      }
+
+      if (c < 0x800) {
+        *out++ = static_cast<char>(0xc0 | (c >> 6));
+        *out++ = static_cast<char>(0x80 | (c & 0x3f));
+        continue;
+      }
+
+      if ((c >= 0xd800) && (c < 0xdc00) && (i < count)) {
+        uint32_t low = Unit(in, i);
+
+        if ((low >= 0xdc00) && (low < 0xe000)) {
+          // a surrogate pair, may run one unit past end
+          ++i;
+          c      = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+          *out++ = static_cast<char>(0xf0 | (c >> 18));
+          *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+          *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+          *out++ = static_cast<char>(0x80 | (c & 0x3f));
+          continue;
+        }
+      }
+
+      if ((c >= 0xd800) && (c < 0xe000)) c = 0xfffd;
+
+      *out++ = static_cast<char>(0xe0 | (c >> 12));
+      *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+      *out++ = static_cast<char>(0x80 | (c & 0x3f));
+    }
+  }
+
+  return static_cast<size_t>(out - pbUtf8);
+}
+
+void AppendUtf16LEAsUtf8(const void *pbUtf16, size_t count, string& utf8)
+{
+  size_t start = utf8.size();
+
+  utf8.resize(start + 3 * count);
+  utf8.resize(start + Utf16LEToUtf8(pbUtf16, count, &utf8[start]));
+}
+} // namespace common
+} // namespace rmscore
@@ -0,0 +1,36 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef _RMS_LIB_UTF16_H_
+#define _RMS_LIB_UTF16_H_
+
+#include <stddef.h>
+#include <string>
+
+namespace rmscore {
+namespace common {
+/*!
+ * Converts count UTF-16LE code units at pbUtf16, which needs no particular
+ * alignment, to UTF-8 at pbUtf8, which must have room for 3 * count bytes.
+ * Returns the number of bytes written. Unpaired surrogates become U+FFFD.
+ *
+ * Runs of ASCII, most of an XML document, are converted 16 units at a time
+ * with AVX2 when the SDK is built for it, 8 at a time with SSE2 otherwise on
+ * x86, one at a time on other processors.
+ */
+size_t Utf16LEToUtf8(const void *pbUtf16,
+                     size_t      count,
+                     char       *pbUtf8);
+
+// the same, appending to utf8
+void   AppendUtf16LEAsUtf8(const void  *pbUtf16,
+                           size_t       count,
+                           std::string& utf8);
+} // namespace common
+} // namespace rmscore
+#endif // _RMS_LIB_UTF16_H_
@@ -10,6 +10,7 @@
 #include <sstream>
 #include "ProtectionPolicy.h"
 #include "../Platform/Logger/Logger.h"
+#include "../Platform/Logger/Trace.h"
 #include "../ModernAPI/RMSExceptions.h"
 #include "../RestClients/IUsageRestrictionsClient.h"
 #include "../RestClients/IPublishClient.h"
@@ -100,54 +101,120 @@ shared_ptr<ProtectionPolicy>ProtectionPolicy::Acquire(
                                                   cbPublishLicense,
                                                   email);
   } catch (exceptions::RMSException) {
-    shared_ptr<IUsageRestrictionsClient> pClient =
-      IUsageRestrictionsClient::Create();
-
-    UsageRestrictionsRequest request =
-    {
-      pbPublishLicense, (uint32_t)cbPublishLicense
-    };
-
-    std::shared_ptr<UsageRestrictionsResponse> response =
-      pClient->GetUsageRestrictions(request,
-                                    authCallback,
-                                    consentCallback,
-                                    email,
-                                    bOffline,
-                                    cancelState,
-                                    cacheMask);
-
-    // log the response
-    Logger::Hidden("ProtectionPolicy::Acquire got a usage restrictions response");
-    Logger::Hidden("AccessStatus: %s",      response->accessStatus.c_str());
-    Logger::Hidden("Id: %s",                response->id.c_str());
-    Logger::Hidden("Name: %s",              response->name.c_str());
-    Logger::Hidden("Referrer: %s",          response->referrer.c_str());
-    Logger::Hidden("Owner: %s",             response->owner.c_str());
-    Logger::Hidden("CipherMode: %s",        response->key.cipherMode.c_str());
-    Logger::Hidden("AllowOfflineAccess: %s",
-                   (response->bAllowOfflineAccess ? "true" : "false"));
-    Logger::Hidden("licenseValidUntil: %s", response->licenseValidUntil.c_str());
-    Logger::Hidden("contentId: %s",         response->contentId.c_str());
-    Logger::Hidden("fromTemplate: %s",
-                   response->bFromTemplate ? "TRUE" : "FALSE");
-
-    // create and initialize a new protection policy object from the received
-    // response
-    pProtectionPolicy = shared_ptr<ProtectionPolicy>(new ProtectionPolicy());
-    pProtectionPolicy->Initialize(pbPublishLicense, cbPublishLicense, response);
-    pProtectionPolicy->SetRequester(email);
-
-    // add the newly acquired protection policy to cache
-    if (cacheMask & modernapi::RESPONSE_CACHE_INMEMORY) {
-      AddProtectionPolicyToCache(pProtectionPolicy);
-    }
+    // concurrent acquisitions of the same PL by the same requester share a
+    // single round trip to the server
+    auto key = GetAcquisitionKey(pbPublishLicense,
+                                 cbPublishLicense,
+                                 email,
+                                 bOffline,
+                                 cacheMask);
+
+    pProtectionPolicy = s_pendingAcquisitions.Do(
+      key,
+      cancelState,
+      [&]() -> shared_ptr<ProtectionPolicy> {
+          return AcquireFromServer(pbPublishLicense,
+                                   cbPublishLicense,
+                                   authCallback,
+                                   consentCallback,
+                                   email,
+                                   bOffline,
+                                   cancelState,
+                                   cacheMask);
+        });
   }
   Logger::Hidden(" -ProtectionPolicy::Acquire");
 
   return pProtectionPolicy;
 } // ProtectionPolicy::Acquire
 
+shared_ptr<ProtectionPolicy>ProtectionPolicy::AcquireFromServer(
+  const uint8_t                          *pbPublishLicense,
+  const size_t                            cbPublishLicense,
+  modernapi::IAuthenticationCallbackImpl& authCallback,
+  modernapi::IConsentCallbackImpl       & consentCallback,
+  const string                          & email,
+  const bool                              bOffline,
+  std::shared_ptr<std::atomic<bool> >     cancelState,
+  modernapi::ResponseCacheFlags           cacheMask)
+{
+  shared_ptr<IUsageRestrictionsClient> pClient =
+    IUsageRestrictionsClient::Create();
+
+  UsageRestrictionsRequest request =
+  {
+    pbPublishLicense, (uint32_t)cbPublishLicense
+  };
+
+  std::shared_ptr<UsageRestrictionsResponse> response =
+    pClient->GetUsageRestrictions(request,
+                                  authCallback,
+                                  consentCallback,
+                                  email,
+                                  bOffline,
+                                  cancelState,
+                                  cacheMask);
+
+  Logger::Hidden("ProtectionPolicy::Acquire got a usage restrictions response");
+
+  if (Trace::IsEnabled()) {
+    Trace::Event(TRACE_LICENSE_ACQUIRED)
+      .String(response->accessStatus)
+      .String(response->id)
+      .String(response->name)
+      .String(response->referrer)
+      .String(response->owner)
+      .String(response->key.cipherMode)
+      .String(response->contentId)
+      .Int(response->bFromTemplate ? 1 : 0)
+      .Int(response->bAllowOfflineAccess ? 1 : 0)
+      .String(response->licenseValidUntil);
+  }
+
+  // create and initialize a new protection policy object from the received
+  // response
+  auto pProtectionPolicy = shared_ptr<ProtectionPolicy>(new ProtectionPolicy());
+  pProtectionPolicy->Initialize(pbPublishLicense, cbPublishLicense, response);
+  pProtectionPolicy->SetRequester(email);
+
+  // add the newly acquired protection policy to cache
+  if (cacheMask & modernapi::RESPONSE_CACHE_INMEMORY) {
+    AddProtectionPolicyToCache(pProtectionPolicy);
+  }
+
+  return pProtectionPolicy;
+} // ProtectionPolicy::AcquireFromServer
+
+string ProtectionPolicy::GetAcquisitionKey(
+  const uint8_t                *pbPublishLicense,
+  const size_t                  cbPublishLicense,
+  const string                & requester,
+  const bool                    bOffline,
+  modernapi::ResponseCacheFlags cacheMask)
+{
+  auto cryptoEngine = rmscrypto::api::CreateCryptoEngine();
+  auto sha256       = cryptoEngine->CreateHash(
+    rmscrypto::api::CryptoHashAlgorithm::CRYPTO_HASH_ALGORITHM_SHA256);
+
+  common::ByteArray vbHash(sha256->GetOutputSize());
+  uint32_t cbHashSize = static_cast<uint32_t>(vbHash.size());
+
+  sha256->Hash(pbPublishLicense, static_cast<uint32_t>(cbPublishLicense),
+               &vbHash[0], cbHashSize);
+  vbHash.resize(cbHashSize);
+
+  auto hash = common::ConvertBytesToBase64(vbHash);
+
+  string lowerRequester(requester);
+  transform(lowerRequester.begin(), lowerRequester.end(),
+            lowerRequester.begin(), ::tolower);
+
+  ostringstream key;
+  key << string(hash.begin(), hash.end()) << "|" << lowerRequester << "|" <<
+    (bOffline ? 1 : 0) << "|" << static_cast<int>(cacheMask);
+  return key.str();
+} // ProtectionPolicy::GetAcquisitionKey
+
 std::shared_ptr<ProtectionPolicy>ProtectionPolicy::Create(
   const bool                              bPreferDeprecatedAlgorithms,
   const bool                              bAllowAuditedExtraction,
@@ -173,19 +240,19 @@ std::shared_ptr<ProtectionPolicy>ProtectionPolicy::Create(
                                                        email,
                                                        cancelState);
 
-  // log the response
-  Logger::Hidden("ProtectionPolicy ::Create got a publish response");
-
-  string license;
-  for(auto x : response.serializedLicense)
-      license.push_back(x);
-  Logger::Hidden("Serialized License: %s", license.c_str());
-  Logger::Hidden("Id: %s",         response.id.c_str());
-  Logger::Hidden("Name: %s",       response.name.c_str());
-  Logger::Hidden("Referrer: '%s'", response.referrer.c_str());
-  Logger::Hidden("Owner: %s",      response.owner.c_str());
-  Logger::Hidden("CipherMode: %s", response.key.cipherMode.c_str());
-  Logger::Hidden("ContentId: %s",  response.contentId.c_str());
+  Logger::Hidden("ProtectionPolicy::Create got a publish response");
+
+  if (Trace::IsEnabled()) {
+    Trace::Event(TRACE_LICENSE_PUBLISHED)
+      .String(response.id)
+      .String(response.name)
+      .String(response.referrer)
+      .String(response.owner)
+      .String(response.key.cipherMode)
+      .String(response.contentId)
+      .Secret(response.serializedLicense.data(),
+              response.serializedLicense.size());
+  }
 
   // create and initialize a new protection policy object from the received
   // response
@@ -266,15 +333,19 @@ shared_ptr<ProtectionPolicy>ProtectionPolicy::Create(
                                                 email,
                                                 cancelState);
 
-  // log the response
-  Logger::Hidden(
-    "ProtectionPolicy ::Create got a publish response with Id ='%s',Name = '%s'',Referrer = '%s'', Owner = '%s', CipherMode : '%s',ContentId: '%s'",
-    response.id.c_str(),
-    response.name.c_str(),
-    response.referrer.c_str(),
-    response.owner.c_str(),
-    response.key.cipherMode.c_str(),
-    response.contentId.c_str());
+  Logger::Hidden("ProtectionPolicy::Create got a publish response");
+
+  if (Trace::IsEnabled()) {
+    Trace::Event(TRACE_LICENSE_PUBLISHED)
+      .String(response.id)
+      .String(response.name)
+      .String(response.referrer)
+      .String(response.owner)
+      .String(response.key.cipherMode)
+      .String(response.contentId)
+      .Secret(response.serializedLicense.data(),
+              response.serializedLicense.size());
+  }
 
   auto pProtectionPolicy = shared_ptr<ProtectionPolicy>(new ProtectionPolicy());
   pProtectionPolicy->Initialize(response,
@@ -576,5 +647,7 @@ void ProtectionPolicy::AddProtectionPolicyToCache(
 ProtectionPolicy::CachedProtectionPolicies *ProtectionPolicy::
 s_pCachedProtectionPolicies = nullptr;
 common::Mutex ProtectionPolicy::s_cachedProtectionPoliciesMutex;
+common::SingleFlight<shared_ptr<ProtectionPolicy> >
+ProtectionPolicy::s_pendingAcquisitions;
 } // namespace core
 } // namespace rmscore
@@ -13,6 +13,7 @@
 #include <CryptoAPI.h>
 #include "../Common/CommonTypes.h"
 #include "../Common/FrameworkSpecificTypes.h"
+#include "../Common/SingleFlight.h"
 #include "../ModernAPI/IConsentCallbackImpl.h"
 #include "../ModernAPI/IAuthenticationCallbackImpl.h"
 #include "../ModernAPI/ProtectedFileStream.h"
@@ -222,8 +223,27 @@ public:
   static void AddProtectionPolicyToCache(
     std::shared_ptr<ProtectionPolicy>pProtectionPolicy);
 
+  // builds the key used to coalesce concurrent acquisitions: hash of the PL,
+  // requester and the flags which may change the outcome
+  static std::string GetAcquisitionKey(
+    const uint8_t                *pbPublishLicense,
+    const size_t                  cbPublishLicense,
+    const std::string           & requester,
+    const bool                    bOffline,
+    modernapi::ResponseCacheFlags cacheMask);
+
 private:
 
+  static std::shared_ptr<ProtectionPolicy>AcquireFromServer(
+    const uint8_t                          *pbPublishLicense,
+    const size_t                            cbPublishLicense,
+    modernapi::IAuthenticationCallbackImpl& authCallback,
+    modernapi::IConsentCallbackImpl       & consentCallback,
+    const std::string                     & email,
+    const bool                              bOffline,
+    std::shared_ptr<std::atomic<bool> >     cancelState,
+    modernapi::ResponseCacheFlags           cacheMask);
+
   // undefined copy constructor
   ProtectionPolicy(const ProtectionPolicy&);
 
@@ -263,6 +283,10 @@ private:
 
   static CachedProtectionPolicies *s_pCachedProtectionPolicies;
   static common::Mutex s_cachedProtectionPoliciesMutex;
+
+  // acquisitions currently in flight, keyed by GetAcquisitionKey()
+  static common::SingleFlight<std::shared_ptr<ProtectionPolicy> >
+  s_pendingAcquisitions;
 };
 } // namespace core
 } // namespace rmscore
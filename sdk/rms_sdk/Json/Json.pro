@@ -11,8 +11,12 @@ CONFIG(debug, debug|release) {
 }
 
 SOURCES += \
-    JsonSerializer.cpp
+    JsonSerializer.cpp \
+    JsonReader.cpp \
+    JsonWriter.cpp
 
 HEADERS += \
     IJsonSerializer.h \
-    JsonSerializer.h
+    JsonSerializer.h \
+    JsonReader.h \
+    JsonWriter.h
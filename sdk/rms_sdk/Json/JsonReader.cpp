@@ -0,0 +1,437 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include "JsonReader.h"
+
+using namespace std;
+
+namespace rmscore {
+namespace json {
+// deeper documents are rejected rather than risking the stack of callers
+// that recurse
+static const size_t MAX_DEPTH = 1024;
+
+JsonReader::JsonReader(const uint8_t *pbJson, size_t cbJson)
+  : m_begin(reinterpret_cast<const char *>(pbJson))
+  , m_position(m_begin)
+  , m_end(m_begin + cbJson)
+{}
+
+JsonReader::Type JsonReader::PeekType()
+{
+  switch (PeekChar()) {
+  case '{':
+    return Object;
+
+  case '[':
+    return Array;
+
+  case '"':
+    return String;
+
+  case 't':
+  case 'f':
+    return Bool;
+
+  case 'n':
+    return Null;
+
+  default:
+    return Number;
+  }
+}
+
+void JsonReader::BeginObject()
+{
+  if (PeekType() != Object) {
+    throw exceptions::RMSInvalidArgumentException(
+            "JsonReader: the value is not an object");
+  }
+
+  if (m_hasValue.size() >= MAX_DEPTH) Fail("too deep");
+
+  ++m_position;
+  m_hasValue.push_back(false);
+}
+
+bool JsonReader::NextMember(string& name)
+{
+  if (!NextInContainer('}')) return false;
+
+  if (PeekChar() != '"') Fail("expected a member name");
+
+  ParseString(name);
+  Expect(':');
+  return true;
+}
+
+void JsonReader::BeginArray()
+{
+  if (PeekType() != Array) {
+    throw exceptions::RMSInvalidArgumentException(
+            "JsonReader: the value is not an array");
+  }
+
+  if (m_hasValue.size() >= MAX_DEPTH) Fail("too deep");
+
+  ++m_position;
+  m_hasValue.push_back(false);
+}
+
+bool JsonReader::NextElement()
+{
+  return NextInContainer(']');
+}
+
+bool JsonReader::NextInContainer(char close)
+{
+  if (PeekChar() == close) {
+    ++m_position;
+    m_hasValue.pop_back();
+    return false;
+  }
+
+  if (m_hasValue.back()) Expect(',');
+  m_hasValue.back() = true;
+  return true;
+}
+
+string JsonReader::ReadString(const string& defaultValue)
+{
+  switch (PeekType()) {
+  case String:
+  {
+    string value;
+    ParseString(value);
+    return value;
+  }
+
+  case Null:
+    SkipValue();
+    return defaultValue;
+
+  default:
+    throw exceptions::RMSInvalidArgumentException(
+            "JsonReader: the value is not a string");
+  }
+}
+
+bool JsonReader::ReadBool(bool defaultValue)
+{
+  switch (PeekType()) {
+  case Bool:
+
+    if (Consume("true")) return true;
+
+    if (Consume("false")) return false;
+
+    Fail("invalid literal");
+
+  case Null:
+    SkipValue();
+    return defaultValue;
+
+  default:
+    throw exceptions::RMSInvalidArgumentException(
+            "JsonReader: the value is not a boolean");
+  }
+}
+
+double JsonReader::ReadNumber(double defaultValue)
+{
+  switch (PeekType()) {
+  case Number:
+    return ParseNumber();
+
+  case Null:
+    SkipValue();
+    return defaultValue;
+
+  default:
+    throw exceptions::RMSInvalidArgumentException(
+            "JsonReader: the value is not a number");
+  }
+}
+
+vector<string>JsonReader::ReadStringArray()
+{
+  vector<string> values;
+
+  if (PeekType() == Null) {
+    SkipValue();
+    return values;
+  }
+
+  BeginArray();
+
+  while (NextElement()) {
+    if (PeekType() == String) {
+      values.push_back(string());
+      ParseString(values.back());
+    } else {
+      SkipValue();
+      values.push_back(string());
+    }
+  }
+  return values;
+}
+
+void JsonReader::SkipValue()
+{
+  // the containers opened here, true for an object; iterative, so that deep
+  // documents can't exhaust the stack
+  vector<bool> inObject;
+  string ignored;
+
+  for (;;) {
+    switch (PeekType()) {
+    case Object:
+      BeginObject();
+      inObject.push_back(true);
+      break;
+
+    case Array:
+      BeginArray();
+      inObject.push_back(false);
+      break;
+
+    case String:
+      ParseString(ignored);
+      break;
+
+    case Bool:
+
+      if (!Consume("true") && !Consume("false")) Fail("invalid literal");
+      break;
+
+    case Null:
+
+      if (!Consume("null")) Fail("invalid literal");
+      break;
+
+    case Number:
+      ParseNumber();
+      break;
+    }
+
+    // moves to the next value, closing the containers that end here
+    for (;;) {
+      if (inObject.empty()) return;
+
+      if (inObject.back() ? NextMember(ignored) : NextElement()) break;
+
+      inObject.pop_back();
+    }
+  }
+}
+
+void JsonReader::End()
+{
+  SkipWhiteSpace();
+
+  if (m_position != m_end) Fail("unexpected data after the document");
+}
+
+void JsonReader::SkipWhiteSpace()
+{
+  while ((m_position < m_end) &&
+         ((*m_position == ' ') || (*m_position == '\t') ||
+          (*m_position == '\n') || (*m_position == '\r'))) {
+    ++m_position;
+  }
+}
+
+char JsonReader::PeekChar()
+{
+  SkipWhiteSpace();
+
+  if (m_position == m_end) Fail("unexpected end of the document");
+
+  return *m_position;
+}
+
+void JsonReader::Expect(char c)
+{
+  if (PeekChar() != c) {
+    char what[] = "expected ' '";
+    what[10] = c;
+    Fail(what);
+  }
+  ++m_position;
+}
+
+bool JsonReader::Consume(const char *literal)
+{
+  size_t length = strlen(literal);
+
+  if ((static_cast<size_t>(m_end - m_position) < length) ||
+      (memcmp(m_position, literal, length) != 0)) {
+    return false;
+  }
+  m_position += length;
+  return true;
+}
+
+void JsonReader::ParseString(string& value)
+{
+  value.clear();
+  ++m_position; // the opening quote
+
+  for (;;) {
+    // the characters that need no unescaping are copied in runs
+    auto run = m_position;
+
+    while ((m_position < m_end) && (*m_position != '"') &&
+           (*m_position != '\\') &&
+           (static_cast<unsigned char>(*m_position) >= 0x20)) {
+      ++m_position;
+    }
+    value.append(run, m_position);
+
+    if (m_position == m_end) Fail("unterminated string");
+
+    char c = *m_position++;
+
+    if (c == '"') return;
+
+    if (c != '\\') Fail("control character in a string");
+
+    if (m_position == m_end) Fail("unterminated string");
+
+    switch (*m_position++) {
+    case '"':  value += '"';  break;
+    case '\\': value += '\\'; break;
+    case '/':  value += '/';  break;
+    case 'b':  value += '\b'; break;
+    case 'f':  value += '\f'; break;
+    case 'n':  value += '\n'; break;
+    case 'r':  value += '\r'; break;
+    case 't':  value += '\t'; break;
+    case 'u':
+    {
+      uint32_t codePoint = ParseHex4();
+
+      if ((codePoint >= 0xd800) && (codePoint < 0xdc00) &&
+          (m_end - m_position >= 6) && (m_position[0] == '\\') &&
+          (m_position[1] == 'u')) {
+        auto     pair = m_position;
+        m_position += 2;
+        uint32_t low = ParseHex4();
+
+        if ((low >= 0xdc00) && (low < 0xe000)) {
+          codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+        } else {
+          // not a pair, the second escape is read on its own
+          m_position = pair;
+        }
+      }
+
+      // unpaired surrogates can't be encoded in UTF-8
+      if ((codePoint >= 0xd800) && (codePoint < 0xe000)) codePoint = 0xfffd;
+
+      AppendCodePoint(codePoint, value);
+      break;
+    }
+
+    default:
+      Fail("invalid escape sequence");
+    }
+  }
+}
+
+void JsonReader::AppendCodePoint(uint32_t codePoint, string& value)
+{
+  if (codePoint < 0x80) {
+    value += static_cast<char>(codePoint);
+  } else if (codePoint < 0x800) {
+    value += static_cast<char>(0xc0 | (codePoint >> 6));
+    value += static_cast<char>(0x80 | (codePoint & 0x3f));
+  } else if (codePoint < 0x10000) {
+    value += static_cast<char>(0xe0 | (codePoint >> 12));
+    value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    value += static_cast<char>(0x80 | (codePoint & 0x3f));
+  } else {
+    value += static_cast<char>(0xf0 | (codePoint >> 18));
+    value += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+    value += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+    value += static_cast<char>(0x80 | (codePoint & 0x3f));
+  }
+}
+
+uint32_t JsonReader::ParseHex4()
+{
+  if (m_end - m_position < 4) Fail("invalid escape sequence");
+
+  uint32_t value = 0;
+
+  for (int i = 0; i < 4; ++i) {
+    char c = *m_position++;
+    value <<= 4;
+
+    if ((c >= '0') && (c <= '9')) value |= c - '0';
+    else if ((c >= 'a') && (c <= 'f')) value |= c - 'a' + 10;
+    else if ((c >= 'A') && (c <= 'F')) value |= c - 'A' + 10;
+    else Fail("invalid escape sequence");
+  }
+  return value;
+}
+
+double JsonReader::ParseNumber()
+{
+  // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  auto start = m_position;
+  auto digits = [this]() {
+                  auto first = m_position;
+
+                  while ((m_position < m_end) && (*m_position >= '0') &&
+                         (*m_position <= '9')) {
+                    ++m_position;
+                  }
+                  return m_position != first;
+                };
+
+  if ((m_position < m_end) && (*m_position == '-')) ++m_position;
+
+  if ((m_position < m_end) && (*m_position == '0')) ++m_position;
+  else if (!digits()) Fail("invalid value");
+
+  if ((m_position < m_end) && (*m_position == '.')) {
+    ++m_position;
+
+    if (!digits()) Fail("invalid number");
+  }
+
+  if ((m_position < m_end) && ((*m_position == 'e') || (*m_position == 'E'))) {
+    ++m_position;
+
+    if ((m_position < m_end) && ((*m_position == '+') || (*m_position == '-'))) {
+      ++m_position;
+    }
+
+    if (!digits()) Fail("invalid number");
+  }
+
+  // independent of the locale's decimal point
+  istringstream stream(string(start, m_position));
+  stream.imbue(locale::classic());
+
+  double value = 0;
+  stream >> value;
+  return value;
+}
+
+void JsonReader::Fail(const char *what)
+{
+  throw SyntaxError(string("JsonReader: ") + what + " at offset " +
+                    to_string(m_position - m_begin));
+}
+} // namespace json
+} // namespace rmscore
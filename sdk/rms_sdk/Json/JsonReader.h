@@ -0,0 +1,106 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_JSONREADER_H_
+#define _RMS_LIB_JSONREADER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "../ModernAPI/RMSExceptions.h"
+
+namespace rmscore {
+namespace json {
+/*!
+ * A pull parser over a JSON document in memory: the caller walks the
+ * document in order and reads each value straight into its own fields, no
+ * tree is built. Values the caller doesn't ask for are skipped.
+ *
+ *   reader.BeginObject();
+ *   while (reader.NextMember(name)) {
+ *     if (name == "Id") id = reader.ReadString();
+ *     else reader.SkipValue();
+ *   }
+ *   reader.End();
+ *
+ * The Read methods convert the way IJsonObject's getters do: null gives the
+ * default value, a value of another type throws RMSInvalidArgumentException.
+ * Malformed JSON throws JsonReader::SyntaxError.
+ */
+class JsonReader {
+public:
+
+  class SyntaxError : public exceptions::RMSInvalidArgumentException {
+public:
+
+    SyntaxError(const std::string& message) _NOEXCEPT
+      : exceptions::RMSInvalidArgumentException(message) {}
+
+    virtual ~SyntaxError() _NOEXCEPT {}
+  };
+
+  enum Type { Null, Bool, Number, String, Object, Array };
+
+  JsonReader(const uint8_t *pbJson,
+             size_t         cbJson);
+
+  // the type of the next value
+  Type        PeekType();
+
+  void        BeginObject();
+
+  // reads the name of the next member of the current object, false at its
+  // end
+  bool        NextMember(std::string& name);
+
+  void        BeginArray();
+
+  // true if the current array has another element, false at its end
+  bool        NextElement();
+
+  std::string ReadString(const std::string& defaultValue = std::string());
+  bool        ReadBool(bool defaultValue = false);
+  double      ReadNumber(double defaultValue = 0.0);
+
+  // reads an array of strings, null gives an empty one; elements of other
+  // types read as empty strings
+  std::vector<std::string>ReadStringArray();
+
+  void        SkipValue();
+
+  // checks that nothing but white space follows the document
+  void        End();
+
+private:
+
+  JsonReader(const JsonReader&);
+  JsonReader& operator=(const JsonReader&);
+
+  void        SkipWhiteSpace();
+  char        PeekChar();
+  void        Expect(char c);
+  bool        Consume(const char *literal);
+  void        ParseString(std::string& value);
+  void        AppendCodePoint(uint32_t    codePoint,
+                              std::string& value);
+  uint32_t    ParseHex4();
+  double      ParseNumber();
+  bool        NextInContainer(char close);
+
+  [[noreturn]] void Fail(const char *what);
+
+  const char *m_begin;
+  const char *m_position;
+  const char *m_end;
+
+  // for each open object or array, whether it has had a value yet
+  std::vector<bool> m_hasValue;
+};
+} // namespace json
+} // namespace rmscore
+#endif // _RMS_LIB_JSONREADER_H_
@@ -0,0 +1,199 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include <cstring>
+#include "JsonWriter.h"
+
+using namespace std;
+
+namespace rmscore {
+namespace json {
+JsonWriter::JsonWriter(common::ByteArray& buffer)
+  : m_buffer(buffer)
+  , m_afterName(false)
+{}
+
+JsonWriter& JsonWriter::BeginObject()
+{
+  Separate();
+  m_buffer.push_back('{');
+  m_hasValue.push_back(false);
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndObject()
+{
+  m_buffer.push_back('}');
+  m_hasValue.pop_back();
+  return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray()
+{
+  Separate();
+  m_buffer.push_back('[');
+  m_hasValue.push_back(false);
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndArray()
+{
+  m_buffer.push_back(']');
+  m_hasValue.pop_back();
+  return *this;
+}
+
+JsonWriter& JsonWriter::Name(const char *name)
+{
+  Separate();
+  m_buffer.push_back('"');
+  AppendEscaped(name, strlen(name));
+  Append("\":", 2);
+  m_afterName = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::Name(const string& name)
+{
+  Separate();
+  m_buffer.push_back('"');
+  AppendEscaped(name.data(), name.size());
+  Append("\":", 2);
+  m_afterName = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::String(const char *value)
+{
+  Separate();
+  m_buffer.push_back('"');
+  AppendEscaped(value, strlen(value));
+  m_buffer.push_back('"');
+  return *this;
+}
+
+JsonWriter& JsonWriter::String(const string& value)
+{
+  Separate();
+  m_buffer.push_back('"');
+  AppendEscaped(value.data(), value.size());
+  m_buffer.push_back('"');
+  return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value)
+{
+  Separate();
+
+  if (value) Append("true", 4);
+  else Append("false", 5);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Number(int64_t value)
+{
+  Separate();
+
+  string text = to_string(value);
+  Append(text.data(), text.size());
+  return *this;
+}
+
+JsonWriter& JsonWriter::Base64(const void *pbData, size_t cbData)
+{
+  static const char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  Separate();
+  m_buffer.push_back('"');
+
+  auto   in    = static_cast<const uint8_t *>(pbData);
+  size_t start = m_buffer.size();
+
+  // the encoding is written in place, 3 bytes to 4 characters
+  m_buffer.resize(start + (cbData + 2) / 3 * 4);
+
+  auto   out = reinterpret_cast<char *>(&m_buffer[start]);
+  size_t i   = 0;
+
+  for (; i + 3 <= cbData; i += 3) {
+    uint32_t triple = (static_cast<uint32_t>(in[i]) << 16) |
+                      (static_cast<uint32_t>(in[i + 1]) << 8) | in[i + 2];
+    *out++ = alphabet[triple >> 18];
+    *out++ = alphabet[(triple >> 12) & 0x3f];
+    *out++ = alphabet[(triple >> 6) & 0x3f];
+    *out++ = alphabet[triple & 0x3f];
+  }
+
+  if (i < cbData) {
+    uint32_t triple = static_cast<uint32_t>(in[i]) << 16;
+
+    if (i + 1 < cbData) triple |= static_cast<uint32_t>(in[i + 1]) << 8;
+
+    *out++ = alphabet[triple >> 18];
+    *out++ = alphabet[(triple >> 12) & 0x3f];
+    *out++ = (i + 1 < cbData) ? alphabet[(triple >> 6) & 0x3f] : '=';
+    *out++ = '=';
+  }
+
+  m_buffer.push_back('"');
+  return *this;
+}
+
+void JsonWriter::Separate()
+{
+  if (m_afterName) {
+    m_afterName = false;
+    return;
+  }
+
+  if (!m_hasValue.empty()) {
+    if (m_hasValue.back()) m_buffer.push_back(',');
+    m_hasValue.back() = true;
+  }
+}
+
+void JsonWriter::Append(const char *text, size_t size)
+{
+  m_buffer.insert(m_buffer.end(), text, text + size);
+}
+
+void JsonWriter::AppendEscaped(const char *text, size_t size)
+{
+  static const char hex[] = "0123456789abcdef";
+
+  size_t run = 0;
+
+  for (size_t i = 0; i < size; ++i) {
+    auto c = static_cast<uint8_t>(text[i]);
+
+    if ((c >= 0x20) && (c != '"') && (c != '\\')) continue;
+
+    // the characters that need no escaping are copied in runs
+    Append(text + run, i - run);
+    run = i + 1;
+
+    switch (c) {
+    case '"':  Append("\\\"", 2); break;
+    case '\\': Append("\\\\", 2); break;
+    case '\b': Append("\\b", 2);  break;
+    case '\f': Append("\\f", 2);  break;
+    case '\n': Append("\\n", 2);  break;
+    case '\r': Append("\\r", 2);  break;
+    case '\t': Append("\\t", 2);  break;
+    default:
+    {
+      char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+      Append(escaped, sizeof(escaped));
+    }
+    }
+  }
+  Append(text + run, size - run);
+}
+} // namespace json
+} // namespace rmscore
@@ -0,0 +1,72 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_JSONWRITER_H_
+#define _RMS_LIB_JSONWRITER_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "../Common/CommonTypes.h"
+
+namespace rmscore {
+namespace json {
+/*!
+ * Writes compact JSON straight into a byte buffer, without building a tree.
+ * The output is the same as QJsonDocument::toJson(QJsonDocument::Compact)
+ * for the same document, provided the caller writes the members of each
+ * object in the order QJsonObject keeps them, i.e. sorted by name, and
+ * passes valid UTF-8 strings.
+ *
+ * The writer appends to the buffer it is given, which can be reused, and
+ * does not check that the calls form a valid document.
+ */
+class JsonWriter {
+public:
+
+  explicit JsonWriter(common::ByteArray& buffer);
+
+  JsonWriter& BeginObject();
+  JsonWriter& EndObject();
+  JsonWriter& BeginArray();
+  JsonWriter& EndArray();
+
+  // the name of the next member of the current object
+  JsonWriter& Name(const char *name);
+  JsonWriter& Name(const std::string& name);
+
+  JsonWriter& String(const char *value);
+  JsonWriter& String(const std::string& value);
+  JsonWriter& Bool(bool value);
+  JsonWriter& Number(int64_t value);
+
+  // a string holding the base64 encoding of the bytes
+  JsonWriter& Base64(const void *pbData,
+                     size_t      cbData);
+
+private:
+
+  JsonWriter(const JsonWriter&);
+  JsonWriter& operator=(const JsonWriter&);
+
+  void Separate();
+  void Append(const char *text,
+              size_t      size);
+  void AppendEscaped(const char *text,
+                     size_t      size);
+
+  common::ByteArray& m_buffer;
+
+  // whether the innermost object or array has a value yet, and whether a
+  // member name was just written
+  std::vector<bool> m_hasValue;
+  bool m_afterName;
+};
+} // namespace json
+} // namespace rmscore
+#endif // _RMS_LIB_JSONWRITER_H_
@@ -8,72 +8,104 @@
 
 #include <cmath>
 #include <algorithm>
+#include <QVariant>
 #include "../ModernAPI/RMSExceptions.h"
 #include "../Common/tools.h"
 #include "../Common/FrameworkSpecificTypes.h"
 #include "../Platform/Json/IJsonObject.h"
 #include "../Platform/Json/IJsonArray.h"
 #include "../Platform/Json/IJsonParser.h"
+#include "../Platform/Logger/Logger.h"
 #include "jsonserializer.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
 
 using namespace std;
 using namespace rmscore::platform::json;
+using namespace rmscore::platform::logger;
 using namespace rmscore::common;
 using namespace rmscore::restclients;
 
 namespace rmscore {
 namespace json {
+// QJsonObject kept the members of the requests sorted by name, in UTF-16
+// order; the writer needs them in that order to produce the same bytes
+static void WriteAppData(JsonWriter                     & writer,
+                         const modernapi::AppDataHashMap& appData)
+{
+  vector<pair<QString, const modernapi::AppDataHashMap::value_type *> > sorted;
+
+  for (auto& item : appData) {
+    sorted.push_back(make_pair(QString::fromStdString(item.first), &item));
+  }
+  sort(begin(sorted), end(sorted),
+       [](const pair<QString, const modernapi::AppDataHashMap::value_type *>& left,
+          const pair<QString, const modernapi::AppDataHashMap::value_type *>& right)
+    {
+      return left.first < right.first;
+    });
+
+  writer.BeginObject();
+
+  for (auto& item : sorted) {
+    writer.Name(item.second->first).String(item.second->second);
+  }
+  writer.EndObject();
+}
+
+static void WriteStrings(JsonWriter& writer, const vector<string>& values)
+{
+  writer.BeginArray();
+
+  for (auto& value : values) {
+    writer.String(value);
+  }
+  writer.EndArray();
+}
+
 ByteArray JsonSerializer::SerializeUsageRestrictionsRequest(
   const UsageRestrictionsRequest& request)
 {
-  // convert the PL to base64 encoded string
-  ByteArray base64PL(ConvertBytesToBase64(request.pbPublishLicense,
-                                          request.cbPublishLicense));
+  // the PL is base64 encoded straight into the request
+  ByteArray  serialized;
+  JsonWriter writer(serialized);
 
-  auto pJsonObject = IJsonObject::Create();
+  serialized.reserve(request.cbPublishLicense / 3 * 4 + 64);
 
-  pJsonObject->SetNamedValue("SerializedPublishingLicense", base64PL);
+  writer.BeginObject()
+  .Name("SerializedPublishingLicense")
+  .Base64(request.pbPublishLicense, request.cbPublishLicense)
+  .EndObject();
 
-  return pJsonObject->Stringify();
+  return serialized;
 }
 
 common::ByteArray JsonSerializer::SerializePublishUsingTemplateRequest(
   const PublishUsingTemplateRequest& request)
 {
-  auto pJson = IJsonObject::Create();
+  ByteArray  serialized;
+  JsonWriter writer(serialized);
 
-  pJson->SetNamedBool("PreferDeprecatedAlgorithms",
-                      request.bPreferDeprecatedAlgorithms);
-  pJson->SetNamedBool("AllowAuditedExtraction",
-                      request.bAllowAuditedExtraction);
-  pJson->SetNamedString("TemplateId", request.templateId);
+  writer.BeginObject();
+  writer.Name("AllowAuditedExtraction").Bool(request.bAllowAuditedExtraction);
+  writer.Name("PreferDeprecatedAlgorithms").Bool(
+    request.bPreferDeprecatedAlgorithms);
 
   if (!request.signedApplicationData.empty())
   {
-    auto pSignedApplicationDataJson = IJsonObject::Create();
-
-    for_each(
-      begin(request.signedApplicationData),
-      end(request.signedApplicationData),
-      [ = ](const pair<string, string>& appData)
-        {
-          // pSignedApplicationDataJson->SetNamedString(appData.name,
-          // appData.value);
-          pSignedApplicationDataJson->SetNamedString(appData.first,
-                                                     appData.second);
-        });
-
-    pJson->SetNamedObject("SignedApplicationData", *pSignedApplicationDataJson);
+    writer.Name("SignedApplicationData");
+    WriteAppData(writer, request.signedApplicationData);
   }
 
-  return pJson->Stringify();
+  writer.Name("TemplateId").String(request.templateId);
+  writer.EndObject();
+
+  return serialized;
 }
 
 common::ByteArray JsonSerializer::SerializePublishCustomRequest(
   const PublishCustomRequest& request)
 {
-  auto pJson = IJsonObject::Create();
-
   // Request
   // {
   //	"PreferDeprecatedAlgorithms": ...,
@@ -94,47 +126,52 @@ common::ByteArray JsonSerializer::SerializePublishCustomRequest(
   //	      ...
   //      }
   // }
+  //
+  // the members are written sorted by name, see WriteAppData
+  ByteArray  serialized;
+  JsonWriter writer(serialized);
 
-  pJson->SetNamedBool("PreferDeprecatedAlgorithms",
-                      request.bPreferDeprecatedAlgorithms);
-  pJson->SetNamedBool("AllowAuditedExtraction",
-                      request.bAllowAuditedExtraction);
+  writer.BeginObject();
+  writer.Name("AllowAuditedExtraction").Bool(request.bAllowAuditedExtraction);
 
-  // Add ReferralInfo only when referrer is set
-  if (request.wsReferralInfo.length() > 0)
-  {
-    pJson->SetNamedString("ReferralInfo", request.wsReferralInfo);
+  writer.Name("Policy").BeginObject();
+
+  // Add Descriptors
+  if (!request.name.empty() &&
+      !request.description.empty() &&
+      !request.language.empty()) {
+    writer.Name("Descriptors").BeginArray().BeginObject();
+    writer.Name("Description").String(request.description);
+    writer.Name("Language").String(request.language);
+    writer.Name("Name").String(request.name);
+    writer.EndObject().EndArray();
   }
 
-  if (!request.signedApplicationData.empty())
+  // the appdata should look like this:
+  // "Policy": {
+  //      ...
+  //      "EncryptedApplicationData": {
+  //          "EncryptedAppDataName1": "EncryptedAppDataValue1"
+  //          "EncryptedAppDataName2": "EncryptedAppDataValue2"
+  //          ...
+  //      },
+  //      ...
+  // }
+  if (!request.encryptedApplicationData.empty())
   {
-    auto pSignedApplicationDataJson = IJsonObject::Create();
-
-    for_each(
-      begin(request.signedApplicationData),
-      end(request.signedApplicationData),
-      [ = ](const pair<string, string>& appData)
-        {
-          pSignedApplicationDataJson->SetNamedString(appData.first,
-                                                     appData.second);
-        });
-
-    pJson->SetNamedObject("SignedApplicationData", *pSignedApplicationDataJson);
+    writer.Name("EncryptedApplicationData");
+    WriteAppData(writer, request.encryptedApplicationData);
   }
 
-  auto pPolicyJson = IJsonObject::Create();
+  // old version support
+  writer.Name("IntervalTimeInDays").Number(request.bAllowOfflineAccess ? 30 : 0);
 
-  // Add Descriptors
-  if (!request.name.empty() &&
-      !request.description.empty() &&
-      !request.language.empty()) {
-    auto pDescriptorObjectArray = IJsonArray::Create();
-    auto pDescriptorObject      = IJsonObject::Create();
-    pDescriptorObject->SetNamedString("Name",        request.name);
-    pDescriptorObject->SetNamedString("Description", request.description);
-    pDescriptorObject->SetNamedString("Language",    request.language);
-    pDescriptorObjectArray->Append(*pDescriptorObject);
-    pPolicyJson->SetNamedArray("Descriptors", *pDescriptorObjectArray);
+  if (std::chrono::system_clock::to_time_t(request.ftLicenseValidUntil) > 0)
+  {
+    common::DateTime dt = common::DateTime::fromTime_t(
+      std::chrono::system_clock::to_time_t(request.ftLicenseValidUntil));
+    writer.Name("LicenseValidUntil").String(
+      dt.toUTC().toString(Qt::ISODate).toStdString());
   }
 
   // the user rights list json in the policy looks something like this:
@@ -160,205 +197,250 @@ common::ByteArray JsonSerializer::SerializePublishCustomRequest(
   //      ],
   //      ...
   // }
+  WriteUserRightsOrRoles(writer, request);
 
+  writer.Name("allowOfflineAccess").Bool(request.bAllowOfflineAccess);
+  writer.EndObject();
 
-  AddUserRightsOrRolesInCustomRequest(pPolicyJson.get(), request);
-
-  pPolicyJson->SetNamedBool("allowOfflineAccess", request.bAllowOfflineAccess);
+  writer.Name("PreferDeprecatedAlgorithms").Bool(
+    request.bPreferDeprecatedAlgorithms);
 
-  // old version support
-  pPolicyJson->SetNamedNumber("IntervalTimeInDays",
-                              request.bAllowOfflineAccess ? 30 : 0);
-
-  if (std::chrono::system_clock::to_time_t(request.ftLicenseValidUntil) > 0)
+  // Add ReferralInfo only when referrer is set
+  if (request.wsReferralInfo.length() > 0)
   {
-    common::DateTime dt = common::DateTime::fromTime_t(
-      std::chrono::system_clock::to_time_t(request.ftLicenseValidUntil));
-        pPolicyJson->SetNamedString("LicenseValidUntil", dt.toUTC().toString(
-                                  Qt::ISODate).toStdString());
+    writer.Name("ReferralInfo").String(request.wsReferralInfo);
   }
 
-  // the appdata should look like this:
-  // "Policy": {
-  //      ...
-  //      "EncryptedApplicationData": {
-  //          "EncryptedAppDataName1": "EncryptedAppDataValue1"
-  //          "EncryptedAppDataName2": "EncryptedAppDataValue2"
-  //          ...
-  //      },
-  //      ...
-  // }
-
-  if (!request.encryptedApplicationData.empty())
+  if (!request.signedApplicationData.empty())
   {
-    auto pEncryptedApplicationDataJson = IJsonObject::Create();
-
-    for_each(
-      begin(request.encryptedApplicationData),
-      end(request.encryptedApplicationData),
-      [ = ](const pair<string, string>appData)
-        {
-          pEncryptedApplicationDataJson->SetNamedString(appData.first.
-                                                        c_str(),
-                                                        appData.second.
-                                                        c_str());
-        });
-
-    pPolicyJson->SetNamedObject("EncryptedApplicationData",
-                                *pEncryptedApplicationDataJson);
+    writer.Name("SignedApplicationData");
+    WriteAppData(writer, request.signedApplicationData);
   }
 
-  pJson->SetNamedObject("Policy", *pPolicyJson);
-  return pJson->Stringify();
+  writer.EndObject();
+  return serialized;
 }
 
-void JsonSerializer::AddUserRightsOrRolesInCustomRequest(
-  IJsonObject                *pPolicyJson,
-  const PublishCustomRequest& request)
+void JsonSerializer::WriteUserRightsOrRoles(JsonWriter                & writer,
+                                            const PublishCustomRequest& request)
 {
-  auto userName     = "Users";
-  auto UserProperty = request.userRightsList.size() !=
-                      0 ? "Rights" : "Roles";
-  auto jsonArrayName = request.userRightsList.size() !=
-                       0 ? "UserRights" : "UserRoles";
-  auto pUserRightsOrRolesListJson = IJsonArray::Create();
-
   if (request.userRightsList.size() != 0)
   {
-    for_each(
-      begin(request.userRightsList),
-      end(request.userRightsList),
-      [ = ](const UserRightsRequest& userRights)
-        {
-          auto pUsersJson = IJsonArray::Create();
+    writer.Name("UserRights").BeginArray();
 
-          for_each(
-            begin(userRights.users),
-            end(userRights.users),
-            [ = ](const string& user)
-          {
-            pUsersJson->Append(user);
-          });
+    for (auto& userRights : request.userRightsList)
+    {
+      writer.BeginObject();
+      writer.Name("Rights");
+      WriteStrings(writer, userRights.rights);
+      writer.Name("Users");
+      WriteStrings(writer, userRights.users);
+      writer.EndObject();
+    }
+  }
+  else
+  {
+    writer.Name("UserRoles").BeginArray();
 
-          auto pRightsJson = IJsonArray::Create();
+    for (auto& userRoles : request.userRolesList)
+    {
+      writer.BeginObject();
+      writer.Name("Roles");
+      WriteStrings(writer, userRoles.roles);
+      writer.Name("Users");
+      WriteStrings(writer, userRoles.users);
+      writer.EndObject();
+    }
+  }
+  writer.EndArray();
+}
 
-          for_each(
-            begin(userRights.rights),
-            end(userRights.rights),
-            [ = ](const string& right)
-          {
-            pRightsJson->Append(right);
-          });
+// reads an application data object; the values are expected to be strings,
+// others convert the way QVariant::toString converted them
+static modernapi::AppDataHashMap ReadAppData(JsonReader& reader)
+{
+  modernapi::AppDataHashMap appData;
+  string name;
+
+  reader.BeginObject();
+
+  while (reader.NextMember(name))
+  {
+    switch (reader.PeekType())
+    {
+    case JsonReader::String:
+      appData[name] = reader.ReadString();
+      break;
 
-          auto pUserRightsJson = IJsonObject::Create();
+    case JsonReader::Number:
+      appData[name] = QVariant(reader.ReadNumber()).toString().toStdString();
+      break;
 
-          pUserRightsJson->SetNamedArray(userName,     *pUsersJson);
-          pUserRightsJson->SetNamedArray(UserProperty, *pRightsJson);
+    case JsonReader::Bool:
+      appData[name] = reader.ReadBool() ? "true" : "false";
+      break;
 
-          pUserRightsOrRolesListJson->Append(*pUserRightsJson);
-        });
+    default:
+      reader.SkipValue();
+      appData[name] = string();
+    }
   }
-  else
-  {
-    for_each(
-      begin(request.userRolesList),
-      end(request.userRolesList),
-      [ = ](const UserRolesRequest& useroles)
-        {
-          auto pUsersJson = IJsonArray::Create();
+  return appData;
+}
 
-          for_each(
-            begin(useroles.users),
-            end(useroles.users),
-            [ = ](const string& user)
-          {
-            pUsersJson->Append(user);
-          });
+// reads a UserRights or UserRoles array, whose objects hold a Users array and
+// an array named listName
+template<typename T>
+static void ReadUserList(JsonReader    & reader,
+                         const char     *listName,
+                         vector<string>T::*list,
+                         vector<T>     & result)
+{
+  string name;
 
-          auto pRolesJson = IJsonArray::Create();
+  if (reader.PeekType() == JsonReader::Null)
+  {
+    reader.SkipValue();
+    return;
+  }
 
-          for_each(
-            begin(useroles.roles),
-            end(useroles.roles),
-            [ = ](const string& role)
-          {
-            pRolesJson->Append(role);
-          });
+  reader.BeginArray();
 
-          auto pUserRolesJson = IJsonObject::Create();
+  while (reader.NextElement())
+  {
+    T item;
 
-          pUserRolesJson->SetNamedArray(userName,     *pUsersJson);
-          pUserRolesJson->SetNamedArray(UserProperty, *pRolesJson);
+    reader.BeginObject();
 
-          pUserRightsOrRolesListJson->Append(*pUserRolesJson);
-        });
+    while (reader.NextMember(name))
+    {
+      if (name == "Users") item.users = reader.ReadStringArray();
+      else if (name == listName) item.*list = reader.ReadStringArray();
+      else reader.SkipValue();
+    }
+    result.emplace_back(move(item));
   }
-
-  pPolicyJson->SetNamedArray(jsonArrayName, *pUserRightsOrRolesListJson);
 }
 
 UsageRestrictionsResponse JsonSerializer::DeserializeUsageRestrictionsResponse(
   common::ByteArray& sResponse)
 {
-  shared_ptr<IJsonParser> pJsonParser = IJsonParser::Create();
+  UsageRestrictionsResponse response;
 
-  // parse the JSON
-  shared_ptr<IJsonObject> pJsonResponse = pJsonParser->Parse(sResponse);
+  // the fields are read in one pass over the response, in whatever order
+  // they come, and interpreted once it is read
+  bool   hasKey                = false;
+  bool   hasAllowOfflineAccess = false;
+  bool   hasPolicy             = false;
+  double intervalTime          = -1.0;
+  string referrer;
+  string name;
 
-  UsageRestrictionsResponse response;
+  response.bFromTemplate                        = false;
+  response.customPolicy.bAllowAuditedExtraction = false;
 
-  if (pJsonResponse == nullptr) return response;
-
-  response.accessStatus = pJsonResponse->GetNamedString("AccessStatus");
-  response.id           = pJsonResponse->GetNamedString("Id");
-  response.name         = pJsonResponse->GetNamedString("Name");
-  response.description  = pJsonResponse->GetNamedString("Description");
-  response.referrer     =
-    ProcessReferrerResponse(pJsonResponse->GetNamedString("Referrer"));
-  response.owner     = pJsonResponse->GetNamedString("Owner");
-  response.issuedTo  = pJsonResponse->GetNamedString("IssuedTo");
-  response.contentId = pJsonResponse->GetNamedString("ContentId");
-
-  // Key
-  if (pJsonResponse->HasName("Key") && !pJsonResponse->IsNull("Key"))
-  {
-    shared_ptr<IJsonObject> pJsonKey = pJsonResponse->GetNamedObject("Key");
-    response.key.algorithm  = pJsonKey->GetNamedString("Algorithm");
-    response.key.cipherMode = pJsonKey->GetNamedString("CipherMode");
-    response.key.value      = pJsonKey->GetNamedValue("Value");
-
-    // BUG 101481: There is a bug in PROD where the AccessStatus field is
-    // missing. When the fix reaches production, the below
-    // statement should be removed.
-    if (response.accessStatus.empty())
-    {
-      response.accessStatus = "AccessGranted";
-    }
-  }
-  else
+  try
   {
-    // BUG 101481: There is a bug in PROD where the AccessStatus field is
-    // missing. When the fix reaches production, the below
-    // statement should be removed.
-    if (response.accessStatus.empty())
+    JsonReader reader(sResponse.data(), sResponse.size());
+
+    if (reader.PeekType() != JsonReader::Object)
     {
-      response.accessStatus = "AccessDenied";
+      Logger::Error("JsonSerializer::DeserializeUsageRestrictionsResponse: %s",
+                    "given json is not a json object");
+      return UsageRestrictionsResponse();
     }
-  }
 
-  // Rights
-  response.rights = pJsonResponse->GetNamedStringArray("Rights");
+    reader.BeginObject();
+
+    while (reader.NextMember(name))
+    {
+      if (name == "AccessStatus") response.accessStatus = reader.ReadString();
+      else if (name == "Id") response.id = reader.ReadString();
+      else if (name == "Name") response.name = reader.ReadString();
+      else if (name == "Description") response.description = reader.ReadString();
+      else if (name == "Referrer") referrer = reader.ReadString();
+      else if (name == "Owner") response.owner = reader.ReadString();
+      else if (name == "IssuedTo") response.issuedTo = reader.ReadString();
+      else if (name == "ContentId") response.contentId = reader.ReadString();
+      else if (name == "Rights") response.rights = reader.ReadStringArray();
+      else if (name == "Roles") response.roles = reader.ReadStringArray();
+      else if (name == "ContentValidUntil") response.contentValidUntil =
+          reader.ReadString();
+      else if (name == "LicenseValidUntil") response.licenseValidUntil =
+          reader.ReadString();
+      else if (name == "FromTemplate") response.bFromTemplate = reader.ReadBool();
+      else if (name == "allowOfflineAccess")
+      {
+        hasAllowOfflineAccess        = true;
+        response.bAllowOfflineAccess = reader.ReadBool(true);
+      }
+      else if ((name == "Key") && (reader.PeekType() != JsonReader::Null))
+      {
+        hasKey = true;
+        reader.BeginObject();
+
+        while (reader.NextMember(name))
+        {
+          if (name == "Algorithm") response.key.algorithm = reader.ReadString();
+          else if (name == "CipherMode") response.key.cipherMode =
+              reader.ReadString();
+          else if (name == "Value")
+          {
+            auto value = reader.ReadString();
+            response.key.value = ByteArray(value.begin(), value.end());
+          }
+          else reader.SkipValue();
+        }
+      }
+      else if ((name == "Policy") && (reader.PeekType() != JsonReader::Null))
+      {
+        hasPolicy = true;
+        reader.BeginObject();
 
-  if (pJsonResponse->HasName("Roles") && !pJsonResponse->IsNull("Roles"))
+        while (reader.NextMember(name))
+        {
+          if (name == "IntervalTimeInDays") intervalTime = reader.ReadNumber(-1.0);
+          else if (name == "AllowAuditedExtraction") response.customPolicy.
+            bAllowAuditedExtraction = reader.ReadBool();
+          else if (name == "UserRights") ReadUserList(
+              reader, "Rights", &UserRightsResponse::rights,
+              response.customPolicy.userRightsList);
+          else if (name == "UserRoles") ReadUserList(
+              reader, "Roles", &UserRolesResponse::roles,
+              response.customPolicy.userRolesList);
+          else reader.SkipValue();
+        }
+      }
+      else if ((name == "SignedApplicationData") &&
+               (reader.PeekType() != JsonReader::Null))
+      {
+        response.signedApplicationData = ReadAppData(reader);
+      }
+      else if ((name == "EncryptedApplicationData") &&
+               (reader.PeekType() != JsonReader::Null))
+      {
+        response.encryptedApplicationData = ReadAppData(reader);
+      }
+      else reader.SkipValue();
+    }
+    reader.End();
+  }
+  catch (JsonReader::SyntaxError& e)
   {
-    response.roles = pJsonResponse->GetNamedStringArray("Roles");
+    Logger::Error("JsonSerializer::DeserializeUsageRestrictionsResponse: %s",
+                  e.what());
+    return UsageRestrictionsResponse();
   }
 
-  // expiry times
-  response.contentValidUntil = pJsonResponse->GetNamedString("ContentValidUntil");
-  response.licenseValidUntil = pJsonResponse->GetNamedString("LicenseValidUntil");
+  response.referrer = ProcessReferrerResponse(move(referrer));
 
-  response.bFromTemplate = pJsonResponse->GetNamedBool("FromTemplate");
+  // BUG 101481: There is a bug in PROD where the AccessStatus field is
+  // missing. When the fix reaches production, the below
+  // statement should be removed.
+  if (response.accessStatus.empty())
+  {
+    response.accessStatus = hasKey ? "AccessGranted" : "AccessDenied";
+  }
 
   // parse expiry times
   if (!response.contentValidUntil.empty())
@@ -390,70 +472,18 @@ UsageRestrictionsResponse JsonSerializer::DeserializeUsageRestrictionsResponse(
     response.ftLicenseValidUntil = std::chrono::system_clock::from_time_t(0);
   }
 
-  if (pJsonResponse->HasName("allowOfflineAccess")) {
-    response.bAllowOfflineAccess = pJsonResponse->GetNamedBool(
-      "allowOfflineAccess", true);
-  } else {
+  if (!hasAllowOfflineAccess) {
     // true by default
     response.bAllowOfflineAccess = true;
   }
 
-
   // custom policy response
-  if (pJsonResponse->HasName("Policy") && !pJsonResponse->IsNull("Policy"))
+  if (hasPolicy)
   {
-    auto pJsonPolicy = pJsonResponse->GetNamedObject("Policy");
-
-    auto intervalTime =
-      static_cast<int>(round(pJsonPolicy->GetNamedNumber("IntervalTimeInDays",
-                                                         -1.0)));
-
-    if (intervalTime <= 0) response.bAllowOfflineAccess = false;
-
-    response.customPolicy.bAllowAuditedExtraction = pJsonPolicy->GetNamedBool(
-      "AllowAuditedExtraction",
-      false);
-
-    // UserRights looks something like this
-    // "UserRights": [
-    //      {"Users": ["user11", "user12", ...], "Rights": ["right11",
-    // "right12"], ... }
-    //      {"Users": ["user21", "user22", ...], "Rights": ["right21",
-    // "right22"], ... }
-    //      ...
-    // ]
-    auto pJsonUserRightsList = pJsonPolicy->GetNamedArray("UserRights");
-
-    for (unsigned iUserRights = 0; iUserRights < pJsonUserRightsList->Size();
-         ++iUserRights)
+    if (static_cast<int>(round(intervalTime)) <= 0)
     {
-      auto pJsonUserRights = pJsonUserRightsList->GetObjectAt(iUserRights);
-
-      UserRightsResponse userRights;
-      userRights.users  = pJsonUserRights->GetNamedStringArray("Users");
-      userRights.rights = pJsonUserRights->GetNamedStringArray("Rights");
-
-      response.customPolicy.userRightsList.emplace_back(move(userRights));
+      response.bAllowOfflineAccess = false;
     }
-
-    // if UserRoles are present add them too
-    if (pJsonPolicy->HasName("UserRoles") && !pJsonPolicy->IsNull("UserRoles"))
-    {
-      auto pJsonUserRolesList = pJsonPolicy->GetNamedArray("UserRoles");
-
-      for (unsigned iUserRoles = 0; iUserRoles < pJsonUserRolesList->Size();
-           ++iUserRoles)
-      {
-        auto pJsonUserRoles = pJsonUserRolesList->GetObjectAt(iUserRoles);
-
-        UserRolesResponse userRoles;
-        userRoles.users = pJsonUserRoles->GetNamedStringArray("Users");
-        userRoles.roles = pJsonUserRoles->GetNamedStringArray("Roles");
-
-        response.customPolicy.userRolesList.emplace_back(move(userRoles));
-      }
-    }
-
     response.customPolicy.bIsNull = false;
   }
   else
@@ -461,25 +491,6 @@ UsageRestrictionsResponse JsonSerializer::DeserializeUsageRestrictionsResponse(
     response.customPolicy.bIsNull = true;
   }
 
-  // signed application data
-  if (pJsonResponse->HasName("SignedApplicationData") &&
-      !pJsonResponse->IsNull("SignedApplicationData"))
-  {
-    auto pJsonSignedAppData = pJsonResponse->GetNamedObject(
-      "SignedApplicationData");
-    response.signedApplicationData = pJsonSignedAppData->ToStringDictionary();
-  }
-
-  // encrypted application data
-  if (pJsonResponse->HasName("EncryptedApplicationData") &&
-      !pJsonResponse->IsNull("EncryptedApplicationData"))
-  {
-    auto pJsonEncryptedAppData = pJsonResponse->GetNamedObject(
-      "EncryptedApplicationData");
-    response.encryptedApplicationData =
-      pJsonEncryptedAppData->ToStringDictionary();
-  }
-
   return response;
 }
 
@@ -511,22 +522,27 @@ ServerErrorResponse JsonSerializer::DeserializeErrorResponse(
 TemplateListResponse JsonSerializer::DeserializeTemplateListResponse(
   ByteArray& sResponse)
 {
-  auto pJsonParser = IJsonParser::Create();
+  JsonReader reader(sResponse.data(), sResponse.size());
+  string     name;
 
   // template list should be an array
-  auto pJsonArray = pJsonParser->ParseArray(sResponse);
+  reader.BeginArray();
 
   TemplateListResponse response;
 
-  for (uint32_t index = 0; index < pJsonArray->Size(); ++index)
+  while (reader.NextElement())
   {
-    auto pTemplateJson = pJsonArray->GetObjectAt(index);
+    TemplateResponse atemplate;
 
-    auto atemplate = TemplateResponse {
-      pTemplateJson->GetNamedString("Id"),
-      pTemplateJson->GetNamedString("Name"),
-      pTemplateJson->GetNamedString("Description")
-    };
+    reader.BeginObject();
+
+    while (reader.NextMember(name))
+    {
+      if (name == "Id") atemplate.id = reader.ReadString();
+      else if (name == "Name") atemplate.name = reader.ReadString();
+      else if (name == "Description") atemplate.description = reader.ReadString();
+      else reader.SkipValue();
+    }
 
     if (atemplate.id.empty())
     {
@@ -545,6 +561,7 @@ TemplateListResponse JsonSerializer::DeserializeTemplateListResponse(
 
     response.templates.emplace_back(move(atemplate));
   }
+  reader.End();
 
   return response;
 }
@@ -622,21 +639,26 @@ PublishResponse JsonSerializer::DeserializePublishResponse(ByteArray& sResponse)
 ServiceDiscoveryListResponse JsonSerializer::DeserializeServiceDiscoveryResponse(
   ByteArray& sResponse)
 {
-  auto pJsonParser = IJsonParser::Create();
+  JsonReader reader(sResponse.data(), sResponse.size());
+  string     name;
 
   // service discovery response should be an array
-  auto pJsonArray = pJsonParser->ParseArray(sResponse);
+  reader.BeginArray();
 
   ServiceDiscoveryListResponse response;
 
-  for (uint32_t index = 0; index < pJsonArray->Size(); ++index)
+  while (reader.NextElement())
   {
-    auto pTemplateJson = pJsonArray->GetObjectAt(index);
+    ServiceDiscoveryResponse endpoint;
+
+    reader.BeginObject();
 
-    auto endpoint = ServiceDiscoveryResponse {
-      pTemplateJson->GetNamedString("Name"),
-      pTemplateJson->GetNamedString("Uri")
-    };
+    while (reader.NextMember(name))
+    {
+      if (name == "Name") endpoint.name = reader.ReadString();
+      else if (name == "Uri") endpoint.uri = reader.ReadString();
+      else reader.SkipValue();
+    }
 
     if (endpoint.name.empty())
     {
@@ -650,6 +672,7 @@ ServiceDiscoveryListResponse JsonSerializer::DeserializeServiceDiscoveryResponse
 
     response.serviceEndpoints.emplace_back(move(endpoint));
   }
+  reader.End();
 
   return response;
 }
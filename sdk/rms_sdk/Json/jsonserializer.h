@@ -14,6 +14,8 @@
 
 namespace rmscore {
 namespace json {
+class JsonWriter;
+
 class JsonSerializer : public IJsonSerializer
 {
 public:
@@ -29,7 +31,7 @@ public:
 
 private:
     std::string ProcessReferrerResponse(const std::string&& referrerResponse);
-    void AddUserRightsOrRolesInCustomRequest(platform::json::IJsonObject* pPolicyJson, const restclients::PublishCustomRequest& request);
+    void WriteUserRightsOrRoles(JsonWriter& writer, const restclients::PublishCustomRequest& request);
 };
 } // namespace json
 } // namespace rmscore
@@ -23,6 +23,46 @@ public:
   enum class LoggerOption : int { Always, Never };
   virtual void                                 LogOption(LoggerOption opt) = 0;
   virtual LoggerOption                         LogOption()                 = 0;
+
+  // maximum number of concurrent connections to one host, 6 by default
+  virtual void                                 MaxConnectionsPerHost(
+    int maxConnections) = 0;
+  virtual int                                  MaxConnectionsPerHost() = 0;
+
+  // the HTTP stack used to talk to the services; Curl needs the SDK to be
+  // built with libcurl (CONFIG+=curl), otherwise Qt is used. Qt creates a
+  // QCoreApplication if the application has none, Curl needs none.
+  enum class HttpClientOption : int { Qt, Curl };
+  virtual void                                 HttpClient(HttpClientOption opt) = 0;
+  virtual HttpClientOption                     HttpClient()                     = 0;
+
+  // milliseconds a license request waits for the extranet license server
+  // before the same request also goes to the intranet one named in the
+  // publishing license, the first answer wins; 0, the default, disables it.
+  // A server error from the extranet one also sends the request to the
+  // intranet one. The latencies are logged per host ("latency <host>: ...
+  // p95=..."), a budget around the p95 only hedges the slowest requests.
+  // While hedging, the authentication and consent callbacks are called on
+  // threads of the SDK rather than the caller's, one call at a time
+  virtual void                                 HedgingBudget(int msecs) = 0;
+  virtual int                                  HedgingBudget()          = 0;
+
+  // seconds a template list is used without asking the service, 3600 by
+  // default; after that it is still returned, for up to a day, while it is
+  // refreshed in the background. 0 disables the template cache
+  virtual void                                 TemplatesCacheTtl(int secs) = 0;
+  virtual int                                  TemplatesCacheTtl()         = 0;
+
+  // also keeps the template lists, encrypted, in the on-disk REST cache so
+  // they survive the process; off by default
+  virtual void                                 TemplatesCacheOnDisk(bool onDisk) = 0;
+  virtual bool                                 TemplatesCacheOnDisk()            = 0;
+
+  // seconds the authentication challenge of a service is reused without
+  // asking it again, 1800 by default; a request rejected with a reused one
+  // gets a new challenge and is retried once. 0 disables the cache
+  virtual void                                 ChallengeCacheTtl(int secs) = 0;
+  virtual int                                  ChallengeCacheTtl()         = 0;
 };
 
 DLL_PUBLIC_RMS std::shared_ptr<IRMSEnvironment>RMSEnvironment();
@@ -30,6 +30,13 @@ CONFIG(debug, debug|release) {
 win32:LIBS += -L$$REPO_ROOT/third_party/lib/eay/ -lssleay32 -llibeay32 -lGdi32 -lUser32 -lAdvapi32
 else:LIBS  += -lssl -lcrypto
 
+# the optional libcurl backend of Platform/Http (qmake CONFIG+=curl)
+curl {
+    win32:LIBS    += -L$$REPO_ROOT/third_party/lib/curl/ -llibcurl -lWs2_32 -lWldap32 -lCrypt32
+    else:macx:LIBS += -L/usr/local/opt/curl/lib -lcurl
+    else:LIBS     += -lcurl
+}
+
 SOURCES += \
     UserPolicy.cpp \
     TemplateDescriptor.cpp \
@@ -40,6 +47,8 @@ SOURCES += \
     ext/QTStreamImpl.cpp \
     HttpHelper.cpp \
     IRMSEnvironment.cpp \
+    Prewarm.cpp \
+    UserPolicyPool.cpp \
     roles.cpp
 
 HEADERS += \
@@ -67,6 +76,8 @@ HEADERS += \
     CacheControl.h \
     RMSExceptions.h \
     IRMSEnvironment.h \
+    Prewarm.h \
+    UserPolicyPool.h \
     roles.h
 
 
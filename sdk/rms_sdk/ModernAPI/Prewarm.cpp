@@ -0,0 +1,253 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <mutex>
+
+#include "Prewarm.h"
+#include "AuthenticationCallbackImpl.h"
+#include "IRMSEnvironment.h"
+#include "RMSExceptions.h"
+#include "../Platform/Logger/Logger.h"
+#include "../RestClients/Domain.h"
+#include "../RestClients/IDnsLookupClient.h"
+#include "../RestClients/IRestClientCache.h"
+#include "../RestClients/IRestServiceUrlClient.h"
+#include "../RestClients/ITemplatesClient.h"
+#include "../RestClients/LicenseParserResult.h"
+
+using namespace std;
+using namespace rmscore::restclients;
+using namespace rmscore::platform::logger;
+
+namespace rmscore {
+namespace modernapi {
+namespace {
+// The domains and the users are prewarmed on several threads, but the
+// application's callback doesn't have to be reentrant.
+class SerializedAuthenticationCallback : public IAuthenticationCallbackImpl {
+public:
+
+  SerializedAuthenticationCallback(IAuthenticationCallback& callback,
+                                   const string           & userId,
+                                   mutex                  & callbackMutex)
+    : m_callback(callback, userId)
+    , m_mutex(callbackMutex)
+  {}
+
+  virtual bool NeedsChallenge() const override {
+    return m_callback.NeedsChallenge();
+  }
+
+  virtual string GetAccessToken(const AuthenticationChallenge& challenge)
+  override
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    return m_callback.GetAccessToken(challenge);
+  }
+
+private:
+
+  AuthenticationCallbackImpl m_callback;
+  mutex& m_mutex;
+};
+
+// runs one step, records how long it took and whether it failed
+bool RunStage(const string             & name,
+              const string             & target,
+              shared_ptr<atomic<bool> >  cancelState,
+              vector<PrewarmStage>     & stages,
+              function<void()>           step)
+{
+  if ((cancelState != nullptr) && cancelState->load()) return false;
+
+  PrewarmStage stage;
+  stage.Name      = name;
+  stage.Target    = target;
+  stage.Succeeded = false;
+
+  auto started = chrono::steady_clock::now();
+
+  try
+  {
+    step();
+    stage.Succeeded = true;
+  }
+  catch (exceptions::RMSException& e)
+  {
+    stage.Error = e.what();
+  }
+  catch (exception& e)
+  {
+    stage.Error = e.what();
+  }
+
+  stage.Duration = chrono::duration_cast<chrono::milliseconds>(
+    chrono::steady_clock::now() - started);
+
+  Logger::Info("Prewarm: %s %s %s in %d ms %s",
+               name.c_str(),
+               target.c_str(),
+               stage.Succeeded ? "done" : "failed",
+               static_cast<int>(stage.Duration.count()),
+               stage.Error.c_str());
+
+  stages.push_back(stage);
+  return stage.Succeeded;
+}
+
+// the discovery only does the DNS lookup when neither the details of the
+// service nor the answer of a previous lookup are cached
+bool NeedsDnsLookup(const Domain& domain)
+{
+  auto pCache    = IRestClientCache::Create(IRestClientCache::CACHE_PLAINDATA);
+  auto domainStr = domain.GetDomainStringForDnsLookup();
+
+  return (pCache->LookupServiceDiscoveryDetails(domainStr) == nullptr) &&
+         pCache->LookupDnsClientResult(domainStr).empty();
+}
+
+vector<PrewarmStage>PrewarmDomain(const string               & domainName,
+                                  IAuthenticationCallbackImpl& authCallback,
+                                  shared_ptr<atomic<bool> >    cancelState)
+{
+  vector<PrewarmStage> stages;
+  shared_ptr<Domain>   domain;
+
+  RunStage("dns", domainName, cancelState, stages, [&]() {
+    auto url = domainName.find("://") == string::npos ?
+               "https://" + domainName : domainName;
+
+    domain = Domain::CreateFromUrl(url);
+
+    if (NeedsDnsLookup(*domain))
+    {
+      IDnsLookupClient::Create()->LookupDiscoveryService(domain);
+    }
+  });
+
+  if (domain == nullptr) return stages;
+
+  // as if a publishing license issued by the domain was consumed
+  RunStage("discovery", domainName, cancelState, stages, [&]() {
+    auto licenseParserResult = make_shared<LicenseParserResult>(
+      vector<shared_ptr<Domain> >(1, domain), shared_ptr<string>());
+
+    IRestServiceUrlClient::Create()->GetServiceDiscoveryDetails(
+      licenseParserResult, string(), authCallback, nullptr, cancelState);
+  });
+
+  return stages;
+}
+
+vector<PrewarmStage>PrewarmUser(const string               & userId,
+                                IAuthenticationCallbackImpl& authCallback,
+                                shared_ptr<atomic<bool> >    cancelState)
+{
+  vector<PrewarmStage> stages;
+  string templatesUrl;
+
+  RunStage("dns", userId, cancelState, stages, [&]() {
+    auto domain = Domain::CreateFromEmail(userId);
+
+    if (NeedsDnsLookup(*domain))
+    {
+      IDnsLookupClient::Create()->LookupDiscoveryService(domain);
+    }
+  });
+
+  bool discovered = RunStage("discovery", userId, cancelState, stages, [&]() {
+    templatesUrl = IRestServiceUrlClient::Create()->GetTemplatesUrl(
+      userId, authCallback, cancelState);
+  });
+
+  if (!discovered) return stages;
+
+  // caches the challenge of the service and gets a token from the
+  // application on the way
+  RunStage("templates", userId, cancelState, stages, [&]() {
+    ITemplatesClient::Create()->GetTemplates(authCallback, userId, cancelState);
+  });
+
+  return stages;
+}
+} // namespace
+
+vector<PrewarmStage>Prewarm(const vector<string>     & domains,
+                            const vector<string>     & userIds,
+                            IAuthenticationCallback  & authenticationCallback,
+                            shared_ptr<atomic<bool> >  cancelState,
+                            int                        maxConcurrent)
+{
+  mutex callbackMutex;
+  vector<function<vector<PrewarmStage>()> > tasks;
+
+  // the domains have no user, the first one is the best hint for the token
+  const string userHint = userIds.empty() ? string() : userIds[0];
+
+  for (auto& domainName : domains)
+  {
+    tasks.push_back([&, domainName]() {
+      SerializedAuthenticationCallback authCallback(authenticationCallback,
+                                                    userHint,
+                                                    callbackMutex);
+      return PrewarmDomain(domainName, authCallback, cancelState);
+    });
+  }
+
+  for (auto& userId : userIds)
+  {
+    tasks.push_back([&, userId]() {
+      SerializedAuthenticationCallback authCallback(authenticationCallback,
+                                                    userId,
+                                                    callbackMutex);
+      return PrewarmUser(userId, authCallback, cancelState);
+    });
+  }
+
+  if (maxConcurrent <= 0)
+  {
+    maxConcurrent = RMSEnvironment()->MaxConnectionsPerHost();
+  }
+
+  // a pool of workers takes the domains and the users in turn; the stages
+  // are returned in that order whichever worker ran them
+  vector<vector<PrewarmStage> > results(tasks.size());
+  atomic<size_t> next(0);
+  vector<future<void> > workers;
+  size_t count = min(tasks.size(), static_cast<size_t>(maxConcurrent));
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    workers.push_back(async(launch::async, [&]() {
+      for (size_t task = next++; task < tasks.size(); task = next++)
+      {
+        results[task] = tasks[task]();
+      }
+    }));
+  }
+
+  for (auto& worker : workers)
+  {
+    worker.get();
+  }
+
+  vector<PrewarmStage> stages;
+
+  for (auto& result : results)
+  {
+    stages.insert(stages.end(), result.begin(), result.end());
+  }
+
+  return stages;
+}
+} // namespace modernapi
+} // namespace rmscore
@@ -0,0 +1,80 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_PREWARM_H_
+#define _RMS_LIB_PREWARM_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IAuthenticationCallback.h"
+#include "ModernAPIExport.h"
+
+namespace rmscore {
+namespace modernapi {
+/*!
+   @brief Outcome of one step of Prewarm.
+ */
+struct DLL_PUBLIC_RMS PrewarmStage {
+  /*!
+     @brief "dns", "discovery" or "templates".
+   */
+  std::string Name;
+
+  /*!
+     @brief The domain or the user id the step was run for.
+   */
+  std::string Target;
+
+  std::chrono::milliseconds Duration;
+  bool                      Succeeded;
+
+  /*!
+     @brief Why the step failed, empty if it succeeded.
+   */
+  std::string Error;
+};
+
+/*!
+   @brief Does ahead of time the work the first UserPolicy::Acquire or
+      TemplateDescriptor::GetTemplateListAsync of a user would otherwise do
+      lazily: the DNS lookup and the service discovery of the domains and of
+      the users' domains, and the templates of every user, which cache the
+      authentication challenge and get a token on the way.
+
+   The domains and the users are prewarmed concurrently by a pool of
+   maxConcurrent workers; the steps of one domain or one user run in order. A step that fails doesn't stop the other
+   domains or users, nor the following steps when they don't depend on it.
+   The results land in the SDK caches and, through authenticationCallback,
+   in the application's token cache, so it should be the callback the
+   application uses afterwards. Call it at process start, from a background
+   thread as it blocks until everything is done.
+
+   @param domains The license servers the application is going to use, as
+      URLs or host names, e.g. those found in the publishing licenses of the
+      tenant.
+   @param userIds The email addresses of the users.
+   @param authenticationCallback Called, one call at a time, to get the
+      tokens.
+   @param cancelState Stops the steps that are still running when set.
+   @param maxConcurrent How many domains and users are prewarmed at a time,
+      0 means IRMSEnvironment::MaxConnectionsPerHost.
+   @return The timing of every step, domain by domain then user by user.
+ */
+DLL_PUBLIC_RMS std::vector<PrewarmStage>Prewarm(
+  const std::vector<std::string>   & domains,
+  const std::vector<std::string>   & userIds,
+  IAuthenticationCallback          & authenticationCallback,
+  std::shared_ptr<std::atomic<bool> >cancelState = nullptr,
+  int                                maxConcurrent = 0);
+} // namespace modernapi
+} // namespace rmscore
+#endif // _RMS_LIB_PREWARM_H_
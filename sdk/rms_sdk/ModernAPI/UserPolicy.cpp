@@ -6,15 +6,23 @@
  * ======================================================================
  */
 
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #include "../Common/tools.h"
 #include "../Core/ProtectionPolicy.h"
 #include "../ModernAPI/RMSExceptions.h"
 #include "../Platform/Logger/Logger.h"
+#include "../RestClients/LicenseParser.h"
 
 #include "UserPolicy.h"
 
 #include "AuthenticationCallbackImpl.h"
 #include "ConsentCallbackImpl.h"
+#include "IRMSEnvironment.h"
 #include "rights.h"
 
 using namespace rmscore::core;
@@ -25,6 +33,78 @@ using namespace rmscore::platform::logger;
 
 namespace rmscore {
 namespace modernapi {
+namespace {
+// AcquireMany acquires the licenses on several threads, but the
+// application's callbacks don't have to be reentrant.
+class SerializedCallbacks : public IAuthenticationCallbackImpl,
+                            public IConsentCallbackImpl {
+public:
+
+  SerializedCallbacks(IAuthenticationCallback& authenticationCallback,
+                      IConsentCallback        *consentCallback,
+                      const string           & userId)
+    : m_authenticationCallback(authenticationCallback, userId)
+    , m_consentCallback(consentCallback, userId, false)
+  {}
+
+  virtual bool NeedsChallenge() const override {
+    return m_authenticationCallback.NeedsChallenge();
+  }
+
+  virtual string GetAccessToken(const AuthenticationChallenge& challenge)
+  override
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    return m_authenticationCallback.GetAccessToken(challenge);
+  }
+
+  virtual void Consents(const string        & email,
+                        const string        & domain,
+                        const vector<string>& urls) override
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    m_consentCallback.Consents(email, domain, urls);
+  }
+
+private:
+
+  mutex m_mutex;
+  AuthenticationCallbackImpl m_authenticationCallback;
+  ConsentCallbackImpl m_consentCallback;
+};
+
+// the extranet license server of a publishing license, or an empty string
+// if the license can't be parsed; Acquire reports that error
+string GetLicenseServer(const vector<unsigned char>& serializedPolicy)
+{
+  try {
+    auto result = restclients::LicenseParser::ParsePublishingLicense(
+      serializedPolicy.data(), serializedPolicy.size());
+    auto& domains = result->GetDomains();
+
+    if (!domains.empty()) return domains[0]->GetOriginalInput();
+  } catch (exceptions::RMSException&) {}
+
+  return string();
+}
+
+// AcquireMany's work: the first license of each group, then the rest of the
+// groups whose first license was acquired
+struct AcquisitionTask {
+  shared_ptr<vector<size_t> >indices;
+  size_t position;
+};
+
+struct AcquisitionQueue {
+  mutex guard;
+  condition_variable     ready;
+  deque<AcquisitionTask> tasks;
+  size_t warmingUp;
+};
+} // namespace
+
 GetUserPolicyResult::GetUserPolicyResult(GetUserPolicyResultStatus  status,
                                          std::shared_ptr<string>    referrer,
                                          std::shared_ptr<UserPolicy>policy) :
@@ -64,6 +144,15 @@ shared_ptr<GetUserPolicyResult>UserPolicy::Acquire(
     cancelState,
     cacheMask);
 
+  auto result = CreateResult(pImpl);
+
+  Logger::Hidden("-UserPolicy::Acquire");
+  return result;
+} // UserPolicy::Acquire
+
+shared_ptr<GetUserPolicyResult>UserPolicy::CreateResult(
+  shared_ptr<core::ProtectionPolicy>pImpl)
+{
   auto referrer = make_shared<std::string>(pImpl->GetReferrer());
 
   shared_ptr<GetUserPolicyResult> result;
@@ -97,9 +186,140 @@ shared_ptr<GetUserPolicyResult>UserPolicy::Acquire(
     throw exceptions::RMSInvalidArgumentException("Invalid Access Status");
   } // switch
 
-  Logger::Hidden("-UserPolicy::Acquire");
   return result;
-} // UserPolicy::Acquire
+} // UserPolicy::CreateResult
+
+vector<shared_future<shared_ptr<GetUserPolicyResult> > >UserPolicy::AcquireMany(
+  const vector<vector<unsigned char> >& serializedPolicies,
+  const string                        & userId,
+  IAuthenticationCallback             & authenticationCallback,
+  IConsentCallback                     *consentCallback,
+  PolicyAcquisitionOptions              options,
+  ResponseCacheFlags                    cacheMask,
+  shared_ptr<atomic<bool> >             cancelState,
+  int                                   maxConcurrent)
+{
+  Logger::Hidden("+UserPolicy::AcquireMany");
+
+  typedef promise<shared_ptr<GetUserPolicyResult> > Promise;
+
+  // one promise per distinct license, the group a license goes to is the
+  // first domain named in it, i.e. its extranet license server
+  auto promises = make_shared<vector<Promise> >();
+  map<vector<unsigned char>, size_t> distinct;
+  map<string, vector<size_t> > groups;
+  vector<shared_future<shared_ptr<GetUserPolicyResult> > > futures;
+
+  futures.reserve(serializedPolicies.size());
+  promises->reserve(serializedPolicies.size());
+
+  for (auto& serializedPolicy : serializedPolicies) {
+    auto inserted = distinct.insert(make_pair(serializedPolicy,
+                                              promises->size()));
+
+    if (inserted.second) {
+      promises->push_back(Promise());
+      groups[GetLicenseServer(serializedPolicy)].push_back(
+        inserted.first->second);
+    }
+    futures.push_back(
+      (*promises)[inserted.first->second].get_future().share());
+  }
+
+  if (maxConcurrent <= 0) {
+    maxConcurrent = RMSEnvironment()->MaxConnectionsPerHost();
+  }
+
+  Logger::Info("UserPolicy::AcquireMany: %d licenses, %d distinct, %d servers",
+               static_cast<int>(serializedPolicies.size()),
+               static_cast<int>(promises->size()),
+               static_cast<int>(groups.size()));
+
+  auto callbacks = make_shared<SerializedCallbacks>(authenticationCallback,
+                                                    consentCallback,
+                                                    userId);
+  auto policies = make_shared<vector<vector<unsigned char> > >(distinct.size());
+
+  for (auto& entry : distinct) {
+    (*policies)[entry.second] = entry.first;
+  }
+
+  // a single pool of workers serves all the servers; the rest of a group is
+  // queued once its first license was acquired
+  auto queue = make_shared<AcquisitionQueue>();
+
+  for (auto& group : groups) {
+    queue->tasks.push_back(AcquisitionTask {
+      make_shared<vector<size_t> >(group.second), 0
+    });
+  }
+  queue->warmingUp = groups.size();
+
+  auto acquire = [ = ](size_t index) -> exception_ptr {
+                   try {
+                     auto pImpl = ProtectionPolicy::Acquire(
+                       (*policies)[index].data(),
+                       (*policies)[index].size(),
+                       *callbacks,
+                       *callbacks,
+                       userId,
+                       (options & PolicyAcquisitionOptions::POL_OfflineOnly),
+                       cancelState,
+                       cacheMask);
+                     (*promises)[index].set_value(CreateResult(pImpl));
+                     return nullptr;
+                   } catch (...) {
+                     auto error = current_exception();
+                     (*promises)[index].set_exception(error);
+                     return error;
+                   }
+                 };
+
+  size_t count = min(promises->size(), static_cast<size_t>(maxConcurrent));
+
+  for (size_t i = 0; i < count; ++i) {
+    thread([ = ]() {
+        for (;;) {
+          unique_lock<mutex> lock(queue->guard);
+          queue->ready.wait(lock, [&]() {
+              return !queue->tasks.empty() || queue->warmingUp == 0;
+            });
+
+          if (queue->tasks.empty()) return;
+
+          auto task = queue->tasks.front();
+          queue->tasks.pop_front();
+          lock.unlock();
+
+          auto error = acquire((*task.indices)[task.position]);
+
+          if (task.position != 0) continue;
+
+          // the first license of its group warmed up the discovery and the
+          // token; if it failed or was cancelled the others would fail the
+          // same way, so they get its error instead of a request each
+          if (error != nullptr) {
+            for (size_t n = 1; n < task.indices->size(); ++n) {
+              (*promises)[(*task.indices)[n]].set_exception(error);
+            }
+          }
+
+          lock.lock();
+
+          if (error == nullptr) {
+            for (size_t n = 1; n < task.indices->size(); ++n) {
+              queue->tasks.push_back(AcquisitionTask { task.indices, n });
+            }
+          }
+          --queue->warmingUp;
+          queue->ready.notify_all();
+        }
+      }).detach();
+  }
+
+  Logger::Hidden("-UserPolicy::AcquireMany");
+  return futures;
+} // UserPolicy::AcquireMany
 
 std::shared_ptr<UserPolicy>UserPolicy::CreateFromTemplateDescriptor(
   const modernapi::TemplateDescriptor& templateDescriptor,
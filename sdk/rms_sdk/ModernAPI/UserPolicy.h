@@ -11,6 +11,7 @@
 
 #include <stdint.h>
 #include <chrono>
+#include <future>
 
 #include "IAuthenticationCallback.h"
 #include "IConsentCallback.h"
@@ -116,6 +117,35 @@ public:
     ResponseCacheFlags                 cacheMask,
     std::shared_ptr<std::atomic<bool> >cancelState);
 
+  /*!
+     @brief Acquires the policies of many publishing licenses at once, e.g.
+        for an indexer opening a large number of files.
+
+     Identical licenses are acquired once and share their future. The others
+        are grouped by license server: the first license of a group is
+        acquired alone, so that the discovery and the access token are cached
+        for the rest of the group, which is then acquired concurrently. If
+        that first acquisition fails or is cancelled, the rest of its group
+        fails with the same exception without a request. A single pool of
+        maxConcurrent workers serves all the groups (0 means
+        IRMSEnvironment::MaxConnectionsPerHost). The futures are returned in
+        the order of serializedPolicies; a failed acquisition raises its
+        exception from get().
+
+     The callbacks are never called concurrently, but they must stay valid
+        until all the futures are ready.
+   */
+  static std::vector<std::shared_future<std::shared_ptr<GetUserPolicyResult> > >
+  AcquireMany(
+    const std::vector<std::vector<unsigned char> >& serializedPolicies,
+    const std::string                             & userId,
+    IAuthenticationCallback                       & authenticationCallback,
+    IConsentCallback                               *consentCallback,
+    PolicyAcquisitionOptions                        options,
+    ResponseCacheFlags                              cacheMask,
+    std::shared_ptr<std::atomic<bool> >             cancelState,
+    int                                             maxConcurrent = 0);
+
   static std::shared_ptr<UserPolicy>CreateFromTemplateDescriptor(
     const TemplateDescriptor         & templateDescriptor,
     const std::string                & userId,
@@ -160,6 +190,9 @@ private:
 
   UserPolicy(std::shared_ptr<core::ProtectionPolicy>pImpl);
 
+  static std::shared_ptr<GetUserPolicyResult>CreateResult(
+    std::shared_ptr<core::ProtectionPolicy>pImpl);
+
   std::shared_ptr<core::ProtectionPolicy> m_pImpl;
   std::shared_ptr<modernapi::TemplateDescriptor> m_templateDescriptor;
   std::shared_ptr<modernapi::PolicyDescriptor>   m_policyDescriptor;
@@ -0,0 +1,140 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "UserPolicyPool.h"
+#include "../Common/SingleFlight.h"
+#include "../Platform/Logger/Logger.h"
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+namespace rmscore {
+namespace modernapi {
+UserPolicyPool::UserPolicyPool(uint32_t maxUses, chrono::seconds maxAge)
+  : m_maxUses(maxUses)
+  , m_maxAge(maxAge)
+  , m_publications(new common::SingleFlight<shared_ptr<UserPolicy> >())
+{}
+
+UserPolicyPool::~UserPolicyPool()
+{}
+
+shared_ptr<UserPolicy>UserPolicyPool::Lease(
+  const TemplateDescriptor         & templateDescriptor,
+  const string                     & userId,
+  IAuthenticationCallback          & authenticationCallback,
+  UserPolicyCreationOptions          options,
+  const AppDataHashMap             & signedAppData,
+  std::shared_ptr<std::atomic<bool> >cancelState)
+{
+  auto key = GetKey(templateDescriptor, userId, options, signedAppData);
+
+  for (;;) {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      auto policy = TakeUse(key, nullptr);
+
+      if (policy) return policy;
+    }
+
+    // the concurrent leases wait for a single publication; the policy is
+    // pooled only once it was published, so a failure is never leased
+    auto policy = m_publications->Do(key, cancelState, [&]() {
+      Logger::Hidden("UserPolicyPool: publishing a policy for template %s",
+                     templateDescriptor.TemplateId().c_str());
+
+      auto published = UserPolicy::CreateFromTemplateDescriptor(
+        templateDescriptor,
+        userId,
+        authenticationCallback,
+        options,
+        signedAppData,
+        cancelState);
+
+      lock_guard<mutex> lock(m_mutex);
+      Entry entry;
+      entry.policy    = published;
+      entry.uses      = 0;
+      entry.published = chrono::steady_clock::now();
+      m_entries[key]  = entry;
+      return published;
+    });
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      auto leased = TakeUse(key, policy);
+
+      if (leased) return leased;
+    }
+
+    // the other leases used the whole budget of the new policy, publish
+    // again
+  }
+}
+
+shared_ptr<UserPolicy>UserPolicyPool::TakeUse(const string        & key,
+                                              shared_ptr<UserPolicy>policy)
+{
+  auto it = m_entries.find(key);
+
+  if ((it == m_entries.end()) ||
+      ((policy != nullptr) && (it->second.policy != policy)) ||
+      ((m_maxUses != 0) && (it->second.uses >= m_maxUses))) {
+    return nullptr;
+  }
+
+  // a policy which was just published is leased whatever maxAge is
+  if ((policy == nullptr) &&
+      (chrono::steady_clock::now() - it->second.published >= m_maxAge)) {
+    return nullptr;
+  }
+
+  ++it->second.uses;
+  return it->second.policy;
+}
+
+void UserPolicyPool::Clear()
+{
+  lock_guard<mutex> lock(m_mutex);
+
+  m_entries.clear();
+}
+
+string UserPolicyPool::GetKey(const TemplateDescriptor& templateDescriptor,
+                              const string            & userId,
+                              UserPolicyCreationOptions options,
+                              const AppDataHashMap    & signedAppData)
+{
+  string user(userId);
+
+  transform(user.begin(), user.end(), user.begin(), ::tolower);
+
+  // the hash map has no defined order
+  vector<pair<string, string> > appData(signedAppData.begin(),
+                                        signedAppData.end());
+  sort(appData.begin(), appData.end());
+
+  // lengths are prefixed so that the fields can't run into each other
+  ostringstream key;
+  key << templateDescriptor.TemplateId().size() << ':'
+      << templateDescriptor.TemplateId() << user.size() << ':' << user
+      << static_cast<int>(options);
+
+  for (auto& item : appData) {
+    key << ';' << item.first.size() << ':' << item.first
+        << item.second.size() << ':' << item.second;
+  }
+
+  return key.str();
+}
+} // namespace modernapi
+} // namespace rmscore
@@ -0,0 +1,111 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_USERPOLICYPOOL_H_
+#define _RMS_LIB_USERPOLICYPOOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "ModernAPIExport.h"
+#include "UserPolicy.h"
+
+namespace rmscore {
+namespace common {
+template<typename T>
+class SingleFlight;
+} // namespace common
+
+namespace modernapi {
+/*!
+   @brief Shares the policies published from templates between many files.
+
+   UserPolicy::CreateFromTemplateDescriptor publishes a new license on every
+      call. When many files are protected with the same template, a pool
+      publishes once per template, user, options and signed application data
+      and leases the same policy, and so the same content key, to the
+      following files, until the policy has been leased maxUses times or is
+      older than maxAge. Then the next lease publishes a new one.
+
+   All the files protected with one policy share its content id and key, so
+      the budget and the age bound how many files are affected by a leaked
+      key and how long a policy keeps being used after the template changed.
+
+   A pool can be used from several threads; concurrent leases of a policy
+      that isn't published yet wait for a single publication, each waiter
+      until its own cancelState is set. A failed publication isn't pooled,
+      the next lease publishes again.
+ */
+class DLL_PUBLIC_RMS UserPolicyPool {
+public:
+
+  /*!
+     @param maxUses Number of leases of one policy, 0 for no limit.
+     @param maxAge  Time after which a policy isn't leased anymore.
+   */
+  UserPolicyPool(uint32_t             maxUses = 1000,
+                 std::chrono::seconds maxAge  = std::chrono::hours(1));
+  ~UserPolicyPool();
+
+  /*!
+     @brief Same as UserPolicy::CreateFromTemplateDescriptor, but returns the
+        pooled policy when there is a usable one.
+   */
+  std::shared_ptr<UserPolicy>Lease(
+    const TemplateDescriptor         & templateDescriptor,
+    const std::string                & userId,
+    IAuthenticationCallback          & authenticationCallback,
+    UserPolicyCreationOptions          options,
+    const AppDataHashMap             & signedAppData,
+    std::shared_ptr<std::atomic<bool> >cancelState);
+
+  /*!
+     @brief Drops all the pooled policies; the next leases publish again.
+   */
+  void Clear();
+
+private:
+
+  // undefined copy constructor and assignment operator
+  UserPolicyPool(const UserPolicyPool&);
+  UserPolicyPool& operator=(const UserPolicyPool&);
+
+  struct Entry {
+    std::shared_ptr<UserPolicy> policy;
+    uint32_t uses;
+    std::chrono::steady_clock::time_point published;
+  };
+
+  // takes one use of the pooled policy of the key, if it is still usable, or
+  // of the given one, if it was just published and is still pooled; called
+  // with m_mutex held
+  std::shared_ptr<UserPolicy> TakeUse(const std::string           & key,
+                                      std::shared_ptr<UserPolicy>policy);
+
+  static std::string GetKey(const TemplateDescriptor& templateDescriptor,
+                            const std::string       & userId,
+                            UserPolicyCreationOptions options,
+                            const AppDataHashMap    & signedAppData);
+
+  const uint32_t             m_maxUses;
+  const std::chrono::seconds m_maxAge;
+
+  std::mutex m_mutex;
+  std::map<std::string, Entry> m_entries;
+
+  // the publications in flight, per key
+  std::unique_ptr<common::SingleFlight<std::shared_ptr<UserPolicy> > >
+  m_publications;
+};
+} // namespace modernapi
+} // namespace rmscore
+#endif // _RMS_LIB_USERPOLICYPOOL_H_
@@ -0,0 +1,114 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include "CancelNotifier.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace rmscore {
+namespace platform {
+namespace http {
+const int CancelNotifier::checkIntervalMsecs;
+
+CancelSubscription::~CancelSubscription()
+{
+  CancelNotifier::Instance().Unsubscribe(id_);
+}
+
+CancelNotifier& CancelNotifier::Instance()
+{
+  // NOTE: the notifier is leaked deliberately, its thread runs until the end
+  // of the process.
+  static CancelNotifier *notifier = new CancelNotifier();
+
+  return *notifier;
+}
+
+CancelNotifier::CancelNotifier() : m_nextId(1)
+{
+  thread([this]() {
+      Run();
+    }).detach();
+}
+
+SharedCancelSubscription CancelNotifier::Subscribe(
+  shared_ptr<atomic<bool> >cancelState,
+  function<void()>         onCancel)
+{
+  uint64_t id = 0;
+
+  if (cancelState != nullptr) {
+    lock_guard<mutex> lock(m_mutex);
+
+    id = m_nextId++;
+    Subscriber subscriber = { cancelState, onCancel };
+    m_subscribers[id] = subscriber;
+  }
+
+  // wakes the thread up, it may have been waiting without a timeout
+  m_changed.notify_one();
+
+  return SharedCancelSubscription(new CancelSubscription(id));
+}
+
+void CancelNotifier::Cancel(const shared_ptr<atomic<bool> >& cancelState)
+{
+  if (cancelState == nullptr) return;
+
+  cancelState->store(true);
+  m_changed.notify_one();
+}
+
+void CancelNotifier::Unsubscribe(uint64_t id)
+{
+  if (id == 0) return;
+
+  lock_guard<mutex> lock(m_mutex);
+
+  m_subscribers.erase(id);
+}
+
+void CancelNotifier::Run()
+{
+  unique_lock<mutex> lock(m_mutex);
+
+  for (;;) {
+    if (m_subscribers.empty()) {
+      m_changed.wait(lock);
+    } else {
+      m_changed.wait_for(lock, chrono::milliseconds(checkIntervalMsecs));
+    }
+
+    vector<function<void()> > fired;
+
+    for (auto it = m_subscribers.begin(); it != m_subscribers.end();) {
+      if (it->second.cancelState->load()) {
+        fired.push_back(it->second.onCancel);
+        it = m_subscribers.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    if (fired.empty()) continue;
+
+    // the callbacks may subscribe or unsubscribe
+    lock.unlock();
+
+    for (auto& onCancel : fired) {
+      onCancel();
+    }
+    lock.lock();
+  }
+}
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
@@ -0,0 +1,91 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _CANCELNOTIFIER_H_
+#define _CANCELNOTIFIER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace rmscore {
+namespace platform {
+namespace http {
+class CancelNotifier;
+
+// Keeps a cancel callback registered; unregisters it when released.
+class CancelSubscription {
+public:
+
+  ~CancelSubscription();
+
+private:
+
+  friend class CancelNotifier;
+
+  CancelSubscription(uint64_t id) : id_(id) {}
+
+  uint64_t id_;
+};
+
+typedef std::shared_ptr<CancelSubscription> SharedCancelSubscription;
+
+// Turns the cancel flags used across the SDK into notifications. A single
+// thread watches the flags of all the pending operations and calls their
+// callback as soon as a flag is set, so the operations themselves just wait
+// for their completion instead of waking up periodically to check the flag.
+class CancelNotifier {
+public:
+
+  static CancelNotifier& Instance();
+
+  // calls onCancel once, on the notifier thread, when *cancelState becomes
+  // true; a null cancelState never fires
+  SharedCancelSubscription Subscribe(
+    std::shared_ptr<std::atomic<bool> >cancelState,
+    std::function<void()>              onCancel);
+
+  // sets the flag and delivers the notification right away, instead of on the
+  // next check of the notifier thread
+  void Cancel(const std::shared_ptr<std::atomic<bool> >& cancelState);
+
+private:
+
+  friend class CancelSubscription;
+
+  struct Subscriber {
+    std::shared_ptr<std::atomic<bool> >cancelState;
+    std::function<void()>              onCancel;
+  };
+
+  CancelNotifier();
+
+  // undefined copy constructor and assignment operator
+  CancelNotifier(const CancelNotifier&);
+  CancelNotifier& operator=(const CancelNotifier&);
+
+  void Unsubscribe(uint64_t id);
+  void Run();
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::map<uint64_t, Subscriber> m_subscribers;
+  uint64_t m_nextId;
+
+  // how often the flags are checked while there are subscribers
+  static const int checkIntervalMsecs = 10;
+};
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+
+#endif // _CANCELNOTIFIER_H_
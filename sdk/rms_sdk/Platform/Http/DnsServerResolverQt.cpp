@@ -14,6 +14,7 @@
 #include "DnsServerResolverQt.h"
 #include <QUdpSocket>
 #include <QThread>
+#include <memory>
 #include "../../Platform/Logger/Logger.h"
 
 using namespace std;
@@ -28,34 +29,81 @@ shared_ptr<IDnsServerResolver>IDnsServerResolver::Create()
   return make_shared<DnsServerResolverQt>();
 }
 
-std::string DnsServerResolverQt::doLookup(const std::string& dnsRequest)
+std::vector<DnsServiceRecord>DnsServerResolverQt::doLookupFirst(
+  const std::vector<std::string>& dnsRequests)
 {
-  QDnsLookup dns;
-
-  dns.setType(QDnsLookup::SRV);
-  Logger::Hidden("dnsRequest: %s", dnsRequest.c_str());
-  dns.setName(dnsRequest.c_str());
-  dns.lookup();
+  std::vector<DnsServiceRecord> records(dnsRequests.size(),
+                                        DnsServiceRecord {
+                                          DnsServiceRecord::Abandoned, "", 0 });
+  std::vector<std::unique_ptr<QDnsLookup> > lookups;
   QEventLoop loop;
-  QObject::connect(&dns, SIGNAL(finished()), &loop, SLOT(quit()));
-  loop.exec();
 
-  if (dns.error() != QDnsLookup::NoError)
+  // the first name that is still pending or has a record decides whether
+  // the answer is known
+  auto answered = [&]() -> bool {
+                    for (auto& record : records) {
+                      if (record.status == DnsServiceRecord::Abandoned) return false;
+
+                      if (record.status == DnsServiceRecord::Found) return true;
+                    }
+                    return true;
+                  };
+
+  for (size_t i = 0; i < dnsRequests.size(); ++i)
   {
-    qWarning("DNS lookup failed");
+    Logger::Hidden("dnsRequest: %s", dnsRequests[i].c_str());
+
+    QDnsLookup *dns = new QDnsLookup(QDnsLookup::SRV,
+                                     QString::fromStdString(dnsRequests[i]));
+    lookups.emplace_back(dns);
+
+    QObject::connect(dns, &QDnsLookup::finished, &loop, [&, i, dns]() {
+      auto& record = records[i];
+
+      if (dns->error() == QDnsLookup::NoError) {
+        record.status = DnsServiceRecord::NotFound;
+
+        foreach(const QDnsServiceRecord &serviceRecord, dns->serviceRecords())
+        {
+          Logger::Hidden("QDnsServiceRecord record: %s --> %s",
+                         serviceRecord.name().toStdString().c_str(),
+                         serviceRecord.target().toStdString().c_str());
+
+          record.status = DnsServiceRecord::Found;
+          record.target = serviceRecord.target().toStdString();
+          record.ttl    = serviceRecord.timeToLive();
+          break;
+        }
+      } else if (dns->error() == QDnsLookup::NotFoundError) {
+        record.status = DnsServiceRecord::NotFound;
+      } else {
+        qWarning("DNS lookup failed");
+        record.status = DnsServiceRecord::Failed;
+      }
+
+      if (answered()) loop.quit();
+    });
   }
-  foreach(const QDnsServiceRecord &record, dns.serviceRecords())
-  {
-    Logger::Hidden("QDnsServiceRecord record: %s --> %s",
-                   record.name().toStdString().c_str(),
-                   record.target().toStdString().c_str());
 
-    return record.target().toStdString();
+  for (auto& dns : lookups) {
+    dns->lookup();
   }
-  return "";
+
+  if (!lookups.empty() && !answered()) loop.exec();
+
+  // the lookups still running are aborted when they are destroyed
+  return records;
 }
 
 std::string DnsServerResolverQt::lookup(const std::string& dnsRequest)
+{
+  auto records = lookupFirst(std::vector<std::string>(1, dnsRequest));
+
+  return records[0].status == DnsServiceRecord::Found ? records[0].target : "";
+}
+
+std::vector<DnsServiceRecord>DnsServerResolverQt::lookupFirst(
+  const std::vector<std::string>& dnsRequests)
 {
   // If a QCoreApplication does not exist, create a temporary instance.
   // QCoreApplication is a singleton, but it can keep getting created and destroyed.
@@ -64,7 +112,7 @@ std::string DnsServerResolverQt::lookup(const std::string& dnsRequest)
       int argc = 0;
       QCoreApplication a(argc, nullptr);
 
-      auto result = doLookup(dnsRequest);
+      auto result = doLookupFirst(dnsRequests);
 
       QTimer::singleShot(0, &a, SLOT(quit()));
       a.exec();
@@ -72,10 +120,9 @@ std::string DnsServerResolverQt::lookup(const std::string& dnsRequest)
       return result;
   }
 
-  return doLookup(dnsRequest);
+  return doLookupFirst(dnsRequests);
 }
 
-
 } // namespace http
 } // namespace platform
 } // namespace rmscore
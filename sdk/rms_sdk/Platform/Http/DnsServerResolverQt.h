@@ -18,9 +18,12 @@ namespace http {
 class DnsServerResolverQt : public IDnsServerResolver {
 public:
     std::string lookup(const std::string& dnsRequest) override;
+    std::vector<DnsServiceRecord> lookupFirst(
+        const std::vector<std::string>& dnsRequests) override;
 
 private:
-    std::string doLookup(const std::string& dnsRequest);
+    std::vector<DnsServiceRecord> doLookupFirst(
+        const std::vector<std::string>& dnsRequests);
 };
 } // namespace http
 } // namespace platform
@@ -16,15 +16,37 @@ CONFIG(debug, debug|release) {
 }
 
 SOURCES += \
+    CancelNotifier.cpp \
+    HttpClientBase.cpp \
     HttpClientQt.cpp \
+    HttpTransportQt.cpp \
     UriQt.cpp \
     DnsServerResolverQt.cpp
 
 HEADERS += \
+    CancelNotifier.h \
     IUri.h \
     IHttpClient.h \
     IDnsServerResolver.h \
+    HttpClientBase.h \
     HttpClientQt.h \
+    HttpRequest.h \
+    HttpTransportQt.h \
     UriQt.h \
     DnsServerResolverQt.h \
     mscertificates.h
+
+# the libcurl backend is optional: qmake CONFIG+=curl
+curl {
+    DEFINES += WITH_CURL
+
+    win32:INCLUDEPATH += $$REPO_ROOT/third_party/include
+
+    SOURCES += \
+        HttpClientCurl.cpp \
+        HttpTransportCurl.cpp
+
+    HEADERS += \
+        HttpClientCurl.h \
+        HttpTransportCurl.h
+}
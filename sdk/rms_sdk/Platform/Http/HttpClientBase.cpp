@@ -0,0 +1,160 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include "HttpClientBase.h"
+#include <algorithm>
+#include <cctype>
+
+#include "../Logger/Logger.h"
+#include "../Logger/Trace.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+namespace rmscore {
+namespace platform {
+namespace http {
+namespace {
+// the access token is not traced, the trace may be shared to diagnose issues
+const string& TracedHeaderValue(const pair<string, string>& header) {
+  static const string redacted("<redacted>");
+  static const string authorization("authorization");
+
+  bool isAuthorization = header.first.size() == authorization.size() &&
+                         equal(header.first.begin(), header.first.end(),
+                               authorization.begin(),
+                               [](char a, char b) {
+        return tolower(static_cast<unsigned char>(a)) == b;
+      });
+
+  return isAuthorization ? redacted : header.second;
+}
+} // namespace
+
+void HttpClientBase::AddAuthorizationHeader(const string& authToken) {
+  this->AddHeader("Authorization", authToken);
+}
+
+void HttpClientBase::AddAcceptMediaTypeHeader(const string& mediaType) {
+  this->AddHeader("Accept", mediaType);
+}
+
+void HttpClientBase::AddAcceptLanguageHeader(const string& language) {
+  this->AddHeader("Accept-Language", language);
+}
+
+void HttpClientBase::AddHeader(const string& headerName,
+                               const string& headerValue) {
+  this->request_.SetHeader(headerName, headerValue);
+}
+
+StatusCode HttpClientBase::doRequest(const string& method,
+                                     const string& url,
+                                     const common::ByteArray& request,
+                                     common::ByteArray& response,
+                                     std::shared_ptr<std::atomic<bool> >cancelState)
+{
+  Logger::Info("==> %s %s", method.data(), url.data());
+
+  this->request_.method = method;
+  this->request_.url    = url;
+  this->request_.body   = request;
+
+  if (Trace::IsEnabled()) {
+    Trace::Event(TRACE_HTTP_REQUEST).String(method).String(url)
+      .Int(static_cast<int64_t>(request.size()));
+
+    for (auto& header : this->request_.headers) {
+      Trace::Event(TRACE_HTTP_REQUEST_HEADER).String(header.first)
+        .String(TracedHeaderValue(header));
+    }
+
+    // the bodies carry the licenses and the content keys
+    if (!request.empty() && Trace::HasSecrets()) {
+      Trace::Event(TRACE_HTTP_REQUEST_BODY).Bytes(request.data(),
+                                                  request.size());
+    }
+  }
+
+  // the transport aborts the request as soon as it is cancelled, so there is
+  // nothing to check while waiting
+  auto future = SendAsync(this->request_, cancelState, nullptr);
+  future.wait();
+
+  // check abandom
+  if ((cancelState != nullptr) && cancelState->load()) {
+    throw exceptions::RMSNetworkException(
+            "Network operation was cancelled by user",
+            exceptions::RMSNetworkException::CancelledByUser);
+  }
+
+  lastResponse_ = future.get();
+
+  if (!lastResponse_.sslError.empty()) {
+    throw exceptions::RMSNetworkException(
+            lastResponse_.sslError,
+            exceptions::RMSNetworkException::ServerError);
+  }
+
+  Logger::Info("Response StatusCode: %i", lastResponse_.statusCode);
+
+  if (Trace::IsEnabled()) {
+    Trace::Event(TRACE_HTTP_RESPONSE).Int(lastResponse_.statusCode)
+      .String(lastResponse_.error)
+      .Int(static_cast<int64_t>(lastResponse_.body.size()));
+
+    for (auto& header : lastResponse_.headers) {
+      Trace::Event(TRACE_HTTP_RESPONSE_HEADER).String(header.first)
+        .String(header.second);
+    }
+
+    if (!lastResponse_.body.empty() && Trace::HasSecrets()) {
+      Trace::Event(TRACE_HTTP_RESPONSE_BODY).Bytes(lastResponse_.body.data(),
+                                                   lastResponse_.body.size());
+    }
+  }
+
+  response = lastResponse_.body;
+
+  if (!lastResponse_.error.empty()) {
+    Logger::Error("error: %s", lastResponse_.error.c_str());
+  }
+
+  return StatusCode(lastResponse_.statusCode);
+}
+
+StatusCode HttpClientBase::Post(const string& url,
+                                const common::ByteArray& request,
+                                const string& mediaType,
+                                common::ByteArray& response,
+                                std::shared_ptr<std::atomic<bool> >cancelState)
+{
+  this->AddAcceptMediaTypeHeader(mediaType);
+
+  return doRequest("POST", url, request, response, cancelState);
+}
+
+StatusCode HttpClientBase::Get(const string& url,
+                               common::ByteArray& response,
+                               std::shared_ptr<std::atomic<bool> >cancelState)
+{
+  return doRequest("GET", url, common::ByteArray(), response, cancelState);
+}
+
+const string HttpClientBase::GetResponseHeader(const string& headerName) {
+  return lastResponse_.GetHeader(headerName);
+}
+
+void HttpClientBase::SetAllowUI(bool /* allow*/)
+{
+  throw exceptions::RMSNotFoundException("Not implemented");
+}
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
@@ -0,0 +1,66 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _HTTPCLIENTBASE_H_
+#define _HTTPCLIENTBASE_H_
+
+#include <exception>
+#include <atomic>
+#include "IHttpClient.h"
+#include "HttpRequest.h"
+
+namespace rmscore {
+namespace platform {
+namespace http {
+// Blocking IHttpClient calls on top of SendAsync. A client holds the state of
+// a single request; the connections are owned by the transport behind
+// SendAsync, which is shared by all the clients of the backend.
+class HttpClientBase : public IHttpClient {
+public:
+
+  virtual void AddAuthorizationHeader(const std::string& authToken) override;
+  virtual void AddAcceptMediaTypeHeader(const std::string& mediaType) override;
+  virtual void AddAcceptLanguageHeader(const std::string& languages) override;
+
+  virtual void AddHeader(
+      const std::string& headerName,
+      const std::string& headerValue) override;
+
+  virtual StatusCode Post(
+      const std::string& url,
+      const common::ByteArray& request,
+      const std::string& mediaType,
+      common::ByteArray& response,
+      std::shared_ptr<std::atomic<bool> >cancelState) override;
+
+  virtual StatusCode Get(
+      const std::string& url,
+      common::ByteArray& response,
+      std::shared_ptr<std::atomic<bool> >cancelState) override;
+
+  virtual const std::string GetResponseHeader(const std::string& headerName)
+  override;
+
+  virtual void SetAllowUI(bool allow) override;
+
+private:
+  HttpRequest  request_;
+  HttpResponse lastResponse_;
+
+  StatusCode doRequest(
+      const std::string& method,
+      const std::string& url,
+      const common::ByteArray& request,
+      common::ByteArray& response,
+      std::shared_ptr<std::atomic<bool> >cancelState);
+};
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+
+#endif // _HTTPCLIENTBASE_H_
@@ -0,0 +1,27 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include "HttpClientCurl.h"
+#include "HttpTransportCurl.h"
+
+using namespace std;
+
+namespace rmscore {
+namespace platform {
+namespace http {
+shared_future<HttpResponse> HttpClientCurl::SendAsync(
+  const HttpRequest& request,
+  std::shared_ptr<std::atomic<bool> >cancelState,
+  function<void(const HttpResponse&)>callback)
+{
+  return HttpTransportCurl::Instance().Start(request, cancelState,
+                                             callback)->future;
+}
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
@@ -0,0 +1,31 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _HTTPCLIENTCURL_H_
+#define _HTTPCLIENTCURL_H_
+
+#include "HttpClientBase.h"
+
+namespace rmscore {
+namespace platform {
+namespace http {
+// IHttpClient on top of libcurl, see HttpTransportCurl. It doesn't need a
+// QCoreApplication nor a Qt event loop.
+class HttpClientCurl : public HttpClientBase {
+public:
+
+  virtual std::shared_future<HttpResponse> SendAsync(
+      const HttpRequest& request,
+      std::shared_ptr<std::atomic<bool> >cancelState,
+      std::function<void(const HttpResponse&)>callback) override;
+};
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+
+#endif // _HTTPCLIENTCURL_H_
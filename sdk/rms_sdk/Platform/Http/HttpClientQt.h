@@ -9,66 +9,19 @@
 #ifndef _HTTPCLIENTQT_H_
 #define _HTTPCLIENTQT_H_
 
-#include <QCoreApplication>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QNetworkRequest>
-#include <exception>
-#include <atomic>
-#include "IHttpClient.h"
+#include "HttpClientBase.h"
 
 namespace rmscore {
 namespace platform {
 namespace http {
-class HttpClientQt : public IHttpClient {
-  //     Q_OBJECT
-
+// IHttpClient on top of QtNetwork, see HttpTransportQt
+class HttpClientQt : public HttpClientBase {
 public:
 
-  HttpClientQt();
-  ~HttpClientQt();
-
-  virtual void AddAuthorizationHeader(const std::string& authToken) override;
-  virtual void AddAcceptMediaTypeHeader(const std::string& mediaType) override;
-  virtual void AddAcceptLanguageHeader(const std::string& languages) override;
-
-  virtual void AddHeader(
-      const std::string& headerName,
-      const std::string& headerValue) override;
-
-  virtual StatusCode Post(
-      const std::string& url,
-      const common::ByteArray& request,
-      const std::string& mediaType,
-      common::ByteArray& response,
-      std::shared_ptr<std::atomic<bool> >cancelState) override;
-
-  virtual StatusCode Get(
-      const std::string& url,
-      common::ByteArray& response,
-      std::shared_ptr<std::atomic<bool> >cancelState) override;
-
-  virtual const std::string GetResponseHeader(const std::string& headerName)
-  override;
-
-  virtual void SetAllowUI(bool allow) override;
-
-private:
-  QNetworkAccessManager manager_;
-  QNetworkRequest request_;
-  QNetworkReply  *lastReply_;
-
-  StatusCode doPost(
-      const std::string& url,
-      const common::ByteArray& request,
-      const std::string& mediaType,
-      common::ByteArray& response,
-      std::shared_ptr<std::atomic<bool> >cancelState);
-
-  StatusCode doGet(
-      const std::string& url,
-      common::ByteArray& response,
-      std::shared_ptr<std::atomic<bool> >cancelState);
+  virtual std::shared_future<HttpResponse> SendAsync(
+      const HttpRequest& request,
+      std::shared_ptr<std::atomic<bool> >cancelState,
+      std::function<void(const HttpResponse&)>callback) override;
 };
 }
 }
@@ -0,0 +1,79 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _HTTPREQUEST_H_
+#define _HTTPREQUEST_H_
+
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../Common/CommonTypes.h"
+
+namespace rmscore {
+namespace platform {
+namespace http {
+typedef std::vector<std::pair<std::string, std::string> > HttpHeaders;
+
+inline bool HttpHeaderNameEquals(const std::string& left,
+                                 const std::string& right)
+{
+  return left.size() == right.size() &&
+         std::equal(left.begin(), left.end(), right.begin(),
+                    [](char l, char r) {
+        return ::tolower(static_cast<unsigned char>(l)) ==
+               ::tolower(static_cast<unsigned char>(r));
+      });
+}
+
+// State of a single request. The transport is shared by all the requests, so
+// nothing specific to one request is kept on it.
+struct HttpRequest {
+  std::string       method; // "GET" or "POST"
+  std::string       url;
+  HttpHeaders       headers;
+  common::ByteArray body;
+
+  // sets the header, replacing the previous value if any
+  void SetHeader(const std::string& name, const std::string& value)
+  {
+    for (auto& header : headers) {
+      if (HttpHeaderNameEquals(header.first, name)) {
+        header.second = value;
+        return;
+      }
+    }
+    headers.push_back(std::make_pair(name, value));
+  }
+};
+
+struct HttpResponse {
+  HttpResponse() : statusCode(0) {}
+
+  int               statusCode; // 0 if no response was received
+  HttpHeaders       headers;
+  common::ByteArray body;
+  std::string       error;      // transport error, empty on success
+  std::string       sslError;   // TLS validation error, empty on success
+
+  // returns the value of the header or an empty string
+  std::string GetHeader(const std::string& name) const
+  {
+    for (auto& header : headers) {
+      if (HttpHeaderNameEquals(header.first, name)) return header.second;
+    }
+    return std::string();
+  }
+};
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+
+#endif // _HTTPREQUEST_H_
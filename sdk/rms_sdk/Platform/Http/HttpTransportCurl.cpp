@@ -0,0 +1,347 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include "HttpTransportCurl.h"
+#include <thread>
+#include <vector>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include "../Logger/Logger.h"
+#include "../Settings/IRMSEnvironmentImpl.h"
+#include "mscertificates.h"
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+namespace rmscore {
+namespace platform {
+namespace http {
+namespace {
+// the CAs added by AddTrustedCertificate, never freed
+mutex s_trustedMutex;
+vector<X509 *> s_trusted;
+} // namespace
+
+HttpTransportCurl& HttpTransportCurl::Instance()
+{
+  // NOTE: the transport is leaked deliberately, see the class comment.
+  static HttpTransportCurl *transport = new HttpTransportCurl();
+
+  return *transport;
+}
+
+HttpTransportCurl::HttpTransportCurl()
+{
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+
+  m_multi = curl_multi_init();
+
+  // several requests to the same host go over one HTTP/2 connection
+  curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+  // all the easy handles are used on the transport thread, so the share
+  // handle needs no locking
+  m_share = curl_share_init();
+  curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+  thread([this]() {
+      Run();
+    }).detach();
+}
+
+HttpTransportCurl::SharedOperation HttpTransportCurl::Start(
+  const HttpRequest                  & request,
+  shared_ptr<atomic<bool> >            cancelState,
+  function<void(const HttpResponse&)>callback)
+{
+  auto operation = make_shared<Operation>();
+
+  operation->request   = request;
+  operation->future    = operation->promise.get_future().share();
+  operation->callback  = callback;
+  operation->easy      = nullptr;
+  operation->headers   = nullptr;
+  operation->completed = false;
+
+  weak_ptr<Operation> weakOperation = operation;
+  operation->cancelSubscription = CancelNotifier::Instance().Subscribe(
+    cancelState,
+    [this, weakOperation]() {
+      auto cancelled = weakOperation.lock();
+
+      if (cancelled) Abort(cancelled);
+    });
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_starting.push_back(operation);
+  }
+  curl_multi_wakeup(m_multi);
+
+  return operation;
+}
+
+void HttpTransportCurl::Abort(const SharedOperation& operation)
+{
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_aborting.push_back(operation);
+  }
+  curl_multi_wakeup(m_multi);
+}
+
+void HttpTransportCurl::Run()
+{
+  for (;;) {
+    deque<SharedOperation> starting;
+    deque<SharedOperation> aborting;
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      starting.swap(m_starting);
+      aborting.swap(m_aborting);
+    }
+
+    if (!starting.empty()) {
+      long maxConnections = settings::IRMSEnvironmentImpl::Environment()->
+                            MaxConnectionsPerHost();
+      curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                        max(1L, maxConnections));
+    }
+
+    for (auto& operation : starting) {
+      Send(operation);
+    }
+
+    for (auto& operation : aborting) {
+      if (operation->completed) continue;
+
+      Remove(operation);
+
+      HttpResponse response;
+      response.error = "Operation aborted";
+      Complete(operation, response);
+    }
+
+    int running = 0;
+    curl_multi_perform(m_multi, &running);
+
+    CURLMsg *message = nullptr;
+    int left         = 0;
+
+    while ((message = curl_multi_info_read(m_multi, &left)) != nullptr) {
+      if (message->msg == CURLMSG_DONE) {
+        Finish(message->easy_handle, message->data.result);
+      }
+    }
+
+    // sleeps until there is network activity or curl_multi_wakeup is called
+    curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr);
+  }
+}
+
+void HttpTransportCurl::Send(const SharedOperation& operation)
+{
+  // aborted before it was sent
+  if (operation->completed) return;
+
+  const HttpRequest& request = operation->request;
+  CURL *easy = curl_easy_init();
+
+  curl_easy_setopt(easy, CURLOPT_URL,            request.url.c_str());
+  curl_easy_setopt(easy, CURLOPT_SHARE,          m_share);
+  curl_easy_setopt(easy, CURLOPT_HTTP_VERSION,   CURL_HTTP_VERSION_2TLS);
+  curl_easy_setopt(easy, CURLOPT_PIPEWAIT,       1L);
+  curl_easy_setopt(easy, CURLOPT_NOSIGNAL,       1L);
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION,  &HttpTransportCurl::WriteBody);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA,      operation.get());
+  curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, &HttpTransportCurl::WriteHeader);
+  curl_easy_setopt(easy, CURLOPT_HEADERDATA,     operation.get());
+
+  if (curl_easy_setopt(easy, CURLOPT_SSL_CTX_FUNCTION,
+                       &HttpTransportCurl::AddMicrosoftCertificates) != CURLE_OK) {
+    static once_flag warned;
+    call_once(warned, []() {
+        Logger::Warning(
+          "HttpTransportCurl: libcurl is not built with OpenSSL, the Microsoft CAs are not trusted");
+      });
+  }
+
+  if (request.method == "POST") {
+    curl_easy_setopt(easy, CURLOPT_POST,          1L);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS,    request.body.data());
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE,
+                     static_cast<long>(request.body.size()));
+  }
+
+  for (auto& header : request.headers) {
+    operation->headers = curl_slist_append(
+      operation->headers, (header.first + ": " + header.second).c_str());
+  }
+
+  // the REST services don't use 100-continue, don't wait for it
+  operation->headers = curl_slist_append(operation->headers, "Expect:");
+  curl_easy_setopt(easy, CURLOPT_HTTPHEADER, operation->headers);
+
+  operation->easy = easy;
+  m_active[easy]  = operation;
+  curl_multi_add_handle(m_multi, easy);
+}
+
+void HttpTransportCurl::Finish(CURL *easy, CURLcode result)
+{
+  auto it = m_active.find(easy);
+
+  if (it == m_active.end()) return;
+
+  auto operation = it->second;
+  HttpResponse response(move(operation->response));
+
+  if (result == CURLE_OK) {
+    long statusCode = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &statusCode);
+    response.statusCode = static_cast<int>(statusCode);
+  } else {
+    response.error = curl_easy_strerror(result);
+
+    if ((result == CURLE_PEER_FAILED_VERIFICATION) ||
+        (result == CURLE_SSL_CONNECT_ERROR)) {
+      Logger::Error("HttpTransportCurl: %s", response.error.c_str());
+      response.sslError = response.error;
+    }
+  }
+
+  Remove(operation);
+  Complete(operation, response);
+}
+
+void HttpTransportCurl::Remove(const SharedOperation& operation)
+{
+  if (operation->easy != nullptr) {
+    curl_multi_remove_handle(m_multi, operation->easy);
+    curl_easy_cleanup(operation->easy);
+    m_active.erase(operation->easy);
+    operation->easy = nullptr;
+  }
+
+  if (operation->headers != nullptr) {
+    curl_slist_free_all(operation->headers);
+    operation->headers = nullptr;
+  }
+}
+
+void HttpTransportCurl::Complete(const SharedOperation& operation,
+                                 const HttpResponse   & response)
+{
+  if (operation->completed) return;
+
+  operation->completed = true;
+  operation->cancelSubscription.reset();
+
+  // the callback runs first, so that its effects are visible to the callers
+  // waiting on the future
+  if (operation->callback) operation->callback(response);
+  operation->promise.set_value(response);
+}
+
+CURLcode HttpTransportCurl::AddMicrosoftCertificates(CURL *,
+                                                     void *sslContext,
+                                                     void *)
+{
+  // parsed once; like the transport they are never freed
+  static const vector<X509 *> certificates = []() {
+      vector<X509 *> parsed;
+
+      for (auto pem : { &MicrosoftCertCA, &MicrosoftCertSubCA }) {
+        BIO  *bio         = BIO_new_mem_buf(pem->constData(), pem->size());
+        X509 *certificate = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr);
+        BIO_free(bio);
+
+        if (certificate != nullptr) {
+          parsed.push_back(certificate);
+        } else {
+          Logger::Error("HttpTransportCurl: can't parse a Microsoft CA");
+        }
+      }
+      return parsed;
+    }();
+
+  X509_STORE *store = SSL_CTX_get_cert_store(static_cast<SSL_CTX *>(sslContext));
+
+  for (auto certificate : certificates) {
+    // fails harmlessly when the store already has it
+    X509_STORE_add_cert(store, certificate);
+  }
+
+  {
+    lock_guard<mutex> lock(s_trustedMutex);
+
+    for (auto certificate : s_trusted) {
+      X509_STORE_add_cert(store, certificate);
+    }
+  }
+  ERR_clear_error();
+  return CURLE_OK;
+}
+
+void HttpTransportCurl::AddTrustedCertificate(X509 *certificate)
+{
+  if (certificate == nullptr) return;
+
+  X509_up_ref(certificate);
+
+  lock_guard<mutex> lock(s_trustedMutex);
+  s_trusted.push_back(certificate);
+}
+
+size_t HttpTransportCurl::WriteBody(char  *data,
+                                    size_t size,
+                                    size_t count,
+                                    void  *operation)
+{
+  auto& body = static_cast<Operation *>(operation)->response.body;
+
+  body.insert(body.end(), data, data + size * count);
+  return size * count;
+}
+
+size_t HttpTransportCurl::WriteHeader(char  *data,
+                                      size_t size,
+                                      size_t count,
+                                      void  *operation)
+{
+  auto & headers = static_cast<Operation *>(operation)->response.headers;
+  string line(data, size * count);
+
+  // a new status line, e.g. after a redirect, starts a new set of headers
+  if (line.compare(0, 5, "HTTP/") == 0) {
+    headers.clear();
+    return size * count;
+  }
+
+  auto colon = line.find(':');
+
+  if (colon != string::npos) {
+    auto valueStart = line.find_first_not_of(" \t", colon + 1);
+    auto valueEnd   = line.find_last_not_of(" \t\r\n");
+    string value;
+
+    if ((valueStart != string::npos) && (valueEnd >= valueStart)) {
+      value = line.substr(valueStart, valueEnd - valueStart + 1);
+    }
+    headers.push_back(make_pair(line.substr(0, colon), value));
+  }
+  return size * count;
+}
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
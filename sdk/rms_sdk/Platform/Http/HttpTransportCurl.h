@@ -0,0 +1,120 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _HTTPTRANSPORTCURL_H_
+#define _HTTPTRANSPORTCURL_H_
+
+#include <curl/curl.h>
+#include <openssl/x509.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "CancelNotifier.h"
+#include "HttpRequest.h"
+
+namespace rmscore {
+namespace platform {
+namespace http {
+// Process wide HTTP transport on top of libcurl. A single multi handle, driven
+// by its own thread, sends the requests of all the HttpClientCurl instances.
+// The multi handle keeps one connection cache for all of them and multiplexes
+// the requests to a host over one HTTP/2 connection when the server supports
+// it; the DNS cache and the TLS sessions are shared through a share handle.
+// Unlike HttpTransportQt it needs neither a QCoreApplication nor a Qt event
+// loop.
+//
+// The transport is never destroyed, as it may be used until the very end of
+// the process.
+class HttpTransportCurl {
+public:
+
+  // one request in flight, shared between the caller and the transport
+  struct Operation {
+    HttpRequest                      request;
+    std::promise<HttpResponse>       promise;
+    std::shared_future<HttpResponse> future;
+    std::function<void(const HttpResponse&)> callback;
+    SharedCancelSubscription cancelSubscription;
+
+    // accessed on the transport thread only
+    CURL         *easy;
+    curl_slist   *headers;
+    HttpResponse  response;
+    bool          completed;
+  };
+
+  typedef std::shared_ptr<Operation> SharedOperation;
+
+  static HttpTransportCurl& Instance();
+
+  // queues the request, its response is delivered through operation->future
+  // and the callback, if any, on the transport thread; the request is aborted
+  // as soon as cancelState is set
+  SharedOperation Start(const HttpRequest                       & request,
+                        std::shared_ptr<std::atomic<bool> >       cancelState,
+                        std::function<void(const HttpResponse&)>callback);
+
+  // aborts the request; the future gets an empty response
+  void            Abort(const SharedOperation& operation);
+
+  // CURLOPT_SSL_CTX_FUNCTION: adds the Microsoft root and intermediate CAs,
+  // which HttpTransportQt trusts too, and those of AddTrustedCertificate to
+  // the X509 store of the OpenSSL context, next to the CA bundle of the system
+  static CURLcode AddMicrosoftCertificates(CURL *easy,
+                                           void *sslContext,
+                                           void *data);
+
+  // trusts one more CA, e.g. the one of an on-premises server, for the
+  // connections opened afterwards; the store keeps its own reference
+  static void     AddTrustedCertificate(X509 *certificate);
+
+private:
+
+  HttpTransportCurl();
+
+  // undefined copy constructor and assignment operator
+  HttpTransportCurl(const HttpTransportCurl&);
+  HttpTransportCurl& operator=(const HttpTransportCurl&);
+
+  void Run();
+
+  // everything below runs on the transport thread only
+  void Send(const SharedOperation& operation);
+  void Finish(CURL *easy, CURLcode result);
+  void Remove(const SharedOperation& operation);
+  void Complete(const SharedOperation& operation,
+                const HttpResponse   & response);
+
+  static size_t WriteBody(char  *data,
+                          size_t size,
+                          size_t count,
+                          void  *operation);
+  static size_t WriteHeader(char  *data,
+                            size_t size,
+                            size_t count,
+                            void  *operation);
+
+  CURLM  *m_multi;
+  CURLSH *m_share;
+
+  // requests handed over to the transport thread, guarded by m_mutex
+  std::mutex m_mutex;
+  std::deque<SharedOperation> m_starting;
+  std::deque<SharedOperation> m_aborting;
+
+  std::map<CURL *, SharedOperation> m_active;
+};
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+
+#endif // _HTTPTRANSPORTCURL_H_
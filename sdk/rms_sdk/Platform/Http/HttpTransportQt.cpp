@@ -0,0 +1,304 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifdef QTFRAMEWORK
+
+#include "HttpTransportQt.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QSslConfiguration>
+#include <QSslError>
+#include <QUrl>
+#include <algorithm>
+
+#include "../Logger/Logger.h"
+#include "../Settings/IRMSEnvironmentImpl.h"
+#include "mscertificates.h"
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+namespace rmscore {
+namespace platform {
+namespace http {
+static QEvent::Type TaskEventType()
+{
+  static const QEvent::Type type =
+    static_cast<QEvent::Type>(QEvent::registerEventType());
+
+  return type;
+}
+
+// carries a task to the transport thread
+class TaskEvent : public QEvent {
+public:
+
+  TaskEvent(function<void()>task) : QEvent(TaskEventType()), task_(task) {}
+
+  void Run() {
+    task_();
+  }
+
+private:
+
+  function<void()> task_;
+};
+
+class TaskReceiver : public QObject {
+public:
+
+  virtual bool event(QEvent *e) override {
+    if (e->type() == TaskEventType()) {
+      static_cast<TaskEvent *>(e)->Run();
+      return true;
+    }
+    return QObject::event(e);
+  }
+};
+
+class HttpTransportQt::TransportThread : public QThread {
+public:
+
+  TransportThread(HttpTransportQt& transport) : transport_(transport) {}
+
+  QSemaphore ready;
+
+protected:
+
+  virtual void run() override {
+    // QtNetwork calls need to be made from within the scope of a
+    // QCoreApplication. If the host application has none, e.g. a console
+    // program or a service, the transport keeps its own for the lifetime of
+    // the thread.
+    unique_ptr<QCoreApplication> application;
+
+    if (!QCoreApplication::instance()) {
+      static int argc = 0;
+      Logger::Info("HttpTransportQt: no QCoreApplication, creating one.");
+      application.reset(new QCoreApplication(argc, nullptr));
+    }
+
+    TaskReceiver receiver;
+    QNetworkAccessManager manager;
+
+    transport_.m_receiver = &receiver;
+    transport_.m_manager  = &manager;
+    ready.release();
+
+    exec();
+  }
+
+private:
+
+  HttpTransportQt& transport_;
+};
+
+HttpTransportQt& HttpTransportQt::Instance()
+{
+  // NOTE: the transport is leaked deliberately, see the class comment.
+  static HttpTransportQt *transport = new HttpTransportQt();
+
+  return *transport;
+}
+
+HttpTransportQt::HttpTransportQt()
+  : m_thread(nullptr)
+  , m_receiver(nullptr)
+  , m_manager(nullptr)
+{
+  QSslConfiguration sslConfiguration(QSslConfiguration::defaultConfiguration());
+
+  // add Microsoft certificates to trust list
+  QList<QSslCertificate> certificates = sslConfiguration.caCertificates();
+  certificates.append(QSslCertificate::fromData(MicrosoftCertCA));
+  certificates.append(QSslCertificate::fromData(MicrosoftCertSubCA));
+  sslConfiguration.setCaCertificates(certificates);
+
+  // resume the TLS sessions when a new connection to the same host is opened
+  sslConfiguration.setSslOption(QSsl::SslOptionDisableSessionSharing, false);
+  sslConfiguration.setSslOption(QSsl::SslOptionDisableSessionTickets, false);
+  QSslConfiguration::setDefaultConfiguration(sslConfiguration);
+
+  m_thread = new TransportThread(*this);
+  m_thread->start();
+  m_thread->ready.acquire();
+}
+
+HttpTransportQt::SharedOperation HttpTransportQt::Start(
+  const HttpRequest                  & request,
+  shared_ptr<atomic<bool> >            cancelState,
+  function<void(const HttpResponse&)>callback)
+{
+  auto operation = make_shared<Operation>();
+  QUrl url(request.url.c_str());
+
+  operation->request = request;
+  operation->host    = url.scheme().toStdString() + "://" +
+                       url.host().toStdString() + ":" +
+                       to_string(url.port(url.scheme() == "https" ? 443 : 80));
+  operation->future    = operation->promise.get_future().share();
+  operation->callback  = callback;
+  operation->reply     = nullptr;
+  operation->completed = false;
+
+  weak_ptr<Operation> weakOperation = operation;
+  operation->cancelSubscription = CancelNotifier::Instance().Subscribe(
+    cancelState,
+    [this, weakOperation]() {
+      auto cancelled = weakOperation.lock();
+
+      if (cancelled) Abort(cancelled);
+    });
+
+  Post([this, operation]() {
+    Dispatch(operation);
+  });
+
+  return operation;
+}
+
+void HttpTransportQt::Abort(const SharedOperation& operation)
+{
+  Post([this, operation]() {
+    if (operation->completed) return;
+
+    if (operation->reply != nullptr) {
+      // emits finished()
+      operation->reply->abort();
+      return;
+    }
+
+    // still waiting for a connection
+    auto& queue = m_queued[operation->host];
+    queue.erase(std::remove(queue.begin(), queue.end(), operation), queue.end());
+
+    HttpResponse response;
+    response.error = "Operation aborted";
+    Complete(operation, response);
+  });
+}
+
+void HttpTransportQt::Post(function<void()>task)
+{
+  QCoreApplication::postEvent(m_receiver, new TaskEvent(task));
+}
+
+void HttpTransportQt::Dispatch(const SharedOperation& operation)
+{
+  // cancelled before it was sent
+  if (operation->completed) return;
+
+  int maxConnections = max(1,
+                           settings::IRMSEnvironmentImpl::Environment()->
+                           MaxConnectionsPerHost());
+
+  if (m_active[operation->host] < maxConnections) {
+    Send(operation);
+  } else {
+    m_queued[operation->host].push_back(operation);
+  }
+}
+
+void HttpTransportQt::Send(const SharedOperation& operation)
+{
+  const HttpRequest& request = operation->request;
+  QNetworkRequest    networkRequest(QUrl(request.url.c_str()));
+
+  networkRequest.setSslConfiguration(QSslConfiguration::defaultConfiguration());
+
+  for (auto& header : request.headers) {
+    networkRequest.setRawHeader(header.first.c_str(), header.second.c_str());
+  }
+
+  ++m_active[operation->host];
+
+  if (request.method == "POST") {
+    operation->reply = m_manager->post(
+      networkRequest,
+      QByteArray(reinterpret_cast<const char *>(request.body.data()),
+                 static_cast<int>(request.body.size())));
+  } else {
+    operation->reply = m_manager->get(networkRequest);
+  }
+
+  auto reply = operation->reply;
+
+  QObject::connect(reply, &QNetworkReply::sslErrors, m_receiver,
+                   [reply](const QList<QSslError>& errorList) {
+          for (auto& error : errorList) {
+            Logger::Error("QSslError: %s",
+                          error.errorString().toStdString().c_str());
+          }
+
+          if (!errorList.isEmpty()) {
+            reply->setProperty("sslError", errorList.first().errorString());
+          }
+        });
+  QObject::connect(reply, &QNetworkReply::finished, m_receiver,
+                   [this, operation]() {
+          Finish(operation);
+        });
+}
+
+void HttpTransportQt::Finish(const SharedOperation& operation)
+{
+  auto reply = operation->reply;
+
+  if (reply == nullptr) return;
+
+  HttpResponse response;
+
+  response.statusCode = reply->attribute(
+    QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+  foreach(const QNetworkReply::RawHeaderPair & pair, reply->rawHeaderPairs()) {
+    response.headers.push_back(make_pair(pair.first.toStdString(),
+                                         pair.second.toStdString()));
+  }
+
+  QByteArray body = reply->readAll();
+  response.body.assign(body.begin(), body.end());
+
+  if (reply->error() != QNetworkReply::NoError) {
+    response.error = reply->errorString().toStdString();
+  }
+  response.sslError = reply->property("sslError").toString().toStdString();
+
+  operation->reply = nullptr;
+  reply->deleteLater();
+  --m_active[operation->host];
+
+  Complete(operation, response);
+
+  // hand the connection to the next request for the host
+  auto& queue = m_queued[operation->host];
+
+  if (!queue.empty()) {
+    auto next = queue.front();
+    queue.pop_front();
+    Send(next);
+  }
+}
+
+void HttpTransportQt::Complete(const SharedOperation& operation,
+                               const HttpResponse   & response)
+{
+  if (operation->completed) return;
+
+  operation->completed = true;
+  operation->cancelSubscription.reset();
+
+  // the callback runs first, so that its effects are visible to the callers
+  // waiting on the future
+  if (operation->callback) operation->callback(response);
+  operation->promise.set_value(response);
+}
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+#endif // ifdef QTFRAMEWORK
@@ -0,0 +1,102 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _HTTPTRANSPORTQT_H_
+#define _HTTPTRANSPORTQT_H_
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include "CancelNotifier.h"
+#include "HttpRequest.h"
+
+namespace rmscore {
+namespace platform {
+namespace http {
+// Process wide HTTP transport. A single QNetworkAccessManager, living on its
+// own thread, sends the requests of all the HttpClientQt instances, so the
+// connections (and the TLS sessions) are kept alive and reused across REST
+// calls instead of being set up again for every call. The requests complete
+// asynchronously on that thread; the callers wait on a future or get a
+// callback, and cancellation is delivered by the CancelNotifier.
+//
+// The transport is never destroyed, as it may be used until the very end of
+// the process. It uses the host application's QCoreApplication, or creates
+// one on its thread if there is none; such a host must not create its own
+// afterwards.
+class HttpTransportQt {
+public:
+
+  // one request in flight, shared between the caller and the transport
+  struct Operation {
+    HttpRequest                      request;
+    std::string                      host;
+    std::promise<HttpResponse>       promise;
+    std::shared_future<HttpResponse> future;
+    std::function<void(const HttpResponse&)> callback;
+    SharedCancelSubscription cancelSubscription;
+
+    // accessed on the transport thread only
+    QNetworkReply *reply;
+    bool           completed;
+  };
+
+  typedef std::shared_ptr<Operation> SharedOperation;
+
+  static HttpTransportQt& Instance();
+
+  // queues the request, its response is delivered through operation->future
+  // and the callback, if any, on the transport thread; the request is aborted
+  // as soon as cancelState is set
+  SharedOperation Start(const HttpRequest                       & request,
+                        std::shared_ptr<std::atomic<bool> >       cancelState,
+                        std::function<void(const HttpResponse&)>callback);
+
+  // aborts the request; the future gets an empty response
+  void            Abort(const SharedOperation& operation);
+
+private:
+
+  class TransportThread;
+
+  HttpTransportQt();
+
+  // undefined copy constructor and assignment operator
+  HttpTransportQt(const HttpTransportQt&);
+  HttpTransportQt& operator=(const HttpTransportQt&);
+
+  // runs the task on the transport thread
+  void Post(std::function<void()>task);
+
+  // everything below runs on the transport thread only
+  void Dispatch(const SharedOperation& operation);
+  void Send(const SharedOperation& operation);
+  void Finish(const SharedOperation& operation);
+  void Complete(const SharedOperation& operation,
+                const HttpResponse   & response);
+
+  TransportThread *m_thread;
+  QObject *m_receiver;
+  QNetworkAccessManager *m_manager;
+
+  // requests in flight and waiting for a connection, per host
+  std::map<std::string, int> m_active;
+  std::map<std::string, std::deque<SharedOperation> > m_queued;
+};
+}
+}
+} // namespace rmscore { namespace platform { namespace http {
+
+#endif // _HTTPTRANSPORTQT_H_
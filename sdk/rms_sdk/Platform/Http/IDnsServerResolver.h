@@ -18,10 +18,29 @@
 namespace rmscore {
 namespace platform {
 namespace http {
+struct DnsServiceRecord {
+    enum Status {
+        Found,     // target and ttl are set
+        NotFound,  // the name or its SRV record does not exist
+        Failed,    // timeout, server failure...
+        Abandoned  // not needed anymore, a preceding name was found
+    };
+
+    Status      status;
+    std::string target;
+    uint32_t    ttl; // seconds
+};
+
 class IDnsServerResolver {
 public:
     virtual std::string lookup(const std::string& dnsRequest) = 0;
 
+    // Looks up the SRV records of all the names at once and returns as soon
+    // as the first name that has one is known, i.e. when all the names before
+    // it were not found or failed. There is one record per name, in order.
+    virtual std::vector<DnsServiceRecord> lookupFirst(
+        const std::vector<std::string>& dnsRequests) = 0;
+
 public:
     static std::shared_ptr<IDnsServerResolver> Create();
 };
@@ -12,14 +12,18 @@
 #include <memory>
 #include <string>
 #include <atomic>
+#include <functional>
+#include <future>
 
 #include "../../Common/FrameworkSpecificTypes.h"
+#include "HttpRequest.h"
 
 namespace rmscore {
 namespace platform {
 namespace http {
 enum class StatusCode {
   OK                    = 200,
+  NOT_MODIFIED          = 304,
   BAD_REQUEST           = 400,
   UNAUTHORIZED          = 401,
   NOT_FOUND             = 404,
@@ -46,6 +50,15 @@ public:
                          common::ByteArray& response,
                          std::shared_ptr<std::atomic<bool> >cancelState) = 0;
 
+  // Starts the request and returns right away. The response is delivered
+  // through the future and, if given, to the callback, which runs on the I/O
+  // thread. Setting cancelState aborts the request at once; the response of
+  // an aborted request has no status code.
+  virtual std::shared_future<HttpResponse> SendAsync(
+    const HttpRequest& request,
+    std::shared_ptr<std::atomic<bool> >cancelState,
+    std::function<void(const HttpResponse&)>callback = nullptr) = 0;
+
   virtual const std::string GetResponseHeader(const std::string& headerName) = 0;
 
   virtual void SetAllowUI(bool allow) = 0;
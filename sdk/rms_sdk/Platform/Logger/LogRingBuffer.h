@@ -0,0 +1,150 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_LOGRINGBUFFER_H_
+#define _RMS_LIB_LOGRINGBUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace rmscore {
+namespace platform {
+namespace logger {
+// Bounded lock-free queue of log records (D. Vyukov's MPMC queue). Every
+// slot carries a sequence number telling whether it may be written or read
+// at a given position, so producers and consumers only contend on one atomic
+// increment each. Records up to inline_length bytes are copied into the slot,
+// longer ones into a string.
+class LogRingBuffer {
+public:
+
+  static const size_t inline_length = 256;
+
+  struct Record {
+    const char *prefix;
+    std::chrono::system_clock::time_point time;
+    size_t      length;
+    char        text[inline_length];
+    std::string longText;
+
+    const char* Text() const {
+      return length <= inline_length ? text : longText.data();
+    }
+  };
+
+  // capacity must be a power of two
+  explicit LogRingBuffer(size_t capacity)
+    : m_mask(capacity - 1)
+    , m_slots(new Slot[capacity])
+    , m_tail(0)
+    , m_head(0)
+  {
+    for (size_t i = 0; i < capacity; ++i) {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // false if the buffer is full
+  bool TryPush(const char *prefix, const char *text, size_t length) {
+    size_t position = m_tail.load(std::memory_order_relaxed);
+    Slot  *slot;
+
+    for (;;) {
+      slot = &m_slots[position & m_mask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto   diff     = static_cast<ptrdiff_t>(sequence) -
+                        static_cast<ptrdiff_t>(position);
+
+      if (diff == 0) {
+        if (m_tail.compare_exchange_weak(position, position + 1,
+                                         std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    Record& record = slot->record;
+    record.prefix = prefix;
+    record.time   = std::chrono::system_clock::now();
+    record.length = length;
+
+    if (length <= inline_length) {
+      std::memcpy(record.text, text, length);
+    } else {
+      record.longText.assign(text, length);
+    }
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // false if the buffer is empty
+  bool TryPop(Record& record) {
+    size_t position = m_head.load(std::memory_order_relaxed);
+    Slot  *slot;
+
+    for (;;) {
+      slot = &m_slots[position & m_mask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto   diff     = static_cast<ptrdiff_t>(sequence) -
+                        static_cast<ptrdiff_t>(position + 1);
+
+      if (diff == 0) {
+        if (m_head.compare_exchange_weak(position, position + 1,
+                                         std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = m_head.load(std::memory_order_relaxed);
+      }
+    }
+
+    record.prefix = slot->record.prefix;
+    record.time   = slot->record.time;
+    record.length = slot->record.length;
+
+    if (record.length <= inline_length) {
+      std::memcpy(record.text, slot->record.text, record.length);
+    } else {
+      record.longText.swap(slot->record.longText);
+    }
+
+    slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+
+  // undefined copy constructor and assignment operator
+  LogRingBuffer(const LogRingBuffer&);
+  LogRingBuffer& operator=(const LogRingBuffer&);
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Record record;
+  };
+
+  const size_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+
+  // kept apart, they are written by different threads; padded rather than
+  // aligned, as C++11 new doesn't honor extended alignments
+  char                m_padding1[64];
+  std::atomic<size_t> m_tail;
+  char                m_padding2[64];
+  std::atomic<size_t> m_head;
+};
+} // namespace logger
+} // namespace platform
+} // namespace rmscore
+#endif // _RMS_LIB_LOGRINGBUFFER_H_
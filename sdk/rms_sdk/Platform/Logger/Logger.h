@@ -9,97 +9,171 @@
 #ifndef _RMS_LIB_LOGGER_H_
 #define _RMS_LIB_LOGGER_H_
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <cstdio>
+#include <cstring>
 #include <QProcessEnvironment>
 #include "../Settings/IRMSEnvironmentImpl.h"
 
+// the most verbose level compiled in, the calls above it are removed by the
+// compiler; e.g. DEFINES += RMS_LOG_LEVEL=3 drops the hidden records
+#ifndef RMS_LOG_LEVEL
+# define RMS_LOG_LEVEL 4
+#endif // ifndef RMS_LOG_LEVEL
+
 namespace rmscore {
 namespace platform {
 namespace logger {
+enum LogLevel {
+  LOG_LEVEL_ERROR   = 1,
+  LOG_LEVEL_WARNING = 2,
+  LOG_LEVEL_INFO    = 3,
+  LOG_LEVEL_HIDDEN  = 4
+};
+
+// Records are checked against the compile-time and the runtime levels and
+// IRMSEnvironment::LogOption before the arguments are formatted. They are
+// formatted into a per-thread buffer and queued to the sink, which writes
+// them from a background thread.
 class Logger {
-  static const int max_length = 1024000;
+  static const int max_length    = 1024000;
+  static const int buffer_length = 4096;
 
 public:
 
-  template<typename ... Arguments>
-  static void Append(const std::string& prefix,
-                     const std::string& record,
-                     Arguments ...      arguments) {
-    auto cArgs =  sizeof ... (Arguments);
-
-    auto env   = settings::IRMSEnvironmentImpl::Environment();
-    if (!env || (env->LogOption() == modernapi::IRMSEnvironment::LoggerOption::Never)) {
+  template<int level, typename ... Arguments>
+  static void Append(const char    *prefix,
+                     const char    *record,
+                     Arguments ...  arguments) {
+    if ((level > RMS_LOG_LEVEL) || !IsEnabled(level)) {
       return;
     }
+    Format(prefix, record, arguments ...);
+  }
 
-    if (cArgs > 0) {
-      std::string buff(max_length, '-');
-#ifdef Q_OS_WIN32
-      int num_bytes = sprintf_s(&buff[0], max_length,
-                                record.c_str(), arguments ...);
-#else // ifdef Q_OS_WIN32
-            # if defined(__clang__)
-                #  pragma clang diagnostic push
-                #  pragma clang diagnostic ignored "-Wformat-security"
-            # endif // if defined(__clang__)
-            # if defined(__GNUC__)
-                #  pragma GCC diagnostic ignored "-Wformat-security"
-            # endif // if defined(__GNUC__)
-      int num_bytes = std::snprintf(&buff[0], max_length,
-                                    record.c_str(), arguments ...);
-            # if defined(__clang__)
-                #  pragma clang diagnostic pop
-            # endif // if defined(__clang__)
-#endif              // ifdef Q_OS_WIN32
-
-      if (num_bytes < max_length) {
-        buff.resize(num_bytes);
-      }
-      Logger::instance().append(prefix, buff);
-    } else {
-      Logger::instance().append(prefix, record);
-    }
+  template<typename ... Arguments>
+  static void Info(const char *record, Arguments ... arguments) {
+    Logger::Append<LOG_LEVEL_INFO>("INF", record, arguments ...);
   }
 
   template<typename ... Arguments>
   static void Info(const std::string& record, Arguments ... arguments) {
-    Logger::Append("INF", record, arguments ...);
+    Logger::Append<LOG_LEVEL_INFO>("INF", record.c_str(), arguments ...);
+  }
+
+  template<typename ... Arguments>
+  static void Warning(const char *record, Arguments ... arguments) {
+    Logger::Append<LOG_LEVEL_WARNING>("WRN", record, arguments ...);
   }
 
   template<typename ... Arguments>
   static void Warning(const std::string& record, Arguments ... arguments) {
-    Logger::Append("WRN", record, arguments ...);
+    Logger::Append<LOG_LEVEL_WARNING>("WRN", record.c_str(), arguments ...);
+  }
+
+  template<typename ... Arguments>
+  static void Error(const char *record, Arguments ... arguments) {
+    Logger::Append<LOG_LEVEL_ERROR>("ERR", record, arguments ...);
   }
 
   template<typename ... Arguments>
   static void Error(const std::string& record, Arguments ... arguments) {
-    Logger::Append("ERR", record, arguments ...);
+    Logger::Append<LOG_LEVEL_ERROR>("ERR", record.c_str(), arguments ...);
+  }
+
+  template<typename ... Arguments>
+  static void Hidden(const char *record, Arguments ... arguments) {
+    Logger::Append<LOG_LEVEL_HIDDEN>("HDN", record, arguments ...);
   }
 
   template<typename ... Arguments>
   static void Hidden(const std::string& record, Arguments ... arguments) {
-    // read env var
-    static QString ev = QProcessEnvironment::systemEnvironment().value(
-      "RMS_HIDDEN_LOG",
-      "OFF");
-
-    // if set
-    if (QString::compare(ev, "ON") == 0)
-    {
-      Logger::Append("HDN", record, arguments ...);
-    }
+    Logger::Append<LOG_LEVEL_HIDDEN>("HDN", record.c_str(), arguments ...);
   }
 
+  // the most verbose level written at runtime; LOG_LEVEL_HIDDEN if the
+  // RMS_HIDDEN_LOG environment variable is ON, LOG_LEVEL_INFO otherwise
+  static int Level() {
+    return RuntimeLevel().load(std::memory_order_relaxed);
+  }
+
+  static void SetLevel(int level) {
+    RuntimeLevel().store(level, std::memory_order_relaxed);
+  }
+
+  static bool IsEnabled(int level) {
+    if (level > Level()) return false;
+
+    // the instance is read in place rather than through Environment(), to
+    // keep the reference count out of every call
+    auto env = settings::_instance.get();
+    return env != nullptr && env->IsLogEnabled();
+  }
+
+  // writes the queued records, e.g. before the process exits
+  static void Flush();
+
   virtual ~Logger() {}
 
 protected:
 
-  virtual void append(const std::string& prefix,
-                      const std::string& record) = 0;
+  // record is not null-terminated, it must be copied before returning
+  virtual void append(const char *prefix,
+                      const char *record,
+                      size_t      length) = 0;
+  virtual void flush() = 0;
 
 private:
 
+  static std::atomic<int>& RuntimeLevel() {
+    static std::atomic<int> level(
+      QString::compare(QProcessEnvironment::systemEnvironment().value(
+                         "RMS_HIDDEN_LOG", "OFF"), "ON") == 0 ?
+      LOG_LEVEL_HIDDEN : LOG_LEVEL_INFO);
+
+    return level;
+  }
+
+  // without arguments the record is not a format
+  static void Format(const char *prefix, const char *record) {
+    Logger::instance().append(prefix, record, std::strlen(record));
+  }
+
+  template<typename ... Arguments>
+  static void Format(const char    *prefix,
+                     const char    *record,
+                     Arguments ...  arguments) {
+    static thread_local char buff[buffer_length];
+
+            # if defined(__clang__)
+                #  pragma clang diagnostic push
+                #  pragma clang diagnostic ignored "-Wformat-security"
+            # endif // if defined(__clang__)
+            # if defined(__GNUC__)
+                #  pragma GCC diagnostic ignored "-Wformat-security"
+            # endif // if defined(__GNUC__)
+    int num_bytes = std::snprintf(buff, buffer_length, record, arguments ...);
+
+    if (num_bytes < 0) return;
+
+    if (num_bytes < buffer_length) {
+      Logger::instance().append(prefix, buff, num_bytes);
+      return;
+    }
+
+    // rare long records, e.g. server responses, go through the heap
+    std::string large(std::min(num_bytes + 1, max_length), '\0');
+    num_bytes = std::snprintf(&large[0], large.size(), record, arguments ...);
+            # if defined(__clang__)
+                #  pragma clang diagnostic pop
+            # endif // if defined(__clang__)
+
+    Logger::instance().append(prefix, large.data(),
+                              std::min<size_t>(num_bytes, large.size() - 1));
+  }
+
   static Logger& instance();
 };
 } // namespace logger
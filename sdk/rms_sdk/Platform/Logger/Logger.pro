@@ -17,8 +17,12 @@ CONFIG(debug, debug|release) {
 }
 
 SOURCES += \
-    LoggerImplQt.cpp
+    LoggerImplQt.cpp \
+    Trace.cpp
 
 HEADERS += \
     Logger.h \
-    LoggerImplQt.h
+    LogRingBuffer.h \
+    LoggerImplQt.h \
+    Trace.h \
+    TraceFormat.h
@@ -9,27 +9,38 @@
 #ifdef QTFRAMEWORK
 #include "LoggerImplQt.h"
 #include <time.h>
+#include <cstdlib>
 #include <sstream>
 #include <string>
+#include <thread>
 
 namespace rmscore {
 namespace platform {
 namespace logger {
 Logger& Logger::instance() {
-  static LoggerImplQt instance;
+  // NOTE: the logger is leaked deliberately, see the class comment.
+  static LoggerImplQt *instance = new LoggerImplQt();
 
-  return instance;
+  return *instance;
 }
 
-static std::string localTime(const char *format) {
-  const time_t rawtime = time(nullptr);
+void Logger::Flush() {
+  Logger::instance().flush();
+}
 
-#ifdef Q_OS_WIN32
+static tm localTime(std::time_t rawtime) {
   tm timebuf;
+
+#ifdef Q_OS_WIN32
   localtime_s(&timebuf, &rawtime);
 #else // ifdef Q_OS_WIN32
-  tm timebuf = *localtime(&rawtime);
+  localtime_r(&rawtime, &timebuf);
 #endif // ifdef Q_OS_WIN32
+  return timebuf;
+}
+
+static std::string localTime(const char *format) {
+  tm timebuf = localTime(time(nullptr));
   const int   BUFF_LEN = 32;
   std::string res(BUFF_LEN, '-');
   auto len = strftime(&res[0], BUFF_LEN, format, &timebuf);
@@ -37,7 +48,12 @@ static std::string localTime(const char *format) {
   return res;
 }
 
-LoggerImplQt::LoggerImplQt() {
+LoggerImplQt::LoggerImplQt()
+  : m_records(capacity)
+  , m_lastSecond(0)
+{
+  m_timeText[0] = '\0';
+
   std::stringstream filename;
 
   filename << "rms_log_" << localTime("%H%M%S-%d%m") << ".log";
@@ -45,19 +61,74 @@ LoggerImplQt::LoggerImplQt() {
   this->stream_.open(filename.str(), std::ofstream::out | std::ofstream::trunc);
 
   if (this->stream_.fail()) {
-    Logger::Hidden("Can't open file: %s", filename.str().c_str());
+    // not through the logger, this runs while its instance is created
+    std::fprintf(stderr, "Can't open file: %s\n", filename.str().c_str());
   }
+
+  std::thread([this]() {
+      Run();
+    }).detach();
+
+  std::atexit([]() {
+      Logger::Flush();
+    });
 }
 
 LoggerImplQt::~LoggerImplQt() {
   this->stream_.close();
 }
 
-void LoggerImplQt::append(const std::string& prefix, const std::string& record) {
-  std::stringstream ss;
+void LoggerImplQt::append(const char *prefix,
+                          const char *record,
+                          size_t      length) {
+  // the writer is only slower than the callers in bursts, wait for it
+  // rather than dropping records
+  while (!m_records.TryPush(prefix, record, length)) {
+    std::this_thread::yield();
+  }
+}
+
+void LoggerImplQt::flush() {
+  while (Drain()) {}
+}
 
-  ss << localTime("%H:%M:%S ") << prefix.c_str() << ": " << record;
-  this->stream_ << ss.str() << std::endl;
+void LoggerImplQt::Run() {
+  for (;;) {
+    if (!Drain()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+}
+
+bool LoggerImplQt::Drain() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LogRingBuffer::Record record;
+  bool written = false;
+
+  while (m_records.TryPop(record)) {
+    this->stream_ << TimeText(record.time) << record.prefix << ": ";
+    this->stream_.write(record.Text(), record.length);
+    this->stream_ << '\n';
+    written = true;
+  }
+
+  if (written) {
+    this->stream_.flush();
+  }
+  return written;
+}
+
+const char * LoggerImplQt::TimeText(std::chrono::system_clock::time_point time)
+{
+  auto second = std::chrono::system_clock::to_time_t(time);
+
+  // most records of a batch share their second
+  if (second != m_lastSecond) {
+    tm timebuf = localTime(second);
+    strftime(m_timeText, sizeof(m_timeText), "%H:%M:%S ", &timebuf);
+    m_lastSecond = second;
+  }
+  return m_timeText;
 }
 } // namespace logger
 } // namespace platform
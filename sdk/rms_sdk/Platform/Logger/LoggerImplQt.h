@@ -10,11 +10,18 @@
 #define _RMS_LIB_LOGGERQTIMPL_H_
 
 #include "Logger.h"
+#include "LogRingBuffer.h"
+#include <ctime>
 #include <fstream>
+#include <mutex>
 
 namespace rmscore {
 namespace platform {
 namespace logger {
+// Queues the records in a ring buffer; a background thread writes them to
+// the file and flushes it once per batch. The logger is never destroyed, as
+// it may be used until the very end of the process, the records still queued
+// at exit are written by an atexit handler.
 class LoggerImplQt : public Logger {
 public:
 
@@ -22,14 +29,31 @@ public:
 
 protected:
 
-  virtual void append(const std::string& prefix,
-                      const std::string& record) override;
+  virtual void append(const char *prefix,
+                      const char *record,
+                      size_t      length) override;
+  virtual void flush() override;
 
 private:
 
   LoggerImplQt();
   friend class Logger;
+
+  void        Run();
+
+  // writes the queued records, false if there were none
+  bool        Drain();
+  const char* TimeText(std::chrono::system_clock::time_point time);
+
+  static const size_t capacity = 8192;
+
+  LogRingBuffer m_records;
+
+  // guards the file, i.e. the consumers of m_records
+  std::mutex    m_mutex;
   std::ofstream stream_;
+  std::time_t   m_lastSecond;
+  char          m_timeText[16];
 };
 } // namespace logger
 } // namespace platform
@@ -0,0 +1,225 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace rmscore {
+namespace platform {
+namespace logger {
+namespace {
+// the file is written through a large stdio buffer, a record costs a copy
+// and rarely a system call
+const size_t fileBufferLength = 256 * 1024;
+
+mutex& FileMutex() {
+  // NOTE: leaked deliberately, records may be written until the process ends.
+  static mutex *fileMutex = new mutex();
+
+  return *fileMutex;
+}
+
+FILE *s_file = nullptr;
+
+// each thread builds its records in its own buffer, which keeps its capacity
+vector<uint8_t>& RecordBuffer() {
+  static thread_local vector<uint8_t> buffer;
+
+  return buffer;
+}
+
+uint32_t CurrentThread() {
+  static thread_local uint32_t thread = static_cast<uint32_t>(
+    hash<std::thread::id>()(this_thread::get_id()));
+
+  return thread;
+}
+
+// starts the trace named by the environment when the library is loaded
+struct TraceFromEnvironment {
+  TraceFromEnvironment() {
+    const char *path = getenv("RMS_TRACE_FILE");
+
+    if ((path == nullptr) || (*path == '\0')) return;
+
+    const char *maxBytes = getenv("RMS_TRACE_MAX_BYTES");
+    const char *secrets  = getenv("RMS_TRACE_SECRETS");
+    Trace::Open(path, maxBytes != nullptr ?
+                static_cast<uint32_t>(strtoul(maxBytes, nullptr, 10)) : 4096,
+                (secrets != nullptr) && (strcmp(secrets, "1") == 0));
+  }
+} traceFromEnvironment;
+} // namespace
+
+atomic<bool>     Trace::s_enabled(false);
+atomic<uint32_t> Trace::s_maxBytes(4096);
+atomic<bool>     Trace::s_withSecrets(false);
+
+bool Trace::Open(const string& path, uint32_t maxBytes, bool withSecrets) {
+  lock_guard<mutex> lock(FileMutex());
+
+  if (s_file != nullptr) {
+    s_enabled = false;
+    fclose(s_file);
+    s_file = nullptr;
+  }
+
+  FILE *file = fopen(path.c_str(), "wb");
+
+  if (file == nullptr) return false;
+
+  setvbuf(file, nullptr, _IOFBF, fileBufferLength);
+
+  uint8_t version[4];
+
+  for (size_t i = 0; i < sizeof(version); ++i) {
+    version[i] = static_cast<uint8_t>(TRACE_VERSION >> (8 * i));
+  }
+  fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file);
+  fwrite(version,     1, sizeof(version),     file);
+
+  static bool atExitRegistered = false;
+
+  if (!atExitRegistered) {
+    atexit([]() {
+        Trace::Flush();
+      });
+    atExitRegistered = true;
+  }
+
+  s_file     = file;
+  s_maxBytes    = maxBytes;
+  s_withSecrets = withSecrets;
+  s_enabled     = true;
+  return true;
+}
+
+void Trace::Close() {
+  lock_guard<mutex> lock(FileMutex());
+
+  s_enabled = false;
+
+  if (s_file != nullptr) {
+    fclose(s_file);
+    s_file = nullptr;
+  }
+}
+
+void Trace::Flush() {
+  lock_guard<mutex> lock(FileMutex());
+
+  if (s_file != nullptr) fflush(s_file);
+}
+
+void Trace::Write(const uint8_t *data, size_t length) {
+  lock_guard<mutex> lock(FileMutex());
+
+  // the trace may have been closed since the record was started
+  if (s_file != nullptr) fwrite(data, 1, length, s_file);
+}
+
+Trace::Event::Event(TraceEvent event)
+  : m_active(Trace::IsEnabled())
+  , m_start(0)
+  , m_count(0)
+{
+  if (!m_active) return;
+
+  auto microseconds = chrono::duration_cast<chrono::microseconds>(
+    chrono::system_clock::now().time_since_epoch()).count();
+
+  // records may nest, e.g. when a field's value is computed by a function
+  // that traces, so each one remembers where it starts
+  m_start = RecordBuffer().size();
+  AppendInt(0,     4); // size, set when written
+  AppendInt(event, 2);
+  AppendInt(0,     2); // number of fields, set when written
+  AppendInt(static_cast<uint64_t>(microseconds), 8);
+  AppendInt(CurrentThread(), 4);
+}
+
+Trace::Event::~Event() {
+  if (!m_active) return;
+
+  auto& buffer = RecordBuffer();
+  auto  size   = static_cast<uint32_t>(buffer.size() - m_start - 4);
+
+  for (size_t i = 0; i < 4; ++i) {
+    buffer[m_start + i] = static_cast<uint8_t>(size >> (8 * i));
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    buffer[m_start + 6 + i] = static_cast<uint8_t>(m_count >> (8 * i));
+  }
+
+  Trace::Write(buffer.data() + m_start, buffer.size() - m_start);
+  buffer.resize(m_start);
+}
+
+Trace::Event& Trace::Event::Int(int64_t value) {
+  if (!m_active) return *this;
+
+  RecordBuffer().push_back(TRACE_FIELD_INT);
+  AppendInt(static_cast<uint64_t>(value), 8);
+  ++m_count;
+  return *this;
+}
+
+Trace::Event& Trace::Event::String(const string& value) {
+  AppendBytes(TRACE_FIELD_STRING, value.data(), value.size(), s_maxBytes.load());
+  return *this;
+}
+
+Trace::Event& Trace::Event::Bytes(const void *data, size_t length) {
+  AppendBytes(TRACE_FIELD_BYTES, data, length, s_maxBytes.load());
+  return *this;
+}
+
+Trace::Event& Trace::Event::Secret(const void *data, size_t length) {
+  AppendBytes(TRACE_FIELD_BYTES, data, length,
+              Trace::HasSecrets() ? s_maxBytes.load() : 0);
+  return *this;
+}
+
+void Trace::Event::AppendBytes(TraceFieldType type,
+                               const void    *data,
+                               size_t         length,
+                               size_t         maxStored) {
+  if (!m_active) return;
+
+  auto  stored = static_cast<uint32_t>(min(length, maxStored));
+  auto  bytes  = static_cast<const uint8_t *>(data);
+  auto& buffer = RecordBuffer();
+
+  buffer.push_back(type);
+  AppendInt(stored, 4);
+  AppendInt(length, 4);
+  buffer.insert(buffer.end(), bytes, bytes + stored);
+  ++m_count;
+}
+
+void Trace::Event::AppendInt(uint64_t value, size_t size) {
+  auto& buffer = RecordBuffer();
+
+  for (size_t i = 0; i < size; ++i) {
+    buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+} // namespace logger
+} // namespace platform
+} // namespace rmscore
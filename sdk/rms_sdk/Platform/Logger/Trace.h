@@ -0,0 +1,95 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_TRACE_H_
+#define _RMS_LIB_TRACE_H_
+
+#include <atomic>
+#include <string>
+#include "TraceFormat.h"
+
+namespace rmscore {
+namespace platform {
+namespace logger {
+// Binary trace of the requests and licenses, see TraceFormat.h, meant to be
+// left on under load. It is started by setting the RMS_TRACE_FILE environment
+// variable to the path of the trace, or by Open. Strings and bytes are
+// copied once, from the caller's buffers into the record, and at most
+// RMS_TRACE_MAX_BYTES (4096 by default) of each.
+//
+// The HTTP bodies and the licenses hold the content keys and the users'
+// rights, so they are only recorded in a trace opened with secrets, or with
+// RMS_TRACE_SECRETS=1 set too; such a trace is as sensitive as the content
+// it was taken with and must not be shared. Other traces keep their lengths.
+//
+//   if (Trace::IsEnabled()) {
+//     Trace::Event(TRACE_HTTP_REQUEST).String(method).String(url).Int(size);
+//   }
+class Trace {
+public:
+
+  static bool IsEnabled() {
+    return s_enabled.load(std::memory_order_relaxed);
+  }
+
+  // replaces the current trace, if any; false if the file can't be created
+  static bool Open(const std::string& path,
+                   uint32_t           maxBytes    = 4096,
+                   bool               withSecrets = false);
+  static void Close();
+  static void Flush();
+
+  // whether Secret fields are recorded
+  static bool HasSecrets() {
+    return s_withSecrets.load(std::memory_order_relaxed);
+  }
+
+  // a record, written when it goes out of scope
+  class Event {
+  public:
+
+    explicit Event(TraceEvent event);
+    ~Event();
+
+    Event& Int(int64_t value);
+    Event& String(const std::string& value);
+    Event& Bytes(const void *data, size_t length);
+
+    // bytes which may hold key material: only their length unless the
+    // trace has secrets
+    Event& Secret(const void *data, size_t length);
+
+  private:
+
+    // undefined copy constructor and assignment operator
+    Event(const Event&);
+    Event& operator=(const Event&);
+
+    void AppendInt(uint64_t value, size_t size);
+    void AppendBytes(TraceFieldType type,
+                     const void    *data,
+                     size_t         length,
+                     size_t         maxStored);
+
+    bool     m_active;
+    size_t   m_start;
+    uint16_t m_count;
+  };
+
+private:
+
+  static void Write(const uint8_t *data, size_t length);
+
+  static std::atomic<bool>     s_enabled;
+  static std::atomic<uint32_t> s_maxBytes;
+  static std::atomic<bool>     s_withSecrets;
+};
+} // namespace logger
+} // namespace platform
+} // namespace rmscore
+#endif // _RMS_LIB_TRACE_H_
@@ -0,0 +1,208 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#ifndef _RMS_LIB_TRACEFORMAT_H_
+#define _RMS_LIB_TRACEFORMAT_H_
+
+#include <stdint.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// The binary trace format, shared by the SDK and the trace decoder; it
+// depends on the standard library only.
+//
+// A trace file starts with the 8 bytes "RMSTRACE" and a uint32 version,
+// followed by records:
+//
+//   uint32 size of the rest of the record
+//   uint16 event, see TraceEvent
+//   uint16 number of fields
+//   uint64 microseconds since the epoch
+//   uint32 thread
+//   fields, each one a uint8 TraceFieldType followed by
+//     TRACE_FIELD_INT:            int64
+//     TRACE_FIELD_STRING / BYTES: uint32 stored length, uint32 original
+//                                 length, stored bytes
+//
+// All the integers are little endian. Strings and bytes longer than the
+// trace's cap are truncated, the original length tells by how much.
+namespace rmscore {
+namespace platform {
+namespace logger {
+const char     TRACE_MAGIC[8] = { 'R', 'M', 'S', 'T', 'R', 'A', 'C', 'E' };
+const uint32_t TRACE_VERSION  = 1;
+
+// fixed ids, never reuse or renumber them, old traces must stay readable
+enum TraceEvent : uint16_t {
+  TRACE_HTTP_REQUEST         = 1, // method, url, body length
+  TRACE_HTTP_REQUEST_HEADER  = 2, // name, value
+  TRACE_HTTP_REQUEST_BODY    = 3, // body, in traces with secrets only
+  TRACE_HTTP_RESPONSE        = 4, // status, error, body length
+  TRACE_HTTP_RESPONSE_HEADER = 5, // name, value
+  TRACE_HTTP_RESPONSE_BODY   = 6, // body, in traces with secrets only
+  TRACE_LICENSE_PUBLISHED    = 7, // id, name, referrer, owner, cipher mode,
+                                  // content id, license (its length only
+                                  // in traces without secrets)
+  TRACE_LICENSE_ACQUIRED     = 8  // access status, id, name, referrer, owner,
+                                  // cipher mode, content id, from template,
+                                  // allow offline access, license valid until
+};
+
+enum TraceFieldType : uint8_t {
+  TRACE_FIELD_INT    = 1,
+  TRACE_FIELD_STRING = 2,
+  TRACE_FIELD_BYTES  = 3
+};
+
+struct TraceEventInfo {
+  uint16_t    event;
+  const char *name;
+  const char *fields[10];
+};
+
+// names used by the decoder
+inline const TraceEventInfo* GetTraceEventInfo(uint16_t event) {
+  static const TraceEventInfo infos[] = {
+    { TRACE_HTTP_REQUEST,         "http.request",
+      { "method", "url", "bodyLength" } },
+    { TRACE_HTTP_REQUEST_HEADER,  "http.request.header",
+      { "name", "value" } },
+    { TRACE_HTTP_REQUEST_BODY,    "http.request.body",
+      { "body" } },
+    { TRACE_HTTP_RESPONSE,        "http.response",
+      { "status", "error", "bodyLength" } },
+    { TRACE_HTTP_RESPONSE_HEADER, "http.response.header",
+      { "name", "value" } },
+    { TRACE_HTTP_RESPONSE_BODY,   "http.response.body",
+      { "body" } },
+    { TRACE_LICENSE_PUBLISHED,    "license.published",
+      { "id", "name", "referrer", "owner", "cipherMode", "contentId",
+        "license" } },
+    { TRACE_LICENSE_ACQUIRED,     "license.acquired",
+      { "accessStatus", "id", "name", "referrer", "owner", "cipherMode",
+        "contentId", "fromTemplate", "allowOfflineAccess",
+        "licenseValidUntil" } }
+  };
+
+  for (auto& info : infos) {
+    if (info.event == event) return &info;
+  }
+  return nullptr;
+}
+
+struct TraceField {
+  TraceFieldType type;
+  int64_t        intValue;
+  std::string    bytes;          // STRING and BYTES
+  uint32_t       originalLength; // STRING and BYTES, before truncation
+};
+
+struct TraceRecord {
+  uint16_t event;
+  uint64_t microseconds;
+  uint32_t thread;
+  std::vector<TraceField> fields;
+};
+
+// Reads the records of a trace held in memory.
+class TraceReader {
+public:
+
+  TraceReader(const uint8_t *data, size_t length)
+    : m_data(data)
+    , m_length(length)
+    , m_position(0)
+    , m_valid(false)
+  {
+    if ((length >= sizeof(TRACE_MAGIC) + 4) &&
+        (std::memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0)) {
+      m_position = sizeof(TRACE_MAGIC);
+      m_version  = static_cast<uint32_t>(ReadInt(4));
+      m_valid    = m_version == TRACE_VERSION;
+    }
+  }
+
+  // false if the header is missing or of an unknown version
+  bool IsValid() const {
+    return m_valid;
+  }
+
+  // false at the end of the trace or on a truncated record, e.g. when the
+  // process died while writing it
+  bool Next(TraceRecord& record) {
+    if (!m_valid || !Available(4)) return false;
+
+    size_t size = static_cast<size_t>(ReadInt(4));
+
+    if (!Available(size) || (size < 16)) return false;
+
+    size_t end = m_position + size;
+
+    record.event        = static_cast<uint16_t>(ReadInt(2));
+    uint16_t count      = static_cast<uint16_t>(ReadInt(2));
+    record.microseconds = ReadInt(8);
+    record.thread       = static_cast<uint32_t>(ReadInt(4));
+    record.fields.clear();
+
+    for (uint16_t i = 0; i < count; ++i) {
+      if (m_position >= end) return false;
+
+      TraceField field;
+      field.type           = static_cast<TraceFieldType>(m_data[m_position++]);
+      field.intValue       = 0;
+      field.originalLength = 0;
+
+      if (field.type == TRACE_FIELD_INT) {
+        if (m_position + 8 > end) return false;
+        field.intValue = static_cast<int64_t>(ReadInt(8));
+      } else {
+        if (m_position + 8 > end) return false;
+
+        uint32_t stored = static_cast<uint32_t>(ReadInt(4));
+        field.originalLength = static_cast<uint32_t>(ReadInt(4));
+
+        if (m_position + stored > end) return false;
+        field.bytes.assign(reinterpret_cast<const char *>(m_data + m_position),
+                           stored);
+        m_position += stored;
+      }
+      record.fields.push_back(field);
+    }
+
+    // skips fields added by later versions of the same event
+    m_position = end;
+    return true;
+  }
+
+private:
+
+  bool Available(size_t count) const {
+    return m_length - m_position >= count;
+  }
+
+  uint64_t ReadInt(size_t size) {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+      value |= static_cast<uint64_t>(m_data[m_position + i]) << (8 * i);
+    }
+    m_position += size;
+    return value;
+  }
+
+  const uint8_t *m_data;
+  size_t   m_length;
+  size_t   m_position;
+  uint32_t m_version;
+  bool     m_valid;
+};
+} // namespace logger
+} // namespace platform
+} // namespace rmscore
+#endif // _RMS_LIB_TRACEFORMAT_H_
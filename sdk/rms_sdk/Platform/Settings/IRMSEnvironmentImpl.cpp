@@ -17,6 +17,12 @@ shared_ptr<IRMSEnvironmentImpl> _instance = make_shared<IRMSEnvironmentImpl>();
 
 IRMSEnvironmentImpl::IRMSEnvironmentImpl()
   : _optLog(static_cast<int>(LoggerOption::Always))
+  , _maxConnectionsPerHost(6)
+  , _optHttpClient(static_cast<int>(HttpClientOption::Qt))
+  , _hedgingBudget(0)
+  , _templatesCacheTtl(3600)
+  , _templatesCacheOnDisk(0)
+  , _challengeCacheTtl(1800)
 {}
 
 void IRMSEnvironmentImpl::LogOption(LoggerOption opt) {
@@ -42,6 +48,54 @@ modernapi::IRMSEnvironment::LoggerOption IRMSEnvironmentImpl::LogOption() {
   return static_cast<LoggerOption>(_optLog.load());
 }
 
+void IRMSEnvironmentImpl::MaxConnectionsPerHost(int maxConnections) {
+  _maxConnectionsPerHost = maxConnections;
+}
+
+int IRMSEnvironmentImpl::MaxConnectionsPerHost() {
+  return _maxConnectionsPerHost.load();
+}
+
+void IRMSEnvironmentImpl::HttpClient(HttpClientOption opt) {
+  _optHttpClient = static_cast<int>(opt);
+}
+
+modernapi::IRMSEnvironment::HttpClientOption IRMSEnvironmentImpl::HttpClient() {
+  return static_cast<HttpClientOption>(_optHttpClient.load());
+}
+
+void IRMSEnvironmentImpl::HedgingBudget(int msecs) {
+  _hedgingBudget = msecs;
+}
+
+int IRMSEnvironmentImpl::HedgingBudget() {
+  return _hedgingBudget.load();
+}
+
+void IRMSEnvironmentImpl::TemplatesCacheTtl(int secs) {
+  _templatesCacheTtl = secs;
+}
+
+int IRMSEnvironmentImpl::TemplatesCacheTtl() {
+  return _templatesCacheTtl.load();
+}
+
+void IRMSEnvironmentImpl::TemplatesCacheOnDisk(bool onDisk) {
+  _templatesCacheOnDisk = onDisk ? 1 : 0;
+}
+
+bool IRMSEnvironmentImpl::TemplatesCacheOnDisk() {
+  return _templatesCacheOnDisk.load() != 0;
+}
+
+void IRMSEnvironmentImpl::ChallengeCacheTtl(int secs) {
+  _challengeCacheTtl = secs;
+}
+
+int IRMSEnvironmentImpl::ChallengeCacheTtl() {
+  return _challengeCacheTtl.load();
+}
+
 shared_ptr<modernapi::IRMSEnvironment>IRMSEnvironmentImpl::Environment() {
   return std::dynamic_pointer_cast<modernapi::IRMSEnvironment>(
     platform::settings::_instance);
@@ -26,11 +26,43 @@ public:
   virtual void                                      LogOption(LoggerOption opt);
   virtual LoggerOption                              LogOption();
 
+  // LogOption() != Never without the virtual call, for the logger
+  bool IsLogEnabled() const {
+    return _optLog.load() != static_cast<int>(LoggerOption::Never);
+  }
+
+  virtual void                                      MaxConnectionsPerHost(
+    int maxConnections);
+  virtual int                                       MaxConnectionsPerHost();
+
+  virtual void                                      HttpClient(
+    HttpClientOption opt);
+  virtual HttpClientOption                          HttpClient();
+
+  virtual void                                      HedgingBudget(int msecs);
+  virtual int                                       HedgingBudget();
+
+  virtual void                                      TemplatesCacheTtl(int secs);
+  virtual int                                       TemplatesCacheTtl();
+
+  virtual void                                      TemplatesCacheOnDisk(
+    bool onDisk);
+  virtual bool                                      TemplatesCacheOnDisk();
+
+  virtual void                                      ChallengeCacheTtl(int secs);
+  virtual int                                       ChallengeCacheTtl();
+
   static std::shared_ptr<modernapi::IRMSEnvironment>Environment();
 
 private:
 
   QAtomicInt _optLog;
+  QAtomicInt _maxConnectionsPerHost;
+  QAtomicInt _optHttpClient;
+  QAtomicInt _hedgingBudget;
+  QAtomicInt _templatesCacheTtl;
+  QAtomicInt _templatesCacheOnDisk;
+  QAtomicInt _challengeCacheTtl;
 };
 
 extern std::shared_ptr<IRMSEnvironmentImpl> _instance;
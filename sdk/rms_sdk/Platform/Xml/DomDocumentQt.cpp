@@ -11,6 +11,7 @@
 #include "DomNodeQt.h"
 #include "DomAttributeQt.h"
 #include "DomElementQt.h"
+#include "XPathQueryQt.h"
 #include <QDomNodeList>
 #include <QXmlQuery>
 #include <QBuffer>
@@ -18,6 +19,132 @@
 
 using namespace rmscore::platform::logger;
 
+namespace {
+// the next step of a query to match against the children of a node
+struct PendingStep
+{
+    size_t query;
+    size_t step;
+};
+
+bool Matches(const QDomElement& element, const XmlPathStep& step)
+{
+    // unprefixed names only match the default namespace
+    return element.prefix().isEmpty() && (element.tagName() == step.name) &&
+           (step.attributeName.isEmpty() ||
+            (element.attribute(step.attributeName) == step.attributeValue));
+}
+
+// Walks the children of parent once for all the pending steps, descending
+// only into the children that match one of them, and appends the nodes
+// selected by each query to matches.
+void SelectChildren(const QDomNode                     & parent,
+                    const std::vector<PendingStep>     & pending,
+                    const std::vector<const XmlPath *> & paths,
+                    std::vector<QList<QDomNode> >      & matches)
+{
+    std::vector<int> counts(pending.size(), 0);
+    std::vector<int> seen(pending.size(), 0);
+
+    // [last()] needs the number of matching siblings up front
+    for (size_t i = 0; i < pending.size(); ++i)
+    {
+        auto& step = paths[pending[i].query]->steps[pending[i].step];
+
+        if (step.position != XmlPathStep::LAST) continue;
+
+        for (auto child = parent.firstChildElement(); !child.isNull();
+             child = child.nextSiblingElement())
+        {
+            if (Matches(child, step)) ++counts[i];
+        }
+    }
+
+    for (auto child = parent.firstChildElement(); !child.isNull();
+         child = child.nextSiblingElement())
+    {
+        std::vector<PendingStep> next;
+
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            auto& path = *paths[pending[i].query];
+            auto& step = path.steps[pending[i].step];
+
+            if (!Matches(child, step)) continue;
+
+            ++seen[i];
+
+            if (((step.position > 0) && (seen[i] != step.position)) ||
+                ((step.position == XmlPathStep::LAST) && (seen[i] != counts[i])))
+            {
+                continue;
+            }
+
+            if (pending[i].step + 1 < path.steps.size())
+            {
+                next.push_back({ pending[i].query, pending[i].step + 1 });
+            }
+            else if (path.text)
+            {
+                for (auto node = child.firstChild(); !node.isNull();
+                     node = node.nextSibling())
+                {
+                    if (node.isText() || node.isCDATASection())
+                    {
+                        matches[pending[i].query].append(node);
+                    }
+                }
+            }
+            else
+            {
+                matches[pending[i].query].append(child);
+            }
+        }
+
+        if (!next.empty()) SelectChildren(child, next, paths, matches);
+    }
+}
+
+// the shape of SelectSingleNode's results: a <result> element holding copies
+// of the selected nodes
+sp<IDomElement> ToResult(const QList<QDomNode>& nodes)
+{
+    if (nodes.isEmpty()) return nullptr;
+
+    QDomDocument resDoc;
+    auto root = resDoc.createElement("result");
+    resDoc.appendChild(root);
+
+    for (auto& node : nodes)
+    {
+        root.appendChild(resDoc.importNode(node, true));
+    }
+    return std::make_shared<DomElementQt>(root);
+}
+
+std::vector<sp<IDomElement> > Select(const QDomDocument                & document,
+                                     const std::vector<const XmlPath *> & paths)
+{
+    std::vector<PendingStep> pending;
+
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        pending.push_back({ i, 0 });
+    }
+
+    std::vector<QList<QDomNode> > matches(paths.size());
+    SelectChildren(document, pending, paths, matches);
+
+    std::vector<sp<IDomElement> > results;
+
+    for (auto& nodes : matches)
+    {
+        results.push_back(ToResult(nodes));
+    }
+    return results;
+}
+} // namespace
+
 sp<IDomDocument> IDomDocument::create()
 {
     return sp<IDomDocument>(new DomDocumentQt());
@@ -101,6 +228,22 @@ sp<IDomElement> DomDocumentQt::SelectSingleNode(const std::string &xPath)
     return std::make_shared<DomElementQt>(resDoc.documentElement());
 }
 
+sp<IDomElement> DomDocumentQt::SelectSingleNode(const IXPathQuery &query) const
+{
+    return Select(this->impl_, { &static_cast<const XPathQueryQt&>(query).path() })[0];
+}
+
+std::vector<sp<IDomElement> > DomDocumentQt::SelectNodes(const std::vector<sp<IXPathQuery> > &queries) const
+{
+    std::vector<const XmlPath *> paths;
+
+    for (auto& query : queries)
+    {
+        paths.push_back(&static_cast<const XPathQueryQt&>(*query).path());
+    }
+    return Select(this->impl_, paths);
+}
+
 // from IDomNode
 
 sp<DomNamedNodeMap>	DomDocumentQt::attributes() const
@@ -24,6 +24,8 @@ private:
     bool setContent(const std::string & text, std::string & errorMsg, int & errorLine, int & errorColumn) override;
 
     sp<IDomElement> SelectSingleNode(const std::string &xPath) override;
+    sp<IDomElement> SelectSingleNode(const IXPathQuery &query) const override;
+    std::vector<sp<IDomElement> > SelectNodes(const std::vector<sp<IXPathQuery> > &queries) const override;
 
 // form IDomNode
     sp<DomNamedNodeMap>	attributes() const override;
@@ -10,9 +10,11 @@
 #define IDOMDOCUMENT_H
 
 #include <string>
+#include <vector>
 #include "IDomNode.h"
 
 class IDomElement;
+class IXPathQuery;
 
 class IDomDocument : public IDomNode
 {
@@ -25,6 +27,12 @@ public:
     virtual bool setContent(const std::string & text, std::string & errorMsg, int & errorLine, int & errorColumn) = 0;
 
     virtual sp<IDomElement> SelectSingleNode(const std::string &xPath) = 0;
+
+    // the same as above, with a compiled query evaluated on the parsed tree
+    virtual sp<IDomElement> SelectSingleNode(const IXPathQuery &query) const = 0;
+    // results[i] is the result of queries[i]; all the queries are evaluated
+    // in one traversal of the document
+    virtual std::vector<sp<IDomElement> > SelectNodes(const std::vector<sp<IXPathQuery> > &queries) const = 0;
 public:
     static sp<IDomDocument> create();
 };
@@ -0,0 +1,37 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef IXPATHQUERY_H
+#define IXPATHQUERY_H
+
+#include <string>
+#include "IDomNode.h"
+
+// An XPath query compiled once, for IDomDocument::SelectSingleNode and
+// SelectNodes to evaluate directly on the parsed tree, unlike the string
+// overload of SelectSingleNode that serializes the document and compiles the
+// query on every call. A query holds no state and can be shared by threads.
+//
+// Location paths relative to the document or absolute are supported, whose
+// steps are element names with at most one predicate each, [@attribute='value'],
+// [n] or [last()], optionally ending in text(); e.g.
+// "kml/Document/Placemark[last()]/name/text()". As with the string overload,
+// unprefixed names match the elements of the default namespace.
+class IXPathQuery
+{
+public:
+    virtual ~IXPathQuery() {}
+
+    virtual const std::string& xPath() const = 0;
+
+public:
+    // throws RMSInvalidArgumentException on a query it doesn't support
+    static sp<IXPathQuery> create(const std::string& xPath);
+};
+
+#endif // IXPATHQUERY_H
@@ -0,0 +1,43 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef IXMLPATHEXTRACTOR_H
+#define IXMLPATHEXTRACTOR_H
+
+#include <string>
+#include <vector>
+#include "IDomNode.h"
+
+// Pulls the text of several elements out of an XML buffer in one streaming
+// pass, without building a DOM. The paths are compiled once, when the
+// extractor is created, and the extractor can then be shared by threads.
+//
+// Only absolute location paths are supported, whose steps are element names
+// with at most one [@attribute='value'] predicate each, optionally ending in
+// /text(); e.g. "/Root/BODY[@type='License']/ADDRESS[@type='URL']/text()".
+class IXmlPathExtractor
+{
+public:
+    virtual ~IXmlPathExtractor() {}
+
+    // values[i] is the text of the first element matching paths[i], or empty
+    // if none does. The scan stops once every path has matched. If wrapperRoot
+    // is not empty the buffer is read as the content of an element of that
+    // name, so it may hold several top-level elements and an XML declaration.
+    // Returns false if the XML is not well formed before that point.
+    virtual bool Extract(const char               *xml,
+                         size_t                    size,
+                         std::vector<std::string>& values,
+                         const std::string       & wrapperRoot = std::string()) const = 0;
+
+public:
+    // throws RMSInvalidArgumentException on a path it doesn't support
+    static sp<IXmlPathExtractor> create(const std::vector<std::string>& paths);
+};
+
+#endif // IXMLPATHEXTRACTOR_H
@@ -0,0 +1,16 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifdef QTFRAMEWORK
+#include "XPathQueryQt.h"
+
+sp<IXPathQuery> IXPathQuery::create(const std::string& xPath)
+{
+    return std::make_shared<XPathQueryQt>(xPath);
+}
+#endif // QTFRAMEWORK
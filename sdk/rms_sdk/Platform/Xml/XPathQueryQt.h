@@ -0,0 +1,30 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef XPATHQUERYQT_H
+#define XPATHQUERYQT_H
+
+#include "IXPathQuery.h"
+#include "XmlPath.h"
+
+class XPathQueryQt : public IXPathQuery
+{
+public:
+    XPathQueryQt(const std::string& xPath)
+        : xPath_(xPath)
+        , path_(XmlPath::Compile(xPath)) {}
+
+    const std::string& xPath() const override { return xPath_; }
+    const XmlPath& path() const { return path_; }
+
+private:
+    std::string xPath_;
+    XmlPath     path_;
+};
+
+#endif // XPATHQUERYQT_H
@@ -18,7 +18,10 @@ SOURCES += \
     DomAttributeQt.cpp \
     DomDocumentQt.cpp \
     DomElementQt.cpp \
-    DomNodeQt.cpp
+    DomNodeQt.cpp \
+    XmlPath.cpp \
+    XmlPathExtractorQt.cpp \
+    XPathQueryQt.cpp
 
 HEADERS += \
     IDomDocument.h \
@@ -30,4 +33,9 @@ HEADERS += \
     DomAttributeQt.h \
     DomDocumentQt.h \
     DomElementQt.h \
-    DomNodeQt.h
+    DomNodeQt.h \
+    IXmlPathExtractor.h \
+    XmlPath.h \
+    XmlPathExtractorQt.h \
+    IXPathQuery.h \
+    XPathQueryQt.h
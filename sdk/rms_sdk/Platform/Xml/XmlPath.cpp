@@ -0,0 +1,104 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifdef QTFRAMEWORK
+#include "XmlPath.h"
+#include <cstdlib>
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+
+namespace {
+// parses "[...]" into the step, false if it isn't a supported predicate
+bool ParsePredicate(const string& predicate, XmlPathStep& step)
+{
+    string body = predicate.substr(1, predicate.size() - 2);
+
+    if (body == "last()")
+    {
+        step.position = XmlPathStep::LAST;
+        return true;
+    }
+
+    if (!body.empty() && (body.find_first_not_of("0123456789") == string::npos))
+    {
+        step.position = atoi(body.c_str());
+        return step.position > 0;
+    }
+
+    // @name='value' or @name="value"
+    auto equals = body.find('=');
+
+    if ((body.size() < 4) || (body[0] != '@') || (equals == string::npos) ||
+        (equals < 2) || (body.size() < equals + 3) ||
+        ((body[equals + 1] != '\'') && (body[equals + 1] != '"')) ||
+        (body[body.size() - 1] != body[equals + 1]))
+    {
+        return false;
+    }
+    step.attributeName  = QString::fromStdString(body.substr(1, equals - 1));
+    step.attributeValue = QString::fromStdString(
+        body.substr(equals + 2, body.size() - equals - 3));
+    return true;
+}
+} // namespace
+
+XmlPath XmlPath::Compile(const string& path)
+{
+    XmlPath compiled;
+
+    compiled.absolute = !path.empty() && (path[0] == '/');
+    compiled.text     = false;
+
+    size_t position = compiled.absolute ? 1 : 0;
+    bool   valid    = !path.empty();
+
+    while (valid && (position <= path.size()))
+    {
+        auto   end  = path.find('/', position);
+        string text = path.substr(position, end == string::npos ?
+                                            string::npos : end - position);
+        position = end == string::npos ? path.size() + 1 : end + 1;
+
+        if (text == "text()")
+        {
+            // only as the last step
+            valid         = (position > path.size()) && !compiled.steps.empty();
+            compiled.text = true;
+            break;
+        }
+
+        XmlPathStep step;
+        step.position = 0;
+
+        auto bracket = text.find('[');
+
+        if (bracket == string::npos)
+        {
+            step.name = QString::fromStdString(text);
+        }
+        else
+        {
+            step.name = QString::fromStdString(text.substr(0, bracket));
+            valid     = (text[text.size() - 1] == ']') &&
+                        ParsePredicate(text.substr(bracket), step);
+        }
+
+        valid = valid && !step.name.isEmpty();
+        compiled.steps.push_back(step);
+    }
+
+    if (!valid)
+    {
+        throw exceptions::RMSInvalidArgumentException(
+            "XmlPath: unsupported path: " + path);
+    }
+    return compiled;
+}
+#endif // QTFRAMEWORK
@@ -0,0 +1,39 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef XMLPATH_H
+#define XMLPATH_H
+
+#include <string>
+#include <vector>
+#include <QString>
+
+// The subset of XPath understood by IXmlPathExtractor and IXPathQuery: a
+// location path whose steps are element names with at most one predicate
+// each, [@attribute='value'], [n] or [last()], optionally ending in text().
+struct XmlPathStep
+{
+    QString name;
+    QString attributeName;  // empty if the step has no attribute predicate
+    QString attributeValue;
+    int     position;       // [n], 1 based; LAST for [last()]; 0 if none
+
+    static const int LAST = -1;
+};
+
+struct XmlPath
+{
+    std::vector<XmlPathStep> steps;
+    bool absolute;          // starts with a '/'
+    bool text;              // ends in text()
+
+    // throws RMSInvalidArgumentException on a path out of the subset
+    static XmlPath Compile(const std::string& path);
+};
+
+#endif // XMLPATH_H
@@ -0,0 +1,149 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifdef QTFRAMEWORK
+#include "XmlPathExtractorQt.h"
+#include <QByteArray>
+#include <QXmlStreamReader>
+#include <cstring>
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+
+sp<IXmlPathExtractor> IXmlPathExtractor::create(const vector<string>& paths)
+{
+    return make_shared<XmlPathExtractorQt>(paths);
+}
+
+XmlPathExtractorQt::XmlPathExtractorQt(const vector<string>& paths)
+{
+    for (auto& path : paths)
+    {
+        auto compiled = XmlPath::Compile(path);
+
+        // a streaming reader can't tell which sibling is the last one
+        for (auto& step : compiled.steps)
+        {
+            if (!compiled.absolute || (step.position != 0))
+            {
+                throw exceptions::RMSInvalidArgumentException(
+                    "XmlPathExtractorQt: unsupported path: " + path);
+            }
+        }
+        paths_.push_back(compiled.steps);
+    }
+}
+
+bool XmlPathExtractorQt::Extract(const char          *xml,
+                                 size_t               size,
+                                 vector<string>     & values,
+                                 const string       & wrapperRoot) const
+{
+    values.assign(paths_.size(), string());
+
+    QXmlStreamReader reader;
+
+    if (!wrapperRoot.empty())
+    {
+        // an XML declaration is only allowed at the very beginning
+        if ((size > 5) && (strncmp(xml, "<?xml", 5) == 0))
+        {
+            auto end = static_cast<const char *>(memchr(xml, '>', size));
+
+            if (end != nullptr)
+            {
+                size -= end + 1 - xml;
+                xml   = end + 1;
+            }
+        }
+        reader.addData(QByteArray(("<" + wrapperRoot + ">").c_str()));
+    }
+    reader.addData(QByteArray::fromRawData(xml, static_cast<int>(size)));
+
+    if (!wrapperRoot.empty())
+    {
+        reader.addData(QByteArray(("</" + wrapperRoot + ">").c_str()));
+    }
+
+    // matched[i] is the number of steps of paths_[i] matched by the current
+    // element and its ancestors
+    vector<size_t> matched(paths_.size(), 0);
+    vector<bool>   found(paths_.size(), false);
+    vector<QString> text(paths_.size());
+    size_t depth     = 0;
+    size_t remaining = paths_.size();
+
+    while ((remaining > 0) && !reader.atEnd())
+    {
+        switch (reader.readNext())
+        {
+        case QXmlStreamReader::StartElement:
+            ++depth;
+
+            for (size_t i = 0; i < paths_.size(); ++i)
+            {
+                if (found[i] || (matched[i] != depth - 1) ||
+                    (matched[i] == paths_[i].size()))
+                {
+                    continue;
+                }
+
+                auto& step = paths_[i][matched[i]];
+
+                if ((reader.name() == step.name) &&
+                    (step.attributeName.isEmpty() ||
+                     (reader.attributes().value(step.attributeName) ==
+                      step.attributeValue)))
+                {
+                    matched[i] = depth;
+                }
+            }
+            break;
+
+        case QXmlStreamReader::Characters:
+
+            for (size_t i = 0; i < paths_.size(); ++i)
+            {
+                if (!found[i] && (matched[i] == depth) &&
+                    (depth == paths_[i].size()))
+                {
+                    text[i] += reader.text();
+                }
+            }
+            break;
+
+        case QXmlStreamReader::EndElement:
+
+            for (size_t i = 0; i < paths_.size(); ++i)
+            {
+                if (found[i] || (matched[i] != depth)) continue;
+
+                if (depth == paths_[i].size())
+                {
+                    // the first match wins
+                    found[i]  = true;
+                    values[i] = text[i].toStdString();
+                    --remaining;
+                }
+                else
+                {
+                    --matched[i];
+                }
+            }
+            --depth;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return remaining == 0 || !reader.hasError();
+}
+#endif // QTFRAMEWORK
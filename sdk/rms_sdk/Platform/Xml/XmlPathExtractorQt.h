@@ -0,0 +1,29 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef XMLPATHEXTRACTORQT_H
+#define XMLPATHEXTRACTORQT_H
+
+#include "IXmlPathExtractor.h"
+#include "XmlPath.h"
+
+class XmlPathExtractorQt : public IXmlPathExtractor
+{
+public:
+    XmlPathExtractorQt(const std::vector<std::string>& paths);
+
+    bool Extract(const char               *xml,
+                 size_t                    size,
+                 std::vector<std::string>& values,
+                 const std::string       & wrapperRoot) const override;
+
+private:
+    std::vector<std::vector<XmlPathStep> > paths_;
+};
+
+#endif // XMLPATHEXTRACTORQT_H
@@ -19,6 +19,7 @@
 #include "../ModernAPI/RMSExceptions.h"
 #include "../Platform/Http/IHttpClient.h"
 #include "../Platform/Http/IUri.h"
+#include "../Platform/Settings/IRMSEnvironmentImpl.h"
 
 
 using namespace rmscore::modernapi;
@@ -34,18 +35,43 @@ namespace {
 }
 
 
+common::Mutex AuthenticationHandler::s_challengeCacheMutex;
+map<string, AuthenticationHandler::CachedChallenge> AuthenticationHandler::s_challengeCache;
+
 string AuthenticationHandler::GetAccessTokenForUrl(const string& sUrl,
       const AuthenticationHandlerParameters& authParams,
       IAuthenticationCallbackImpl& callback,
-      std::shared_ptr<std::atomic<bool>> cancelState)
+      std::shared_ptr<std::atomic<bool>> cancelState,
+      bool *pbCachedChallenge)
 {
     AuthenticationChallenge challenge;
+    bool bCachedChallenge = false;
 
     // get the challenge only if needed (e.g., it's not needed in Office case
     // for now)
     if (callback.NeedsChallenge())
     {
-        challenge = GetChallengeForUrl(sUrl, authParams, cancelState);
+        // the Evo headers may change the challenge returned by the server
+        auto key = GetChallengeCacheKey(sUrl);
+
+        if (core::FeatureControl::IsEvoEnabled())
+        {
+            key += "|" + authParams.m_ServerPublicCertificate + "|" +
+                   authParams.m_ServiceDiscoverUrl;
+        }
+
+        bCachedChallenge = LookupChallenge(key, challenge);
+
+        if (!bCachedChallenge)
+        {
+            challenge = GetChallengeForUrl(sUrl, authParams, cancelState);
+            StoreChallenge(key, challenge);
+        }
+    }
+
+    if (nullptr != pbCachedChallenge)
+    {
+        *pbCachedChallenge = bCachedChallenge;
     }
 
     return callback.GetAccessToken(static_cast<const AuthenticationChallenge&>(
@@ -55,21 +81,115 @@ string AuthenticationHandler::GetAccessTokenForUrl(const string& sUrl,
 string AuthenticationHandler::GetAccessTokenForUrl(const string& sUrl,
                                                    common::ByteArray&& requestBody,
                                                    IAuthenticationCallbackImpl& callback,
-                                                   std::shared_ptr<std::atomic<bool>> cancelState)
+                                                   std::shared_ptr<std::atomic<bool>> cancelState,
+                                                   bool *pbCachedChallenge)
 {
     AuthenticationChallenge challenge;
+    bool bCachedChallenge = false;
 
     // get the challenge only if needed (e.g., it's not needed in Office case
     // for now)
     if (callback.NeedsChallenge())
     {
-        challenge = GetChallengeForUrl(sUrl, move(requestBody), cancelState);
+        auto key = GetChallengeCacheKey(sUrl);
+
+        bCachedChallenge = LookupChallenge(key, challenge);
+
+        if (!bCachedChallenge)
+        {
+            challenge = GetChallengeForUrl(sUrl, move(requestBody), cancelState);
+            StoreChallenge(key, challenge);
+        }
+    }
+
+    if (nullptr != pbCachedChallenge)
+    {
+        *pbCachedChallenge = bCachedChallenge;
     }
 
     return callback.GetAccessToken(static_cast<const AuthenticationChallenge&>(
                                    challenge));
 }
 
+void AuthenticationHandler::InvalidateChallengeForUrl(const string& sUrl)
+{
+    auto key = GetChallengeCacheKey(sUrl);
+
+    common::MutexLocker lock(&s_challengeCacheMutex);
+
+    // also drop the entries stored with the Evo headers
+    auto it = s_challengeCache.lower_bound(key);
+
+    while ((it != s_challengeCache.end()) &&
+           (it->first.compare(0, key.size(), key) == 0))
+    {
+        it = s_challengeCache.erase(it);
+    }
+}
+
+string AuthenticationHandler::GetChallengeCacheKey(const string& sUrl)
+{
+    auto nSchemeEnd = sUrl.find("://");
+    auto nPathStart = (string::npos == nSchemeEnd) ?
+                      string::npos : sUrl.find('/', nSchemeEnd + 3);
+
+    // scheme and authority are case insensitive
+    string key = sUrl.substr(0, nPathStart);
+    transform(key.begin(), key.end(), key.begin(), ::tolower);
+
+    if (string::npos != nPathStart)
+    {
+        auto path = sUrl.substr(nPathStart, sUrl.find_first_of("?#", nPathStart) - nPathStart);
+        key += path.substr(0, path.rfind('/') + 1);
+    }
+    else
+    {
+        key += "/";
+    }
+
+    return key;
+}
+
+bool AuthenticationHandler::LookupChallenge(const string& key,
+                                            AuthenticationChallenge& challenge)
+{
+    common::MutexLocker lock(&s_challengeCacheMutex);
+
+    auto it = s_challengeCache.find(key);
+
+    if (it == s_challengeCache.end())
+    {
+        return false;
+    }
+
+    if (common::DateTime::currentMSecsSinceEpoch() > it->second.expires)
+    {
+        s_challengeCache.erase(it);
+        return false;
+    }
+
+    challenge = it->second.challenge;
+    return true;
+}
+
+void AuthenticationHandler::StoreChallenge(const string& key,
+                                           const AuthenticationChallenge& challenge)
+{
+    int64_t ttlMsecs = static_cast<int64_t>(
+        platform::settings::IRMSEnvironmentImpl::Environment()->ChallengeCacheTtl()) * 1000;
+
+    if (ttlMsecs <= 0)
+    {
+        return;
+    }
+
+    common::MutexLocker lock(&s_challengeCacheMutex);
+
+    CachedChallenge cached = { challenge,
+                               common::DateTime::currentMSecsSinceEpoch() + ttlMsecs };
+    s_challengeCache[key] = cached;
+}
+
 AuthenticationChallenge AuthenticationHandler::GetChallengeForUrl(const string& sUrl,
     common::ByteArray&& requestBody,
     std::shared_ptr<std::atomic<bool>> cancelState)
@@ -10,11 +10,13 @@
 #define _RMS_LIB_AUTHENTICATIONHANDLER_H_
 
 #include <atomic>
+#include <map>
 #include <memory>
 #include <string>
 
 #include "../ModernAPI/IAuthenticationCallbackImpl.h"
 #include "../Common/CommonTypes.h"
+#include "../Common/FrameworkSpecificTypes.h"
 
 namespace rmscore {
 namespace restclients {
@@ -29,16 +31,23 @@ public:
         std::string m_ServerPublicCertificate; // Relevant When consuming PL. For EVO STS.
         std::string m_ServiceDiscoverUrl; // Relevant When doing service discovery. For EVO STS.
     };
+    // pbCachedChallenge, if not null, is set to true when the challenge was
+    // taken from the challenge cache instead of being requested from the server
     static std::string GetAccessTokenForUrl(const std::string& sUrl,
                                             const AuthenticationHandlerParameters &authParams,
                                             modernapi::IAuthenticationCallbackImpl& callback,
-                                            std::shared_ptr<std::atomic<bool>> cancelState);
+                                            std::shared_ptr<std::atomic<bool>> cancelState,
+                                            bool *pbCachedChallenge = nullptr);
 
     static std::string GetAccessTokenForUrl(const std::string& sUrl,
                                             common::ByteArray&& requestBody,
                                             modernapi::IAuthenticationCallbackImpl& callback,
-                                            std::shared_ptr<std::atomic<bool>> cancelState);
+                                            std::shared_ptr<std::atomic<bool>> cancelState,
+                                            bool *pbCachedChallenge = nullptr);
 
+    // drops the cached challenge of the url, e.g. when the token obtained for it
+    // was rejected by the server
+    static void InvalidateChallengeForUrl(const std::string& sUrl);
 
 
 private:
@@ -53,6 +62,24 @@ private:
 
     static modernapi::AuthenticationChallenge ParseChallengeHeader(const std::string& header,
                                                                    const std::string& url);
+
+    // The challenges are cached per scheme, host, port and path prefix (the
+    // path without its last segment), as all the endpoints of a service return
+    // the same challenge, for IRMSEnvironment::ChallengeCacheTtl.
+    struct CachedChallenge
+    {
+        modernapi::AuthenticationChallenge challenge;
+        int64_t expires; // msecs since epoch
+    };
+
+    static std::string GetChallengeCacheKey(const std::string& sUrl);
+    static bool LookupChallenge(const std::string& key,
+                                modernapi::AuthenticationChallenge& challenge);
+    static void StoreChallenge(const std::string& key,
+                               const modernapi::AuthenticationChallenge& challenge);
+
+    static common::Mutex s_challengeCacheMutex;
+    static std::map<std::string, CachedChallenge> s_challengeCache;
 };
 
 } // namespace restclients
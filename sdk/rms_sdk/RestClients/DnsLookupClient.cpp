@@ -20,6 +20,18 @@ using namespace rmscore::platform::logger;
 namespace rmscore {
 namespace restclients {
 const string RMS_QUERY_PREFIX = "_rmsdisco._http._tcp.";
+
+// how long a name without a discovery record is remembered; the resolver
+// doesn't report the negative TTL of the zone
+const uint32_t NEGATIVE_DNS_TTL = 5 * 60;
+
+common::Mutex DnsLookupClient::s_cacheMutex;
+map<string, DnsLookupClient::CachedAnswer> DnsLookupClient::s_cache;
+
+DnsLookupClient::DnsLookupClient(shared_ptr<IDnsServerResolver>resolver)
+  : m_resolver(resolver != nullptr ? resolver : IDnsServerResolver::Create())
+{}
+
 DnsLookupClient::~DnsLookupClient()
 {}
 
@@ -30,33 +42,134 @@ shared_ptr<DnsClientResult>DnsLookupClient::LookupDiscoveryService(
     throw exceptions::RMSInvalidArgumentException("Invalid domain");
   }
 
-  auto pResolver = IDnsServerResolver::Create();
-
   string domainString            = domain->GetDomainStringForDnsLookup();
   vector<string> possibleDomains = GetPossibleDomains(domainString);
+  vector<string> dnsRequests;
 
-  for (auto possibleDomainIt = begin(possibleDomains);
-       possibleDomainIt != end(possibleDomains); ++possibleDomainIt)
+  for (auto& possibleDomain : possibleDomains)
   {
-    Logger::Hidden("possibleDomain: %s", possibleDomainIt->c_str());
-    string dnsRequest(RMS_QUERY_PREFIX + *possibleDomainIt);
-    auto   dnsResponse = pResolver->lookup(dnsRequest);
+    Logger::Hidden("possibleDomain: %s", possibleDomain.c_str());
+    dnsRequests.push_back(RMS_QUERY_PREFIX + possibleDomain);
+  }
 
-    if (dnsResponse.empty())
+  // the most specific domain with a record wins
+  auto records = Resolve(*m_resolver, dnsRequests);
+
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    if (records[i].status != DnsServiceRecord::Found)
     {
       Logger::Hidden("Failed DNS lookup with domain: %s",
-                     possibleDomainIt->c_str());
+                     possibleDomains[i].c_str());
       continue;
     }
 
     Logger::Hidden("Successfully queried results with domain: %s",
-                   possibleDomainIt->c_str());
-    return DnsClientResult::Create(dnsResponse);
+                   possibleDomains[i].c_str());
+    return DnsClientResult::Create(records[i].target);
   }
 
   return DnsClientResult::Create(string("api.aadrm.com"));
 }
 
+vector<DnsServiceRecord>DnsLookupClient::Resolve(
+  IDnsServerResolver  & resolver,
+  const vector<string>& dnsRequests)
+{
+  vector<DnsServiceRecord> records(dnsRequests.size(),
+                                   DnsServiceRecord {
+                                     DnsServiceRecord::Abandoned, "", 0 });
+  vector<size_t> pending;
+
+  {
+    common::MutexLocker lock(&s_cacheMutex);
+    auto now = chrono::steady_clock::now();
+
+    for (size_t i = 0; i < dnsRequests.size(); ++i)
+    {
+      auto it = s_cache.find(dnsRequests[i]);
+
+      if ((it != s_cache.end()) && (it->second.expires > now))
+      {
+        Logger::Hidden("Cached DNS answer for %s", dnsRequests[i].c_str());
+        records[i] = it->second.record;
+
+        // the less specific names don't matter anymore
+        if (records[i].status == DnsServiceRecord::Found) break;
+
+        continue;
+      }
+
+      if (it != s_cache.end()) s_cache.erase(it);
+      pending.push_back(i);
+    }
+  }
+
+  if (pending.empty()) return records;
+
+  vector<string> names;
+
+  for (auto i : pending) names.push_back(dnsRequests[i]);
+
+  auto answers = resolver.lookupFirst(names);
+
+  for (size_t k = 0; k < pending.size(); ++k)
+  {
+    records[pending[k]] = answers[k];
+    Cache(names[k], answers[k]);
+  }
+
+  return records;
+}
+
+void DnsLookupClient::Cache(const string          & dnsRequest,
+                            const DnsServiceRecord& record)
+{
+  uint32_t ttl = 0;
+
+  if (record.status == DnsServiceRecord::Found)
+  {
+    ttl = record.ttl;
+  }
+  else if (record.status == DnsServiceRecord::NotFound)
+  {
+    ttl = NEGATIVE_DNS_TTL;
+  }
+
+  // failures are transient, abandoned lookups have no answer
+  if (ttl == 0) return;
+
+  CachedAnswer answer = {
+    record, chrono::steady_clock::now() + chrono::seconds(ttl)
+  };
+
+  common::MutexLocker lock(&s_cacheMutex);
+
+  s_cache[dnsRequest] = answer;
+}
+
+void DnsLookupClient::ClearCache()
+{
+  common::MutexLocker lock(&s_cacheMutex);
+
+  s_cache.clear();
+}
+
+chrono::seconds DnsLookupClient::CachedFor(const string& dnsRequest)
+{
+  common::MutexLocker lock(&s_cacheMutex);
+
+  auto it  = s_cache.find(dnsRequest);
+  auto now = chrono::steady_clock::now();
+
+  if ((it == s_cache.end()) || (it->second.expires <= now))
+  {
+    return chrono::seconds(0);
+  }
+
+  return chrono::duration_cast<chrono::seconds>(it->second.expires - now);
+}
+
 vector<string>DnsLookupClient::GetPossibleDomains(const std::string& domain)
 {
   const int MINIMUM_NUMBER_OF_ELEMENTS_IN_DOMAIN = 1;
@@ -9,22 +9,53 @@
 #ifndef _RMS_LIB_DNSLOOKUPCLIENT_H_
 #define _RMS_LIB_DNSLOOKUPCLIENT_H_
 
+#include <chrono>
+#include <map>
 #include <memory>
+#include <vector>
 #include "../Common/FrameworkSpecificTypes.h"
 #include "../Common/CommonTypes.h"
 #include "IDnsLookupClient.h"
+#include "../Platform/Http/IDnsServerResolver.h"
 
 namespace rmscore {
 namespace restclients {
 class DnsLookupClient : public IDnsLookupClient {
 public:
 
+  // the resolver of the platform unless one is given
+  explicit DnsLookupClient(
+    std::shared_ptr<platform::http::IDnsServerResolver>resolver = nullptr);
   virtual ~DnsLookupClient();
 
   virtual std::shared_ptr<DnsClientResult>LookupDiscoveryService(
     std::shared_ptr<Domain>domain) override;
 
+  // drops the answers cached in memory
+  static void ClearCache();
+
+  // how much longer the answer for the name is cached, 0 if it isn't
+  static std::chrono::seconds CachedFor(const std::string& dnsRequest);
+
 private:
+  struct CachedAnswer {
+    platform::http::DnsServiceRecord record;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  // the names are looked up concurrently, the answers (found or not) are
+  // kept in memory for their TTL
+  static std::vector<platform::http::DnsServiceRecord> Resolve(
+    platform::http::IDnsServerResolver& resolver,
+    const std::vector<std::string>    & dnsRequests);
+  static void Cache(const std::string                     & dnsRequest,
+                    const platform::http::DnsServiceRecord& record);
+
+  static common::Mutex s_cacheMutex;
+  static std::map<std::string, CachedAnswer> s_cache;
+
+  std::shared_ptr<platform::http::IDnsServerResolver> m_resolver;
+
   void SendPacket(
     common::DataStream &sendStream,
     const common::ByteArray &requestMessage);
@@ -8,15 +8,16 @@
 
 #include "../Common/FrameworkSpecificTypes.h"
 #include "../Common/CommonTypes.h"
+#include "../Common/Utf16.h"
 #include "../Core/FeatureControl.h"
 #include "../ModernAPI/RMSExceptions.h"
-#include "../Platform/Xml/IDomDocument.h"
-#include "../Platform/Xml/IDomElement.h"
+#include "../Platform/Xml/IXmlPathExtractor.h"
 
-#include "CXMLUtils.h"
 #include "LicenseParser.h"
 
-
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 using namespace std;
 
@@ -32,6 +33,136 @@ namespace {
         "/Root/XrML/BODY[@type='Microsoft Rights Label']/DISTRIBUTIONPOINT/OBJECT[@type='License-Acquisition-URL']/ADDRESS[@type='URL']/text()";
     const string SLC_XPATH =
         "/Root/XrML/BODY[@type='Microsoft Rights Label']/ISSUEDPRINCIPALS/PRINCIPAL/PUBLICKEY/PARAMETER[@name='modulus']/VALUE/text()";
+
+    enum { EXTRANET = 0, INTRANET = 1, SLC = 2 };
+
+    // compiled once; the scan stops as soon as the three values are found,
+    // usually well before the signature at the end of the license
+    const IXmlPathExtractor& LicenseExtractor()
+    {
+        static auto extractor = IXmlPathExtractor::create({ EXTRANET_XPATH,
+                                                            INTRANET_XPATH,
+                                                            SLC_XPATH });
+        return *extractor;
+    }
+
+    // Bounded LRU memo of the parsed licenses, keyed by a hash of the raw
+    // license bytes; the bytes are kept too, a hit compares them, so a hash
+    // collision is only a miss.
+    class ParsedLicenseCache
+    {
+    public:
+
+        static ParsedLicenseCache& Instance()
+        {
+            // NOTE: the cache is leaked deliberately, parsing may still run
+            // on detached threads when static destructors do.
+            static ParsedLicenseCache *cache = new ParsedLicenseCache();
+            return *cache;
+        }
+
+        shared_ptr<LicenseParserResult> Find(const uint8_t *pb, size_t cb)
+        {
+            auto hash = Hash(pb, cb);
+            lock_guard<mutex> lock(m_mutex);
+            auto range = m_index.equal_range(hash);
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                auto& license = it->second->license;
+
+                if ((license.size() == cb) && (memcmp(license.data(), pb, cb) == 0))
+                {
+                    // move it to the front of the LRU list
+                    m_entries.splice(m_entries.begin(), m_entries, it->second);
+                    return it->second->result;
+                }
+            }
+            return nullptr;
+        }
+
+        void Add(const uint8_t *pb, size_t cb, const shared_ptr<LicenseParserResult>& result)
+        {
+            // not worth keeping a copy of
+            if (cb > MAX_LICENSE_SIZE) return;
+
+            auto hash = Hash(pb, cb);
+            lock_guard<mutex> lock(m_mutex);
+
+            // another thread may have parsed the same license meanwhile
+            auto range = m_index.equal_range(hash);
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                auto& license = it->second->license;
+
+                if ((license.size() == cb) && (memcmp(license.data(), pb, cb) == 0)) return;
+            }
+
+            m_entries.push_front(Entry { hash, string(reinterpret_cast<const char *>(pb), cb), result });
+            m_index.insert(make_pair(hash, m_entries.begin()));
+
+            if (m_entries.size() > MAX_ENTRIES)
+            {
+                auto last = prev(m_entries.end());
+                auto evicted = m_index.equal_range(last->hash);
+
+                for (auto it = evicted.first; it != evicted.second; ++it)
+                {
+                    if (it->second == last)
+                    {
+                        m_index.erase(it);
+                        break;
+                    }
+                }
+                m_entries.erase(last);
+            }
+        }
+
+        void Clear()
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_index.clear();
+            m_entries.clear();
+        }
+
+    private:
+
+        struct Entry
+        {
+            uint64_t hash;
+            string   license;
+            shared_ptr<LicenseParserResult> result;
+        };
+
+        static const size_t MAX_ENTRIES      = 64;
+        static const size_t MAX_LICENSE_SIZE = 1024 * 1024;
+
+        // FNV-1a over 64 bit words, then over the remaining bytes
+        static uint64_t Hash(const uint8_t *pb, size_t cb)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            size_t   i    = 0;
+
+            for (; i + sizeof(uint64_t) <= cb; i += sizeof(uint64_t))
+            {
+                uint64_t word;
+                memcpy(&word, pb + i, sizeof(word));
+                hash ^= word;
+                hash *= 1099511628211ull;
+            }
+            for (; i < cb; ++i)
+            {
+                hash ^= pb[i];
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        mutex m_mutex;
+        list<Entry> m_entries; // most recently used first
+        unordered_multimap<uint64_t, list<Entry>::iterator> m_index;
+    };
 }
 
 const uint8_t BOM_UTF8[] = {0xef, 0xbb, 0xbf};
@@ -39,48 +170,65 @@ const uint8_t BOM_UTF8[] = {0xef, 0xbb, 0xbf};
 const shared_ptr<LicenseParserResult> LicenseParser::ParsePublishingLicense(const void *pbPublishLicense,
                                                                 size_t cbPublishLicense)
 {
-    return ParsePublishingLicenseInner(pbPublishLicense, cbPublishLicense);
+    auto pb     = reinterpret_cast<const uint8_t *>(pbPublishLicense);
+    auto& cache = ParsedLicenseCache::Instance();
+    auto result = cache.Find(pb, cbPublishLicense);
+
+    if (result == nullptr)
+    {
+        // invalid licenses throw and are not memoized
+        result = ParsePublishingLicenseInner(pbPublishLicense, cbPublishLicense);
+        cache.Add(pb, cbPublishLicense, result);
+    }
+    return result;
+}
+
+void LicenseParser::ClearCache()
+{
+    ParsedLicenseCache::Instance().Clear();
 }
 
 const shared_ptr<LicenseParserResult> LicenseParser::ParsePublishingLicenseInner(const void *pbPublishLicense,
                                                                      size_t cbPublishLicense)
 {
-    string publishLicense;
+    // UTF-8 licenses are read in place, UTF-16 ones are converted once
+    const char *publishLicense = nullptr;
+    size_t      size = 0;
+    string      converted;
+
     if ((cbPublishLicense > sizeof(BOM_UTF8)) && (memcmp(pbPublishLicense, BOM_UTF8, sizeof(BOM_UTF8)) == 0))
     {
-        string utf8NoBOM(reinterpret_cast<const uint8_t *>(pbPublishLicense) + sizeof(BOM_UTF8),
-                         reinterpret_cast<const uint8_t *>(pbPublishLicense) +
-                         cbPublishLicense);
-        publishLicense = utf8NoBOM;
+        publishLicense = reinterpret_cast<const char *>(pbPublishLicense) + sizeof(BOM_UTF8);
+        size           = cbPublishLicense - sizeof(BOM_UTF8);
     }
     else if (cbPublishLicense % 2 == 0)
     {
-        // Assume UTF16LE (Unicode)
-        auto strUnicode = QString::fromUtf16(reinterpret_cast<const uint16_t*>(pbPublishLicense), 
-                                                              static_cast<int>(cbPublishLicense) / sizeof(uint16_t));
-        auto utf8ByteArray = strUnicode.toUtf8();
-        string utfString(utf8ByteArray.constData(), utf8ByteArray.length());
-        publishLicense = utfString;
+        // Assume UTF16LE (Unicode), without its byte order mark if any
+        auto pbUtf16 = reinterpret_cast<const uint8_t *>(pbPublishLicense);
+        auto cbUtf16 = cbPublishLicense;
+
+        if ((cbUtf16 >= 2) && (pbUtf16[0] == 0xff) && (pbUtf16[1] == 0xfe))
+        {
+            pbUtf16 += 2;
+            cbUtf16 -= 2;
+        }
+        common::AppendUtf16LEAsUtf8(pbUtf16, cbUtf16 / sizeof(uint16_t), converted);
+        publishLicense = converted.data();
+        size           = converted.size();
     }
     else 
     {
         throw exceptions::RMSNetworkException("Invalid publishing license encoding",
                                               exceptions::RMSNetworkException::InvalidPL);
     }
-    size_t finalSize = publishLicense.size();
+    // the license may be null terminated
+    size_t finalSize = strnlen(publishLicense, size);
 
-    string publishLicenseWithRoot;
-    CXMLUtils::WrapWithRoot(publishLicense.c_str(), finalSize, publishLicenseWithRoot);
-
-    auto document = IDomDocument::create();
-    std::string errMsg;
-    int errLine   = 0;
-    int errColumn = 0;
-
-    auto ok = document->setContent(publishLicenseWithRoot,
-                                 errMsg,
-                                 errLine,
-                                 errColumn);
+    vector<string> values;
+    auto ok = LicenseExtractor().Extract(publishLicense,
+                                         finalSize,
+                                         values,
+                                         "Root");
 
     if (!ok) 
     {
@@ -88,12 +236,9 @@ const shared_ptr<LicenseParserResult> LicenseParser::ParsePublishingLicenseInner
                                           exceptions::RMSNetworkException::InvalidPL);
     }
 
-    auto extranetDomainNode = document->SelectSingleNode(EXTRANET_XPATH);
-    auto intranetDomainNode = document->SelectSingleNode(INTRANET_XPATH);
-
-    auto extranetDomain = (nullptr != extranetDomainNode.get()) ? extranetDomainNode->text() : string();
+    auto extranetDomain = values[EXTRANET];
     RemoveTrailingNewLine(extranetDomain);
-    auto intranetDomain = (nullptr != intranetDomainNode.get()) ? intranetDomainNode->text() : string();
+    auto intranetDomain = values[INTRANET];
     RemoveTrailingNewLine(intranetDomain);
     vector<shared_ptr<Domain> > domains;
 
@@ -120,13 +265,12 @@ const shared_ptr<LicenseParserResult> LicenseParser::ParsePublishingLicenseInner
     shared_ptr<LicenseParserResult> result;
     if (rmscore::core::FeatureControl::IsEvoEnabled())
     {
-        auto slcNode = document->SelectSingleNode(SLC_XPATH);
-        if (nullptr == slcNode.get())
+        auto publicCertificate = values[SLC];
+        if (publicCertificate.empty())
         {
             throw exceptions::RMSNetworkException("Server public certificate",
                                               exceptions::RMSNetworkException::InvalidPL);
         }
-        auto publicCertificate = slcNode->text();
         RemoveTrailingNewLine(publicCertificate);
 
         result = make_shared<LicenseParserResult>(LicenseParserResult(domains,
@@ -23,9 +23,15 @@ namespace restclients {
 class LicenseParser {
 public:
 
+  // The results are memoized by the content of the license, so files
+  // protected with the same license are parsed once; the result is shared,
+  // callers must not hold on to it expecting a fresh copy.
   static const shared_ptr<LicenseParserResult> ParsePublishingLicense(const void *pbPublishLicense,
                                                                       size_t cbPublishLicense);
 
+  // forgets the memoized results
+  static void ClearCache();
+
 private:
 
   static bool IsValidUTF16LEPLStart(const void* pbPublishLicense,
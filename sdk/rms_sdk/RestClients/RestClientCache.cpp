@@ -9,15 +9,17 @@
 #include <CryptoAPI.h>
 #include <RMSCryptoExceptions.h>
 #include "RestClientCache.h"
+#include "RestClientCacheStore.h"
 #include "../ModernAPI/RMSExceptions.h"
 #include "../Platform/Filesystem/IFileSystem.h"
 #include "../Platform/Settings/ILocalSettings.h"
+#include "../Platform/Json/IJsonObject.h"
+#include "../Platform/Json/IJsonParser.h"
 #include "../Common/tools.h"
 #include "../Platform/Logger/Logger.h"
+#include <atomic>
 #include <sstream>
-#include <fstream>
-#include <future>
-#include <QStandardPaths>
+#include <thread>
 
 using namespace std;
 using namespace rmscore::platform::logger;
@@ -31,6 +33,8 @@ static const string CLOUD_DIAGNOSTICS_TAG   = "CLOUD_DIAGNOSTICS_UR";
 static const string PERFORMANCE_TAG         = "PERFORMANCE_UR";
 static const string DNS_CLIENT_RESULT_TAG   = "DNS_CLIENT_RESULT";
 static const string ORIGINAL_INPUT_TAG      = "ORIGINAL_INPUT";
+static const string SERVICE_DISCOVERY_DETAILS_TAG =
+  "SERVICE_DISCOVERY_DETAILS";
 
 using SELF = RestClientCache;
 
@@ -53,79 +57,11 @@ common::StringArray RestClientCache::Lookup(
     return common::StringArray();
   }
 
-  lock_guard<mutex> locker(SELF::cacheMutex);
   try
   {
-    auto fileNamePattern = SELF::GetFileName(cacheName,
-                                             tag,
-                                             pbKey,
-                                             cbKey,
-                                             string(),
-                                             true,
-                                             useHash);
+    auto key = SELF::GetStoreKey(cacheName, tag, pbKey, cbKey, true, useHash);
 
-    auto fileSystem = platform::filesystem::IFileSystem::Create();
-
-    auto vFileNames = fileSystem->QueryLocalStorageFiles(SELF::cacheFolderName,
-                                                         fileNamePattern);
-
-    common::StringArray vResponses;
-
-    for (auto iFileName = vFileNames.begin(); vFileNames.end() != iFileName;
-         ++iFileName)
-    {
-      try
-      {
-        if (SELF::DeleteIfExpired(cacheName, *iFileName))
-        {
-          continue;
-        }
-
-        auto filePath = SELF::cacheFolderName + (*iFileName);
-
-        // open file stream
-        auto ifs = std::make_shared<ifstream>(filePath, ios_base::in);
-
-        // convert to input IStream
-        auto iis = rmscrypto::api::CreateStreamFromStdStream(
-          std::static_pointer_cast<std::istream>(ifs));
-
-        if (iis) {
-          // create input protected stream
-          auto ips = m_type ==
-                     CACHE_ENCRYPTED ? rmscrypto::api::
-                     CreateCryptoStreamWithAutoKey(
-            rmscrypto::api::CIPHER_MODE_CBC4K, filePath, iis) : iis;
-
-          if (ips) {
-            auto data = ips->Read(ips->Size());
-            std::string dataStr(data.begin(), data.end());
-
-            vResponses.push_back(dataStr);
-          }
-        }
-      }
-      catch (exceptions::RMSException)
-      {
-        Logger::Warning(
-          "RestClientCache::Lookup: exception while reading a cached file \"%s\"",
-          (*iFileName).data());
-
-        //                LogException(LOG_MESSAGE_WARNING);
-
-        // not fatal
-        continue;
-      }
-      catch (rmscrypto::exceptions::RMSCryptoException& e)
-      {
-        Logger::Warning(
-          "RestClientCache::Lookup: exception while work with crypto: \"%s\"",
-          e.what());
-
-        // fatal
-        return vResponses;
-      }
-    }
+    auto vResponses = RestClientCacheStore::Get(m_type).Lookup(key);
 
     Logger::Info(
       "-RestClientCache::Lookup: cacheName=\"%s\", tag=\"%s\" returning %d result(s)",
@@ -133,19 +69,24 @@ common::StringArray RestClientCache::Lookup(
       !tag.empty() ? tag.data() : "NULL",
       vResponses.size());
 
-
     return vResponses;
   }
   catch (exceptions::RMSException)
   {
     Logger::Warning(
-      "RestClientCache::Lookup: exception while enumerating cached files.");
-
-    //        LogException(LOG_MESSAGE_WARNING);
+      "RestClientCache::Lookup: exception while reading the cache.");
 
     // return 0 responses
     return common::StringArray();
   }
+  catch (rmscrypto::exceptions::RMSCryptoException& e)
+  {
+    Logger::Warning(
+      "RestClientCache::Lookup: exception while work with crypto: \"%s\"",
+      e.what());
+
+    return common::StringArray();
+  }
 }
 
 void RestClientCache::Store(
@@ -162,48 +103,13 @@ void RestClientCache::Store(
     !tag.empty() ? tag.data() : "NULL",
     !expires.empty() ? expires.data() : "NULL");
 
-  lock_guard<mutex> locker(SELF::cacheMutex);
   try
   {
-    auto fileName = SELF::GetFileName(cacheName,
-                                      tag,
-                                      pbKey,
-                                      cbKey,
-                                      expires,
-                                      false,
-                                      useHash);
-
-    auto filePath = SELF::cacheFolderName + fileName;
-
-    // create chache folder
-    platform::filesystem::IFileSystem::CreateDirectory(SELF::cacheFolderName);
-
-    // 4a63455a-cfa1-4ac6-bd2e-0d046cf1c3f7
-    // john.smith@msopentechtest01.onmicrosoft.com
-    // https://client.test.app
-    // api.aadrm.com
-    // open file stream
-    auto ofs =
-      std::make_shared<fstream>(filePath, ios_base::out | ios_base::trunc);
-
-    // convert to output IStream
-    auto ois =
-      rmscrypto::api::CreateStreamFromStdStream(
-        std::static_pointer_cast<std::ostream>(ofs));
-
-    if (ois) {
-      // create output protected stream
-      auto ops = m_type ==
-                 CACHE_ENCRYPTED ? rmscrypto::api::CreateCryptoStreamWithAutoKey(
-        rmscrypto::api::CIPHER_MODE_CBC4K, filePath, ois) : ois;
-
-      if (ops) {
-        ops->Write(strResponse.data(), strResponse.size());
-        ops->Flush();
-      }
-    }
+    auto key = SELF::GetStoreKey(cacheName, tag, pbKey, cbKey, false, useHash);
+
+    RestClientCacheStore::Get(m_type).Store(key, expires, strResponse);
 
-    SELF::CleanupIfNeeded(cacheName);
+    SELF::CleanupIfNeeded(cacheName, m_type);
   }
   catch (exceptions::RMSException)
   {
@@ -224,56 +130,54 @@ void RestClientCache::Store(
 _ptr<ServiceDiscoveryDetails>RestClientCache::LookupServiceDiscoveryDetails(
   const string& domain)
 {
-  auto endUserLicensesUrl = this->Lookup(domain,
-                                         END_USER_LICENSES_TAG,
-                                         nullptr,
-                                         0,
-                                         false);
-  auto publishingLicensesUrl = this->Lookup(domain,
-                                            PUBLISHING_LICENSES_TAG,
-                                            nullptr,
-                                            0,
-                                            false);
-  auto templatesUrl = this->Lookup(domain,
-                                   TEMPLATES_TAG,
-                                   nullptr,
-                                   0,
-                                   false);
-  auto cloudDiagnosticsServerUrl = this->Lookup(domain,
-                                                CLOUD_DIAGNOSTICS_TAG,
-                                                nullptr,
-                                                0,
-                                                false);
-  auto performanceServerUrl = this->Lookup(domain,
-                                           PERFORMANCE_TAG,
-                                           nullptr,
-                                           0,
-                                           false);
-  auto originalInput = this->Lookup(domain,
-                                    ORIGINAL_INPUT_TAG,
-                                    nullptr,
-                                    0,
-                                    false);
-
-  if (!endUserLicensesUrl.empty()
-      && !publishingLicensesUrl.empty()
-      && !templatesUrl.empty()
-      && !cloudDiagnosticsServerUrl.empty()
-      && !performanceServerUrl.empty()
-      && !originalInput.empty())
+  // all the urls are stored in a single entry
+  auto vResponses = this->Lookup(domain,
+                                 SERVICE_DISCOVERY_DETAILS_TAG,
+                                 nullptr,
+                                 0,
+                                 false);
+
+  if (vResponses.empty())
+  {
+    return nullptr;
+  }
+
+  try
   {
+    auto pJsonObject = platform::json::IJsonParser::Create()->Parse(
+      common::ByteArray(vResponses[0].begin(), vResponses[0].end()));
+
+    if ((pJsonObject == nullptr)
+        || !pJsonObject->HasName(END_USER_LICENSES_TAG)
+        || !pJsonObject->HasName(PUBLISHING_LICENSES_TAG)
+        || !pJsonObject->HasName(TEMPLATES_TAG)
+        || !pJsonObject->HasName(CLOUD_DIAGNOSTICS_TAG)
+        || !pJsonObject->HasName(PERFORMANCE_TAG)
+        || !pJsonObject->HasName(ORIGINAL_INPUT_TAG))
+    {
+      return nullptr;
+    }
+
     auto details = make_shared<ServiceDiscoveryDetails>();
-    details->EndUserLicensesUrl        = endUserLicensesUrl[0];
-    details->PublishingLicensesUrl     = publishingLicensesUrl[0];
-    details->TemplatesUrl              = templatesUrl[0];
-    details->CloudDiagnosticsServerUrl = cloudDiagnosticsServerUrl[0];
-    details->PerformanceServerUrl      = performanceServerUrl[0];
-    details->OriginalInput             = originalInput[0];
+    details->EndUserLicensesUrl =
+      pJsonObject->GetNamedString(END_USER_LICENSES_TAG);
+    details->PublishingLicensesUrl =
+      pJsonObject->GetNamedString(PUBLISHING_LICENSES_TAG);
+    details->TemplatesUrl = pJsonObject->GetNamedString(TEMPLATES_TAG);
+    details->CloudDiagnosticsServerUrl =
+      pJsonObject->GetNamedString(CLOUD_DIAGNOSTICS_TAG);
+    details->PerformanceServerUrl =
+      pJsonObject->GetNamedString(PERFORMANCE_TAG);
+    details->OriginalInput = pJsonObject->GetNamedString(ORIGINAL_INPUT_TAG);
     return details;
   }
+  catch (exceptions::RMSException)
+  {
+    Logger::Warning(
+      "RestClientCache::LookupServiceDiscoveryDetails: invalid cache entry.");
 
-
-  return nullptr;
+    return nullptr;
+  }
 }
 
 void RestClientCache::Store(
@@ -281,58 +185,29 @@ void RestClientCache::Store(
   _ptr<ServiceDiscoveryDetails>serviceDiscoveryDetails,
   const string               & expires)
 {
-  this->Store(domain,
-              END_USER_LICENSES_TAG,
-              nullptr,
-              0,
-              expires,
-              common::ByteArray(serviceDiscoveryDetails->EndUserLicensesUrl.begin(),
-                                serviceDiscoveryDetails->EndUserLicensesUrl.end()),
-              false);
-  this->Store(domain,
-              PUBLISHING_LICENSES_TAG,
-              nullptr,
-              0,
-              expires,
-              common::ByteArray(serviceDiscoveryDetails->PublishingLicensesUrl.
-                                begin(),
-                                serviceDiscoveryDetails->PublishingLicensesUrl.end()),
-              false);
-  this->Store(domain,
-              TEMPLATES_TAG,
-              nullptr,
-              0,
-              expires,
-              common::ByteArray(serviceDiscoveryDetails->TemplatesUrl.begin(),
-                                serviceDiscoveryDetails->TemplatesUrl.end()),
-              false);
-  this->Store(domain,
-              CLOUD_DIAGNOSTICS_TAG,
-              nullptr,
-              0,
-              expires,
-              common::ByteArray(serviceDiscoveryDetails->CloudDiagnosticsServerUrl
-                                .begin(),
-                                serviceDiscoveryDetails->CloudDiagnosticsServerUrl
-                                .end()),
-              false);
-  this->Store(domain,
-              PERFORMANCE_TAG,
-              nullptr,
-              0,
-              expires,
-              common::ByteArray(serviceDiscoveryDetails->PerformanceServerUrl.
-                                begin(),
-                                serviceDiscoveryDetails->PerformanceServerUrl.end()),
-              false);
+  // store all the urls as a single entry, so that they are written and read
+  // together
+  auto pJsonObject = platform::json::IJsonObject::Create();
+
+  pJsonObject->SetNamedString(END_USER_LICENSES_TAG,
+                              serviceDiscoveryDetails->EndUserLicensesUrl);
+  pJsonObject->SetNamedString(PUBLISHING_LICENSES_TAG,
+                              serviceDiscoveryDetails->PublishingLicensesUrl);
+  pJsonObject->SetNamedString(TEMPLATES_TAG,
+                              serviceDiscoveryDetails->TemplatesUrl);
+  pJsonObject->SetNamedString(CLOUD_DIAGNOSTICS_TAG,
+                              serviceDiscoveryDetails->CloudDiagnosticsServerUrl);
+  pJsonObject->SetNamedString(PERFORMANCE_TAG,
+                              serviceDiscoveryDetails->PerformanceServerUrl);
+  pJsonObject->SetNamedString(ORIGINAL_INPUT_TAG,
+                              serviceDiscoveryDetails->OriginalInput);
 
   this->Store(domain,
-              ORIGINAL_INPUT_TAG,
+              SERVICE_DISCOVERY_DETAILS_TAG,
               nullptr,
               0,
               expires,
-              common::ByteArray(serviceDiscoveryDetails->OriginalInput.begin(),
-                                serviceDiscoveryDetails->OriginalInput.end()),
+              pJsonObject->Stringify(),
               false);
 }
 
@@ -358,11 +233,6 @@ void RestClientCache::StoreDnsClientResult(
 
 // static /////////////////////////////////////////////////////////////
 
-// the folder name, where we store the cache
-const string RestClientCache::cacheFolderName = (QStandardPaths::writableLocation(
-                                                   QStandardPaths::HomeLocation) +
-                                                 "/.ms-ad/").toStdString();
-
 // cache settings name constants
 const string RestClientCache::cacheSettingsContainerName =
   "MSOPENTECHThin";
@@ -375,17 +245,27 @@ const string RestClientCache::cacheCleanupCounterSettingName =
 const string RestClientCache::cacheMaximumFilesSettingName =
   "CacheMaximumFiles";
 
-mutex RestClientCache::cacheMutex;
+// cleanup state
+common::Mutex RestClientCache::cleanupMutex;
+map<string, int> RestClientCache::cleanupCounters;
+set<RestClientCache::CleanupRequest> RestClientCache::pendingCleanups;
+map<RestClientCache::CleanupRequest, int64_t> RestClientCache::lastCleanups;
+bool RestClientCache::cleanupRunning = false;
 
 bool RestClientCache::IsCacheLookupDisableTestHookOn()
 {
-  bool res = platform::settings::ILocalSettings::Create()->GetBool(
-    SELF::cacheSettingsContainerName,
-    SELF::cacheSettingsCacheLookupDisableTestHook,
-    false);
+  // every lookup checks it, the settings are only read once per process
+  static const bool res = []() {
+    bool testHookOn = platform::settings::ILocalSettings::Create()->GetBool(
+      SELF::cacheSettingsContainerName,
+      SELF::cacheSettingsCacheLookupDisableTestHook,
+      false);
+
+    Logger::Info("RestClientCache::IsCacheLookupDisableTestHookOn: %s state",
+                 testHookOn ? "TRUE" : "FALSE");
 
-  Logger::Info("RestClientCache::IsCacheLookupDisableTestHookOn: %s state",
-               res ? "TRUE" : "FALSE");
+    return testHookOn;
+  }();
 
   return res;
 }
@@ -412,295 +292,197 @@ common::ByteArray RestClientCache::HashKey(const uint8_t *pbKey, size_t cbKey)
   return std::move(strBase64);
 }
 
-// gets the filename from the cache name, tag and key
-string RestClientCache::GetFileName(
+// gets the key of the entry in the store from the cache name, tag and key
+RestClientCacheStore::Key RestClientCache::GetStoreKey(
   const string& cacheName,
   const string& tag,
   const uint8_t *pbKey, size_t cbKey,
-  const string& expires, bool pattern, bool useHash)
+  bool pattern, bool useHash)
 {
-  //    const string fileNameFormat = "%s-%s=%s-%s.dat";
-  bool bTagPattern = false;
+  RestClientCacheStore::Key key;
 
-  string tagMod(tag);
+  key.cacheName = cacheName;
 
-  if (tag.empty())
+  // an empty tag or hash in a pattern matches all the entries
+  key.tag = tag;
+
+  if (tag.empty() && !pattern)
   {
-    if (pattern)
-    {
-      // to enumerate all files
-      tagMod      = "*?";
-      bTagPattern = true;
-    }
-    else
-    {
-      // just a null tag
-      tagMod = "NULL";
-    }
+    // just a null tag
+    key.tag = "NULL";
   }
 
-  string expiresMod(expires);
-
-  if (expires.empty())
+  if (!useHash)
   {
-    if (pattern)
-    {
-      // to enumerate all files
-      expiresMod = "*?";
-    }
-    else
-    {
-      // just a null expiry time
-      expiresMod = "0000-00-00T00:00Z";
-    }
+    key.hash = "NoHash";
   }
-
-  string nh("NoHash");
-  string enAll("*?");
-  common::ByteArray hash(nh.begin(), nh.end());
-
-  if (useHash)
+  else if (nullptr != pbKey)
   {
-    if (nullptr == pbKey)
-    {
-      //            CHECK_BOOL_X_HR(pattern, E_INVALIDARG);
-
-      // enumerate all
-      hash = common::ByteArray(enAll.begin(), enAll.end());
-    }
-    else
-    {
-      // get the hash of the key
-      hash = HashKey(pbKey, cbKey);
-    }
+    // get the hash of the key
+    auto hash = HashKey(pbKey, cbKey);
+    key.hash = string(hash.begin(), hash.end());
   }
-
-  SELF::ReplaceNotAllowedCharactersInDateTime(expiresMod);
-
-  if (!bTagPattern)
+  else if (!pattern)
   {
-    SELF::ReplaceNotAllowedCharactersInEmail(tagMod);
+    key.hash = "NoHash";
   }
 
-  stringstream ss;
-  string hashStr(hash.begin(), hash.end());
-  ss << cacheName << "-" << expiresMod << "=" << tagMod << "-" << std::hex <<
-    hashStr;
-
-  return ss.str();
+  return key;
 }
 
-// parses the expiry time from the filename
-common::DateTime RestClientCache::GetExpiryTimeFromFileName(
-  const string& cacheName, const string& fileName)
+// queues the cleanup of the cache for the background maintenance thread
+void RestClientCache::LaunchCleanup(const string& cacheName, CacheType type)
 {
-  size_t nFileNameLength  = fileName.length();
-  size_t nCacheNameLength = cacheName.length();
+  CleanupRequest request(cacheName, type);
 
-  if (nFileNameLength <= nCacheNameLength + 1)
   {
-    throw exceptions::RMSInvalidArgumentException("Bad fileName");
-  }
+    common::MutexLocker lock(&SELF::cleanupMutex);
 
-  size_t nExpiresOffset = nCacheNameLength + 1;
+    auto last = SELF::lastCleanups.find(request);
 
-  auto expiresStart = nExpiresOffset;
-  auto expiresEnd   = fileName.find('=');
+    if ((last != SELF::lastCleanups.end()) &&
+        (common::DateTime::currentMSecsSinceEpoch() - last->second <
+         SELF::minimumCleanupIntervalMsecs))
+    {
+      Logger::Info(
+        "RestClientCache::LaunchCleanup: cache was cleaned up recently, skipping.");
+      return;
+    }
 
-  if (string::npos == expiresEnd)
-  {
-    throw exceptions::RMSInvalidArgumentException("Bad fileName");
-  }
+    // already queued
+    if (!SELF::pendingCleanups.insert(request).second) return;
 
-  auto strExpires = fileName.substr(nExpiresOffset, expiresEnd - expiresStart);
+    // the running thread will pick it up
+    if (SELF::cleanupRunning) return;
 
-  SELF::ReplaceBackNotAllowedCharactersInDateTime(strExpires);
+    SELF::cleanupRunning = true;
+  }
 
-  return common::DateTime::fromString(strExpires.c_str(), Qt::ISODate);
+  thread(&SELF::RunCleanups).detach();
 }
 
-// delete the file
-void RestClientCache::DeleteCacheFile(const string& fileName)
+// runs the queued cleanups, one at a time, on the maintenance thread
+void RestClientCache::RunCleanups()
 {
-  auto filePath = SELF::cacheFolderName + fileName;
-
-  try
+  for (;;)
   {
-    auto fileSystem = platform::filesystem::IFileSystem::Create();
-    fileSystem->DeleteLocalStorageFile(filePath);
-  }
-  catch (exceptions::RMSException)
-  {
-    Logger::Warning(
-      "RestClientCache::DeleteCacheFile: exception while deleting a file \"%s\".",
-      fileName.data());
+    CleanupRequest request;
 
-    //        LogException(LOG_MESSAGE_WARNING);
-    // not fatal
-  }
-}
+    {
+      common::MutexLocker lock(&SELF::cleanupMutex);
 
-// delete if the file is expired
-bool RestClientCache::DeleteIfExpired(
-  const string& cacheName, const string& fileName)
-{
-  auto expires = SELF::GetExpiryTimeFromFileName(cacheName, fileName);
+      if (SELF::pendingCleanups.empty())
+      {
+        SELF::cleanupRunning = false;
+        return;
+      }
 
-  if (expires.isNull()) return false;
+      request = *SELF::pendingCleanups.begin();
+      SELF::pendingCleanups.erase(SELF::pendingCleanups.begin());
+      SELF::lastCleanups[request] = common::DateTime::currentMSecsSinceEpoch();
+    }
 
-  common::DateTime now = common::DateTime::currentDateTime();
+    try
+    {
+      Logger::Info("RestClientCache::RunCleanups: cleanup started.");
 
-  if (now > expires)
-  {
-    SELF::DeleteCacheFile(fileName);
-    return true;
-  }
-  else
-  {
-    return false;
+      SELF::DeleteLegacyCacheFiles();
+
+      // drop the expired entries and keep at most the maximum number of
+      // entries allowed in cache
+      RestClientCacheStore::Get(request.second).Cleanup(
+        request.first, SELF::GetCacheMaximumFiles(request.first));
+    }
+    catch (exceptions::RMSException)
+    {
+      Logger::Warning(
+        "RestClientCache::RunCleanups: exception while cache cleanup.");
+    }
+    catch (rmscrypto::exceptions::RMSCryptoException& e)
+    {
+      Logger::Warning(
+        "RestClientCache::RunCleanups: exception while work with crypto: \"%s\"",
+        e.what());
+    }
+    Logger::Info("RestClientCache::RunCleanups: cleanup finished.");
   }
 }
 
-// cleanup procedure
-void RestClientCache::LaunchCleanup(const string& cacheName)
+// deletes the files written by the previous, file per entry, cache layout
+void RestClientCache::DeleteLegacyCacheFiles()
 {
-  // do cleanup in a separate thread
-  auto result = async([cacheName]()
-      {
-        // need to lock as we don't want to delete the file while consuming it.
-        lock_guard<mutex>locker(SELF::cacheMutex);
-        try
-        {
-          Logger::Info("RestClientCache::LaunchCleanup: cleanup started.");
-
-
-          auto pFileSystem = platform::filesystem::IFileSystem::Create();
-
-          // get the pattern of all files in the cache
-          auto fileNamePattern =
-            SELF::GetFileName(cacheName,
-                              string(),
-                              nullptr,
-                              0,
-                              string(),
-                              true,
-                              true);
-
-          // get the maximum number of files allowed in cache
-          auto nMaximumFiles = SELF::GetCacheMaximumFiles(cacheName);
-
-          // enumerate all files of the cache and returns the filenames ordered
-          // by modified date in descending order
-          auto allFileNames =
-            pFileSystem->QueryLocalStorageFiles(cacheName, fileNamePattern);
-
-          // go through the most recent nMaximumFiles or all the files
-          for (std::size_t iFileName = 0;
-               (iFileName < nMaximumFiles) && (iFileName < allFileNames.size());
-               ++iFileName)
-          {
-            try
-            {
-              if (SELF::DeleteIfExpired(cacheName, allFileNames[iFileName]))
-              {
-                Logger::Info(
-                  "RestClientCache::LaunchCleanup: deleted expired cache file \"%s\".",
-                  allFileNames[iFileName].c_str());
-
-// as we've deleted an expired file, there is one more slot
-// left, so we need to increment maximum files number
-                ++nMaximumFiles;
-              }
-            }
-            catch (exceptions::RMSException)
-            {
-              //
-              //
-              //
-              Logger::Warning(
-                "RestClientCache::DeleteCacheFile: exception while checking if the file was expired \"%s\".",
-                allFileNames[iFileName].c_str());
-
-              //                    LogException(LOG_MESSAGE_WARNING);
-
-              // not fatal, should continue with the next file
-            }
-          }
-
-          // delete all the older ones
-          for (auto iFileName = nMaximumFiles; iFileName < allFileNames.size();
-               ++iFileName)
-          {
-            try
-            {
-              SELF::DeleteCacheFile(allFileNames[iFileName].c_str());
-
-              //
-              Logger::Info(
-                "RestClientCache::LaunchCleanup: deleted old cache file \"%s\".",
-                allFileNames[iFileName].c_str());
-            }
-            catch (exceptions::RMSException)
-            {
-              //
-              //
-              //
-              Logger::Warning(
-                "RestClientCache::DeleteCacheFile: exception while deleting a file \"%s\".",
-                allFileNames[iFileName].c_str());
-
-              //                    LogException(LOG_MESSAGE_WARNING);
-
-              // not fatal, should continue with the next file
-            }
-          }
-        }
-        catch (exceptions::RMSException)
-        {
-          Logger::Warning(
-            "RestClientCache::DeleteCacheFile: exception while cache cleanup.");
-        }
-        Logger::Info("RestClientCache::LaunchCleanup: cleanup finished.");
-      });
+  static std::atomic<bool> deleted(false);
+
+  if (deleted.exchange(true)) return;
 
-  result.get();
+  auto pFileSystem = platform::filesystem::IFileSystem::Create();
+  auto fileNames   = pFileSystem->QueryLocalStorageFiles(
+    RestClientCacheStore::GetFolderName(), "*-*=*");
+
+  for (auto& fileName : fileNames)
+  {
+    pFileSystem->DeleteLocalStorageFile(
+      RestClientCacheStore::GetFolderName() + fileName);
+  }
 }
 
 // cleanup if needed
-void RestClientCache::CleanupIfNeeded(const string& cacheName)
+void RestClientCache::CleanupIfNeeded(const string& cacheName, CacheType type)
 {
   try
   {
-    // Note: We are ignoring the race conditions on accessing the counter. It is
-    // ok if 2 threads
-    // launch the cleanup procedure. It will affect the performance a little but
-    // nothing more.
+    // the counters are kept in memory and only persisted every few stores, so
+    // that a store doesn't write the settings file
+    bool launchCleanup    = false;
+    int  counterToPersist = -1;
+
+    {
+      common::MutexLocker lock(&SELF::cleanupMutex);
+
+      auto counter = SELF::cleanupCounters.find(cacheName);
+
+      if (counter == SELF::cleanupCounters.end())
+      {
+        counter = SELF::cleanupCounters.insert(
+          make_pair(cacheName, SELF::GetCacheCleanupCounter(cacheName))).first;
+      }
+
+      if (counter->second <= 0)
+      {
+        // reset the counter before starting cleanup
+        counter->second  = SELF::GetCacheCleanupFrequency(cacheName);
+        counterToPersist = counter->second;
+        launchCleanup    = true;
+      }
+      else
+      {
+        // decrement the counter
+        --counter->second;
 
-    int nCleanupCounter = SELF::GetCacheCleanupCounter(cacheName);
+        if (counter->second % SELF::cleanupCounterPersistInterval == 0)
+        {
+          counterToPersist = counter->second;
+        }
+      }
+    }
 
-    if (nCleanupCounter <= 0)
+    if (counterToPersist >= 0)
     {
-      // reset the counter before starting cleanup
-      SELF::SetCacheCleanupCounter(cacheName,
-                                   SELF::GetCacheCleanupFrequency(cacheName));
+      SELF::SetCacheCleanupCounter(cacheName, counterToPersist);
+    }
 
+    if (launchCleanup)
+    {
       Logger::Info("RestClientCache::CleanupIfNeeded: cleanup needed.");
 
       // now start the cleanup
-      SELF::LaunchCleanup(cacheName);
-    }
-    else
-    {
-      // decrement the counter
-      SELF::SetCacheCleanupCounter(cacheName, nCleanupCounter - 1);
+      SELF::LaunchCleanup(cacheName, type);
     }
   }
   catch (exceptions::RMSException)
   {
     Logger::Warning(
-      "RestClientCache::DeleteCacheFile: exception while checking if cleanup is needed.");
-
-    //        LogException(LOG_MESSAGE_WARNING);
+      "RestClientCache::CleanupIfNeeded: exception while checking if cleanup is needed.");
   }
 }
 
@@ -759,8 +541,7 @@ string RestClientCache::GetCacheSettingName(
   return cacheName + "_" + setting;
 }
 
-// replace '/' or '+' character in the given base64 by '-' such that we can
-// use it as a file name
+// replace '/' or '+' character in the given base64 by '-'
 void RestClientCache::ReplaceNotAllowedCharactersInBase64(
   common::ByteArray& strBase64)
 {
@@ -773,59 +554,6 @@ void RestClientCache::ReplaceNotAllowedCharactersInBase64(
   }
 }
 
-// replace ':' character in the given datetime by '_' such that we can use it
-// as a file name
-void RestClientCache::ReplaceNotAllowedCharactersInDateTime(string& strDate)
-{
-  for (size_t iChar = 0; iChar < strDate.size(); ++iChar)
-  {
-    if (':' == strDate[iChar])
-    {
-      strDate[iChar] = '_';
-    }
-  }
-}
-
-// replace '_' character in the given datetime by ':' such that we can parse
-// it
-void RestClientCache::ReplaceBackNotAllowedCharactersInDateTime(
-  string& strDate)
-{
-  for (size_t iChar = 0; iChar < strDate.size(); ++iChar)
-  {
-    if ('_' == strDate[iChar])
-    {
-      strDate[iChar] = ':';
-    }
-  }
-}
-
-// replace special characters that are not allowed in filename
-void RestClientCache::ReplaceNotAllowedCharactersInEmail(string& strEmail)
-{
-  for (size_t iChar = 0; iChar < strEmail.size(); ++iChar)
-  {
-    switch (strEmail[iChar])
-    {
-    case '|':
-      strEmail[iChar] = ',';
-      break;
-
-    case '*':
-      strEmail[iChar] = ';';
-      break;
-
-    case '?':
-      strEmail[iChar] = '[';
-      break;
-
-    case '/':
-      strEmail[iChar] = ']';
-      break;
-    }
-  }
-}
-
 shared_ptr<IRestClientCache>IRestClientCache::Create(CacheType type)
 {
   return make_shared<RestClientCache>(type);
@@ -9,8 +9,10 @@
 #ifndef _RMS_LIB_RESTCLIENTCACHE_H_
 #define _RMS_LIB_RESTCLIENTCACHE_H_
 
+#include <map>
+#include <set>
 #include "IRestClientCache.h"
-#include <mutex>
+#include "RestClientCacheStore.h"
 
 namespace rmscore {
 namespace restclients {
@@ -49,52 +51,41 @@ public:
     const std::string& ttl,
     const std::string& dnsClientResult) override;
 
-  // returns if the cache is enabled
+  // returns if the cache lookups are disabled by the test hook setting; the
+  // setting is read once, at the first call
   static bool IsCacheLookupDisableTestHookOn();
 
 private:
   CacheType m_type;
 
-  // As the cache is per app, we don't use a global (i.e. named mutex). An app
-  // should run in a single process.
-  // Therefore a process-wise mutex should be ok.
-  static std::mutex cacheMutex;
-
-  // the folder name, where we store the cache
-  static const std::string cacheFolderName;
-
   // hashes the key and returns base64 of the hash
   static common::ByteArray HashKey(const uint8_t *pbKey,
                                    size_t         cbKey);
 
-  // gets the filename from the cache name, tag and key
-  static std::string GetFileName(
+  // gets the key of the entry in the store from the cache name, tag and key
+  static RestClientCacheStore::Key GetStoreKey(
     const std::string& cacheName,
     const std::string& tag,
     const uint8_t     *pbKey,
     size_t             cbKey,
-    const std::string& expires,
     bool               pattern,
     bool               useHash);
 
-  // parses the expiry time from the filename
-  static common::DateTime GetExpiryTimeFromFileName(
-    const std::string& cacheName,
-    const std::string& fileName);
-
-  // delete the file
-  static void DeleteCacheFile(const std::string& fileName);
+  typedef std::pair<std::string, CacheType> CleanupRequest;
 
-  // delete if the file is expired
-  static bool DeleteIfExpired(
-    const std::string& cacheName,
-    const std::string& fileName);
+  // queues the cleanup of the cache for the background maintenance thread
+  static void LaunchCleanup(const std::string& cacheName,
+                            CacheType          type);
 
-  // cleanup procedure
-  static void LaunchCleanup(const std::string& cacheName);
+  // runs the queued cleanups, one at a time, on the maintenance thread
+  static void RunCleanups();
 
   // cleanup if needed
-  static void CleanupIfNeeded(const std::string& cacheName);
+  static void CleanupIfNeeded(const std::string& cacheName,
+                              CacheType          type);
+
+  // deletes the files written by the previous, file per entry, cache layout
+  static void DeleteLegacyCacheFiles();
 
   // cache settings name constants
   static const std::string cacheSettingsContainerName;
@@ -105,6 +96,19 @@ private:
   static const int defaultCleanupFrequency = 100;
   static const int defaultMaximumFiles     = 1000;
 
+  // the counters are persisted every so many stores
+  static const int cleanupCounterPersistInterval = 10;
+
+  // minimum time between two cleanups of the same cache
+  static const int64_t minimumCleanupIntervalMsecs = 10 * 1000;
+
+  // cleanup state shared by all the caches, guarded by cleanupMutex
+  static common::Mutex cleanupMutex;
+  static std::map<std::string, int> cleanupCounters;
+  static std::set<CleanupRequest> pendingCleanups;
+  static std::map<CleanupRequest, int64_t> lastCleanups;
+  static bool cleanupRunning;
+
   // gets the cache cleanup frequency
   static int  GetCacheCleanupFrequency(const std::string& cacheName);
 
@@ -123,20 +127,8 @@ private:
     const std::string& cacheName,
     const std::string& setting);
 
-  // replace '/' or '+' character in the given base64 by '-' such that we can
-  // use it as a file name
+  // replace '/' or '+' character in the given base64 by '-'
   static void ReplaceNotAllowedCharactersInBase64(common::ByteArray& strBase64);
-
-  // replace ':' character in the given datetime by '_' such that we can use it
-  // as a file name
-  static void ReplaceNotAllowedCharactersInDateTime(std::string& strDate);
-
-  // replace '_' character in the given datetime by ':' such that we can parse
-  // it
-  static void ReplaceBackNotAllowedCharactersInDateTime(std::string& strDate);
-
-  // replace special characters that are not allowed in filename
-  static void ReplaceNotAllowedCharactersInEmail(std::string& strEmail);
 };
 } // namespace restclients
 } // namespace rmscore
@@ -0,0 +1,1045 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+#include <CryptoAPI.h>
+#include <RMSCryptoExceptions.h>
+#include "RestClientCacheStore.h"
+#include "../ModernAPI/RMSExceptions.h"
+#include "../Platform/Filesystem/IFileSystem.h"
+#include "../Platform/Logger/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QLockFile>
+#include <QStandardPaths>
+
+#ifdef Q_OS_WIN32
+# include <windows.h>
+#else // ifdef Q_OS_WIN32
+# include <sys/stat.h>
+#endif // ifdef Q_OS_WIN32
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+namespace rmscore {
+namespace restclients {
+static const char indexKeySeparator = '\x1f';
+
+static void PutUInt32(common::ByteArray& buffer, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+static void PutInt64(common::ByteArray& buffer, int64_t value)
+{
+  for (int i = 0; i < 8; ++i) {
+    buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+  }
+}
+
+static uint32_t GetUInt32(const uint8_t *pb)
+{
+  return static_cast<uint32_t>(pb[0]) |
+         (static_cast<uint32_t>(pb[1]) << 8) |
+         (static_cast<uint32_t>(pb[2]) << 16) |
+         (static_cast<uint32_t>(pb[3]) << 24);
+}
+
+static int64_t GetInt64(const uint8_t *pb)
+{
+  uint64_t value = 0;
+
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | pb[i];
+  }
+  return static_cast<int64_t>(value);
+}
+
+// FNV-1a, only used to detect torn or corrupted records
+static uint32_t Checksum(const uint8_t *pb, size_t cb)
+{
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < cb; ++i) {
+    hash ^= pb[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// holds the lock file of a log for the scope, the processes sharing the log
+// append and compact one at a time
+class LogFileLocker {
+public:
+
+  LogFileLocker(QLockFile& lockFile, int timeoutMsecs)
+    : m_lockFile(lockFile)
+    , m_locked(lockFile.tryLock(timeoutMsecs))
+  {}
+
+  ~LogFileLocker()
+  {
+    if (m_locked) m_lockFile.unlock();
+  }
+
+  bool IsLocked() const
+  {
+    return m_locked;
+  }
+
+private:
+
+  QLockFile& m_lockFile;
+  bool m_locked;
+};
+
+const string& RestClientCacheStore::GetFolderName()
+{
+  static const string cacheFolderName = (QStandardPaths::writableLocation(
+                                           QStandardPaths::HomeLocation) +
+                                         "/.ms-ad/").toStdString();
+
+  return cacheFolderName;
+}
+
+RestClientCacheStore& RestClientCacheStore::Get(IRestClientCache::CacheType type)
+{
+  // NOTE: the stores are leaked deliberately, see ProtectionPolicy's cache.
+  static RestClientCacheStore *plainStore = new RestClientCacheStore(
+    GetFolderName() + "RestClientCache.dat", false);
+  static RestClientCacheStore *encryptedStore = new RestClientCacheStore(
+    GetFolderName() + "RestClientCacheEncrypted.dat", true);
+
+  return type == IRestClientCache::CACHE_ENCRYPTED ? *encryptedStore :
+         *plainStore;
+}
+
+RestClientCacheStore::RestClientCacheStore(const string& filePath,
+                                           bool          encrypted)
+  : m_filePath(filePath)
+  , m_encrypted(encrypted)
+  , m_opened(false)
+  , m_fileLock(new QLockFile((filePath + ".lock").c_str()))
+  , m_logEnd(0)
+  , m_deadBytes(0)
+  , m_sequence(0)
+  , m_compactionRunning(false)
+  , m_valuesSize(0)
+{
+  m_fileState.exists = false;
+  m_fileState.id     = 0;
+  m_fileState.size   = 0;
+}
+
+RestClientCacheStore::~RestClientCacheStore()
+{
+  // the shared stores are never destroyed, the others wait for their
+  // compaction thread
+  while (m_compactionRunning.load()) {
+    this_thread::sleep_for(chrono::milliseconds(10));
+  }
+}
+
+common::StringArray RestClientCacheStore::Lookup(const Key& key)
+{
+  lock_guard<mutex> locker(m_mutex);
+
+  OpenIfNeeded();
+
+  common::StringArray vResponses;
+  string value;
+  auto   now = Now();
+
+  if (!key.IsPattern()) {
+    auto i = m_index.find(IndexKey(key));
+
+    if (i == m_index.end()) return vResponses;
+
+    if (IsExpired(i->second, now)) {
+      Remove(i);
+    } else if (GetValue(i, value)) {
+      vResponses.push_back(value);
+    }
+    return vResponses;
+  }
+
+  for (auto i = m_index.begin(); i != m_index.end();) {
+    if (!Matches(i->first, key)) {
+      ++i;
+      continue;
+    }
+
+    if (IsExpired(i->second, now)) {
+      auto expired = i++;
+      Remove(expired);
+      continue;
+    }
+
+    if (GetValue(i, value)) {
+      vResponses.push_back(value);
+    }
+    ++i;
+  }
+  return vResponses;
+}
+
+void RestClientCacheStore::Store(const Key               & key,
+                                 const string            & expires,
+                                 const common::ByteArray & value)
+{
+  lock_guard<mutex> locker(m_mutex);
+
+  OpenIfNeeded();
+
+  LogFileLocker fileLocker(*m_fileLock, fileLockTimeoutMsecs);
+
+  if (!fileLocker.IsLocked()) {
+    throw exceptions::RMSStreamException("Could not lock the cache file.");
+  }
+
+  SyncWithFile();
+  Append(IndexKey(key), ParseExpires(expires), value, false);
+  FlushLog();
+
+  if (NeedsCompaction()) LaunchCompaction();
+}
+
+void RestClientCacheStore::Cleanup(const string& cacheName,
+                                   size_t        maximumEntries)
+{
+  struct Candidate {
+    string   indexKey;
+    uint64_t sequence;
+    bool     expired;
+  };
+
+  vector<Candidate> candidates;
+
+  {
+    lock_guard<mutex> locker(m_mutex);
+
+    OpenIfNeeded();
+
+    // only the index is scanned here, nothing is read or written
+    auto now = Now();
+    Key  cacheKey = { cacheName, string(), string() };
+    vector<Candidate> live;
+
+    for (auto& entry : m_index) {
+      if (!Matches(entry.first, cacheKey)) continue;
+
+      Candidate candidate = { entry.first, entry.second.sequence,
+                              IsExpired(entry.second, now) };
+
+      if (candidate.expired) {
+        candidates.push_back(candidate);
+      } else {
+        live.push_back(candidate);
+      }
+    }
+
+    if (live.size() > maximumEntries) {
+      // keep the most recently stored ones
+      sort(live.begin(), live.end(), [](const Candidate& l,
+                                        const Candidate& r) {
+            return l.sequence > r.sequence;
+          });
+      candidates.insert(candidates.end(), live.begin() + maximumEntries,
+                        live.end());
+    }
+  }
+
+  size_t dropped = 0;
+
+  for (size_t begin = 0; begin < candidates.size(); begin += cleanupBatchSize) {
+    // let the waiting lookups and stores in between the batches
+    if (begin > 0) this_thread::yield();
+
+    lock_guard<mutex> locker(m_mutex);
+
+    // the log was lost by a failed compaction
+    if (!m_opened) return;
+
+    LogFileLocker fileLocker(*m_fileLock, fileLockTimeoutMsecs);
+
+    if (!fileLocker.IsLocked()) {
+      Logger::Warning("RestClientCacheStore::Cleanup: could not lock the cache file.");
+      return;
+    }
+
+    // the sequences change if the log is reloaded, the entries are then
+    // skipped
+    SyncWithFile();
+
+    auto end = min(begin + cleanupBatchSize, candidates.size());
+    bool appended = false;
+
+    for (size_t c = begin; c < end; ++c) {
+      auto i = m_index.find(candidates[c].indexKey);
+
+      // skip the entries which were stored again since the scan
+      if ((i == m_index.end()) ||
+          (i->second.sequence != candidates[c].sequence)) continue;
+
+      if (candidates[c].expired) {
+        Remove(i);
+      } else {
+        Append(candidates[c].indexKey, 0, common::ByteArray(), true);
+        appended = true;
+      }
+      ++dropped;
+    }
+
+    if (appended) FlushLog();
+  }
+
+  Logger::Info("RestClientCacheStore::Cleanup: dropped %d entries.",
+               static_cast<int>(dropped));
+
+  lock_guard<mutex> locker(m_mutex);
+
+  if (m_opened && NeedsCompaction()) LaunchCompaction();
+}
+
+void RestClientCacheStore::OpenIfNeeded()
+{
+  if (m_opened) return;
+
+  platform::filesystem::IFileSystem::CreateDirectory(
+    QFileInfo(m_filePath.c_str()).absolutePath().toStdString());
+
+  // another process may be appending or compacting
+  LogFileLocker fileLocker(*m_fileLock, fileLockTimeoutMsecs);
+
+  if (!fileLocker.IsLocked()) {
+    throw exceptions::RMSStreamException("Could not lock the cache file.");
+  }
+
+  m_stream    = OpenStream(m_filePath, false);
+  m_fileState = GetFileState(m_filePath);
+  LoadIndex();
+  m_opened = true;
+}
+
+rmscrypto::api::SharedStream RestClientCacheStore::OpenStream(
+  const string& filePath,
+  bool          truncate)
+{
+  if (truncate || !QFile::exists(filePath.c_str())) {
+    ofstream create(filePath, ios_base::out | ios_base::binary | ios_base::trunc);
+  }
+
+  auto fs = make_shared<fstream>(filePath,
+                                 ios_base::in | ios_base::out | ios_base::binary);
+
+  if (!fs->is_open()) {
+    throw exceptions::RMSStreamException("Could not open the cache file.");
+  }
+
+  auto backingStream = rmscrypto::api::CreateStreamFromStdStream(
+    static_pointer_cast<iostream>(fs));
+
+  if (!m_encrypted) return backingStream;
+
+  // the key is named after the store, not the file, so that it survives
+  // compactions which write into a temporary file
+  auto stream = rmscrypto::api::CreateCryptoStreamWithAutoKey(
+    rmscrypto::api::CIPHER_MODE_CBC4K, m_filePath, backingStream);
+
+  if (!stream) {
+    throw exceptions::RMSStreamException("Could not create the cache stream.");
+  }
+  return stream;
+}
+
+void RestClientCacheStore::LoadIndex()
+{
+  m_index.clear();
+  m_deadBytes = 0;
+  m_logEnd    = 0;
+  InvalidateValues();
+
+  ScanLog(0);
+}
+
+void RestClientCacheStore::ScanLog(uint64_t pos)
+{
+  uint64_t size    = LogSize();
+  uint64_t skipped = 0;
+  auto     now     = Now();
+
+  while (pos < size) {
+    string   indexKey;
+    uint32_t flags, cbValue;
+    int64_t  expires;
+    uint64_t cbRecord;
+
+    if (!ReadRecordHeader(pos, size, indexKey, flags, cbValue, expires,
+                          cbRecord)) {
+      // a corrupted record, or the torn tail of a crashed append; the log
+      // is never truncated, the bytes are dead space until the next
+      // compaction
+      uint64_t next = FindRecordStart(pos + 1, size);
+
+      skipped     += next - pos;
+      m_deadBytes += next - pos;
+      pos          = next;
+      continue;
+    }
+
+    auto i = m_index.find(indexKey);
+
+    if (i != m_index.end()) {
+      InvalidateValue(indexKey);
+      m_deadBytes += i->second.size;
+      m_index.erase(i);
+    }
+
+    IndexEntry entry = { pos, static_cast<uint32_t>(cbRecord), cbValue,
+                         expires, m_sequence++ };
+
+    if ((flags & recordTombstone) || IsExpired(entry, now)) {
+      m_deadBytes += cbRecord;
+    } else {
+      m_index[indexKey] = entry;
+    }
+    pos += cbRecord;
+  }
+
+  if (skipped > 0) {
+    Logger::Warning(
+      "RestClientCacheStore::ScanLog: skipped %d corrupted bytes in the log.",
+      static_cast<int>(skipped));
+  }
+  m_logEnd = size;
+}
+
+uint64_t RestClientCacheStore::LogSize()
+{
+  uint64_t size = m_stream->Size();
+
+  if (!m_encrypted || (size == 0)) return size;
+
+  // the final block is decrypted to find where its padding starts
+  uint64_t finalBlock = (size - 1) / encryptedBlockSize * encryptedBlockSize;
+  common::ByteArray block(static_cast<size_t>(encryptedBlockSize));
+
+  try
+  {
+    m_stream->Seek(finalBlock);
+    return finalBlock + m_stream->Read(block.data(), block.size());
+  }
+  catch (rmscrypto::exceptions::RMSCryptoException)
+  {
+    // a crash tore the final block while it was rewritten
+    return DropTornBlock(finalBlock);
+  }
+}
+
+uint64_t RestClientCacheStore::DropTornBlock(uint64_t finalBlock)
+{
+  Logger::Warning(
+    "RestClientCacheStore::DropTornBlock: dropping the torn final block of the log.");
+
+  // the stream can't append after a block it can't decrypt, so unlike the
+  // unencrypted log the torn bytes don't stay as dead space
+  uint64_t lastBlock = finalBlock > 0 ? finalBlock - encryptedBlockSize : 0;
+  common::ByteArray block;
+
+  try
+  {
+    if (finalBlock > 0) {
+      block.resize(static_cast<size_t>(encryptedBlockSize));
+      m_stream->Seek(lastBlock);
+      block.resize(static_cast<size_t>(m_stream->Read(block.data(),
+                                                      block.size())));
+    }
+    m_stream.reset();
+
+    if (!QFile::resize(m_filePath.c_str(), static_cast<qint64>(lastBlock))) {
+      CloseLog();
+      throw exceptions::RMSStreamException("Could not truncate the cache file.");
+    }
+    ReopenLog();
+
+    if (!block.empty()) {
+      m_stream->Seek(lastBlock);
+      m_stream->Write(block.data(), block.size());
+      FlushLog();
+    }
+  }
+  catch (rmscrypto::exceptions::RMSCryptoException& e)
+  {
+    CloseLog();
+    throw exceptions::RMSStreamException(e.what());
+  }
+
+  m_fileState = GetFileState(m_filePath);
+  return lastBlock + block.size();
+}
+
+bool RestClientCacheStore::ReadRecordHeader(uint64_t pos,
+                                            uint64_t size,
+                                            string & indexKey,
+                                            uint32_t& flags,
+                                            uint32_t& cbValue,
+                                            int64_t & expires,
+                                            uint64_t& cbRecord)
+{
+  uint8_t header[headerSize];
+
+  if (pos + headerSize + trailerSize > size) return false;
+
+  m_stream->Seek(pos);
+
+  if ((m_stream->Read(header, headerSize) != headerSize) ||
+      (GetUInt32(header) != recordMagic)) return false;
+
+  flags   = GetUInt32(header + 4);
+  cbValue = GetUInt32(header + 12);
+  expires = GetInt64(header + 16);
+
+  uint32_t cbKey = GetUInt32(header + 8);
+  cbRecord = static_cast<uint64_t>(headerSize) + cbKey + cbValue + trailerSize;
+
+  if (pos + cbRecord > size) return false;
+
+  common::ByteArray record(static_cast<size_t>(cbRecord - headerSize));
+
+  if (m_stream->Read(record.data(), record.size()) !=
+      static_cast<int64_t>(record.size())) return false;
+
+  uint32_t checksum = Checksum(header + 4, headerSize - 4) ^
+                      Checksum(record.data(), cbKey + cbValue);
+
+  if (GetUInt32(&record[cbKey + cbValue]) != checksum) return false;
+
+  indexKey.assign(record.begin(), record.begin() + cbKey);
+  return true;
+}
+
+uint64_t RestClientCacheStore::FindRecordStart(uint64_t pos, uint64_t size)
+{
+  static const uint8_t magic[4] = {
+    static_cast<uint8_t>(recordMagic),
+    static_cast<uint8_t>(recordMagic >> 8),
+    static_cast<uint8_t>(recordMagic >> 16),
+    static_cast<uint8_t>(recordMagic >> 24)
+  };
+  const uint64_t chunkSize = 64 * 1024;
+  common::ByteArray chunk;
+
+  while (pos + sizeof(magic) <= size) {
+    chunk.resize(static_cast<size_t>(min(chunkSize, size - pos)));
+    m_stream->Seek(pos);
+
+    if (m_stream->Read(chunk.data(), chunk.size()) !=
+        static_cast<int64_t>(chunk.size())) break;
+
+    auto found = search(chunk.begin(), chunk.end(), magic,
+                        magic + sizeof(magic));
+
+    if (found != chunk.end()) return pos + (found - chunk.begin());
+
+    // a magic may straddle two chunks
+    if (pos + chunk.size() >= size) break;
+    pos += chunk.size() - (sizeof(magic) - 1);
+  }
+  return size;
+}
+
+void RestClientCacheStore::SyncWithFile()
+{
+  auto state = GetFileState(m_filePath);
+
+  if (state.exists && (state.id == m_fileState.id) &&
+      (state.size == m_fileState.size)) return;
+
+  // another process appended to the log, or replaced it
+  bool appended = state.exists && m_fileState.exists &&
+                  (state.id == m_fileState.id) &&
+                  (state.size > m_fileState.size);
+
+  Logger::Info("RestClientCacheStore::SyncWithFile: the log was %s by another process.",
+               appended ? "appended to" : "replaced");
+
+  // the streams may hold stale buffers or blocks
+  ReopenLog();
+
+  if (appended) {
+    ScanLog(m_logEnd);
+  } else {
+    LoadIndex();
+  }
+  m_fileState = GetFileState(m_filePath);
+}
+
+void RestClientCacheStore::ReopenLog()
+{
+  m_stream.reset();
+
+  try
+  {
+    m_stream = OpenStream(m_filePath, false);
+  }
+  catch (exceptions::RMSException)
+  {
+    CloseLog();
+    throw;
+  }
+}
+
+void RestClientCacheStore::CloseLog()
+{
+  // start over from whatever is on disk at the next access
+  m_stream.reset();
+  m_index.clear();
+  InvalidateValues();
+  m_opened = false;
+}
+
+void RestClientCacheStore::FlushLog()
+{
+  m_stream->Flush();
+
+  // the encrypted stream counts the final block it wrote without its
+  // padding, and can't read the block back once it left its cache
+  if (m_encrypted) ReopenLog();
+
+  m_fileState = GetFileState(m_filePath);
+}
+
+void RestClientCacheStore::Append(const string           & indexKey,
+                                  int64_t                  expires,
+                                  const common::ByteArray& value,
+                                  bool                     tombstone)
+{
+  common::ByteArray record;
+  record.reserve(headerSize + indexKey.size() + value.size() + trailerSize);
+
+  PutUInt32(record, recordMagic);
+  PutUInt32(record, tombstone ? recordTombstone : 0);
+  PutUInt32(record, static_cast<uint32_t>(indexKey.size()));
+  PutUInt32(record, static_cast<uint32_t>(value.size()));
+  PutInt64(record, expires);
+  record.insert(record.end(), indexKey.begin(), indexKey.end());
+  record.insert(record.end(), value.begin(),    value.end());
+  PutUInt32(record, Checksum(&record[4], headerSize - 4) ^
+            Checksum(&record[headerSize], indexKey.size() + value.size()));
+
+  m_stream->Seek(m_logEnd);
+  m_stream->Write(record.data(), record.size());
+
+  InvalidateValue(indexKey);
+
+  auto i = m_index.find(indexKey);
+
+  if (i != m_index.end()) {
+    m_deadBytes += i->second.size;
+    m_index.erase(i);
+  }
+
+  if (tombstone) {
+    m_deadBytes += record.size();
+  } else {
+    IndexEntry entry = { m_logEnd, static_cast<uint32_t>(record.size()),
+                         static_cast<uint32_t>(value.size()), expires,
+                         m_sequence++ };
+    m_index[indexKey] = entry;
+  }
+  m_logEnd += record.size();
+}
+
+bool RestClientCacheStore::ReadValue(const IndexEntry & entry,
+                                     common::ByteArray& value)
+{
+  common::ByteArray record;
+  bool read = false;
+
+  try
+  {
+    read = ReadRecord(m_stream, entry, record);
+  }
+  catch (rmscrypto::exceptions::RMSCryptoException)
+  {
+    // another process appended to the encrypted log and rewrote its final
+    // block since the stream was opened; the records are still there
+    ReopenLog();
+
+    try
+    {
+      read = ReadRecord(m_stream, entry, record);
+    }
+    catch (rmscrypto::exceptions::RMSCryptoException)
+    {}
+  }
+
+  if (!read) {
+    Logger::Warning("RestClientCacheStore::ReadValue: could not read a record.");
+    return false;
+  }
+
+  uint32_t cbKey = GetUInt32(&record[8]);
+
+  value.assign(record.begin() + headerSize + cbKey,
+               record.begin() + headerSize + cbKey + entry.cbValue);
+  return true;
+}
+
+bool RestClientCacheStore::ReadRecord(rmscrypto::api::SharedStream stream,
+                                      const IndexEntry           & entry,
+                                      common::ByteArray          & record)
+{
+  record.resize(entry.size);
+  stream->Seek(entry.offset);
+
+  if ((stream->Read(record.data(), record.size()) !=
+       static_cast<int64_t>(record.size())) ||
+      (GetUInt32(record.data()) != recordMagic)) return false;
+
+  uint32_t cbKey = GetUInt32(&record[8]);
+  uint32_t cbData = cbKey + entry.cbValue;
+
+  if (headerSize + cbData + trailerSize != entry.size) return false;
+
+  return GetUInt32(&record[headerSize + cbData]) ==
+         (Checksum(&record[4], headerSize - 4) ^
+          Checksum(&record[headerSize], cbData));
+}
+
+void RestClientCacheStore::Remove(Index::iterator i)
+{
+  // expired records are skipped when the index is loaded, so there is no
+  // need for a tombstone
+  InvalidateValue(i->first);
+  m_deadBytes += i->second.size;
+  m_index.erase(i);
+}
+
+bool RestClientCacheStore::GetValue(Index::const_iterator i, string& value)
+{
+  auto cached = m_values.find(i->first);
+
+  if (cached != m_values.end()) {
+    // move it to the front of the LRU list
+    m_valuesLru.splice(m_valuesLru.begin(), m_valuesLru, cached->second.lru);
+    value = cached->second.value;
+    return true;
+  }
+
+  common::ByteArray record;
+
+  if (!ReadValue(i->second, record)) return false;
+
+  value.assign(record.begin(), record.end());
+  CacheValue(i->first, value);
+  return true;
+}
+
+void RestClientCacheStore::CacheValue(const string& indexKey,
+                                      const string& value)
+{
+  // too big to be worth keeping in memory
+  if (value.size() > maximumCachedValuesSize / 4) return;
+
+  m_valuesLru.push_front(indexKey);
+
+  CachedValue cached = { value, m_valuesLru.begin() };
+  m_values[indexKey] = cached;
+  m_valuesSize      += value.size();
+
+  while (m_values.size() > maximumCachedValues ||
+         m_valuesSize > maximumCachedValuesSize) {
+    string oldest = m_valuesLru.back();
+    InvalidateValue(oldest);
+  }
+}
+
+void RestClientCacheStore::InvalidateValue(const string& indexKey)
+{
+  auto cached = m_values.find(indexKey);
+
+  if (cached == m_values.end()) return;
+
+  m_valuesSize -= cached->second.value.size();
+  m_valuesLru.erase(cached->second.lru);
+  m_values.erase(cached);
+}
+
+void RestClientCacheStore::InvalidateValues()
+{
+  m_values.clear();
+  m_valuesLru.clear();
+  m_valuesSize = 0;
+}
+
+bool RestClientCacheStore::NeedsCompaction() const
+{
+  return m_deadBytes >= compactionMinimumDeadBytes &&
+         m_deadBytes * 2 >= m_logEnd;
+}
+
+void RestClientCacheStore::LaunchCompaction()
+{
+  if (m_compactionRunning.exchange(true)) return;
+
+  // the store outlives the process' threads, so the thread is detached
+  thread([this]() {
+      Compact();
+      m_compactionRunning.store(false);
+    }).detach();
+}
+
+void RestClientCacheStore::Compact()
+{
+  // a launched compaction and a direct call don't run together
+  lock_guard<mutex> compactionLocker(m_compactionMutex);
+
+  typedef pair<string, IndexEntry> Record;
+  vector<Record> snapshot;
+  FileState snapshotState;
+
+  {
+    lock_guard<mutex> locker(m_mutex);
+
+    if (!m_opened) return;
+
+    LogFileLocker fileLocker(*m_fileLock, fileLockTimeoutMsecs);
+
+    if (!fileLocker.IsLocked()) {
+      Logger::Warning("RestClientCacheStore::Compact: could not lock the cache file.");
+      return;
+    }
+
+    try
+    {
+      SyncWithFile();
+    }
+    catch (exceptions::RMSException)
+    {
+      Logger::Warning("RestClientCacheStore::Compact: could not read the cache file.");
+      return;
+    }
+
+    snapshot.assign(m_index.begin(), m_index.end());
+    snapshotState = m_fileState;
+  }
+
+  Logger::Info("RestClientCacheStore::Compact: compaction started.");
+
+  // copy the live records in the order they were stored
+  sort(snapshot.begin(), snapshot.end(), [](const Record& l, const Record& r) {
+        return l.second.sequence < r.second.sequence;
+      });
+
+  // one per process, the other processes may be compacting the same log
+  auto tmpPath = m_filePath + ".compact" +
+                 to_string(QCoreApplication::applicationPid());
+
+  try
+  {
+    // the records are copied without holding the locks, through a stream of
+    // their own; lookups and stores go on with m_stream meanwhile
+    auto in  = OpenStream(m_filePath, false);
+    auto out = OpenStream(tmpPath, true);
+
+    // the log was replaced between the snapshot and the opening
+    if (GetFileState(m_filePath).id != snapshotState.id) {
+      throw exceptions::RMSStreamException("The cache file was replaced.");
+    }
+
+    // maps the offsets in the log to the offsets in the new log
+    unordered_map<uint64_t, uint64_t> copied;
+    uint64_t pos = 0;
+    common::ByteArray record;
+
+    for (auto& r : snapshot) {
+      if (!ReadRecord(in, r.second, record)) continue;
+
+      out->Write(record.data(), record.size());
+      copied[r.second.offset] = pos;
+      pos += record.size();
+    }
+    in.reset();
+
+    lock_guard<mutex> locker(m_mutex);
+
+    if (!m_opened) throw exceptions::RMSStreamException("The cache was closed.");
+
+    LogFileLocker fileLocker(*m_fileLock, fileLockTimeoutMsecs);
+
+    if (!fileLocker.IsLocked()) {
+      throw exceptions::RMSStreamException("Could not lock the cache file.");
+    }
+
+    SyncWithFile();
+
+    // another process compacted the log meanwhile, the copy is stale
+    if (m_fileState.id != snapshotState.id) {
+      throw exceptions::RMSStreamException("The cache file was replaced.");
+    }
+
+    // the entries of the snapshot which are still live keep their copy, the
+    // records stored meanwhile are copied now
+    vector<Record> live(m_index.begin(), m_index.end());
+
+    sort(live.begin(), live.end(), [](const Record& l, const Record& r) {
+          return l.second.sequence < r.second.sequence;
+        });
+
+    Index newIndex;
+
+    for (auto& r : live) {
+      auto entry = r.second;
+      auto c     = copied.find(entry.offset);
+
+      if (c != copied.end()) {
+        entry.offset = c->second;
+      } else {
+        if (!ReadRecord(m_stream, entry, record)) continue;
+
+        out->Write(record.data(), record.size());
+        entry.offset = pos;
+        pos         += record.size();
+      }
+      newIndex[r.first] = entry;
+    }
+    out->Flush();
+    out.reset();
+
+    // swap the files in one step, the other processes see either the old
+    // log or the new one; the log is closed first as Windows doesn't replace
+    // open files
+    m_stream.reset();
+
+    bool replaced = ReplaceFile(tmpPath, m_filePath);
+
+    try
+    {
+      m_stream = OpenStream(m_filePath, false);
+    }
+    catch (exceptions::RMSException)
+    {
+      CloseLog();
+      throw;
+    }
+
+    if (!replaced) {
+      throw exceptions::RMSStreamException("Could not replace the cache file.");
+    }
+
+    m_fileState = GetFileState(m_filePath);
+    m_index.swap(newIndex);
+    m_logEnd    = pos;
+    m_deadBytes = 0;
+
+    Logger::Info("RestClientCacheStore::Compact: compaction finished.");
+  }
+  catch (exceptions::RMSException)
+  {
+    Logger::Warning("RestClientCacheStore::Compact: exception while compacting.");
+    QFile::remove(tmpPath.c_str());
+  }
+  catch (rmscrypto::exceptions::RMSCryptoException& e)
+  {
+    Logger::Warning(
+      "RestClientCacheStore::Compact: exception while work with crypto: \"%s\"",
+      e.what());
+    QFile::remove(tmpPath.c_str());
+  }
+}
+
+string RestClientCacheStore::IndexKey(const Key& key)
+{
+  return key.cacheName + indexKeySeparator + key.tag + indexKeySeparator +
+         key.hash;
+}
+
+bool RestClientCacheStore::Matches(const string& indexKey, const Key& key)
+{
+  auto tagStart  = indexKey.find(indexKeySeparator);
+  auto hashStart = indexKey.find(indexKeySeparator, tagStart + 1);
+
+  if ((string::npos == tagStart) || (string::npos == hashStart)) return false;
+
+  if (indexKey.compare(0, tagStart, key.cacheName) != 0) return false;
+
+  if (!key.tag.empty() &&
+      (indexKey.compare(tagStart + 1, hashStart - tagStart - 1, key.tag) != 0)) {
+    return false;
+  }
+
+  return key.hash.empty() || indexKey.compare(hashStart + 1, string::npos,
+                                              key.hash) == 0;
+}
+
+int64_t RestClientCacheStore::ParseExpires(const string& expires)
+{
+  if (expires.empty()) return 0;
+
+  auto dateTime = common::DateTime::fromString(expires.c_str(), Qt::ISODate);
+
+  return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+}
+
+bool RestClientCacheStore::IsExpired(const IndexEntry& entry, int64_t now)
+{
+  return entry.expires != 0 && now > entry.expires;
+}
+
+int64_t RestClientCacheStore::Now()
+{
+  return common::DateTime::currentMSecsSinceEpoch();
+}
+
+RestClientCacheStore::FileState RestClientCacheStore::GetFileState(
+  const string& filePath)
+{
+  FileState state = { false, 0, 0 };
+  QFileInfo fileInfo(filePath.c_str());
+
+  if (!fileInfo.exists()) return state;
+
+  state.exists = true;
+  state.size   = static_cast<uint64_t>(fileInfo.size());
+
+#ifdef Q_OS_WIN32
+  // a compaction renames a new file over the log, which keeps its own
+  // creation time
+  state.id = static_cast<uint64_t>(fileInfo.created().toMSecsSinceEpoch());
+#else // ifdef Q_OS_WIN32
+  struct stat st;
+
+  if (::stat(filePath.c_str(), &st) == 0) {
+    state.id = static_cast<uint64_t>(st.st_ino);
+  }
+#endif // ifdef Q_OS_WIN32
+  return state;
+}
+
+bool RestClientCacheStore::ReplaceFile(const string& from, const string& to)
+{
+#ifdef Q_OS_WIN32
+  return MoveFileExW(QString::fromStdString(from).toStdWString().c_str(),
+                     QString::fromStdString(to).toStdWString().c_str(),
+                     MOVEFILE_REPLACE_EXISTING) != 0;
+#else // ifdef Q_OS_WIN32
+  return rename(from.c_str(), to.c_str()) == 0;
+#endif // ifdef Q_OS_WIN32
+}
+} // namespace restclients
+} // namespace rmscore
@@ -0,0 +1,222 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef _RMS_LIB_RESTCLIENTCACHESTORE_H_
+#define _RMS_LIB_RESTCLIENTCACHESTORE_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <IStream.h>
+#include "IRestClientCache.h"
+
+class QLockFile;
+
+namespace rmscore {
+namespace restclients {
+// Persistent store behind RestClientCache. All the responses of one cache type
+// live in a single append-only log file; an in-memory index maps
+// (cacheName, tag, keyHash) to the position of the latest record and keeps
+// its expiry, so a lookup is a hash lookup plus one read. Records are never
+// rewritten in place: updates append a new record, removals append a
+// tombstone, and the dead space is reclaimed by a background compaction.
+// An encrypted log is written through a CBC4K stream, which rewrites its
+// final 4 KB block on every append; if a crash tears that block, the block
+// is dropped when the log is loaded again.
+//
+// The most recently read values are also kept in memory, so that repeated
+// lookups of the same entry don't read and decrypt the record again.
+//
+// The log lives in the user's profile and is shared by all the processes of
+// the user. Appends and compactions hold a lock file next to the log, and
+// first catch up with the records the other processes appended, or reload
+// the log if another process compacted it. Lookups don't take the lock, so a
+// process may not see the most recent stores of the others until it stores
+// something itself.
+class RestClientCacheStore {
+public:
+
+  struct Key {
+    std::string cacheName;
+    std::string tag;  // empty matches any tag on lookup
+    std::string hash; // empty matches any hash on lookup
+
+    bool        IsPattern() const {
+      return tag.empty() || hash.empty();
+    }
+  };
+
+  // returns the store for the given cache type, opening it on first use
+  static RestClientCacheStore& Get(IRestClientCache::CacheType type);
+
+  // a store of its own on the given file, Get() returns the shared ones
+  RestClientCacheStore(const std::string& filePath, bool encrypted);
+  ~RestClientCacheStore();
+
+  // the folder name, where we store the cache
+  static const std::string& GetFolderName();
+
+  // returns the values of all the live entries that match the key
+  common::StringArray Lookup(const Key& key);
+
+  // stores the value; expires is an ISO date, empty means it never expires
+  void                Store(const Key               & key,
+                            const std::string       & expires,
+                            const common::ByteArray & value);
+
+  // drops expired entries and, if there are more than maximumEntries entries
+  // of the given cache, the least recently stored ones; starts a compaction
+  // when enough of the log is dead space. The entries are dropped in small
+  // batches, so lookups and stores are only blocked for one batch at a time.
+  void                Cleanup(const std::string& cacheName,
+                              size_t             maximumEntries);
+
+  // rewrites the log with only the live records; Store and Cleanup start it
+  // in the background once enough of the log is dead space. The records are
+  // copied from a snapshot of the index without blocking lookups and stores,
+  // only the records stored meanwhile are copied under the lock.
+  void                Compact();
+
+private:
+
+  struct IndexEntry {
+    uint64_t offset;   // offset of the record in the log
+    uint32_t size;     // size of the whole record
+    uint32_t cbValue;  // size of the value
+    int64_t  expires;  // msecs since epoch (UTC), 0 if it never expires
+    uint64_t sequence; // store order, used to evict the oldest entries
+  };
+
+  typedef std::unordered_map<std::string, IndexEntry> Index;
+
+  struct CachedValue {
+    std::string                      value;
+    std::list<std::string>::iterator lru;
+  };
+
+  // identity and size of the log file, to notice the changes of the other
+  // processes
+  struct FileState {
+    bool     exists;
+    uint64_t id;
+    uint64_t size;
+  };
+
+  // undefined copy constructor and assignment operator
+  RestClientCacheStore(const RestClientCacheStore&);
+  RestClientCacheStore& operator=(const RestClientCacheStore&);
+
+  void                  OpenIfNeeded();
+  rmscrypto::api::SharedStream OpenStream(const std::string& filePath,
+                                          bool               truncate);
+  void                  LoadIndex();
+
+  // indexes the records from pos to the end of the log, skipping the
+  // corrupted ones
+  void                  ScanLog(uint64_t pos);
+  bool                  ReadRecordHeader(uint64_t     pos,
+                                         uint64_t     size,
+                                         std::string& indexKey,
+                                         uint32_t   & flags,
+                                         uint32_t   & cbValue,
+                                         int64_t    & expires,
+                                         uint64_t   & cbRecord);
+  uint64_t              FindRecordStart(uint64_t pos,
+                                        uint64_t size);
+
+  // the end of the last record that can be read, the encrypted stream
+  // reports the size of the cipher text which includes the padding
+  uint64_t              LogSize();
+
+  // truncates the final block of an encrypted log which can't be decrypted
+  // anymore, the block before it is written again as the final block;
+  // returns the new end of the log
+  uint64_t              DropTornBlock(uint64_t finalBlock);
+
+  // called with the lock file held, catches up with the other processes
+  void                  SyncWithFile();
+  void                  FlushLog();
+
+  // opens the log again, forgets it if it can't be opened
+  void                  ReopenLog();
+
+  // forgets the log after it could not be opened again
+  void                  CloseLog();
+
+  void                  Append(const std::string      & indexKey,
+                               int64_t                  expires,
+                               const common::ByteArray& value,
+                               bool                     tombstone);
+  bool                  ReadValue(const IndexEntry   & entry,
+                                  common::ByteArray& value);
+
+  // reads the whole record of the entry and checks it
+  static bool           ReadRecord(rmscrypto::api::SharedStream stream,
+                                   const IndexEntry           & entry,
+                                   common::ByteArray          & record);
+  void                  Remove(Index::iterator i);
+
+  // reads the value of the entry, from memory if it was read recently
+  bool                  GetValue(Index::const_iterator i,
+                                 std::string         & value);
+  void                  CacheValue(const std::string& indexKey,
+                                   const std::string& value);
+  void                  InvalidateValue(const std::string& indexKey);
+  void                  InvalidateValues();
+
+  bool                  NeedsCompaction() const;
+  void                  LaunchCompaction();
+
+  static std::string    IndexKey(const Key& key);
+  static bool           Matches(const std::string& indexKey,
+                                const Key        & key);
+  static int64_t        ParseExpires(const std::string& expires);
+  static bool           IsExpired(const IndexEntry& entry,
+                                  int64_t           now);
+  static int64_t        Now();
+  static FileState      GetFileState(const std::string& filePath);
+  static bool           ReplaceFile(const std::string& from,
+                                    const std::string& to);
+
+  std::string m_filePath;
+  bool m_encrypted;
+  bool m_opened;
+
+  std::mutex m_mutex;
+  std::mutex m_compactionMutex;
+  std::unique_ptr<QLockFile> m_fileLock;
+  FileState m_fileState;
+  rmscrypto::api::SharedStream m_stream;
+  Index m_index;
+  uint64_t m_logEnd;
+  uint64_t m_deadBytes;
+  uint64_t m_sequence;
+  std::atomic<bool> m_compactionRunning;
+
+  // in-memory tier, least recently used values are at the back of the list
+  std::unordered_map<std::string, CachedValue> m_values;
+  std::list<std::string> m_valuesLru;
+  size_t m_valuesSize;
+
+  static const uint32_t recordMagic     = 0x31434352; // "RCC1"
+  static const uint32_t recordTombstone = 0x1;
+  static const uint32_t headerSize      = 24;
+  static const uint32_t trailerSize     = 4;
+  static const uint64_t encryptedBlockSize         = 4096; // CBC4K
+  static const uint64_t compactionMinimumDeadBytes = 256 * 1024;
+  static const int      fileLockTimeoutMsecs       = 5000;
+  static const size_t   cleanupBatchSize           = 64;
+  static const size_t   maximumCachedValues        = 256;
+  static const size_t   maximumCachedValuesSize    = 4 * 1024 * 1024;
+};
+} // namespace restclients
+} // namespace rmscore
+#endif // _RMS_LIB_RESTCLIENTCACHESTORE_H_
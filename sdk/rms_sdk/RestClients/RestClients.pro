@@ -28,6 +28,7 @@ SOURCES += \
     RestClientErrorHandling.cpp \
     ServiceDiscoveryClient.cpp \
     RestClientCache.cpp \
+    RestClientCacheStore.cpp \
     TemplatesClient.cpp \
     PublishClient.cpp
 
@@ -51,6 +52,7 @@ HEADERS += \
     RestClientErrorHandling.h \
     IRestClientCache.h \
     RestClientCache.h \
+    RestClientCacheStore.h \
     IServiceDiscoveryClient.h \
     ServiceDiscoveryClient.h \
     TemplatesClient.h \
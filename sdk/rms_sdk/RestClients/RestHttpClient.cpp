@@ -6,11 +6,14 @@
  * ======================================================================
  */
 
+#include <chrono>
 #include <numeric>
 #include "RestHttpClient.h"
 #include "AuthenticationHandler.h"
+#include "../Common/LatencyHistogram.h"
 #include "../Common/tools.h"
 #include "../Platform/Http/IHttpClient.h"
+#include "../Platform/Http/IUri.h"
 #include "../Platform/Settings/ILanguageSettings.h"
 #include "../Platform/Logger/Logger.h"
 
@@ -26,14 +29,18 @@ namespace restclients {
 RestHttpClient::Result RestHttpClient::Get(const std::string& sUrl,
     const AuthenticationHandler::AuthenticationHandlerParameters&  authParams,
     IAuthenticationCallbackImpl& authenticationCallback,
-    std::shared_ptr<std::atomic<bool>> cancelState)
+    std::shared_ptr<std::atomic<bool>> cancelState,
+    const std::string& ifNoneMatch,
+    bool renewChallenge)
 {
     // Performance latency should exclude the time it takes in Authentication and
     // consent operations
+    bool bCachedChallenge = false;
     auto accessToken = AuthenticationHandler::GetAccessTokenForUrl(sUrl,
         authParams,
         authenticationCallback,
-        cancelState);
+        cancelState,
+        &bCachedChallenge);
 
     Logger::Hidden("access token %s", accessToken.c_str());
 
@@ -42,11 +49,28 @@ RestHttpClient::Result RestHttpClient::Get(const std::string& sUrl,
         string(sUrl),        // Url
         common::ByteArray(), // requestBody
         accessToken,         // accessToken
-        cancelState };
+        cancelState,
+        ifNoneMatch };           // ifNoneMatch
 
     // call the DoHttpRequest() and abandon the call when the cancel event is
     // signalled (for Office scenarios)
-    return RestHttpClient::DoHttpRequest(move(parameters));
+    auto result = RestHttpClient::DoHttpRequest(parameters);
+
+    // the cached challenge may be stale, get a new one and try again
+    if ((StatusCode::UNAUTHORIZED == result.status) && bCachedChallenge &&
+        renewChallenge)
+    {
+        Logger::Info("RestHttpClient::Get: token rejected, renewing the challenge");
+
+        AuthenticationHandler::InvalidateChallengeForUrl(sUrl);
+        parameters.accessToken = AuthenticationHandler::GetAccessTokenForUrl(sUrl,
+            authParams,
+            authenticationCallback,
+            cancelState);
+        result = RestHttpClient::DoHttpRequest(parameters);
+    }
+
+    return result;
 }
 
 RestHttpClient::Result RestHttpClient::Post(const string& sUrl,
@@ -59,21 +83,41 @@ RestHttpClient::Result RestHttpClient::Post(const string& sUrl,
 
     // empty not needed at the moment for post.
 
+    // the body is only sent along with the challenge request when the
+    // challenge is not cached
+    bool bCachedChallenge = false;
     auto accessToken = AuthenticationHandler::GetAccessTokenForUrl(sUrl,
         move(requestBody), // requestBody
         authenticationCallback,
-        cancelState);
+        cancelState,
+        &bCachedChallenge);
 
     auto parameters = HttpRequestParameters {
         HTTP_POST,         // type
         string(sUrl),      // Url
         move(requestBody), // requestBody
         accessToken,       // accessToken
-        cancelState };
+        cancelState,
+        string() };        // ifNoneMatch
 
     // call the DoHttpRequest() and abandon the call when the cancel event is
     // signalled (for Office scenarios)
-    return RestHttpClient::DoHttpRequest(move(parameters));
+    auto result = RestHttpClient::DoHttpRequest(parameters);
+
+    // the cached challenge may be stale, get a new one and try again
+    if ((StatusCode::UNAUTHORIZED == result.status) && bCachedChallenge)
+    {
+        Logger::Info("RestHttpClient::Post: token rejected, renewing the challenge");
+
+        AuthenticationHandler::InvalidateChallengeForUrl(sUrl);
+        parameters.accessToken = AuthenticationHandler::GetAccessTokenForUrl(sUrl,
+            common::ByteArray(parameters.requestBody),
+            authenticationCallback,
+            cancelState);
+        result = RestHttpClient::DoHttpRequest(parameters);
+    }
+
+    return result;
 }
 
 RestHttpClient::Result RestHttpClient::DoHttpRequest(const HttpRequestParameters& parameters)
@@ -100,7 +144,13 @@ RestHttpClient::Result RestHttpClient::DoHttpRequest(const HttpRequestParameters
 
     pHttpClient->AddHeader("x-ms-rms-platform-id", m_sPlatformIdHeaderCache);
 
+    if (!parameters.ifNoneMatch.empty())
+    {
+        pHttpClient->AddHeader("If-None-Match", parameters.ifNoneMatch);
+    }
+
     Result result;
+    auto started = chrono::steady_clock::now();
 
     switch (parameters.type)
     {
@@ -129,9 +179,29 @@ RestHttpClient::Result RestHttpClient::DoHttpRequest(const HttpRequestParameters
 
     Logger::Hidden("RestHttpClient::DoHttpRequest returned status code: %d", (int)result.status);
 
+    result.etag = pHttpClient->GetResponseHeader("ETag");
+
+    RecordLatency(parameters.requestUrl,
+        chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now() - started).count());
+
     return result;
 }
 
+void RestHttpClient::RecordLatency(const string& sUrl, int64_t msecs)
+{
+    auto host = IUri::Create(sUrl)->GetHost();
+    auto histogram = LatencyHistogram::ForEndpoint(host);
+
+    histogram->Record(msecs);
+
+    // often enough to tune IRMSEnvironment::HedgingBudget from the log
+    if (histogram->Count() % s_latencyLogInterval == 0)
+    {
+        Logger::Info("latency %s: %s", host.c_str(), histogram->Summary().c_str());
+    }
+}
+
 string RestHttpClient::ConstructAuthTokenHeader(const string& accessToken)
 {
     // prefix with "Bearer "
@@ -27,12 +27,19 @@ public:
     {
         platform::http::StatusCode status;
         common::ByteArray          responseBody;
+        std::string                etag;
     };
 
+    // ifNoneMatch, if not empty, makes the request conditional: the status is
+    // NOT_MODIFIED, with no body, while the resource still has that ETag.
+    // renewChallenge false returns an UNAUTHORIZED status as is, the cached
+    // challenge is kept and the token isn't asked for again
     static Result Get(const std::string& sUrl,
         const AuthenticationHandler::AuthenticationHandlerParameters &authParams,
         modernapi::IAuthenticationCallbackImpl& authenticationCallback,
-        std::shared_ptr<std::atomic<bool> >     cancelState);
+        std::shared_ptr<std::atomic<bool> >     cancelState,
+        const std::string& ifNoneMatch = std::string(),
+        bool renewChallenge = true);
 
     static Result Post(const std::string& sUrl,
         common::ByteArray&& requestBody,
@@ -54,10 +61,15 @@ private:
         common::ByteArray requestBody;
         std::string accessToken;
         std::shared_ptr<std::atomic<bool>> cancelState;
+        std::string ifNoneMatch;
     };
 
     static Result DoHttpRequest(const HttpRequestParameters& parameters);
 
+    // per host, authentication excluded
+    static void RecordLatency(const std::string& sUrl, int64_t msecs);
+    static const int64_t s_latencyLogInterval = 50;
+
     static std::string ConstructAuthTokenHeader(const std::string& accessToken);
     static std::string ConstructLanguageHeader();
     static std::string GenerateRequestId();
@@ -33,6 +33,8 @@ map<string, shared_ptr<ServiceDiscoveryDetails>,
     MyStringCompare> RestServiceUrlClient::serviceDiscoveryDetailsCache =
   map<string, shared_ptr<ServiceDiscoveryDetails>, MyStringCompare>();
 
+common::Mutex RestServiceUrlClient::serviceDiscoveryDetailsCacheMutex;
+
 RestServiceUrlClient::~RestServiceUrlClient()
 {}
 
@@ -42,6 +44,7 @@ shared_ptr<ServiceDiscoveryDetails>RestServiceUrlClient::FindCache(
   if (sEmail.empty() ||
       RestClientCache::IsCacheLookupDisableTestHookOn()) return nullptr;
 
+  common::MutexLocker lock(&serviceDiscoveryDetailsCacheMutex);
   auto it = serviceDiscoveryDetailsCache.find(string(sEmail));
 
   if (it == serviceDiscoveryDetailsCache.end()) return nullptr;
@@ -49,6 +52,15 @@ shared_ptr<ServiceDiscoveryDetails>RestServiceUrlClient::FindCache(
   return it->second;
 }
 
+void RestServiceUrlClient::StoreCache(
+  const string                          & sEmail,
+  std::shared_ptr<ServiceDiscoveryDetails>serviceDiscoveryDetails)
+{
+  common::MutexLocker lock(&serviceDiscoveryDetailsCacheMutex);
+
+  serviceDiscoveryDetailsCache[string(sEmail)] = serviceDiscoveryDetails;
+}
+
 void RestServiceUrlClient::GetConsent(
   IConsentCallbackImpl                  & consentCallback,
   const string                          & sEmail,
@@ -112,7 +124,7 @@ string RestServiceUrlClient::GetTemplatesUrl(
       authenticationCallback,
       nullptr,
       cancelState);
-    serviceDiscoveryDetailsCache[string(sEmail)] = serviceDiscoveryDetails;
+    StoreCache(sEmail, serviceDiscoveryDetails);
   }
   return string(serviceDiscoveryDetails->TemplatesUrl);
 }
@@ -133,7 +145,7 @@ string RestServiceUrlClient::GetPublishUrl(
       authenticationCallback,
       nullptr,
       cancelState);
-    serviceDiscoveryDetailsCache[string(sEmail)] = serviceDiscoveryDetails;
+    StoreCache(sEmail, serviceDiscoveryDetails);
   }
   return string(serviceDiscoveryDetails->PublishingLicensesUrl);
 }
@@ -154,7 +166,7 @@ string RestServiceUrlClient::GetCloudDiagnosticsServerUrl(
       authenticationCallback,
       nullptr,
       cancelState);
-    serviceDiscoveryDetailsCache[string(sEmail)] = serviceDiscoveryDetails;
+    StoreCache(sEmail, serviceDiscoveryDetails);
   }
   return string(serviceDiscoveryDetails->CloudDiagnosticsServerUrl);
 }
@@ -175,7 +187,7 @@ string RestServiceUrlClient::GetPerformanceServerUrl(
       authenticationCallback,
       nullptr,
       cancelState);
-    serviceDiscoveryDetailsCache[string(sEmail)] = serviceDiscoveryDetails;
+    StoreCache(sEmail, serviceDiscoveryDetails);
   }
   return string(serviceDiscoveryDetails->PerformanceServerUrl);
 }
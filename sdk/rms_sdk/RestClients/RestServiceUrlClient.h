@@ -13,6 +13,7 @@
 #include <map>
 #include <memory>
 
+#include "../Common/FrameworkSpecificTypes.h"
 #include "IRestServiceUrlClient.h"
 #include "LicenseParserResult.h"
 
@@ -74,7 +75,13 @@ private:
 
     std::string GetTtlString(uint32_t ttl);
 
+    // guards serviceDiscoveryDetailsCache, the clients are used from several
+    // threads (e.g. by Prewarm)
+    static common::Mutex serviceDiscoveryDetailsCacheMutex;
+
     static std::shared_ptr<ServiceDiscoveryDetails> FindCache(const std::string& sEmail);
+    static void StoreCache(const std::string& sEmail,
+        std::shared_ptr<ServiceDiscoveryDetails> serviceDiscoveryDetails);
 
 
     static void GetConsent(modernapi::IConsentCallbackImpl& consentCallback,
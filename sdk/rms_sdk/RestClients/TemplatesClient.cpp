@@ -6,10 +6,17 @@
  * ======================================================================
  */
 
+#include <algorithm>
+#include <thread>
+
+#include "../Common/tools.h"
 #include "../ModernAPI/RMSExceptions.h"
 #include "../Json/IJsonSerializer.h"
+#include "../Platform/Logger/Logger.h"
+#include "../Platform/Settings/IRMSEnvironmentImpl.h"
 
 
+#include "IRestClientCache.h"
 #include "RestClientErrorHandling.h"
 #include "RestHttpClient.h"
 #include "RestServiceUrls.h"
@@ -20,9 +27,73 @@ using namespace std;
 using namespace rmscore::modernapi;
 using namespace rmscore::json;
 using namespace rmscore::platform::http;
+using namespace rmscore::platform::logger;
 
 namespace rmscore {
 namespace restclients {
+namespace {
+// remembers the token the application returned, so that the list can be
+// revalidated later without calling the application back
+class TokenRecordingCallback : public IAuthenticationCallbackImpl {
+public:
+
+  TokenRecordingCallback(IAuthenticationCallbackImpl& callback)
+    : m_callback(callback)
+  {}
+
+  virtual bool NeedsChallenge() const override {
+    return m_callback.NeedsChallenge();
+  }
+
+  virtual string GetAccessToken(const AuthenticationChallenge& challenge)
+  override
+  {
+    m_accessToken = m_callback.GetAccessToken(challenge);
+    return m_accessToken;
+  }
+
+  const string& AccessToken() const {
+    return m_accessToken;
+  }
+
+private:
+
+  IAuthenticationCallbackImpl& m_callback;
+  string m_accessToken;
+};
+
+// hands out the recorded token in the background revalidation
+class RecordedTokenCallback : public IAuthenticationCallbackImpl {
+public:
+
+  RecordedTokenCallback(const string& accessToken)
+    : m_accessToken(accessToken)
+  {}
+
+  virtual bool NeedsChallenge() const override {
+    return true;
+  }
+
+  virtual string GetAccessToken(const AuthenticationChallenge&) override
+  {
+    return m_accessToken;
+  }
+
+private:
+
+  string m_accessToken;
+};
+
+int64_t NowMsecs()
+{
+  return common::DateTime::currentMSecsSinceEpoch();
+}
+} // namespace
+
+const char TemplatesClient::s_templatesCacheName[] = "TPL";
+
+common::Mutex TemplatesClient::s_cacheMutex;
+map<string, TemplatesClient::CachedTemplates> TemplatesClient::s_cache;
 
 TemplateListResponse TemplatesClient::GetTemplates(modernapi::IAuthenticationCallbackImpl& authenticationCallback,
     const std::string& sEmail,
@@ -33,31 +104,268 @@ TemplateListResponse TemplatesClient::GetTemplates(modernapi::IAuthenticationCal
                                                                       authenticationCallback,
                                                                       cancelState);
 
+    auto environment = platform::settings::IRMSEnvironmentImpl::Environment();
+    int64_t ttlMsecs = static_cast<int64_t>(environment->TemplatesCacheTtl()) * 1000;
+
+    if (ttlMsecs <= 0)
+    {
+        return Fetch(templatesUrl, authenticationCallback, nullptr, cancelState).response;
+    }
+
+    string email(sEmail);
+    transform(email.begin(), email.end(), email.begin(), ::tolower);
+    const string key = templatesUrl + "|" + email;
+
+    CachedTemplates cached;
+    bool found = false;
+    CachedTemplates loaded;
+    bool isLoaded = false;
+    bool triedDisk = false;
+
+    while (!found)
+    {
+        {
+            common::MutexLocker lock(&s_cacheMutex);
+            auto it = s_cache.find(key);
+
+            // another thread may have cached the list meanwhile, it is kept
+            if (it == s_cache.end() && isLoaded)
+            {
+                it = s_cache.insert(make_pair(key, loaded)).first;
+            }
+
+            if (it != s_cache.end())
+            {
+                found = true;
+                cached = it->second;
+
+                int64_t age = NowMsecs() - cached.fetched;
+
+                if (age < ttlMsecs)
+                {
+                    return cached.response;
+                }
+
+                // stale: answer now, refresh behind the caller's back
+                if ((age < ttlMsecs + s_maxStaleSecs * 1000) &&
+                    !cached.accessToken.empty())
+                {
+                    if (!it->second.refreshing)
+                    {
+                        it->second.refreshing = true;
+
+                        thread([key, templatesUrl, email, cached]() {
+                            Revalidate(key, templatesUrl, email, cached);
+                        }).detach();
+                    }
+                    return cached.response;
+                }
+                break;
+            }
+        }
+
+        if (triedDisk || !environment->TemplatesCacheOnDisk())
+        {
+            break;
+        }
+
+        // read and decrypted without the lock, which the lookups of the other
+        // lists would wait for
+        triedDisk = true;
+        isLoaded = LoadFromDisk(templatesUrl, email, loaded);
+
+        if (!isLoaded)
+        {
+            break;
+        }
+    }
+
+    // not cached, too old or loaded from disk without a token: the caller
+    // waits, but a list that didn't change only costs a 304
+    auto fetched = Fetch(templatesUrl, authenticationCallback,
+                         found ? &cached : nullptr, cancelState);
+    {
+        common::MutexLocker lock(&s_cacheMutex);
+        s_cache[key] = fetched;
+    }
+
+    if (environment->TemplatesCacheOnDisk())
+    {
+        StoreToDisk(templatesUrl, email, fetched);
+    }
+
+    return fetched.response;
+}
+
+TemplatesClient::CachedTemplates TemplatesClient::Fetch(
+    const string& templatesUrl,
+    IAuthenticationCallbackImpl& authenticationCallback,
+    const CachedTemplates *cached,
+    shared_ptr<atomic<bool> > cancelState,
+    bool renewChallenge)
+{
+    TokenRecordingCallback recordingCallback(authenticationCallback);
+
     AuthenticationHandler::AuthenticationHandlerParameters authParams;
     auto result =
     RestHttpClient::Get(templatesUrl,
       authParams,
-      authenticationCallback,
-      cancelState);
+      recordingCallback,
+      cancelState,
+      cached != nullptr ? cached->etag : string(),
+      renewChallenge);
+
+    CachedTemplates fetched;
+
+    if ((StatusCode::NOT_MODIFIED == result.status) && (cached != nullptr))
+    {
+        Logger::Hidden("TemplatesClient: the template list didn't change");
+        fetched = *cached;
+    }
+    else
+    {
+        if (StatusCode::OK != result.status)
+        {
+            HandleRestClientError(result.status, result.responseBody);
+        }
+
+        auto pJsonSerializer = IJsonSerializer::Create();
+
+        try
+        {
+            fetched.response = pJsonSerializer->DeserializeTemplateListResponse(result.responseBody);
+        }
+        catch (exceptions::RMSException)
+        {
+            throw exceptions::RMSNetworkException("TemplatesClient: Got an invalid json from the REST service",
+                exceptions::RMSNetworkException::ServerError);
+        }
+        fetched.body = move(result.responseBody);
+        fetched.etag = result.etag;
+    }
+
+    fetched.fetched     = NowMsecs();
+    fetched.accessToken = recordingCallback.AccessToken();
+    fetched.refreshing  = false;
+
+    // a cached challenge means no token was asked for, keep the previous one
+    if (fetched.accessToken.empty() && (cached != nullptr))
+    {
+        fetched.accessToken = cached->accessToken;
+    }
+
+    return fetched;
+}
+
+void TemplatesClient::Revalidate(const string& key,
+                                 const string& templatesUrl,
+                                 const string& sEmail,
+                                 CachedTemplates cached)
+{
+    RecordedTokenCallback recordedTokenCallback(cached.accessToken);
+
+    try
+    {
+        // a 401 is the expired token, not a stale challenge: renewing the
+        // challenge would only send the same token again
+        auto fetched = Fetch(templatesUrl, recordedTokenCallback, &cached, nullptr,
+                             false);
+        {
+            common::MutexLocker lock(&s_cacheMutex);
+            s_cache[key] = fetched;
+        }
+
+        if (platform::settings::IRMSEnvironmentImpl::Environment()->TemplatesCacheOnDisk())
+        {
+            StoreToDisk(templatesUrl, sEmail, fetched);
+        }
+    }
+    catch (exceptions::RMSException& e)
+    {
+        // most likely the token expired; the next call will fetch the list
+        // with the application's callback
+        Logger::Hidden("TemplatesClient: background revalidation failed: %s", e.what());
+
+        common::MutexLocker lock(&s_cacheMutex);
+        auto it = s_cache.find(key);
+
+        if (it != s_cache.end())
+        {
+            it->second.refreshing = false;
+            it->second.accessToken.clear();
+        }
+    }
+}
+
+// the disk entry is "<fetched msecs>\n<etag>\n<body>"
+bool TemplatesClient::LoadFromDisk(const string& templatesUrl,
+                                   const string& sEmail,
+                                   CachedTemplates& cached)
+{
+    try
+    {
+        auto pCache = IRestClientCache::Create(IRestClientCache::CACHE_ENCRYPTED);
+        auto values = pCache->Lookup(s_templatesCacheName, sEmail,
+                                     reinterpret_cast<const uint8_t *>(templatesUrl.data()),
+                                     templatesUrl.size(), true);
+
+        if (values.empty()) return false;
 
-    if (StatusCode::OK != result.status)
+        const string& value = values[0];
+        auto firstBreak  = value.find('\n');
+        auto secondBreak = firstBreak == string::npos ?
+                           string::npos : value.find('\n', firstBreak + 1);
+
+        if (secondBreak == string::npos) return false;
+
+        cached.fetched    = stoll(value.substr(0, firstBreak));
+        cached.etag       = value.substr(firstBreak + 1, secondBreak - firstBreak - 1);
+        cached.body       = common::ByteArray(value.begin() + secondBreak + 1, value.end());
+        cached.response   = IJsonSerializer::Create()->DeserializeTemplateListResponse(cached.body);
+        cached.refreshing = false;
+        return true;
+    }
+    catch (exception&)
     {
-        HandleRestClientError(result.status, result.responseBody);
+        Logger::Hidden("TemplatesClient: ignoring an unreadable cached template list");
+        return false;
     }
+}
+
+void TemplatesClient::StoreToDisk(const string& templatesUrl,
+                                  const string& sEmail,
+                                  const CachedTemplates& cached)
+{
+    auto environment = platform::settings::IRMSEnvironmentImpl::Environment();
+    string header = to_string(cached.fetched) + "\n" + cached.etag + "\n";
 
-    auto pJsonSerializer = IJsonSerializer::Create();
+    common::ByteArray value(header.begin(), header.end());
+    value.insert(value.end(), cached.body.begin(), cached.body.end());
+
+    int64_t age  = (NowMsecs() - cached.fetched) / 1000;
+    auto expires = common::DateTime::currentDateTimeUtc().addSecs(
+        environment->TemplatesCacheTtl() + s_maxStaleSecs - age);
 
     try
     {
-        return pJsonSerializer->DeserializeTemplateListResponse(result.responseBody);
+        auto pCache = IRestClientCache::Create(IRestClientCache::CACHE_ENCRYPTED);
+        pCache->Store(s_templatesCacheName, sEmail,
+                      reinterpret_cast<const uint8_t *>(templatesUrl.data()),
+                      templatesUrl.size(), common::timeToString(expires), value, true);
     }
-    catch (exceptions::RMSException)
+    catch (exceptions::RMSException&)
     {
-        throw exceptions::RMSNetworkException("TemplatesClient: Got an invalid json from the REST service",
-            exceptions::RMSNetworkException::ServerError);
+        Logger::Hidden("TemplatesClient: couldn't store the template list");
     }
 }
 
+void TemplatesClient::ClearCache()
+{
+    common::MutexLocker lock(&s_cacheMutex);
+
+    s_cache.clear();
+}
+
 shared_ptr<ITemplatesClient>ITemplatesClient::Create()
 {
     return make_shared<TemplatesClient>();
@@ -9,16 +9,67 @@
 #ifndef _RMS_LIB_TEMPLATESCLIENT_H_
 #define _RMS_LIB_TEMPLATESCLIENT_H_
 
+#include <map>
 #include "ITemplatesClient.h"
+#include "../Common/FrameworkSpecificTypes.h"
+
 namespace rmscore {
 namespace restclients {
 class TemplatesClient : public ITemplatesClient {
 public:
 
+  // The lists are cached per templates URL (i.e. tenant) and user, see
+  // IRMSEnvironment::TemplatesCacheTtl. A stale list is returned right away
+  // and revalidated in the background with the token of the previous fetch;
+  // the service answers 304 when the list has not changed.
   virtual TemplateListResponse GetTemplates(
     modernapi::IAuthenticationCallbackImpl& authenticationCallback,
     const std::string                     & sEmail,
     std::shared_ptr<std::atomic<bool> >     cancelState) override;
+
+  // drops the lists cached in memory
+  static void ClearCache();
+
+private:
+
+  struct CachedTemplates {
+    TemplateListResponse response;
+    common::ByteArray    body; // as received, for the disk cache
+    std::string          etag;
+    int64_t              fetched; // msecs since epoch
+    std::string          accessToken; // of the last fetch, never persisted
+    bool                 refreshing;
+  };
+
+  // gets the list from the service, conditionally if cached is not null;
+  // returns the updated entry
+  static CachedTemplates Fetch(
+    const std::string                     & templatesUrl,
+    modernapi::IAuthenticationCallbackImpl& authenticationCallback,
+    const CachedTemplates                  *cached,
+    std::shared_ptr<std::atomic<bool> >     cancelState,
+    bool                                    renewChallenge = true);
+
+  // with the token of the last fetch, which may have expired meanwhile: a
+  // rejected token leaves the challenge cache alone and makes the next call
+  // fetch the list in the foreground
+  static void Revalidate(const std::string& key,
+                         const std::string& templatesUrl,
+                         const std::string& sEmail,
+                         CachedTemplates    cached);
+
+  static bool LoadFromDisk(const std::string& templatesUrl,
+                           const std::string& sEmail,
+                           CachedTemplates  & cached);
+  static void StoreToDisk(const std::string    & templatesUrl,
+                          const std::string    & sEmail,
+                          const CachedTemplates& cached);
+
+  static const int64_t s_maxStaleSecs = 24 * 60 * 60;
+  static const char    s_templatesCacheName[];
+
+  static common::Mutex s_cacheMutex;
+  static std::map<std::string, CachedTemplates> s_cache;
 };
 } // namespace restclients
 } // namespace rmscore
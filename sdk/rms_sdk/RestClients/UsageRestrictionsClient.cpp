@@ -7,11 +7,14 @@
  */
 
 #include <memory>
+#include <mutex>
 
+#include "../Common/HedgedRequest.h"
 #include "../Json/jsonserializer.h"
 #include "../ModernAPI/RMSExceptions.h"
 #include "../Platform/Http/IHttpClient.h"
 #include "../Platform/Logger/Logger.h"
+#include "../Platform/Settings/IRMSEnvironmentImpl.h"
 #include "../RestClients/IRestClientCache.h"
 #include "../RestClients/RestServiceUrlClient.h"
 #include "../RestClients/RestHttpClient.h"
@@ -31,6 +34,71 @@ using namespace rmscore::platform::logger;
 
 namespace rmscore {
 namespace restclients {
+namespace {
+// Hands the caller's callbacks to the attempts of a hedged request, one call
+// at a time as they may run on two threads. The attempt that lost may still
+// be running after GetUsageRestrictions returned, so the callbacks are
+// released then and the late attempt fails instead of reaching them.
+class HedgedCallbacks : public IAuthenticationCallbackImpl,
+                        public IConsentCallbackImpl {
+public:
+
+  HedgedCallbacks(IAuthenticationCallbackImpl& authCallback,
+                  IConsentCallbackImpl       & consentCallback)
+    : m_authCallback(&authCallback)
+    , m_consentCallback(&consentCallback)
+    , m_bNeedsChallenge(authCallback.NeedsChallenge())
+  {}
+
+  virtual bool NeedsChallenge() const override
+  {
+    return m_bNeedsChallenge;
+  }
+
+  virtual string GetAccessToken(const AuthenticationChallenge& challenge) override
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    ThrowIfReleased();
+    return m_authCallback->GetAccessToken(challenge);
+  }
+
+  virtual void Consents(const string        & email,
+                        const string        & domain,
+                        const vector<string>& urls) override
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    ThrowIfReleased();
+    m_consentCallback->Consents(email, domain, urls);
+  }
+
+  void Release()
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    m_authCallback    = nullptr;
+    m_consentCallback = nullptr;
+  }
+
+private:
+
+  void ThrowIfReleased()
+  {
+    if (m_authCallback == nullptr) {
+      throw exceptions::RMSNetworkException(
+              "UsageRestrictionsClient: the hedged request was abandoned",
+              exceptions::RMSNetworkException::CancelledByUser);
+    }
+  }
+
+  mutex m_mutex;
+  IAuthenticationCallbackImpl *m_authCallback;
+  IConsentCallbackImpl *m_consentCallback;
+  const bool m_bNeedsChallenge;
+};
+} // namespace
+
 std::shared_ptr<UsageRestrictionsResponse>UsageRestrictionsClient::
 GetUsageRestrictions(const UsageRestrictionsRequest        & request,
                      modernapi::IAuthenticationCallbackImpl& authCallback,
@@ -63,23 +131,39 @@ GetUsageRestrictions(const UsageRestrictionsRequest        & request,
   auto serializedRequest = pJsonSerializer->SerializeUsageRestrictionsRequest(
     request);
 
-  auto pRestServiceUrlClient = IRestServiceUrlClient::Create();
   auto licenseParserResult = LicenseParser::ParsePublishingLicense(request.pbPublishLicense,
     request.cbPublishLicense);
 
+  auto hedgingBudget = platform::settings::IRMSEnvironmentImpl::Environment()->
+                       HedgingBudget();
+  RestHttpClient::Result httpRequestResult;
 
-  auto endUserLicenseUrl = pRestServiceUrlClient->GetEndUserLicensesUrl(
-    licenseParserResult,
-    email,
-    authCallback,
-    consentCallback,
-    cancelState);
-
-  auto httpRequestResult = RestHttpClient::Post(
-    endUserLicenseUrl,
-    move(serializedRequest),
-    authCallback,
-    cancelState);
+  if ((hedgingBudget > 0) && (licenseParserResult->GetDomains().size() > 1))
+  {
+    httpRequestResult = PostHedged(licenseParserResult,
+                                   move(serializedRequest),
+                                   authCallback,
+                                   consentCallback,
+                                   email,
+                                   hedgingBudget,
+                                   cancelState);
+  }
+  else
+  {
+    auto pRestServiceUrlClient = IRestServiceUrlClient::Create();
+    auto endUserLicenseUrl = pRestServiceUrlClient->GetEndUserLicensesUrl(
+      licenseParserResult,
+      email,
+      authCallback,
+      consentCallback,
+      cancelState);
+
+    httpRequestResult = RestHttpClient::Post(
+      endUserLicenseUrl,
+      move(serializedRequest),
+      authCallback,
+      cancelState);
+  }
 
   if (StatusCode::OK != httpRequestResult.status)
   {
@@ -110,6 +194,90 @@ GetUsageRestrictions(const UsageRestrictionsRequest        & request,
   return response;
 }
 
+RestHttpClient::Result UsageRestrictionsClient::PostHedged(
+  const std::shared_ptr<LicenseParserResult>& licenseParserResult,
+  common::ByteArray                        && serializedRequest,
+  modernapi::IAuthenticationCallbackImpl    & authCallback,
+  modernapi::IConsentCallbackImpl           & consentCallback,
+  const std::string                         & email,
+  int                                         hedgingBudget,
+  std::shared_ptr<std::atomic<bool> >         cancelState)
+{
+  typedef common::HedgedRequest<RestHttpClient::Result> Hedge;
+
+  // the primary goes through all the domains as before, the alternate only
+  // tries the second one (the intranet domain)
+  auto domains   = licenseParserResult->GetDomains();
+  auto alternate = make_shared<LicenseParserResult>(
+    vector<shared_ptr<Domain> >(1, domains[1]),
+    licenseParserResult->GetServerPublicCertificate());
+
+  // everything the attempts use is owned by them, see HedgedCallbacks
+  auto callbacks = make_shared<HedgedCallbacks>(authCallback, consentCallback);
+  auto body      = make_shared<common::ByteArray>(move(serializedRequest));
+
+  struct Endpoints {
+    mutex  urlMutex;
+    string primaryUrl;
+  };
+  auto endpoints = make_shared<Endpoints>();
+
+  auto attempt = [callbacks, body, email, endpoints](
+    shared_ptr<LicenseParserResult>licenseParserResult,
+    bool                           bPrimary,
+    shared_ptr<atomic<bool> >      cancelState) -> RestHttpClient::Result
+  {
+    auto url = IRestServiceUrlClient::Create()->GetEndUserLicensesUrl(
+      licenseParserResult, email, *callbacks, *callbacks, cancelState);
+
+    {
+      lock_guard<mutex> lock(endpoints->urlMutex);
+
+      if (bPrimary) {
+        endpoints->primaryUrl = url;
+      } else if (_stricmp(url.c_str(), endpoints->primaryUrl.c_str()) == 0) {
+        // both domains lead to the same license server, e.g. when it is
+        // cached for the user; sending the request twice buys nothing
+        throw exceptions::RMSNetworkException(
+                "UsageRestrictionsClient: the alternate endpoint is the primary one",
+                exceptions::RMSNetworkException::ServerError);
+      }
+    }
+
+    Logger::Hidden("UsageRestrictionsClient: %s attempt to %s",
+                   bPrimary ? "primary" : "alternate", url.c_str());
+
+    return RestHttpClient::Post(url, common::ByteArray(*body), *callbacks,
+                                cancelState);
+  };
+
+  Hedge::Winner winner = Hedge::Primary;
+
+  try
+  {
+    auto result = Hedge::Run(
+      bind(attempt, licenseParserResult, true, placeholders::_1),
+      bind(attempt, alternate, false, placeholders::_1),
+      chrono::milliseconds(hedgingBudget),
+      cancelState,
+      &winner,
+      [](const RestHttpClient::Result& result) {
+        // a server error is worth trying the other endpoint for
+        return static_cast<int>(result.status) < 500;
+      });
+
+    callbacks->Release();
+    Logger::Hidden("UsageRestrictionsClient: the %s endpoint answered first",
+                   winner == Hedge::Primary ? "primary" : "alternate");
+    return result;
+  }
+  catch (...)
+  {
+    callbacks->Release();
+    throw;
+  }
+}
+
 int64_t daysTo(const std::chrono::time_point<std::chrono::system_clock>& l,
                const std::chrono::time_point<std::chrono::system_clock>& r) {
   return std::chrono::duration_cast<std::chrono::hours>(l - r).count() / 24;
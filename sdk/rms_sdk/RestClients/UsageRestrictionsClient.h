@@ -10,6 +10,8 @@
 #define _RMS_LIB_USAGERESTRICTIONSCLIENT_H_
 
 #include "IUsageRestrictionsClient.h"
+#include "LicenseParserResult.h"
+#include "RestHttpClient.h"
 
 namespace rmscore {
 namespace restclients {
@@ -27,6 +29,18 @@ public:
 
 private:
 
+  // sends the request to the license server of the first domain of the
+  // publishing license and, if it takes longer than hedgingBudget, to the
+  // one of the second domain as well; the first answer is returned
+  static RestHttpClient::Result PostHedged(
+    const std::shared_ptr<LicenseParserResult>& licenseParserResult,
+    common::ByteArray                        && serializedRequest,
+    modernapi::IAuthenticationCallbackImpl    & authCallback,
+    modernapi::IConsentCallbackImpl           & consentCallback,
+    const std::string                         & email,
+    int                                         hedgingBudget,
+    std::shared_ptr<std::atomic<bool> >         cancelState);
+
   static bool TryGetFromCache(const UsageRestrictionsRequest            & request,
                               const std::string                         & email,
                               std::shared_ptr<UsageRestrictionsResponse>& response,
@@ -0,0 +1,19 @@
+REPO_ROOT = $$PWD/../../../..
+DESTDIR   = $$REPO_ROOT/bin
+TARGET    = rms_trace_decoder
+
+TEMPLATE  = app
+
+QT       -= core gui
+CONFIG   += console c++11 debug_and_release warn_on
+CONFIG   -= app_bundle qt
+
+CONFIG(debug, debug|release) {
+    TARGET = $$join(TARGET,,,d)
+}
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../Platform/Logger/TraceFormat.h
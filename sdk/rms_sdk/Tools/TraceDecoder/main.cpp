@@ -0,0 +1,145 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+ */
+
+// Prints a binary trace written by the SDK (see RMS_TRACE_FILE) as text, one
+// record per line:
+//
+//   rms_trace_decoder <trace> [max bytes printed per field]
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../../Platform/Logger/TraceFormat.h"
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+static string FormatTime(uint64_t microseconds) {
+  time_t seconds = static_cast<time_t>(microseconds / 1000000);
+  tm     utc;
+
+#ifdef _WIN32
+  gmtime_s(&utc, &seconds);
+#else // ifdef _WIN32
+  gmtime_r(&seconds, &utc);
+#endif // ifdef _WIN32
+
+  char text[32];
+  strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &utc);
+
+  char fraction[16];
+  snprintf(fraction, sizeof(fraction), ".%06uZ",
+           static_cast<unsigned>(microseconds % 1000000));
+
+  return string(text) + fraction;
+}
+
+// printable text is quoted, anything else is shown in hex
+static string FormatBytes(const TraceField& field, size_t maxPrinted) {
+  const string& bytes = field.bytes;
+  bool printable = true;
+
+  for (unsigned char c : bytes) {
+    if ((c < 0x20 || c > 0x7e) && c != '\t' && c != '\r' && c != '\n') {
+      printable = false;
+      break;
+    }
+  }
+
+  size_t shown = min(bytes.size(), maxPrinted);
+  string text;
+
+  if (printable) {
+    text.push_back('"');
+
+    for (size_t i = 0; i < shown; ++i) {
+      switch (bytes[i]) {
+      case '"':  text += "\\\""; break;
+      case '\\': text += "\\\\"; break;
+      case '\r': text += "\\r";  break;
+      case '\n': text += "\\n";  break;
+      case '\t': text += "\\t";  break;
+      default:   text.push_back(bytes[i]);
+      }
+    }
+    text.push_back('"');
+  } else {
+    static const char digits[] = "0123456789abcdef";
+    text = "0x";
+
+    for (size_t i = 0; i < shown; ++i) {
+      text.push_back(digits[static_cast<unsigned char>(bytes[i]) >> 4]);
+      text.push_back(digits[static_cast<unsigned char>(bytes[i]) & 0xf]);
+    }
+  }
+
+  if (field.originalLength > shown) {
+    text += "...(" + to_string(field.originalLength) + " bytes)";
+  }
+  return text;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace> [max bytes printed per field]\n",
+            argv[0]);
+    return 2;
+  }
+
+  size_t maxPrinted = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4096;
+
+  ifstream file(argv[1], ios::binary);
+
+  if (!file) {
+    fprintf(stderr, "can't open %s\n", argv[1]);
+    return 1;
+  }
+
+  vector<uint8_t> data((istreambuf_iterator<char>(file)),
+                       istreambuf_iterator<char>());
+  TraceReader reader(data.data(), data.size());
+
+  if (!reader.IsValid()) {
+    fprintf(stderr, "%s is not an RMS trace of version %u\n", argv[1],
+            TRACE_VERSION);
+    return 1;
+  }
+
+  TraceRecord record;
+  size_t count = 0;
+
+  while (reader.Next(record)) {
+    auto info = GetTraceEventInfo(record.event);
+    string line = FormatTime(record.microseconds) + " " +
+                  to_string(record.thread) + " " +
+                  (info != nullptr ? info->name :
+                   "event." + to_string(record.event));
+
+    for (size_t i = 0; i < record.fields.size(); ++i) {
+      auto& field = record.fields[i];
+      const char *name = (info != nullptr) &&
+                         (i < sizeof(info->fields) / sizeof(info->fields[0])) ?
+                         info->fields[i] : nullptr;
+
+      line += " " + (name != nullptr ? string(name) : "field" + to_string(i)) +
+              "=";
+      line += field.type == TRACE_FIELD_INT ? to_string(field.intValue) :
+              FormatBytes(field, maxPrinted);
+    }
+
+    puts(line.c_str());
+    ++count;
+  }
+
+  fprintf(stderr, "%u records\n", static_cast<unsigned>(count));
+  return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include "PlatformLoggerTest.h"
+#include "../../Platform/Logger/Logger.h"
+#include "../../Platform/Logger/LogRingBuffer.h"
+#include "../../Platform/Settings/IRMSEnvironmentImpl.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace rmscore::modernapi;
+using namespace rmscore::platform::logger;
+using namespace rmscore::platform::settings;
+
+void PlatformLoggerTest::cleanup()
+{
+    IRMSEnvironmentImpl::Environment()->LogOption(
+        IRMSEnvironment::LoggerOption::Always);
+    Logger::SetLevel(LOG_LEVEL_INFO);
+    Logger::Flush();
+}
+
+void PlatformLoggerTest::testRingBufferOrder()
+{
+    LogRingBuffer buffer(4);
+    LogRingBuffer::Record record;
+
+    QVERIFY(!buffer.TryPop(record));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        string text = to_string(i);
+        QVERIFY(buffer.TryPush("INF", text.data(), text.size()));
+    }
+    QVERIFY(!buffer.TryPush("INF", "full", 4));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        QVERIFY(buffer.TryPop(record));
+        QCOMPARE(string(record.Text(), record.length), to_string(i));
+        QCOMPARE(string(record.prefix), string("INF"));
+    }
+    QVERIFY(!buffer.TryPop(record));
+
+    // the slots are reused once read
+    QVERIFY(buffer.TryPush("ERR", "again", 5));
+    QVERIFY(buffer.TryPop(record));
+    QCOMPARE(string(record.Text(), record.length), string("again"));
+}
+
+void PlatformLoggerTest::testRingBufferLongRecord()
+{
+    LogRingBuffer buffer(2);
+    LogRingBuffer::Record record;
+    string text(LogRingBuffer::inline_length * 3, 'x');
+
+    QVERIFY(buffer.TryPush("HDN", text.data(), text.size()));
+    QVERIFY(buffer.TryPop(record));
+    QCOMPARE(string(record.Text(), record.length), text);
+}
+
+void PlatformLoggerTest::testRingBufferConcurrent()
+{
+    const int producers = 4;
+    const int records   = 20000;
+
+    LogRingBuffer buffer(256);
+    vector<thread> threads;
+
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.push_back(thread([&, p]() {
+            for (int i = 0; i < records; ++i)
+            {
+                string text = to_string(p) + ":" + to_string(i);
+
+                while (!buffer.TryPush("INF", text.data(), text.size()))
+                {
+                    this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    // records of one producer come out in the order it pushed them
+    vector<int> next(producers, 0);
+    LogRingBuffer::Record record;
+    bool ordered = true;
+
+    for (int received = 0; received < producers * records;)
+    {
+        if (!buffer.TryPop(record))
+        {
+            this_thread::yield();
+            continue;
+        }
+
+        string text(record.Text(), record.length);
+        auto colon = text.find(':');
+        int p = stoi(text.substr(0, colon));
+        int i = stoi(text.substr(colon + 1));
+
+        ordered = ordered && (next[p] == i);
+        next[p] = i + 1;
+        ++received;
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    QVERIFY(ordered);
+    for (int p = 0; p < producers; ++p)
+    {
+        QCOMPARE(next[p], records);
+    }
+}
+
+void PlatformLoggerTest::benchmarkLoggingOff()
+{
+    IRMSEnvironmentImpl::Environment()->LogOption(
+        IRMSEnvironment::LoggerOption::Never);
+
+    int i = 0;
+    QBENCHMARK {
+        Logger::Info("PlatformLoggerTest: record %d of %s", ++i, "benchmark");
+    }
+}
+
+void PlatformLoggerTest::benchmarkFiltered()
+{
+    Logger::SetLevel(LOG_LEVEL_INFO);
+
+    int i = 0;
+    QBENCHMARK {
+        Logger::Hidden("PlatformLoggerTest: record %d of %s", ++i, "benchmark");
+    }
+}
+
+void PlatformLoggerTest::benchmarkToFile()
+{
+    int i = 0;
+    QBENCHMARK {
+        Logger::Info("PlatformLoggerTest: record %d of %s", ++i, "benchmark");
+    }
+    Logger::Flush();
+}
@@ -0,0 +1,30 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef PLATFORMLOGGERTEST_H
+#define PLATFORMLOGGERTEST_H
+#include <QtTest>
+
+class PlatformLoggerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void cleanup();
+
+    void testRingBufferOrder();
+    void testRingBufferLongRecord();
+    void testRingBufferConcurrent();
+
+    // per call cost of a record that is dropped because logging is off, that
+    // is dropped by the level, and that is written to the file
+    void benchmarkLoggingOff();
+    void benchmarkFiltered();
+    void benchmarkToFile();
+};
+
+#endif // PLATFORMLOGGERTEST_H
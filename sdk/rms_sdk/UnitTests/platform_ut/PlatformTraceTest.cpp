@@ -0,0 +1,154 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include "PlatformTraceTest.h"
+#include "../../Platform/Logger/Trace.h"
+#include <QFile>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace rmscore::platform::logger;
+
+static const QString tracePath = QString(SRCDIR) + "data/tmptrace.bin";
+
+static vector<uint8_t> ReadTrace()
+{
+    QFile file(tracePath);
+    file.open(QIODevice::ReadOnly);
+    auto data = file.readAll();
+
+    return vector<uint8_t>(data.begin(), data.end());
+}
+
+void PlatformTraceTest::cleanup()
+{
+    Trace::Close();
+    QFile::remove(tracePath);
+}
+
+void PlatformTraceTest::testRecordsRoundTrip()
+{
+    QVERIFY(Trace::Open(tracePath.toStdString()));
+    QVERIFY(Trace::IsEnabled());
+
+    Trace::Event(TRACE_HTTP_REQUEST).String("POST")
+        .String("https://api.aadrm.com/my/v1/licenses").Int(42);
+    Trace::Event(TRACE_HTTP_RESPONSE).Int(200).String("").Int(0);
+    Trace::Close();
+
+    auto data = ReadTrace();
+    TraceReader reader(data.data(), data.size());
+    TraceRecord record;
+
+    QVERIFY(reader.IsValid());
+
+    QVERIFY(reader.Next(record));
+    QCOMPARE(record.event, static_cast<uint16_t>(TRACE_HTTP_REQUEST));
+    QCOMPARE(record.fields.size(), static_cast<size_t>(3));
+    QCOMPARE(record.fields[0].type, TRACE_FIELD_STRING);
+    QCOMPARE(record.fields[0].bytes, string("POST"));
+    QCOMPARE(record.fields[1].bytes,
+             string("https://api.aadrm.com/my/v1/licenses"));
+    QCOMPARE(record.fields[2].type, TRACE_FIELD_INT);
+    QCOMPARE(record.fields[2].intValue, static_cast<int64_t>(42));
+    QVERIFY(record.microseconds > 0);
+
+    QVERIFY(reader.Next(record));
+    QCOMPARE(record.event, static_cast<uint16_t>(TRACE_HTTP_RESPONSE));
+    QCOMPARE(record.fields[0].intValue, static_cast<int64_t>(200));
+
+    QVERIFY(!reader.Next(record));
+}
+
+void PlatformTraceTest::testBytesAreCapped()
+{
+    QVERIFY(Trace::Open(tracePath.toStdString(), 16));
+
+    vector<uint8_t> body(1000, 0x5a);
+    Trace::Event(TRACE_HTTP_RESPONSE_BODY).Bytes(body.data(), body.size());
+    Trace::Close();
+
+    auto data = ReadTrace();
+    TraceReader reader(data.data(), data.size());
+    TraceRecord record;
+
+    QVERIFY(reader.Next(record));
+    QCOMPARE(record.fields[0].type, TRACE_FIELD_BYTES);
+    QCOMPARE(record.fields[0].bytes, string(16, '\x5a'));
+    QCOMPARE(record.fields[0].originalLength, static_cast<uint32_t>(1000));
+}
+
+void PlatformTraceTest::testSecretsNeedOptIn()
+{
+    const string key = "content key";
+
+    // by default only the length of a secret is recorded
+    QVERIFY(Trace::Open(tracePath.toStdString()));
+    QVERIFY(!Trace::HasSecrets());
+    Trace::Event(TRACE_LICENSE_PUBLISHED).String("id").Secret(key.data(), key.size());
+    Trace::Close();
+
+    auto data = ReadTrace();
+    TraceReader reader(data.data(), data.size());
+    TraceRecord record;
+
+    QVERIFY(reader.Next(record));
+    QCOMPARE(record.fields[0].bytes, string("id"));
+    QCOMPARE(record.fields[1].type, TRACE_FIELD_BYTES);
+    QCOMPARE(record.fields[1].bytes, string());
+    QCOMPARE(record.fields[1].originalLength, static_cast<uint32_t>(key.size()));
+
+    QVERIFY(Trace::Open(tracePath.toStdString(), 4096, true));
+    QVERIFY(Trace::HasSecrets());
+    Trace::Event(TRACE_LICENSE_PUBLISHED).String("id").Secret(key.data(), key.size());
+    Trace::Close();
+
+    data = ReadTrace();
+    TraceReader secretReader(data.data(), data.size());
+
+    QVERIFY(secretReader.Next(record));
+    QCOMPARE(record.fields[1].bytes, key);
+}
+
+void PlatformTraceTest::testNothingWrittenWhenClosed()
+{
+    QVERIFY(Trace::Open(tracePath.toStdString()));
+    Trace::Close();
+    QVERIFY(!Trace::IsEnabled());
+
+    Trace::Event(TRACE_HTTP_REQUEST).String("GET").String("url").Int(0);
+
+    auto data = ReadTrace();
+    TraceReader reader(data.data(), data.size());
+    TraceRecord record;
+
+    QVERIFY(reader.IsValid());
+    QVERIFY(!reader.Next(record));
+}
+
+void PlatformTraceTest::testTruncatedTrace()
+{
+    QVERIFY(Trace::Open(tracePath.toStdString()));
+    Trace::Event(TRACE_HTTP_REQUEST_HEADER).String("Accept")
+        .String("application/json");
+    Trace::Event(TRACE_HTTP_REQUEST_HEADER).String("Accept-Language")
+        .String("en-US");
+    Trace::Close();
+
+    // as if the process died while writing the second record
+    auto data = ReadTrace();
+    data.resize(data.size() - 3);
+
+    TraceReader reader(data.data(), data.size());
+    TraceRecord record;
+
+    QVERIFY(reader.Next(record));
+    QCOMPARE(record.fields[1].bytes, string("application/json"));
+    QVERIFY(!reader.Next(record));
+}
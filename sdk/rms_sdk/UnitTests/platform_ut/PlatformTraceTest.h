@@ -0,0 +1,26 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef PLATFORMTRACETEST_H
+#define PLATFORMTRACETEST_H
+#include <QtTest>
+
+class PlatformTraceTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void cleanup();
+
+    void testRecordsRoundTrip();
+    void testBytesAreCapped();
+    void testSecretsNeedOptIn();
+    void testNothingWrittenWhenClosed();
+    void testTruncatedTrace();
+};
+
+#endif // PLATFORMTRACETEST_H
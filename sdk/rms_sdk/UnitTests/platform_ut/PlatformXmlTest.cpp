@@ -11,9 +11,32 @@
 #include "../../Platform/Xml/IDomDocument.h"
 #include "../../Platform/Xml/IDomNode.h"
 #include "../../Platform/Xml/IDomElement.h"
+#include "../../Platform/Xml/IXmlPathExtractor.h"
+#include "../../Platform/Xml/IXPathQuery.h"
+#include "../../ModernAPI/RMSExceptions.h"
 
 using namespace rmscore::platform::logger;
 
+namespace {
+const char *COORDINATES_XPATH =
+    "kml/Document/Placemark[last()]/GeometryCollection/LineString/coordinates";
+
+sp<IDomDocument> LoadDocument(const QString& name)
+{
+    QFile file(QString(SRCDIR) + "data/" + name);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return nullptr;
+
+    auto doc = IDomDocument::create();
+    std::string errorMsg;
+    int errorLine = 0;
+    int errorColumn = 0;
+
+    if (!doc->setContent(QString(file.readAll()).toStdString(), errorMsg,
+                         errorLine, errorColumn)) return nullptr;
+    return doc;
+}
+} // namespace
 
 PlatformXmlTest::PlatformXmlTest()
 {
@@ -63,3 +86,180 @@ void PlatformXmlTest::testSelectSingleNode(bool enabled)
     Logger::Hidden("real: %s", realResult.data());
     QVERIFY(realResult == expectedResult.toStdString());
 }
+
+void PlatformXmlTest::testPathExtractor()
+{
+    const std::string xml =
+        "<a><b type='x'>skipped<c>1</c></b>"
+        "<b type='y'><c>first &amp; only</c><c>second</c></b>"
+        "<d><![CDATA[<raw>]]> text</d></a>";
+
+    auto extractor = IXmlPathExtractor::create({
+        "/a/b[@type='y']/c/text()",
+        "/a/b[@type=\"x\"]/text()",
+        "/a/d/text()",
+        "/a/b[@type='z']/c/text()",
+        "/a/b/c" });
+
+    std::vector<std::string> values;
+    QVERIFY(extractor->Extract(xml.data(), xml.size(), values));
+    QCOMPARE(values.size(), static_cast<size_t>(5));
+    QCOMPARE(values[0], std::string("first & only"));
+    // only the text of the element itself, not of its children
+    QCOMPARE(values[1], std::string("skipped"));
+    QCOMPARE(values[2], std::string("<raw> text"));
+    QCOMPARE(values[3], std::string());
+    QCOMPARE(values[4], std::string("1"));
+}
+
+void PlatformXmlTest::testPathExtractorWrapperRoot()
+{
+    // several top-level elements, as in a publishing license
+    const std::string xml =
+        "<?xml version=\"1.0\"?><XrML><BODY>one</BODY></XrML>"
+        "<XrML><BODY>two</BODY></XrML>";
+
+    auto extractor = IXmlPathExtractor::create({ "/Root/XrML/BODY/text()" });
+    std::vector<std::string> values;
+
+    QVERIFY(extractor->Extract(xml.data(), xml.size(), values, "Root"));
+    QCOMPARE(values[0], std::string("one"));
+
+    QVERIFY(!extractor->Extract(xml.data(), xml.size(), values));
+}
+
+void PlatformXmlTest::testPathExtractorInvalid()
+{
+    auto extractor = IXmlPathExtractor::create({ "/a/b/text()" });
+    std::vector<std::string> values;
+    const std::string xml = "<a><c></a>";
+
+    QVERIFY(!extractor->Extract(xml.data(), xml.size(), values));
+    QCOMPARE(values[0], std::string());
+
+    const char *unsupported[] = { "a/b", "/a/b[last()]", "/a//b", "/a/text()/b" };
+
+    for (auto path : unsupported)
+    {
+        bool thrown = false;
+
+        try
+        {
+            IXmlPathExtractor::create({ path });
+        }
+        catch (rmscore::exceptions::RMSInvalidArgumentException&)
+        {
+            thrown = true;
+        }
+        QVERIFY2(thrown, path);
+    }
+}
+
+void PlatformXmlTest::testXPathQuery()
+{
+    auto doc = LoadDocument("testXPath1.xml");
+    QVERIFY(doc != nullptr);
+
+    auto query  = IXPathQuery::create(COORDINATES_XPATH);
+    auto result = doc->SelectSingleNode(*query);
+    QVERIFY(result != nullptr);
+    QCOMPARE(result->text(), std::string("0.000010,0.000020,0.000030"));
+
+    // the same result as the string overload, query after query
+    auto expected = doc->SelectSingleNode(std::string(COORDINATES_XPATH));
+    QCOMPARE(doc->SelectSingleNode(*query)->text(), expected->text());
+
+    auto missing = IXPathQuery::create("kml/Document/Placemark[3]");
+    QVERIFY(doc->SelectSingleNode(*missing) == nullptr);
+}
+
+void PlatformXmlTest::testSelectNodes()
+{
+    auto doc = IDomDocument::create();
+    std::string errorMsg;
+    int errorLine = 0;
+    int errorColumn = 0;
+
+    QVERIFY(doc->setContent(
+        "<a><b type='x'>skipped<c>1</c></b>"
+        "<b type='y'><c>2</c><c>3</c></b>"
+        "<d><![CDATA[<raw>]]> text</d></a>",
+        errorMsg, errorLine, errorColumn));
+
+    auto results = doc->SelectNodes({
+        IXPathQuery::create("/a/b[@type='y']/c[2]/text()"),
+        IXPathQuery::create("a/b/c"),
+        IXPathQuery::create("a/b[last()]/c[1]"),
+        IXPathQuery::create("a/d/text()"),
+        IXPathQuery::create("a/b[@type='z']") });
+
+    QCOMPARE(results.size(), static_cast<size_t>(5));
+    QCOMPARE(results[0]->text(), std::string("3"));
+    // every match, as with SelectSingleNode
+    QCOMPARE(results[1]->text(), std::string("123"));
+    QCOMPARE(results[1]->childNodes()->size(), static_cast<size_t>(3));
+    QCOMPARE(results[2]->text(), std::string("2"));
+    QCOMPARE(results[3]->text(), std::string("<raw> text"));
+    QVERIFY(results[4] == nullptr);
+}
+
+void PlatformXmlTest::testXPathQueryUnsupported()
+{
+    const char *unsupported[] = {
+        "bookstore/book/author[last-name = \"Bob\"]/award",
+        "a//b", "a/b[1][2]", "a/text()/b", "a/b[0]", "" };
+
+    for (auto xPath : unsupported)
+    {
+        bool thrown = false;
+
+        try
+        {
+            IXPathQuery::create(xPath);
+        }
+        catch (rmscore::exceptions::RMSInvalidArgumentException&)
+        {
+            thrown = true;
+        }
+        QVERIFY2(thrown, xPath);
+    }
+}
+
+void PlatformXmlTest::benchmark_SelectSingleNode()
+{
+    auto doc = LoadDocument("testXPath1.xml");
+    QVERIFY(doc != nullptr);
+
+    QBENCHMARK {
+        doc->SelectSingleNode(std::string(COORDINATES_XPATH));
+    }
+}
+
+void PlatformXmlTest::benchmark_SelectSingleNodeCompiled()
+{
+    auto doc = LoadDocument("testXPath1.xml");
+    QVERIFY(doc != nullptr);
+
+    auto query = IXPathQuery::create(COORDINATES_XPATH);
+
+    QBENCHMARK {
+        doc->SelectSingleNode(*query);
+    }
+}
+
+void PlatformXmlTest::benchmark_SelectNodes()
+{
+    auto doc = LoadDocument("testXPath1.xml");
+    QVERIFY(doc != nullptr);
+
+    std::vector<sp<IXPathQuery> > queries = {
+        IXPathQuery::create(COORDINATES_XPATH),
+        IXPathQuery::create("kml/Document/name/text()"),
+        IXPathQuery::create("kml/Document/Placemark[1]/address/text()"),
+        IXPathQuery::create("kml/Document/Style[@id='roadStyle']/LineStyle/color")
+    };
+
+    QBENCHMARK {
+        doc->SelectNodes(queries);
+    }
+}
@@ -19,6 +19,15 @@ public:
 private Q_SLOTS:
     void testSelectSingleNode(bool enabled = true);
     void testSelectSingleNode_data();
+    void testPathExtractor();
+    void testPathExtractorWrapperRoot();
+    void testPathExtractorInvalid();
+    void testXPathQuery();
+    void testSelectNodes();
+    void testXPathQueryUnsupported();
+    void benchmark_SelectSingleNode();
+    void benchmark_SelectSingleNodeCompiled();
+    void benchmark_SelectNodes();
 };
 #endif // PLATFORMXMLTEST
 
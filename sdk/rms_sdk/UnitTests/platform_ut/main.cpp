@@ -14,6 +14,8 @@
 #include"PlatformJsonArrayTest.h"
 #include"PlatformFileTest.h"
 #include"PlatformFileSystemTest.h"
+#include"PlatformLoggerTest.h"
+#include"PlatformTraceTest.h"
 
 int main(int argc, char *argv[])
 {
@@ -26,6 +28,8 @@ int main(int argc, char *argv[])
     res += QTest::qExec(new PlatformJsonArrayTest(), argc, argv);
     res += QTest::qExec(new PlatformFileSystemTest(), argc, argv);
     res += QTest::qExec(new PlatformFileTest(), argc, argv);
+    res += QTest::qExec(new PlatformLoggerTest(), argc, argv);
+    res += QTest::qExec(new PlatformTraceTest(), argc, argv);
 
     return res;
 }
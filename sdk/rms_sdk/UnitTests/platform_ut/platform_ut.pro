@@ -34,7 +34,9 @@ SOURCES += \
     PlatformJsonArrayTest.cpp \
     PlatformJsonObjectTest.cpp \
     PlatformFileSystemTest.cpp \
-    PlatformFileTest.cpp
+    PlatformFileTest.cpp \
+    PlatformLoggerTest.cpp \
+    PlatformTraceTest.cpp
 
 HEADERS += \
     PlatformHttpClientTest.h \
@@ -43,4 +45,6 @@ HEADERS += \
     PlatformJsonObjectTest.h \
     PlatformFileSystemTest.h \
     PlatformFileTest.h \
+    PlatformLoggerTest.h \
+    PlatformTraceTest.h \
     TestHelpers.h
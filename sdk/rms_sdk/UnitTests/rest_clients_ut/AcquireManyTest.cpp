@@ -0,0 +1,211 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "AcquireManyTest.h"
+#include "StandInRmsService.h"
+#include "../../ModernAPI/UserPolicy.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::modernapi;
+
+typedef vector<shared_future<shared_ptr<GetUserPolicyResult> > > Futures;
+
+static Futures AcquireMany(const vector<vector<unsigned char> >& licenses,
+                           const string& userId,
+                           StandInTokenCallback& callback,
+                           int maxConcurrent,
+                           shared_ptr<atomic<bool> > cancelState = nullptr)
+{
+    return UserPolicy::AcquireMany(licenses,
+                                   userId,
+                                   callback,
+                                   nullptr,
+                                   PolicyAcquisitionOptions::POL_None,
+                                   ResponseCacheFlags::RESPONSE_CACHE_NOCACHE,
+                                   cancelState,
+                                   maxConcurrent);
+}
+
+// the name of the acquired policy, or the reason of the network error
+static string Outcome(const shared_future<shared_ptr<GetUserPolicyResult> >& future)
+{
+    try {
+        auto result = future.get();
+        return result->Policy != nullptr ? result->Policy->Name() : "<no policy>";
+    } catch (exceptions::RMSNetworkException& e) {
+        return "<error " + to_string(static_cast<int>(e.reason())) + ">";
+    } catch (exceptions::RMSException&) {
+        return "<error>";
+    }
+}
+
+static string NetworkError(exceptions::RMSNetworkException::Reason reason)
+{
+    return "<error " + to_string(static_cast<int>(reason)) + ">";
+}
+
+void AcquireManyTest::test_IdenticalLicensesAreAcquiredOnce()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    vector<vector<unsigned char> > licenses(5, service.PublishingLicense("same"));
+    licenses.push_back(service.PublishingLicense("other"));
+
+    auto futures = AcquireMany(licenses, service.Email(), callback, 4);
+
+    QCOMPARE(futures.size(), licenses.size());
+    for (size_t i = 0; i < 5; ++i) {
+        QCOMPARE(Outcome(futures[i]), string("same"));
+        QCOMPARE(futures[i].get(), futures[0].get());
+    }
+    QCOMPARE(Outcome(futures[5]), string("other"));
+    QCOMPARE(service.Requests("enduserlicenses"), 2);
+}
+
+void AcquireManyTest::test_ResultsFollowTheOrderOfTheLicenses()
+{
+    StandInRmsService first;
+    StandInRmsService second;
+    QVERIFY(first.Start());
+    QVERIFY(second.Start());
+    StandInTokenCallback callback;
+
+    // the licenses of the two servers are interleaved and some repeat
+    vector<string> names = { "a0", "b0", "a1", "a0", "b1", "b2", "a2", "b0" };
+    vector<vector<unsigned char> > licenses;
+    for (auto& name : names) {
+        licenses.push_back(name[0] == 'a' ? first.PublishingLicense(name)
+                                          : second.PublishingLicense(name));
+    }
+
+    auto futures = AcquireMany(licenses, first.Email(), callback, 3);
+
+    QCOMPARE(futures.size(), names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        QCOMPARE(Outcome(futures[i]), names[i]);
+    }
+    QCOMPARE(first.Requests("enduserlicenses"), 3);
+    QCOMPARE(second.Requests("enduserlicenses"), 3);
+}
+
+void AcquireManyTest::test_EachServerIsWarmedUpOnce()
+{
+    StandInRmsService first(50);
+    StandInRmsService second(50);
+    QVERIFY(first.Start());
+    QVERIFY(second.Start());
+    StandInTokenCallback callback;
+
+    vector<vector<unsigned char> > licenses;
+    for (int i = 0; i < 6; ++i) {
+        licenses.push_back(first.PublishingLicense("a" + to_string(i)));
+        licenses.push_back(second.PublishingLicense("b" + to_string(i)));
+    }
+
+    auto futures = AcquireMany(licenses, first.Email(), callback, 6);
+    for (auto& future : futures) {
+        QVERIFY(Outcome(future)[0] != '<');
+    }
+
+    // the rest of a group only starts once its first license cached the
+    // challenge, none of them asks for it again
+    QCOMPARE(first.Challenges(), 1);
+    QCOMPARE(second.Challenges(), 1);
+    QCOMPARE(first.Requests("enduserlicenses"), 6);
+    QCOMPARE(second.Requests("enduserlicenses"), 6);
+}
+
+void AcquireManyTest::test_ConcurrencyIsBoundedAcrossServers()
+{
+    StandInRmsService service(100);
+    QVERIFY(service.Start());
+    auto otherDomain = service.AddDomain();
+    StandInTokenCallback callback;
+
+    // two license servers, as far as the grouping goes, on one stand-in which
+    // sees all the requests
+    vector<vector<unsigned char> > licenses;
+    for (int i = 0; i < 8; ++i) {
+        licenses.push_back(service.PublishingLicense("a" + to_string(i)));
+        licenses.push_back(service.PublishingLicense("b" + to_string(i), otherDomain));
+    }
+
+    auto futures = AcquireMany(licenses, service.Email(), callback, 3);
+    for (auto& future : futures) {
+        QVERIFY(Outcome(future)[0] != '<');
+    }
+
+    QCOMPARE(service.Requests("enduserlicenses"), 16);
+    QVERIFY(service.PeakConcurrentRequests() <= 3);
+    QVERIFY(service.PeakConcurrentRequests() > 1);
+}
+
+void AcquireManyTest::test_FailedWarmUpStopsItsGroup()
+{
+    StandInRmsService failing;
+    StandInRmsService healthy;
+    QVERIFY(failing.Start());
+    QVERIFY(healthy.Start());
+    failing.SetStatus("enduserlicenses", 404);
+    StandInTokenCallback callback;
+
+    vector<vector<unsigned char> > licenses;
+    for (int i = 0; i < 4; ++i) {
+        licenses.push_back(failing.PublishingLicense("a" + to_string(i)));
+        licenses.push_back(healthy.PublishingLicense("b" + to_string(i)));
+    }
+
+    auto futures = AcquireMany(licenses, healthy.Email(), callback, 4);
+
+    const string notAvailable =
+        NetworkError(exceptions::RMSNetworkException::ServiceNotAvailable);
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(Outcome(futures[2 * i]), notAvailable);
+        QCOMPARE(Outcome(futures[2 * i + 1]), "b" + to_string(i));
+    }
+
+    // only the first license of the failing group was sent
+    QCOMPARE(failing.Requests("enduserlicenses"), 1);
+    QCOMPARE(healthy.Requests("enduserlicenses"), 4);
+}
+
+void AcquireManyTest::test_CancelledWarmUpStopsItsGroup()
+{
+    StandInRmsService service(500);
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    vector<vector<unsigned char> > licenses;
+    for (int i = 0; i < 6; ++i) {
+        licenses.push_back(service.PublishingLicense("a" + to_string(i)));
+    }
+
+    auto cancelState = make_shared<atomic<bool> >(false);
+    auto futures = AcquireMany(licenses, service.Email(), callback, 4, cancelState);
+
+    this_thread::sleep_for(chrono::milliseconds(100));
+    *cancelState = true;
+
+    const string cancelled =
+        NetworkError(exceptions::RMSNetworkException::CancelledByUser);
+    for (auto& future : futures) {
+        QCOMPARE(Outcome(future), cancelled);
+    }
+
+    // the warm-up was still waiting for its challenge, the others never
+    // reached the server
+    QCOMPARE(service.Requests("enduserlicenses"), 0);
+    QCOMPARE(service.Challenges(), 1);
+}
@@ -0,0 +1,24 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef ACQUIREMANYTEST_H
+#define ACQUIREMANYTEST_H
+#include <QtTest>
+
+class AcquireManyTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_IdenticalLicensesAreAcquiredOnce();
+    void test_ResultsFollowTheOrderOfTheLicenses();
+    void test_EachServerIsWarmedUpOnce();
+    void test_ConcurrencyIsBoundedAcrossServers();
+    void test_FailedWarmUpStopsItsGroup();
+    void test_CancelledWarmUpStopsItsGroup();
+};
+#endif // ACQUIREMANYTEST_H
@@ -0,0 +1,150 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include "ChallengeCacheTest.h"
+#include "StandInRmsService.h"
+#include "../../RestClients/RestHttpClient.h"
+#include "../../ModernAPI/AuthenticationCallbackImpl.h"
+#include "../../Platform/Settings/IRMSEnvironmentImpl.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::modernapi;
+using namespace rmscore::restclients;
+using namespace rmscore::platform::http;
+
+static StatusCode Get(StandInRmsService& service,
+                      StandInTokenCallback& callback,
+                      const string& url)
+{
+    AuthenticationCallbackImpl authCallback(callback, service.Email());
+    AuthenticationHandler::AuthenticationHandlerParameters authParams;
+
+    return RestHttpClient::Get(url, authParams, authCallback, nullptr).status;
+}
+
+static StatusCode Post(StandInRmsService& service,
+                       StandInTokenCallback& callback,
+                       const string& url)
+{
+    AuthenticationCallbackImpl authCallback(callback, service.Email());
+    const string body = "{}";
+
+    return RestHttpClient::Post(url, common::ByteArray(body.begin(), body.end()),
+                                authCallback, nullptr).status;
+}
+
+void ChallengeCacheTest::cleanup()
+{
+    platform::settings::IRMSEnvironmentImpl::Environment()->ChallengeCacheTtl(1800);
+}
+
+void ChallengeCacheTest::test_ChallengeIsSharedByThePathPrefix()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    QVERIFY(Get(service, callback, service.Url("templates")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 1);
+
+    // the other endpoints of the service, whatever the query or the method
+    QVERIFY(Get(service, callback, service.Url("templates?culture=en")) == StatusCode::OK);
+    QVERIFY(Post(service, callback, service.Url("enduserlicenses")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 1);
+
+    // another path prefix is another service
+    QVERIFY(Get(service, callback, service.Url("v2/templates")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 2);
+    QVERIFY(Get(service, callback, service.Url("v2/templates")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 2);
+
+    QCOMPARE(service.Requests("templates"), 4);
+    QCOMPARE(service.Requests("enduserlicenses"), 1);
+}
+
+void ChallengeCacheTest::test_ChallengeExpires()
+{
+    auto environment = platform::settings::IRMSEnvironmentImpl::Environment();
+    QCOMPARE(environment->ChallengeCacheTtl(), 1800);
+
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    environment->ChallengeCacheTtl(1);
+
+    QVERIFY(Get(service, callback, service.Url("templates")) == StatusCode::OK);
+    QVERIFY(Get(service, callback, service.Url("templates")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 1);
+
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    QVERIFY(Get(service, callback, service.Url("templates")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 2);
+
+    // not cached at all
+    environment->ChallengeCacheTtl(0);
+    AuthenticationHandler::InvalidateChallengeForUrl(service.Url("templates"));
+
+    QVERIFY(Get(service, callback, service.Url("templates")) == StatusCode::OK);
+    QVERIFY(Get(service, callback, service.Url("templates")) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 4);
+}
+
+void ChallengeCacheTest::test_StaleChallengeIsRenewedOnce()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    const string url = service.Url("templates");
+
+    QVERIFY(Get(service, callback, url) == StatusCode::OK);
+
+    // the token got with the cached challenge is rejected: a new challenge,
+    // a new token and the request again
+    service.RejectTokens(1);
+    QVERIFY(Get(service, callback, url) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 2);
+    QCOMPARE(service.Requests("templates"), 3);
+
+    // only once
+    service.RejectTokens(2);
+    QVERIFY(Get(service, callback, url) == StatusCode::UNAUTHORIZED);
+    QCOMPARE(service.Challenges(), 3);
+    QCOMPARE(service.Requests("templates"), 5);
+
+    // and not with a challenge just received
+    AuthenticationHandler::InvalidateChallengeForUrl(url);
+    service.RejectTokens(1);
+    QVERIFY(Get(service, callback, url) == StatusCode::UNAUTHORIZED);
+    QCOMPARE(service.Challenges(), 4);
+    QCOMPARE(service.Requests("templates"), 6);
+}
+
+void ChallengeCacheTest::test_StaleChallengeIsRenewedOnPost()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    const string url = service.Url("enduserlicenses");
+
+    QVERIFY(Post(service, callback, url) == StatusCode::OK);
+
+    service.RejectTokens(1);
+    QVERIFY(Post(service, callback, url) == StatusCode::OK);
+    QCOMPARE(service.Challenges(), 2);
+    QCOMPARE(service.Requests("enduserlicenses"), 3);
+
+    service.RejectTokens(2);
+    QVERIFY(Post(service, callback, url) == StatusCode::UNAUTHORIZED);
+    QCOMPARE(service.Challenges(), 3);
+    QCOMPARE(service.Requests("enduserlicenses"), 5);
+}
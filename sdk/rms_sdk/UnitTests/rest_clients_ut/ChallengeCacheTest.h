@@ -0,0 +1,23 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef CHALLENGECACHETEST_H
+#define CHALLENGECACHETEST_H
+#include <QtTest>
+
+class ChallengeCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void cleanup();
+    void test_ChallengeIsSharedByThePathPrefix();
+    void test_ChallengeExpires();
+    void test_StaleChallengeIsRenewedOnce();
+    void test_StaleChallengeIsRenewedOnPost();
+};
+#endif // CHALLENGECACHETEST_H
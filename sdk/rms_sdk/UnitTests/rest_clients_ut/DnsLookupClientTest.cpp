@@ -0,0 +1,138 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "DnsLookupClientTest.h"
+#include "../../RestClients/DnsLookupClient.h"
+#include "../../RestClients/Domain.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::restclients;
+using namespace rmscore::platform::http;
+
+static const string PREFIX = "_rmsdisco._http._tcp.";
+
+// answers from a table, the names it doesn't have are not found
+class StandInDnsResolver : public IDnsServerResolver
+{
+public:
+    void Answer(const string& domain, DnsServiceRecord::Status status,
+                const string& target = string(), uint32_t ttl = 0)
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_records[PREFIX + domain] = DnsServiceRecord { status, target, ttl };
+    }
+
+    // the names looked up, in order
+    vector<string> Queries()
+    {
+        lock_guard<mutex> lock(m_mutex);
+        return m_queries;
+    }
+
+    virtual string lookup(const string&) override
+    {
+        return string();
+    }
+
+    virtual vector<DnsServiceRecord> lookupFirst(const vector<string>& dnsRequests) override
+    {
+        lock_guard<mutex> lock(m_mutex);
+        vector<DnsServiceRecord> records;
+
+        for (auto& name : dnsRequests) {
+            m_queries.push_back(name);
+            auto it = m_records.find(name);
+            records.push_back(it != m_records.end() ?
+                              it->second :
+                              DnsServiceRecord { DnsServiceRecord::NotFound, "", 0 });
+        }
+        return records;
+    }
+
+private:
+    mutex m_mutex;
+    map<string, DnsServiceRecord> m_records;
+    vector<string> m_queries;
+};
+
+static string Lookup(const shared_ptr<StandInDnsResolver>& resolver, const string& email)
+{
+    DnsLookupClient client(resolver);
+    return client.LookupDiscoveryService(Domain::CreateFromEmail(email))->GetDiscoveryUrl();
+}
+
+void DnsLookupClientTest::init()
+{
+    DnsLookupClient::ClearCache();
+}
+
+void DnsLookupClientTest::test_AnswerIsCachedForItsTtl()
+{
+    auto resolver = make_shared<StandInDnsResolver>();
+    resolver->Answer("contoso.com", DnsServiceRecord::Found, "rms.contoso.com", 60);
+
+    // the subdomain has no record, its parent has
+    QCOMPARE(Lookup(resolver, "john@sales.contoso.com"), string("rms.contoso.com"));
+    QCOMPARE(resolver->Queries().size(), size_t(2));
+
+    QCOMPARE(Lookup(resolver, "john@sales.contoso.com"), string("rms.contoso.com"));
+    QCOMPARE(Lookup(resolver, "jane@contoso.com"), string("rms.contoso.com"));
+    QCOMPARE(resolver->Queries().size(), size_t(2));
+
+    auto cachedFor = DnsLookupClient::CachedFor(PREFIX + "contoso.com").count();
+    QVERIFY(cachedFor > 55 && cachedFor <= 60);
+}
+
+void DnsLookupClientTest::test_AnswerExpires()
+{
+    auto resolver = make_shared<StandInDnsResolver>();
+    resolver->Answer("fabrikam.com", DnsServiceRecord::Found, "rms.fabrikam.com", 1);
+
+    QCOMPARE(Lookup(resolver, "john@sales.fabrikam.com"), string("rms.fabrikam.com"));
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    // only the expired name is asked again, the missing one is still cached
+    resolver->Answer("fabrikam.com", DnsServiceRecord::Found, "rms2.fabrikam.com", 60);
+    QCOMPARE(Lookup(resolver, "john@sales.fabrikam.com"), string("rms2.fabrikam.com"));
+
+    auto queries = resolver->Queries();
+    QCOMPARE(queries.size(), size_t(3));
+    QCOMPARE(queries[2], PREFIX + "fabrikam.com");
+}
+
+void DnsLookupClientTest::test_MissingRecordIsCachedForFiveMinutes()
+{
+    auto resolver = make_shared<StandInDnsResolver>();
+
+    // no record anywhere: the default service
+    QCOMPARE(Lookup(resolver, "john@northwind.com"), string("api.aadrm.com"));
+    QCOMPARE(Lookup(resolver, "john@northwind.com"), string("api.aadrm.com"));
+    QCOMPARE(resolver->Queries().size(), size_t(1));
+
+    auto cachedFor = DnsLookupClient::CachedFor(PREFIX + "northwind.com").count();
+    QVERIFY(cachedFor > 295 && cachedFor <= 300);
+}
+
+void DnsLookupClientTest::test_FailureIsNotCached()
+{
+    auto resolver = make_shared<StandInDnsResolver>();
+    resolver->Answer("litware.com", DnsServiceRecord::Failed);
+
+    QCOMPARE(Lookup(resolver, "john@litware.com"), string("api.aadrm.com"));
+    QCOMPARE(DnsLookupClient::CachedFor(PREFIX + "litware.com").count(),
+             static_cast<chrono::seconds::rep>(0));
+
+    resolver->Answer("litware.com", DnsServiceRecord::Found, "rms.litware.com", 60);
+    QCOMPARE(Lookup(resolver, "john@litware.com"), string("rms.litware.com"));
+    QCOMPARE(resolver->Queries().size(), size_t(2));
+}
@@ -0,0 +1,23 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef DNSLOOKUPCLIENTTEST_H
+#define DNSLOOKUPCLIENTTEST_H
+#include <QtTest>
+
+class DnsLookupClientTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void test_AnswerIsCachedForItsTtl();
+    void test_AnswerExpires();
+    void test_MissingRecordIsCachedForFiveMinutes();
+    void test_FailureIsNotCached();
+};
+#endif // DNSLOOKUPCLIENTTEST_H
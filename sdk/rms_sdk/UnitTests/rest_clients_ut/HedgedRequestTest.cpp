@@ -0,0 +1,151 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include <QElapsedTimer>
+#include "HedgedRequestTest.h"
+#include "../../Common/HedgedRequest.h"
+#include "../../Common/LatencyHistogram.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+
+typedef common::HedgedRequest<string> Hedge;
+typedef shared_ptr<atomic<bool> > CancelState;
+
+// answers after delayMs unless it is cancelled first
+static Hedge::Attempt Endpoint(const string& answer, int delayMs,
+                               shared_ptr<atomic<int> > calls = nullptr,
+                               CancelState *pCancel = nullptr)
+{
+    return [=](CancelState cancelState) -> string {
+        if (calls) ++*calls;
+        if (pCancel) *pCancel = cancelState;
+
+        for (int waited = 0; waited < delayMs; waited += 5) {
+            if (cancelState->load()) {
+                throw exceptions::RMSNetworkException(
+                        "cancelled", exceptions::RMSNetworkException::CancelledByUser);
+            }
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+        return answer;
+    };
+}
+
+static Hedge::Attempt FailingEndpoint(int delayMs)
+{
+    return [=](CancelState) -> string {
+        this_thread::sleep_for(chrono::milliseconds(delayMs));
+        throw exceptions::RMSNetworkException(
+                "unreachable", exceptions::RMSNetworkException::ServerError);
+    };
+}
+
+void HedgedRequestTest::test_PrimaryWithinBudget()
+{
+    auto alternateCalls = make_shared<atomic<int> >(0);
+    Hedge::Winner winner = Hedge::Alternate;
+
+    auto answer = Hedge::Run(Endpoint("extranet", 20),
+                             Endpoint("intranet", 20, alternateCalls),
+                             chrono::milliseconds(500), nullptr, &winner);
+
+    QCOMPARE(answer, string("extranet"));
+    QCOMPARE(winner, Hedge::Primary);
+    QCOMPARE(alternateCalls->load(), 0);
+}
+
+void HedgedRequestTest::test_SlowPrimaryIsHedged()
+{
+    CancelState primaryCancel;
+    Hedge::Winner winner = Hedge::Primary;
+    QElapsedTimer timer;
+    timer.start();
+
+    auto answer = Hedge::Run(Endpoint("extranet", 3000, nullptr, &primaryCancel),
+                             Endpoint("intranet", 50),
+                             chrono::milliseconds(100), nullptr, &winner);
+
+    QCOMPARE(answer, string("intranet"));
+    QCOMPARE(winner, Hedge::Alternate);
+    QVERIFY(timer.elapsed() < 1000);
+
+    // the slow primary is abandoned
+    QVERIFY(primaryCancel->load());
+}
+
+void HedgedRequestTest::test_FailedPrimaryFallsBack()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // the alternate starts as soon as the primary fails, not after the budget
+    auto answer = Hedge::Run(FailingEndpoint(10), Endpoint("intranet", 10),
+                             chrono::milliseconds(5000), nullptr);
+
+    QCOMPARE(answer, string("intranet"));
+    QVERIFY(timer.elapsed() < 1000);
+}
+
+void HedgedRequestTest::test_BothFail()
+{
+    bool failed = false;
+
+    try {
+        Hedge::Run(FailingEndpoint(10), FailingEndpoint(10),
+                   chrono::milliseconds(50), nullptr);
+    } catch (exceptions::RMSNetworkException& e) {
+        failed = e.reason() == exceptions::RMSNetworkException::ServerError;
+    }
+    QVERIFY(failed);
+}
+
+void HedgedRequestTest::test_RejectedPrimaryFallsBack()
+{
+    auto accept = [](const string& answer) { return answer != "503"; };
+    Hedge::Winner winner = Hedge::Primary;
+    QElapsedTimer timer;
+    timer.start();
+
+    // a fast server error doesn't win, the alternate is asked right away
+    auto answer = Hedge::Run(Endpoint("503", 10), Endpoint("intranet", 10),
+                             chrono::milliseconds(5000), nullptr, &winner, accept);
+
+    QCOMPARE(answer, string("intranet"));
+    QCOMPARE(winner, Hedge::Alternate);
+    QVERIFY(timer.elapsed() < 1000);
+
+    // when the alternate doesn't do better, the primary's answer is returned
+    answer = Hedge::Run(Endpoint("503", 10), FailingEndpoint(10),
+                        chrono::milliseconds(50), nullptr, &winner, accept);
+
+    QCOMPARE(answer, string("503"));
+    QCOMPARE(winner, Hedge::Primary);
+}
+
+void HedgedRequestTest::test_LatencyHistogramPercentiles()
+{
+    auto histogram = common::LatencyHistogram::ForEndpoint("hedging.test");
+    QVERIFY(histogram == common::LatencyHistogram::ForEndpoint("hedging.test"));
+    QCOMPARE(histogram->Percentile(0.95), static_cast<int64_t>(0));
+
+    for (int i = 0; i < 90; ++i) histogram->Record(40);
+    for (int i = 0; i < 9; ++i) histogram->Record(700);
+    histogram->Record(45000);
+
+    QCOMPARE(histogram->Count(), static_cast<int64_t>(100));
+    QCOMPARE(histogram->Percentile(0.50), static_cast<int64_t>(50));
+    QCOMPARE(histogram->Percentile(0.95), static_cast<int64_t>(1000));
+    QCOMPARE(histogram->Percentile(0.99), static_cast<int64_t>(1000));
+    QCOMPARE(histogram->Percentile(1.0), static_cast<int64_t>(45000));
+    QCOMPARE(histogram->Summary(),
+             string("n=100 p50=50 p95=1000 p99=1000 max=45000"));
+}
@@ -0,0 +1,24 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef HEDGEDREQUESTTEST_H
+#define HEDGEDREQUESTTEST_H
+#include <QtTest>
+
+class HedgedRequestTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_PrimaryWithinBudget();
+    void test_SlowPrimaryIsHedged();
+    void test_FailedPrimaryFallsBack();
+    void test_BothFail();
+    void test_RejectedPrimaryFallsBack();
+    void test_LatencyHistogramPercentiles();
+};
+#endif // HEDGEDREQUESTTEST_H
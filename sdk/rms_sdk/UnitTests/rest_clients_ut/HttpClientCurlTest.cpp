@@ -0,0 +1,172 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include <QElapsedTimer>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include "HttpClientCurlTest.h"
+#include "HttpStandInServer.h"
+#include "TlsStandInServer.h"
+#include "../../Platform/Http/HttpTransportCurl.h"
+#include "../../Platform/Http/IHttpClient.h"
+#include "../../Platform/Settings/IRMSEnvironmentImpl.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::platform::http;
+
+typedef modernapi::IRMSEnvironment::HttpClientOption HttpClientOption;
+
+void HttpClientCurlTest::init()
+{
+    platform::settings::IRMSEnvironmentImpl::Environment()->HttpClient(
+        HttpClientOption::Curl);
+}
+
+void HttpClientCurlTest::cleanup()
+{
+    platform::settings::IRMSEnvironmentImpl::Environment()->HttpClient(
+        HttpClientOption::Qt);
+}
+
+void HttpClientCurlTest::test_GetAndPost()
+{
+    HttpStandInServer server(200, "{\"Status\":\"OK\"}");
+    QVERIFY(server.Start());
+
+    const string url = server.Url("/my/v1/publishing").toStdString();
+    common::ByteArray response;
+
+    auto pHttpClient = IHttpClient::Create();
+    pHttpClient->AddHeader("x-ms-rms-request-id", "curl");
+    QVERIFY(pHttpClient->Get(url, response, nullptr) == StatusCode::OK);
+    QCOMPARE(string(response.begin(), response.end()),
+             string("{\"Status\":\"OK\"}"));
+    QVERIFY(server.LastRequestHeaders().contains("x-ms-rms-request-id: curl"));
+
+    const string body = "{\"Request\":1}";
+    QVERIFY(pHttpClient->Post(url, common::ByteArray(body.begin(), body.end()),
+                              "application/json", response,
+                              nullptr) == StatusCode::OK);
+    QVERIFY(server.LastRequestHeaders().contains("Accept: application/json"));
+    QCOMPARE(pHttpClient->GetResponseHeader("Content-Type"),
+             string("application/json"));
+    QCOMPARE(server.RequestCount(), 2);
+}
+
+void HttpClientCurlTest::test_ConnectionIsReused()
+{
+    HttpStandInServer server(200, "{}");
+    QVERIFY(server.Start());
+
+    const string url = server.Url("/my/v1/servicediscovery").toStdString();
+    common::ByteArray response;
+
+    for (int i = 0; i < 5; ++i) {
+        QVERIFY(IHttpClient::Create()->Get(url, response, nullptr) == StatusCode::OK);
+    }
+
+    QCOMPARE(server.RequestCount(), 5);
+    QCOMPARE(server.ConnectionCount(), 1);
+}
+
+void HttpClientCurlTest::test_CancellationIsImmediate()
+{
+    HttpStandInServer server(200, "{}", 3000);
+    QVERIFY(server.Start());
+
+    auto cancelState = make_shared<atomic<bool> >(false);
+    thread canceller([cancelState]() {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        cancelState->store(true);
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    common::ByteArray response;
+    bool cancelled = false;
+
+    try {
+        IHttpClient::Create()->Get(server.Url().toStdString(), response, cancelState);
+    } catch (exceptions::RMSNetworkException& e) {
+        cancelled = e.reason() == exceptions::RMSNetworkException::CancelledByUser;
+    }
+    canceller.join();
+
+    QVERIFY(cancelled);
+    QVERIFY2(timer.elapsed() < 300, "cancellation was not delivered promptly");
+}
+
+void HttpClientCurlTest::test_MicrosoftCertificatesAreTrusted()
+{
+    // a context without the CA bundle of the system, so that the store holds
+    // what the transport adds only
+    SSL_CTX *context = SSL_CTX_new(TLS_client_method());
+    QVERIFY(context != nullptr);
+
+    // once per connection; adding them again changes nothing
+    for (int i = 0; i < 2; ++i) {
+        QCOMPARE(HttpTransportCurl::AddMicrosoftCertificates(nullptr, context, nullptr),
+                 CURLE_OK);
+    }
+
+    auto objects = X509_STORE_get0_objects(SSL_CTX_get_cert_store(context));
+    QStringList subjects;
+
+    for (int i = 0; i < sk_X509_OBJECT_num(objects); ++i) {
+        X509 *certificate = X509_OBJECT_get0_X509(sk_X509_OBJECT_value(objects, i));
+        QVERIFY(certificate != nullptr);
+
+        char subject[256];
+        X509_NAME_oneline(X509_get_subject_name(certificate), subject, sizeof(subject));
+        subjects.append(QString::fromLatin1(subject));
+    }
+    SSL_CTX_free(context);
+
+    QCOMPARE(subjects.size(), 2);
+    QVERIFY2(subjects.filter("Microsoft Root Certificate Authority 2011").size() == 1,
+             qPrintable(subjects.join("; ")));
+}
+
+void HttpClientCurlTest::test_HttpsSessionIsResumed()
+{
+    TlsStandInServer server("{\"Status\":\"OK\"}");
+    QVERIFY(server.Start());
+
+    const string url = server.Url("/my/v1/servicediscovery").toStdString();
+    common::ByteArray response;
+
+    // its certificate isn't trusted yet
+    bool rejected = false;
+
+    try {
+        IHttpClient::Create()->Get(url, response, nullptr);
+    } catch (exceptions::RMSNetworkException&) {
+        rejected = true;
+    }
+    QVERIFY(rejected);
+    QCOMPARE(server.Handshakes(), 0);
+
+    HttpTransportCurl::AddTrustedCertificate(server.Certificate());
+
+    // a connection per request, the handshakes after the first one resume
+    // the session kept by the share handle
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(IHttpClient::Create()->Get(url, response, nullptr) == StatusCode::OK);
+        QCOMPARE(string(response.begin(), response.end()),
+                 string("{\"Status\":\"OK\"}"));
+    }
+
+    QCOMPARE(server.RequestCount(), 3);
+    QCOMPARE(server.Handshakes(), 3);
+    QCOMPARE(server.ResumedHandshakes(), 2);
+}
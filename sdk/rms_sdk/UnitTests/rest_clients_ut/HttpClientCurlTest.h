@@ -0,0 +1,25 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef HTTPCLIENTCURLTEST_H
+#define HTTPCLIENTCURLTEST_H
+#include <QtTest>
+
+class HttpClientCurlTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void test_GetAndPost();
+    void test_ConnectionIsReused();
+    void test_CancellationIsImmediate();
+    void test_MicrosoftCertificatesAreTrusted();
+    void test_HttpsSessionIsResumed();
+};
+#endif // HTTPCLIENTCURLTEST_H
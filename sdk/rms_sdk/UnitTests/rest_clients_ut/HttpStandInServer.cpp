@@ -0,0 +1,160 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <memory>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include "HttpStandInServer.h"
+
+static QByteArray HeaderValue(const QByteArray& headers, const QByteArray& name)
+{
+    foreach(const QByteArray &line, headers.split('\n')) {
+        int colon = line.indexOf(':');
+        if (colon > 0 &&
+            line.left(colon).trimmed().toLower() == name.toLower()) {
+            return line.mid(colon + 1).trimmed();
+        }
+    }
+    return QByteArray();
+}
+
+QByteArray HttpStandInServer::Request::Header(const QByteArray& name) const
+{
+    return HeaderValue(headers, name);
+}
+
+HttpStandInServer::HttpStandInServer(Handler handler)
+    : m_handler(handler)
+    , m_port(0)
+    , m_requestCount(0)
+    , m_connectionCount(0)
+    , m_inFlight(0)
+    , m_peakInFlight(0)
+{}
+
+HttpStandInServer::HttpStandInServer(int               statusCode,
+                                     const QByteArray& body,
+                                     int               delayMs,
+                                     const QList<QPair<QByteArray, QByteArray> >& headers)
+    : HttpStandInServer([=](const Request&) {
+          Reply reply = { statusCode, body, headers, delayMs };
+          return reply;
+      })
+{}
+
+HttpStandInServer::~HttpStandInServer()
+{
+    Stop();
+}
+
+bool HttpStandInServer::Start()
+{
+    start();
+    m_ready.acquire();
+    return m_port != 0;
+}
+
+void HttpStandInServer::Stop()
+{
+    if (isRunning()) {
+        quit();
+        wait();
+    }
+}
+
+QByteArray HttpStandInServer::Url(const QByteArray& path) const
+{
+    return "http://127.0.0.1:" + QByteArray::number(m_port) + path;
+}
+
+QByteArray HttpStandInServer::LastRequestHeaders() const
+{
+    QMutexLocker lock(&m_lastRequestMutex);
+    return m_lastRequestHeaders;
+}
+
+QByteArray HttpStandInServer::Response(const Reply& reply)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(reply.statusCode) +
+                          " StandIn\r\n";
+    response += "Content-Type: application/json\r\n";
+    response += "Content-Length: " + QByteArray::number(reply.body.size()) + "\r\n";
+    for (const auto& header : reply.headers) {
+        response += header.first + ": " + header.second + "\r\n";
+    }
+    response += "\r\n";
+    response += reply.body;
+    return response;
+}
+
+void HttpStandInServer::run()
+{
+    QTcpServer server;
+
+    if (!server.listen(QHostAddress::LocalHost, 0)) {
+        m_ready.release();
+        return;
+    }
+    m_port = server.serverPort();
+
+    QObject::connect(&server, &QTcpServer::newConnection, [this, &server]() {
+        while (server.hasPendingConnections()) {
+            QTcpSocket *socket = server.nextPendingConnection();
+            ++m_connectionCount;
+
+            auto buffer = std::make_shared<QByteArray>();
+            QObject::connect(socket, &QTcpSocket::readyRead, [this, socket, buffer]() {
+                buffer->append(socket->readAll());
+
+                // a keep-alive connection may carry several requests
+                for (;;) {
+                    int headerEnd = buffer->indexOf("\r\n\r\n");
+                    if (headerEnd < 0) return;
+
+                    QByteArray headers = buffer->left(headerEnd);
+                    int length = HeaderValue(headers, "content-length").toInt();
+                    int total = headerEnd + 4 + length;
+                    if (buffer->size() < total) return;
+
+                    Request request;
+                    QList<QByteArray> requestLine =
+                        headers.left(headers.indexOf("\r\n")).split(' ');
+                    request.method  = requestLine.value(0);
+                    request.path    = requestLine.value(1);
+                    request.headers = headers;
+                    request.body    = buffer->mid(headerEnd + 4, length);
+                    buffer->remove(0, total);
+
+                    {
+                        QMutexLocker lock(&m_lastRequestMutex);
+                        m_lastRequestHeaders = headers;
+                    }
+                    ++m_requestCount;
+
+                    int inFlight = ++m_inFlight;
+                    int peak = m_peakInFlight.load();
+                    while (inFlight > peak &&
+                           !m_peakInFlight.compare_exchange_weak(peak, inFlight)) {}
+
+                    Reply reply = m_handler(request);
+                    QByteArray response = Response(reply);
+                    QTimer::singleShot(reply.delayMs, socket, [this, socket, response]() {
+                        --m_inFlight;
+                        socket->write(response);
+                    });
+                }
+            });
+            QObject::connect(socket, &QTcpSocket::disconnected,
+                             socket, &QObject::deleteLater);
+        }
+    });
+
+    m_ready.release();
+    exec();
+}
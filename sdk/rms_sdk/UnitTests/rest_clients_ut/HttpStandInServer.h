@@ -0,0 +1,88 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef HTTPSTANDINSERVER_H
+#define HTTPSTANDINSERVER_H
+
+#include <atomic>
+#include <functional>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+
+// Minimal HTTP/1.1 server listening on localhost, used by the tests instead of
+// the real REST service. It runs its own event loop on a separate thread,
+// answers every request with the same canned response, or the one built by a
+// handler, after an optional delay and counts the requests and connections it
+// has seen.
+class HttpStandInServer : public QThread
+{
+public:
+    struct Request
+    {
+        QByteArray method;
+        QByteArray path; // with the query
+        QByteArray headers;
+        QByteArray body;
+
+        // the value of the header, case insensitive, or an empty array
+        QByteArray Header(const QByteArray& name) const;
+    };
+
+    struct Reply
+    {
+        int statusCode;
+        QByteArray body;
+        QList<QPair<QByteArray, QByteArray> > headers;
+        int delayMs;
+    };
+
+    // called on the server thread, once per request
+    typedef std::function<Reply(const Request&)> Handler;
+
+    explicit HttpStandInServer(Handler handler);
+    HttpStandInServer(int               statusCode,
+                      const QByteArray& body,
+                      int               delayMs = 0,
+                      const QList<QPair<QByteArray, QByteArray> >& headers =
+                        QList<QPair<QByteArray, QByteArray> >());
+    ~HttpStandInServer();
+
+    // starts listening and returns once the port is known
+    bool Start();
+    void Stop();
+
+    QByteArray Url(const QByteArray& path = QByteArray("/")) const;
+    int        RequestCount() const { return m_requestCount.load(); }
+    int        ConnectionCount() const { return m_connectionCount.load(); }
+    QByteArray LastRequestHeaders() const;
+
+    // the highest number of requests waiting for their response at once
+    int        PeakConcurrentRequests() const { return m_peakInFlight.load(); }
+
+protected:
+    void run() override;
+
+private:
+    static QByteArray Response(const Reply& reply);
+
+    Handler m_handler;
+
+    quint16 m_port;
+    QSemaphore m_ready;
+    std::atomic<int> m_requestCount;
+    std::atomic<int> m_connectionCount;
+    std::atomic<int> m_inFlight;
+    std::atomic<int> m_peakInFlight;
+
+    mutable QMutex m_lastRequestMutex;
+    QByteArray m_lastRequestHeaders;
+};
+#endif // HTTPSTANDINSERVER_H
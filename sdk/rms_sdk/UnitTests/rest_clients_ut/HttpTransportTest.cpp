@@ -0,0 +1,171 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QProcess>
+#include "HttpTransportTest.h"
+#include "HttpStandInServer.h"
+#include "../../Platform/Http/IHttpClient.h"
+#include "../../Platform/Settings/IRMSEnvironmentImpl.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::platform::http;
+
+static StatusCode Get(const string& url)
+{
+    auto pHttpClient = IHttpClient::Create();
+    common::ByteArray response;
+    return pHttpClient->Get(url, response, nullptr);
+}
+
+void HttpTransportTest::test_ConnectionIsReused()
+{
+    HttpStandInServer server(200, "{}");
+    QVERIFY(server.Start());
+
+    const string url = server.Url("/my/v1/servicediscovery").toStdString();
+
+    for (int i = 0; i < 5; ++i) {
+        QVERIFY(Get(url) == StatusCode::OK);
+    }
+
+    QCOMPARE(server.RequestCount(), 5);
+    QCOMPARE(server.ConnectionCount(), 1);
+}
+
+void HttpTransportTest::test_HeadersAreNotShared()
+{
+    HttpStandInServer server(200, "{}");
+    QVERIFY(server.Start());
+
+    const string url = server.Url().toStdString();
+    common::ByteArray response;
+
+    auto pFirstClient = IHttpClient::Create();
+    pFirstClient->AddHeader("x-ms-rms-request-id", "first");
+    pFirstClient->Get(url, response, nullptr);
+    QVERIFY(server.LastRequestHeaders().contains("x-ms-rms-request-id: first"));
+
+    QVERIFY(Get(url) == StatusCode::OK);
+    QVERIFY(!server.LastRequestHeaders().contains("x-ms-rms-request-id"));
+}
+
+void HttpTransportTest::test_MaxConnectionsPerHost()
+{
+    HttpStandInServer server(200, "{}", 200);
+    QVERIFY(server.Start());
+
+    auto environment = platform::settings::IRMSEnvironmentImpl::Environment();
+    environment->MaxConnectionsPerHost(1);
+
+    const string url = server.Url().toStdString();
+    vector<thread> threads;
+
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&url]() { Get(url); });
+    }
+    for (auto& t : threads) t.join();
+
+    environment->MaxConnectionsPerHost(6);
+
+    // the requests were queued by the transport and sent one after another
+    QCOMPARE(server.RequestCount(), 4);
+    QCOMPARE(server.ConnectionCount(), 1);
+}
+
+void HttpTransportTest::test_CancellationIsImmediate()
+{
+    HttpStandInServer server(200, "{}", 3000);
+    QVERIFY(server.Start());
+
+    auto cancelState = make_shared<atomic<bool> >(false);
+    thread canceller([cancelState]() {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        cancelState->store(true);
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    auto pHttpClient = IHttpClient::Create();
+    common::ByteArray response;
+    bool cancelled = false;
+
+    try {
+        pHttpClient->Get(server.Url().toStdString(), response, cancelState);
+    } catch (exceptions::RMSNetworkException& e) {
+        cancelled = e.reason() == exceptions::RMSNetworkException::CancelledByUser;
+    }
+    canceller.join();
+
+    QVERIFY(cancelled);
+    QVERIFY2(timer.elapsed() < 300, "cancellation was not delivered promptly");
+}
+
+void HttpTransportTest::test_SendAsyncCallback()
+{
+    HttpStandInServer server(200, "{\"Status\":\"OK\"}", 100);
+    QVERIFY(server.Start());
+
+    HttpRequest request;
+    request.method = "GET";
+    request.url    = server.Url().toStdString();
+
+    atomic<int> callbacks(0);
+    vector<shared_future<HttpResponse> > futures;
+
+    // all the requests are in flight at the same time, driven by the I/O thread
+    for (int i = 0; i < 8; ++i) {
+        futures.push_back(IHttpClient::Create()->SendAsync(
+            request, nullptr, [&callbacks](const HttpResponse& response) {
+                if (response.statusCode == 200) ++callbacks;
+            }));
+    }
+
+    for (auto& future : futures) {
+        QCOMPARE(future.get().statusCode, 200);
+        QCOMPARE(string(future.get().body.begin(), future.get().body.end()),
+                 string("{\"Status\":\"OK\"}"));
+    }
+    QCOMPARE(callbacks.load(), 8);
+    QCOMPARE(server.RequestCount(), 8);
+}
+
+const char HttpTransportTest::NoApplicationArg[] = "--get-without-application";
+
+int HttpTransportTest::GetWithoutApplication(const char *url)
+{
+    try {
+        return Get(url) == StatusCode::OK ? 0 : 1;
+    } catch (exceptions::RMSException&) {
+        return 2;
+    }
+}
+
+void HttpTransportTest::test_HostWithoutApplication()
+{
+    HttpStandInServer server(200, "{}");
+    QVERIFY(server.Start());
+
+    // the transport of this process already has the application of the
+    // tests, a console host is run in a process of its own
+    QProcess host;
+    host.start(QCoreApplication::applicationFilePath(),
+               QStringList() << NoApplicationArg << QString::fromLatin1(server.Url()));
+    QVERIFY(host.waitForFinished(10000));
+
+    QCOMPARE(host.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(host.exitCode(), 0);
+    QCOMPARE(server.RequestCount(), 1);
+}
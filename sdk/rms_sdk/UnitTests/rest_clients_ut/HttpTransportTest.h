@@ -0,0 +1,30 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef HTTPTRANSPORTTEST_H
+#define HTTPTRANSPORTTEST_H
+#include <QtTest>
+
+class HttpTransportTest : public QObject
+{
+    Q_OBJECT
+public:
+    // main() runs GetWithoutApplication(url) instead of the tests when the
+    // first argument is this, before creating its QCoreApplication
+    static const char NoApplicationArg[];
+    static int GetWithoutApplication(const char *url);
+
+private Q_SLOTS:
+    void test_ConnectionIsReused();
+    void test_HeadersAreNotShared();
+    void test_MaxConnectionsPerHost();
+    void test_CancellationIsImmediate();
+    void test_SendAsyncCallback();
+    void test_HostWithoutApplication();
+};
+#endif // HTTPTRANSPORTTEST_H
@@ -0,0 +1,553 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include "JsonSerializerTest.h"
+#include "LicenseParserTestConstants.h"
+#include "../../Json/IJsonSerializer.h"
+#include "../../Json/JsonWriter.h"
+#include "../../Common/tools.h"
+#include "../../Platform/Json/IJsonObject.h"
+#include "../../Platform/Json/IJsonArray.h"
+#include "../../Platform/Json/IJsonParser.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::common;
+using namespace rmscore::json;
+using namespace rmscore::platform::json;
+using namespace rmscore::restclients;
+
+static string ToString(const ByteArray& bytes)
+{
+    return string(bytes.begin(), bytes.end());
+}
+
+// what the serializers built before they wrote the JSON directly
+static ByteArray SerializeWithTree(const UsageRestrictionsRequest& request)
+{
+    auto pJsonObject = IJsonObject::Create();
+    pJsonObject->SetNamedValue("SerializedPublishingLicense",
+                               ConvertBytesToBase64(request.pbPublishLicense,
+                                                    request.cbPublishLicense));
+    return pJsonObject->Stringify();
+}
+
+static shared_ptr<IJsonObject> AppDataWithTree(const modernapi::AppDataHashMap& appData)
+{
+    auto pJson = IJsonObject::Create();
+
+    for (auto& item : appData)
+    {
+        pJson->SetNamedString(item.first, item.second);
+    }
+    return pJson;
+}
+
+static shared_ptr<IJsonArray> StringsWithTree(const vector<string>& values)
+{
+    auto pJson = IJsonArray::Create();
+
+    for (auto& value : values)
+    {
+        pJson->Append(value);
+    }
+    return pJson;
+}
+
+static ByteArray SerializeWithTree(const PublishUsingTemplateRequest& request)
+{
+    auto pJson = IJsonObject::Create();
+
+    pJson->SetNamedBool("PreferDeprecatedAlgorithms", request.bPreferDeprecatedAlgorithms);
+    pJson->SetNamedBool("AllowAuditedExtraction", request.bAllowAuditedExtraction);
+    pJson->SetNamedString("TemplateId", request.templateId);
+
+    if (!request.signedApplicationData.empty())
+    {
+        pJson->SetNamedObject("SignedApplicationData", *AppDataWithTree(request.signedApplicationData));
+    }
+    return pJson->Stringify();
+}
+
+static ByteArray SerializeWithTree(const PublishCustomRequest& request)
+{
+    auto pJson = IJsonObject::Create();
+
+    pJson->SetNamedBool("PreferDeprecatedAlgorithms", request.bPreferDeprecatedAlgorithms);
+    pJson->SetNamedBool("AllowAuditedExtraction", request.bAllowAuditedExtraction);
+
+    if (request.wsReferralInfo.length() > 0)
+    {
+        pJson->SetNamedString("ReferralInfo", request.wsReferralInfo);
+    }
+
+    if (!request.signedApplicationData.empty())
+    {
+        pJson->SetNamedObject("SignedApplicationData", *AppDataWithTree(request.signedApplicationData));
+    }
+
+    auto pPolicyJson = IJsonObject::Create();
+
+    if (!request.name.empty() && !request.description.empty() && !request.language.empty())
+    {
+        auto pDescriptors = IJsonArray::Create();
+        auto pDescriptor  = IJsonObject::Create();
+        pDescriptor->SetNamedString("Name", request.name);
+        pDescriptor->SetNamedString("Description", request.description);
+        pDescriptor->SetNamedString("Language", request.language);
+        pDescriptors->Append(*pDescriptor);
+        pPolicyJson->SetNamedArray("Descriptors", *pDescriptors);
+    }
+
+    auto pUserRightsOrRoles = IJsonArray::Create();
+
+    for (auto& userRights : request.userRightsList)
+    {
+        auto pUserRights = IJsonObject::Create();
+        pUserRights->SetNamedArray("Users", *StringsWithTree(userRights.users));
+        pUserRights->SetNamedArray("Rights", *StringsWithTree(userRights.rights));
+        pUserRightsOrRoles->Append(*pUserRights);
+    }
+
+    for (auto& userRoles : request.userRolesList)
+    {
+        auto pUserRoles = IJsonObject::Create();
+        pUserRoles->SetNamedArray("Users", *StringsWithTree(userRoles.users));
+        pUserRoles->SetNamedArray("Roles", *StringsWithTree(userRoles.roles));
+        pUserRightsOrRoles->Append(*pUserRoles);
+    }
+
+    pPolicyJson->SetNamedArray(request.userRightsList.empty() ? "UserRoles" : "UserRights",
+                               *pUserRightsOrRoles);
+    pPolicyJson->SetNamedBool("allowOfflineAccess", request.bAllowOfflineAccess);
+    pPolicyJson->SetNamedNumber("IntervalTimeInDays", request.bAllowOfflineAccess ? 30 : 0);
+
+    if (!request.encryptedApplicationData.empty())
+    {
+        pPolicyJson->SetNamedObject("EncryptedApplicationData", *AppDataWithTree(request.encryptedApplicationData));
+    }
+
+    pJson->SetNamedObject("Policy", *pPolicyJson);
+    return pJson->Stringify();
+}
+
+// what the deserializers did before they read the JSON in one pass, minus
+// the referrer and date post-processing they still share
+static UsageRestrictionsResponse DeserializeWithTree(ByteArray& sResponse)
+{
+    UsageRestrictionsResponse response;
+    auto pJsonResponse = IJsonParser::Create()->Parse(sResponse);
+
+    if (pJsonResponse == nullptr) return response;
+
+    response.accessStatus = pJsonResponse->GetNamedString("AccessStatus");
+    response.id           = pJsonResponse->GetNamedString("Id");
+    response.name         = pJsonResponse->GetNamedString("Name");
+    response.description  = pJsonResponse->GetNamedString("Description");
+    response.referrer     = pJsonResponse->GetNamedString("Referrer");
+    response.owner        = pJsonResponse->GetNamedString("Owner");
+    response.issuedTo     = pJsonResponse->GetNamedString("IssuedTo");
+    response.contentId    = pJsonResponse->GetNamedString("ContentId");
+
+    if (pJsonResponse->HasName("Key") && !pJsonResponse->IsNull("Key"))
+    {
+        auto pJsonKey = pJsonResponse->GetNamedObject("Key");
+        response.key.algorithm  = pJsonKey->GetNamedString("Algorithm");
+        response.key.cipherMode = pJsonKey->GetNamedString("CipherMode");
+        response.key.value      = pJsonKey->GetNamedValue("Value");
+    }
+
+    response.rights = pJsonResponse->GetNamedStringArray("Rights");
+
+    if (pJsonResponse->HasName("Roles") && !pJsonResponse->IsNull("Roles"))
+    {
+        response.roles = pJsonResponse->GetNamedStringArray("Roles");
+    }
+
+    response.contentValidUntil = pJsonResponse->GetNamedString("ContentValidUntil");
+    response.licenseValidUntil = pJsonResponse->GetNamedString("LicenseValidUntil");
+    response.bFromTemplate     = pJsonResponse->GetNamedBool("FromTemplate");
+    response.bAllowOfflineAccess = pJsonResponse->HasName("allowOfflineAccess")
+        ? pJsonResponse->GetNamedBool("allowOfflineAccess", true) : true;
+
+    if (pJsonResponse->HasName("Policy") && !pJsonResponse->IsNull("Policy"))
+    {
+        auto pJsonPolicy = pJsonResponse->GetNamedObject("Policy");
+
+        if (pJsonPolicy->GetNamedNumber("IntervalTimeInDays", -1.0) <= 0)
+        {
+            response.bAllowOfflineAccess = false;
+        }
+        response.customPolicy.bAllowAuditedExtraction =
+            pJsonPolicy->GetNamedBool("AllowAuditedExtraction", false);
+
+        auto pJsonUserRightsList = pJsonPolicy->GetNamedArray("UserRights");
+
+        for (unsigned i = 0; i < pJsonUserRightsList->Size(); ++i)
+        {
+            auto pJsonUserRights = pJsonUserRightsList->GetObjectAt(i);
+            UserRightsResponse userRights;
+            userRights.users  = pJsonUserRights->GetNamedStringArray("Users");
+            userRights.rights = pJsonUserRights->GetNamedStringArray("Rights");
+            response.customPolicy.userRightsList.emplace_back(move(userRights));
+        }
+        response.customPolicy.bIsNull = false;
+    }
+    else
+    {
+        response.customPolicy.bIsNull = true;
+    }
+
+    if (pJsonResponse->HasName("SignedApplicationData") &&
+        !pJsonResponse->IsNull("SignedApplicationData"))
+    {
+        response.signedApplicationData =
+            pJsonResponse->GetNamedObject("SignedApplicationData")->ToStringDictionary();
+    }
+    return response;
+}
+
+static TemplateListResponse DeserializeTemplatesWithTree(ByteArray& sResponse)
+{
+    auto pJsonArray = IJsonParser::Create()->ParseArray(sResponse);
+    TemplateListResponse response;
+
+    for (uint32_t index = 0; index < pJsonArray->Size(); ++index)
+    {
+        auto pTemplateJson = pJsonArray->GetObjectAt(index);
+
+        response.templates.push_back(TemplateResponse {
+            pTemplateJson->GetNamedString("Id"),
+            pTemplateJson->GetNamedString("Name"),
+            pTemplateJson->GetNamedString("Description")
+        });
+    }
+    return response;
+}
+
+static ByteArray ToBytes(const string& text)
+{
+    return ByteArray(text.begin(), text.end());
+}
+
+// a usage restrictions response granting rights to many users
+static ByteArray ManyRightsResponse(int users)
+{
+    string json =
+        "{\"AccessStatus\":\"AccessGranted\",\"Id\":\"id\",\"Name\":\"Custom \\\"quoted\\\"\","
+        "\"Description\":\"caf\\u00e9\",\"Referrer\":\"mailto:owner@contoso.com\","
+        "\"Owner\":\"owner@contoso.com\",\"IssuedTo\":\"user@contoso.com\","
+        "\"Key\":{\"Algorithm\":\"AES\",\"CipherMode\":\"CBC4K\",\"Value\":\"AAECAwQFBgcICQoLDA0ODw==\"},"
+        "\"Rights\":[\"VIEW\",\"EDIT\",\"PRINT\"],\"Roles\":null,"
+        "\"ContentValidUntil\":null,\"LicenseValidUntil\":null,"
+        "\"FromTemplate\":false,\"ContentId\":\"{content}\",\"Unknown\":{\"a\":[1,{}]},"
+        "\"SignedApplicationData\":{\"name\":\"value\",\"number\":2},"
+        "\"Policy\":{\"AllowAuditedExtraction\":true,\"IntervalTimeInDays\":30,\"UserRights\":[";
+
+    for (int i = 0; i < users; ++i)
+    {
+        if (i > 0) json += ",";
+        json += "{\"Users\":[\"user" + to_string(i) + "@contoso.com\"],"
+                "\"Rights\":[\"VIEW\",\"EDIT\",\"EXTRACT\",\"PRINT\"]}";
+    }
+    return ToBytes(json + "]}}");
+}
+
+static ByteArray TemplateList(int templates)
+{
+    string json = "[";
+
+    for (int i = 0; i < templates; ++i)
+    {
+        if (i > 0) json += ",";
+        json += "{\"Id\":\"{" + to_string(i) + "}\",\"Name\":\"Template " + to_string(i) +
+                "\",\"Description\":\"Only the recipients can view \\u00e0 \\/ " +
+                to_string(i) + "\",\"Extra\":[true,null,1.5e3]}";
+    }
+    return ToBytes(json + "]");
+}
+
+void JsonSerializerTest::test_WriterEscapesLikeQt()
+{
+    const string values[] = {
+        "plain", "", "quote \" backslash \\ slash /",
+        "\b\f\n\r\t", string("nul \0 and \x01\x1f\x7f", 13),
+        "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80"
+    };
+
+    for (auto& value : values)
+    {
+        ByteArray written;
+        JsonWriter writer(written);
+        writer.BeginArray().String(value).EndArray();
+
+        QJsonArray array;
+        array.append(QString::fromStdString(value));
+        auto expected = QJsonDocument(array).toJson(QJsonDocument::Compact);
+
+        QCOMPARE(ToString(written), expected.toStdString());
+    }
+}
+
+void JsonSerializerTest::test_WriterBase64()
+{
+    const string data = "any carnal pleasure.";
+
+    for (size_t size = 0; size <= data.size(); ++size)
+    {
+        ByteArray written;
+        JsonWriter writer(written);
+        writer.Base64(data.data(), size);
+
+        auto expected = QByteArray(data.data(), static_cast<int>(size)).toBase64();
+        QCOMPARE(ToString(written), "\"" + expected.toStdString() + "\"");
+    }
+}
+
+void JsonSerializerTest::test_UsageRestrictionsRequest()
+{
+    UsageRestrictionsRequest request;
+    request.pbPublishLicense = PL_0101right_CBC_xml;
+    request.cbPublishLicense = PL_0101right_CBC_xml_len;
+
+    auto serialized = IJsonSerializer::Create()->SerializeUsageRestrictionsRequest(request);
+    QCOMPARE(ToString(serialized), ToString(SerializeWithTree(request)));
+}
+
+void JsonSerializerTest::test_PublishUsingTemplateRequest()
+{
+    PublishUsingTemplateRequest request;
+    request.bPreferDeprecatedAlgorithms = false;
+    request.bAllowAuditedExtraction     = true;
+    request.templateId = "{00000000-0000-0000-0000-000000000000}";
+
+    QCOMPARE(ToString(IJsonSerializer::Create()->SerializePublishUsingTemplateRequest(request)),
+             ToString(SerializeWithTree(request)));
+
+    // app data members come out sorted, as QJsonObject kept them
+    request.signedApplicationData["zeta"]           = "last";
+    request.signedApplicationData["Alpha"]          = "first \"quoted\"";
+    request.signedApplicationData["alpha"]          = "after the upper case";
+    request.signedApplicationData["\xef\xbc\xa1"]   = "U+FF21";
+    request.signedApplicationData["\xf0\x9f\x98\x80"] = "U+1F600, before U+FF21 in UTF-16";
+
+    QCOMPARE(ToString(IJsonSerializer::Create()->SerializePublishUsingTemplateRequest(request)),
+             ToString(SerializeWithTree(request)));
+}
+
+void JsonSerializerTest::test_PublishCustomRequest()
+{
+    PublishCustomRequest request(true, false);
+    request.bAllowOfflineAccess = false;
+    request.ftLicenseValidUntil = chrono::system_clock::from_time_t(0);
+
+    // neither rights nor roles, nor descriptors
+    QCOMPARE(ToString(IJsonSerializer::Create()->SerializePublishCustomRequest(request)),
+             ToString(SerializeWithTree(request)));
+
+    request.wsReferralInfo      = "mailto:owner@contoso.com";
+    request.name                = "Name";
+    request.description         = "Description\nwith a new line";
+    request.language            = "en-us";
+    request.bAllowOfflineAccess = true;
+    request.userRightsList.push_back({ { "user1@contoso.com", "user2@contoso.com" },
+                                       { "VIEW", "EDIT" } });
+    request.userRightsList.push_back({ { "user3@contoso.com" }, { "OWNER" } });
+    request.signedApplicationData["signed"]       = "value";
+    request.encryptedApplicationData["encrypted"] = "value";
+    request.encryptedApplicationData["Encrypted"] = "value";
+
+    QCOMPARE(ToString(IJsonSerializer::Create()->SerializePublishCustomRequest(request)),
+             ToString(SerializeWithTree(request)));
+
+    request.userRightsList.clear();
+    request.userRolesList.push_back({ { "user1@contoso.com" }, { "Viewer" } });
+
+    QCOMPARE(ToString(IJsonSerializer::Create()->SerializePublishCustomRequest(request)),
+             ToString(SerializeWithTree(request)));
+}
+
+void JsonSerializerTest::benchmark_SerializeUsageRestrictionsRequest()
+{
+    UsageRestrictionsRequest request;
+    request.pbPublishLicense = PL_0101right_ECB_xml;
+    request.cbPublishLicense = PL_0101right_ECB_xml_len;
+    auto pSerializer = IJsonSerializer::Create();
+
+    QBENCHMARK {
+        pSerializer->SerializeUsageRestrictionsRequest(request);
+    }
+}
+
+void JsonSerializerTest::benchmark_SerializeUsageRestrictionsRequestWithTree()
+{
+    UsageRestrictionsRequest request;
+    request.pbPublishLicense = PL_0101right_ECB_xml;
+    request.cbPublishLicense = PL_0101right_ECB_xml_len;
+
+    QBENCHMARK {
+        SerializeWithTree(request);
+    }
+}
+
+void JsonSerializerTest::test_UsageRestrictionsResponse()
+{
+    auto json     = ManyRightsResponse(3);
+    auto response = IJsonSerializer::Create()->DeserializeUsageRestrictionsResponse(json);
+    auto expected = DeserializeWithTree(json);
+
+    QCOMPARE(response.accessStatus, expected.accessStatus);
+    QCOMPARE(response.id, expected.id);
+    QCOMPARE(response.name, string("Custom \"quoted\""));
+    QCOMPARE(response.description, string("caf\xc3\xa9"));
+    QCOMPARE(response.referrer, expected.referrer);
+    QCOMPARE(response.owner, expected.owner);
+    QCOMPARE(response.issuedTo, expected.issuedTo);
+    QCOMPARE(response.contentId, expected.contentId);
+    QVERIFY(response.key.value == expected.key.value);
+    QCOMPARE(response.key.algorithm, expected.key.algorithm);
+    QCOMPARE(response.key.cipherMode, expected.key.cipherMode);
+    QVERIFY(response.rights == expected.rights);
+    QVERIFY(response.roles.empty());
+    QCOMPARE(response.bFromTemplate, expected.bFromTemplate);
+    QCOMPARE(response.bAllowOfflineAccess, expected.bAllowOfflineAccess);
+    QVERIFY(!response.customPolicy.bIsNull);
+    QCOMPARE(response.customPolicy.bAllowAuditedExtraction,
+             expected.customPolicy.bAllowAuditedExtraction);
+    QCOMPARE(response.customPolicy.userRightsList.size(), static_cast<size_t>(3));
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        QVERIFY(response.customPolicy.userRightsList[i].users ==
+                expected.customPolicy.userRightsList[i].users);
+        QVERIFY(response.customPolicy.userRightsList[i].rights ==
+                expected.customPolicy.userRightsList[i].rights);
+    }
+    QVERIFY(response.signedApplicationData == expected.signedApplicationData);
+    QCOMPARE(response.signedApplicationData["number"], string("2"));
+}
+
+void JsonSerializerTest::test_UsageRestrictionsResponseDefaults()
+{
+    auto json     = ToBytes("{\"Id\":\"id\",\"Rights\":[],\"Policy\":{\"UserRights\":[]}}");
+    auto response = IJsonSerializer::Create()->DeserializeUsageRestrictionsResponse(json);
+
+    // no key, no access
+    QCOMPARE(response.accessStatus, string("AccessDenied"));
+    // a policy without an offline interval doesn't allow offline access
+    QVERIFY(!response.bAllowOfflineAccess);
+    QVERIFY(!response.customPolicy.bIsNull);
+    QVERIFY(!response.customPolicy.bAllowAuditedExtraction);
+    QVERIFY(!response.bFromTemplate);
+    QVERIFY(response.ftLicenseValidUntil == chrono::system_clock::from_time_t(0));
+
+    json     = ToBytes("{\"Key\":{\"Value\":\"AA==\"}}");
+    response = IJsonSerializer::Create()->DeserializeUsageRestrictionsResponse(json);
+    QCOMPARE(response.accessStatus, string("AccessGranted"));
+    QVERIFY(response.bAllowOfflineAccess);
+    QVERIFY(response.customPolicy.bIsNull);
+}
+
+void JsonSerializerTest::test_TemplateListResponse()
+{
+    auto json     = TemplateList(5);
+    auto response = IJsonSerializer::Create()->DeserializeTemplateListResponse(json);
+    auto expected = DeserializeTemplatesWithTree(json);
+
+    QCOMPARE(response.templates.size(), static_cast<size_t>(5));
+
+    for (size_t i = 0; i < 5; ++i)
+    {
+        QCOMPARE(response.templates[i].id, expected.templates[i].id);
+        QCOMPARE(response.templates[i].name, expected.templates[i].name);
+        QCOMPARE(response.templates[i].description, expected.templates[i].description);
+    }
+
+    json = ToBytes("[{\"Id\":\"{0}\",\"Name\":null,\"Description\":\"d\"}]");
+    QVERIFY_EXCEPTION_THROWN(IJsonSerializer::Create()->DeserializeTemplateListResponse(json),
+                             rmscore::exceptions::RMSInvalidArgumentException);
+}
+
+void JsonSerializerTest::test_ServiceDiscoveryResponse()
+{
+    auto json = ToBytes(
+        "[{\"Name\":\"LicensingExternalUrl\",\"Uri\":\"https:\\/\\/contoso.com\\/licensing\"},"
+        " {\"Name\":\"TemplatesExternalUrl\",\"Uri\":\"https://contoso.com/templates\",\"Version\":2}]");
+    auto response = IJsonSerializer::Create()->DeserializeServiceDiscoveryResponse(json);
+
+    QCOMPARE(response.serviceEndpoints.size(), static_cast<size_t>(2));
+    QCOMPARE(response.serviceEndpoints[0].uri, string("https://contoso.com/licensing"));
+    QCOMPARE(response.serviceEndpoints[1].name, string("TemplatesExternalUrl"));
+
+    json = ToBytes("[{\"Name\":\"LicensingExternalUrl\"}]");
+    QVERIFY_EXCEPTION_THROWN(IJsonSerializer::Create()->DeserializeServiceDiscoveryResponse(json),
+                             rmscore::exceptions::RMSInvalidArgumentException);
+}
+
+void JsonSerializerTest::test_MalformedResponses()
+{
+    auto pSerializer = IJsonSerializer::Create();
+
+    // a malformed usage restrictions response reads as an empty one
+    auto json = ToBytes("{\"AccessStatus\":\"AccessGranted\",");
+    QVERIFY(pSerializer->DeserializeUsageRestrictionsResponse(json).accessStatus.empty());
+
+    // the lists throw instead
+    json = ToBytes("[{\"Id\":\"{0}\"");
+    QVERIFY_EXCEPTION_THROWN(pSerializer->DeserializeTemplateListResponse(json),
+                             rmscore::exceptions::RMSInvalidArgumentException);
+
+    json = ToBytes("{\"Name\":\"not a list\"}");
+    QVERIFY_EXCEPTION_THROWN(pSerializer->DeserializeServiceDiscoveryResponse(json),
+                             rmscore::exceptions::RMSInvalidArgumentException);
+
+    // a string where a boolean belongs
+    json = ToBytes("{\"FromTemplate\":\"yes\"}");
+    QVERIFY_EXCEPTION_THROWN(pSerializer->DeserializeUsageRestrictionsResponse(json),
+                             rmscore::exceptions::RMSInvalidArgumentException);
+}
+
+void JsonSerializerTest::benchmark_DeserializeUsageRestrictionsResponse()
+{
+    auto json        = ManyRightsResponse(1000);
+    auto pSerializer = IJsonSerializer::Create();
+
+    QBENCHMARK {
+        pSerializer->DeserializeUsageRestrictionsResponse(json);
+    }
+}
+
+void JsonSerializerTest::benchmark_DeserializeUsageRestrictionsResponseWithTree()
+{
+    auto json = ManyRightsResponse(1000);
+
+    QBENCHMARK {
+        DeserializeWithTree(json);
+    }
+}
+
+void JsonSerializerTest::benchmark_DeserializeTemplateListResponse()
+{
+    auto json        = TemplateList(1000);
+    auto pSerializer = IJsonSerializer::Create();
+
+    QBENCHMARK {
+        pSerializer->DeserializeTemplateListResponse(json);
+    }
+}
+
+void JsonSerializerTest::benchmark_DeserializeTemplateListResponseWithTree()
+{
+    auto json = TemplateList(1000);
+
+    QBENCHMARK {
+        DeserializeTemplatesWithTree(json);
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef JSONSERIALIZERTEST_H
+#define JSONSERIALIZERTEST_H
+#include <QtTest>
+
+class JsonSerializerTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_WriterEscapesLikeQt();
+    void test_WriterBase64();
+    void test_UsageRestrictionsRequest();
+    void test_PublishUsingTemplateRequest();
+    void test_PublishCustomRequest();
+    void test_UsageRestrictionsResponse();
+    void test_UsageRestrictionsResponseDefaults();
+    void test_TemplateListResponse();
+    void test_ServiceDiscoveryResponse();
+    void test_MalformedResponses();
+
+    // the writer against the IJsonObject tree it replaced
+    void benchmark_SerializeUsageRestrictionsRequest();
+    void benchmark_SerializeUsageRestrictionsRequestWithTree();
+
+    // the pull parser against the IJsonObject tree it replaced, on a
+    // response with many rights and on a long template list
+    void benchmark_DeserializeUsageRestrictionsResponse();
+    void benchmark_DeserializeUsageRestrictionsResponseWithTree();
+    void benchmark_DeserializeTemplateListResponse();
+    void benchmark_DeserializeTemplateListResponseWithTree();
+};
+#endif // JSONSERIALIZERTEST_H
@@ -8,8 +8,12 @@
 
 #include "LicenseParserTest.h"
 #include "LicenseParserTestConstants.h"
+#include "../../RestClients/CXMLUtils.h"
 #include "../../RestClients/LicenseParser.h"
 #include "../../Common/CommonTypes.h"
+#include "../../ModernAPI/RMSExceptions.h"
+#include "../../Platform/Xml/IDomDocument.h"
+#include "../../Platform/Xml/IDomElement.h"
 #include <QFile>
 #include <sstream>
 
@@ -17,11 +21,118 @@ using namespace std;
 using namespace rmscore::common;
 using namespace rmscore::restclients;
 
+static const string LICENSING_URL =
+    "https://c04a2344-eae8-4d4f-89dc-036792332149.rms.na.aadrm.com/_wmcs/licensing";
+
 void LicenseParserTest::test_UTF16LE_License()
 {
     shared_ptr<uint8_t> spData(new uint8_t[PL_0101right_ECB_xml_len]);
     memcpy(spData.get(), PL_0101right_ECB_xml, PL_0101right_ECB_xml_len);
     auto licenseParserResult = LicenseParser::ParsePublishingLicense(spData.get(), PL_0101right_ECB_xml_len);
+
+    // the extranet and intranet URLs are the same
+    auto& domains = licenseParserResult->GetDomains();
+    QCOMPARE(domains.size(), static_cast<size_t>(1));
+    QCOMPARE(domains[0]->GetOriginalInput(), LICENSING_URL);
+    QVERIFY(licenseParserResult->GetServerPublicCertificate() != nullptr);
+    QVERIFY(!licenseParserResult->GetServerPublicCertificate()->empty());
+}
+
+void LicenseParserTest::test_InvalidLicense()
+{
+    const char license[] = "\xef\xbb\xbf<XrML><BODY type=\"Microsoft Rights Label\"><DISTRIBUTIONPOINT>";
+    bool thrown = false;
+
+    try
+    {
+        LicenseParser::ParsePublishingLicense(license, sizeof(license));
+    }
+    catch (rmscore::exceptions::RMSNetworkException& e)
+    {
+        thrown = e.reason() == rmscore::exceptions::RMSNetworkException::InvalidPL;
+    }
+    QVERIFY(thrown);
+}
+
+void LicenseParserTest::test_MemoizedLicense()
+{
+    LicenseParser::ClearCache();
+
+    auto first = LicenseParser::ParsePublishingLicense(PL_0101right_CBC_xml, PL_0101right_CBC_xml_len);
+
+    // memoized by content, not by address
+    vector<uint8_t> copy(PL_0101right_CBC_xml, PL_0101right_CBC_xml + PL_0101right_CBC_xml_len);
+    QVERIFY(LicenseParser::ParsePublishingLicense(copy.data(), copy.size()) == first);
+
+    // a license that differs in a single byte is parsed again
+    copy[copy.size() / 2] ^= 1;
+    bool reparsed = false;
+
+    try
+    {
+        reparsed = LicenseParser::ParsePublishingLicense(copy.data(), copy.size()) != first;
+    }
+    catch (rmscore::exceptions::RMSNetworkException&)
+    {
+        reparsed = true;
+    }
+    QVERIFY(reparsed);
+
+    LicenseParser::ClearCache();
+    QVERIFY(LicenseParser::ParsePublishingLicense(PL_0101right_CBC_xml, PL_0101right_CBC_xml_len) != first);
+}
+
+void LicenseParserTest::benchmark_ParsePublishingLicense()
+{
+    QBENCHMARK {
+        LicenseParser::ClearCache();
+        LicenseParser::ParsePublishingLicense(PL_0101right_ECB_xml, PL_0101right_ECB_xml_len);
+        LicenseParser::ParsePublishingLicense(PL_0101right_CBC_xml, PL_0101right_CBC_xml_len);
+    }
+}
+
+void LicenseParserTest::benchmark_ParsePublishingLicenseMemoized()
+{
+    LicenseParser::ParsePublishingLicense(PL_0101right_ECB_xml, PL_0101right_ECB_xml_len);
+    LicenseParser::ParsePublishingLicense(PL_0101right_CBC_xml, PL_0101right_CBC_xml_len);
+
+    QBENCHMARK {
+        LicenseParser::ParsePublishingLicense(PL_0101right_ECB_xml, PL_0101right_ECB_xml_len);
+        LicenseParser::ParsePublishingLicense(PL_0101right_CBC_xml, PL_0101right_CBC_xml_len);
+    }
+}
+
+// what ParsePublishingLicense did for a UTF-8 license before it streamed
+static void ParseWithDom(const uint8_t *pbLicense, size_t cbLicense)
+{
+    const string xpaths[] = {
+        "/Root/XrML/BODY[@type='Microsoft Rights Label']/DISTRIBUTIONPOINT/OBJECT[@type='Extranet-License-Acquisition-URL']/ADDRESS[@type='URL']/text()",
+        "/Root/XrML/BODY[@type='Microsoft Rights Label']/DISTRIBUTIONPOINT/OBJECT[@type='License-Acquisition-URL']/ADDRESS[@type='URL']/text()",
+        "/Root/XrML/BODY[@type='Microsoft Rights Label']/ISSUEDPRINCIPALS/PRINCIPAL/PUBLICKEY/PARAMETER[@name='modulus']/VALUE/text()"
+    };
+
+    string license(reinterpret_cast<const char *>(pbLicense), cbLicense);
+    string wrapped;
+    CXMLUtils::WrapWithRoot(license.c_str(), license.size(), wrapped);
+
+    auto document = IDomDocument::create();
+    string errMsg;
+    int errLine = 0;
+    int errColumn = 0;
+    QVERIFY(document->setContent(wrapped, errMsg, errLine, errColumn));
+
+    for (auto& xpath : xpaths)
+    {
+        QVERIFY(document->SelectSingleNode(xpath) != nullptr);
+    }
+}
+
+void LicenseParserTest::benchmark_ParsePublishingLicenseWithDom()
+{
+    // skips the BOM
+    QBENCHMARK {
+        ParseWithDom(PL_0101right_CBC_xml + 3, PL_0101right_CBC_xml_len - 3);
+    }
 }
 
 void LicenseParserTest::test_UTF8_License()
@@ -29,4 +140,7 @@ void LicenseParserTest::test_UTF8_License()
     shared_ptr<uint8_t> spData(new uint8_t[PL_0101right_CBC_xml_len]);
     memcpy(spData.get(), PL_0101right_CBC_xml, PL_0101right_CBC_xml_len);
     auto licenseParserResult = LicenseParser::ParsePublishingLicense(spData.get(), PL_0101right_CBC_xml_len);
+
+    QVERIFY(!licenseParserResult->GetDomains().empty());
+    QVERIFY(licenseParserResult->GetServerPublicCertificate() != nullptr);
 }
@@ -16,5 +16,12 @@ class LicenseParserTest : public QObject
 private Q_SLOTS:
     void test_UTF8_License();
     void test_UTF16LE_License();
+    void test_InvalidLicense();
+    void test_MemoizedLicense();
+
+    // the single pass extractor against the DOM and XQuery it replaced
+    void benchmark_ParsePublishingLicense();
+    void benchmark_ParsePublishingLicenseWithDom();
+    void benchmark_ParsePublishingLicenseMemoized();
 };
 #endif // LICENSEPARSERTEST_H_
@@ -0,0 +1,142 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <QDateTime>
+#include "PrewarmTest.h"
+#include "StandInRmsService.h"
+#include "../../ModernAPI/Prewarm.h"
+#include "../../ModernAPI/AuthenticationCallbackImpl.h"
+#include "../../RestClients/IRestClientCache.h"
+#include "../../RestClients/IRestServiceUrlClient.h"
+#include "../../RestClients/TemplatesClient.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::modernapi;
+using namespace rmscore::restclients;
+
+static bool Succeeded(const vector<PrewarmStage>& stages)
+{
+    for (auto& stage : stages) {
+        if (!stage.Succeeded) {
+            qWarning("%s %s: %s", stage.Name.c_str(), stage.Target.c_str(),
+                     stage.Error.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+static int Count(const vector<PrewarmStage>& stages, const string& name)
+{
+    int count = 0;
+
+    for (auto& stage : stages) {
+        if (stage.Name == name) ++count;
+    }
+    return count;
+}
+
+void PrewarmTest::init()
+{
+    TemplatesClient::ClearCache();
+}
+
+void PrewarmTest::test_PrewarmFillsTheCaches()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    // two users of two domains, prewarmed concurrently
+    const string other = "jane@" + service.AddDomain();
+    vector<string> userIds { service.Email(), other };
+
+    auto stages = Prewarm(vector<string>(1, service.Domain()), userIds, callback);
+
+    QVERIFY(Succeeded(stages));
+    QCOMPARE(Count(stages, "dns"), 3);
+    QCOMPARE(Count(stages, "discovery"), 3);
+    QCOMPARE(Count(stages, "templates"), 2);
+
+    // both lists are fetched, the users may race for the challenge
+    QVERIFY(service.Challenges() >= 1);
+    QCOMPARE(service.Requests("templates"), 2);
+    int calls = callback.Calls();
+
+    // the discovery of the users is kept in memory: pointing the cached
+    // discovery of the domain elsewhere doesn't change their templates URL
+    auto elsewhere = make_shared<ServiceDiscoveryDetails>();
+    elsewhere->TemplatesUrl = "https://elsewhere.contoso.test/my/v1/templates";
+    auto expires = QDateTime::currentDateTimeUtc().addSecs(3600).toString(Qt::ISODate);
+    IRestClientCache::Create(IRestClientCache::CACHE_PLAINDATA)->Store(
+        service.Domain(), elsewhere, expires.toStdString());
+
+    for (auto& userId : userIds) {
+        AuthenticationCallbackImpl authCallback(callback, userId);
+
+        QCOMPARE(IRestServiceUrlClient::Create()->GetTemplatesUrl(userId, authCallback, nullptr),
+                 service.Url("templates"));
+
+        // and so are the lists, no request and no token
+        auto response = ITemplatesClient::Create()->GetTemplates(authCallback, userId, nullptr);
+        QCOMPARE(response.templates.size(), size_t(2));
+    }
+    QCOMPARE(service.Requests("templates"), 2);
+    QCOMPARE(callback.Calls(), calls);
+}
+
+void PrewarmTest::test_SecondPrewarmDoesNothing()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    vector<string> domains(1, service.Domain());
+    vector<string> userIds(1, service.Email());
+
+    QVERIFY(Succeeded(Prewarm(domains, userIds, callback)));
+    QCOMPARE(service.Challenges(), 1);
+    QCOMPARE(service.Requests("templates"), 1);
+    QCOMPARE(callback.Calls(), 1);
+
+    // everything is cached: the service sees nothing
+    auto stages = Prewarm(domains, userIds, callback);
+
+    QVERIFY(Succeeded(stages));
+    QCOMPARE(stages.size(), size_t(5));
+    QCOMPARE(service.Challenges(), 1);
+    QCOMPARE(service.Requests("templates"), 1);
+    QCOMPARE(service.NotModified(), 0);
+    QCOMPARE(service.Requests("enduserlicenses"), 0);
+    QCOMPARE(service.Requests("publishinglicenses"), 0);
+}
+
+void PrewarmTest::test_ConcurrencyIsBounded()
+{
+    StandInRmsService service(100);
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    vector<string> userIds;
+    for (int i = 0; i < 6; ++i) {
+        userIds.push_back("user" + to_string(i) + "@" + service.AddDomain());
+    }
+
+    auto stages = Prewarm(vector<string>(), userIds, callback, nullptr, 2);
+
+    QVERIFY(Succeeded(stages));
+    QCOMPARE(Count(stages, "templates"), 6);
+    QCOMPARE(service.Requests("templates"), 6);
+    QCOMPARE(callback.Calls(), 6);
+    QVERIFY(service.PeakConcurrentRequests() <= 2);
+
+    // the stages come user by user, in the order of userIds
+    QCOMPARE(stages.front().Target, userIds.front());
+    QCOMPARE(stages.back().Target, userIds.back());
+}
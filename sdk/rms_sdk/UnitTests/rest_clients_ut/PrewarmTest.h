@@ -0,0 +1,22 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef PREWARMTEST_H
+#define PREWARMTEST_H
+#include <QtTest>
+
+class PrewarmTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void test_PrewarmFillsTheCaches();
+    void test_SecondPrewarmDoesNothing();
+    void test_ConcurrencyIsBounded();
+};
+#endif // PREWARMTEST_H
@@ -0,0 +1,82 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <thread>
+#include <vector>
+#include "ProtectionPolicyTest.h"
+#include "StandInRmsService.h"
+#include "../../Core/ProtectionPolicy.h"
+#include "../../ModernAPI/AuthenticationCallbackImpl.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::core;
+using namespace rmscore::modernapi;
+
+void ProtectionPolicyTest::test_ConcurrentAcquisitionsShareOneRequest()
+{
+    // slow enough for all the threads to join the first acquisition
+    StandInRmsService service(300);
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    AuthenticationCallbackImpl authCallback(callback, service.Email());
+
+    const auto license = service.PublishingLicense("shared");
+    vector<shared_ptr<ProtectionPolicy> > policies(8);
+    vector<thread> threads;
+
+    for (size_t i = 0; i < policies.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            try {
+                policies[i] = ProtectionPolicy::Acquire(
+                    license.data(), license.size(), authCallback, service.Email(),
+                    false, nullptr, ResponseCacheFlags::RESPONSE_CACHE_NOCACHE);
+            } catch (...) {}
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (auto& policy : policies) {
+        QVERIFY(policy != nullptr);
+        QCOMPARE(policy.get(), policies[0].get());
+    }
+    QCOMPARE(policies[0]->GetName(), string("shared"));
+    QCOMPARE(service.Requests("enduserlicenses"), 1);
+}
+
+void ProtectionPolicyTest::test_AcquisitionKey()
+{
+    const string first  = "<first license/>";
+    const string second = "<second license/>";
+    auto pb = [](const string& license) {
+        return reinterpret_cast<const uint8_t *>(license.data());
+    };
+    auto key = [&](const string& license, const string& requester, bool bOffline,
+                   ResponseCacheFlags cacheMask) {
+        return ProtectionPolicy::GetAcquisitionKey(pb(license), license.size(),
+                                                   requester, bOffline, cacheMask);
+    };
+    const auto cacheMask = static_cast<ResponseCacheFlags>(
+        ResponseCacheFlags::RESPONSE_CACHE_INMEMORY | ResponseCacheFlags::RESPONSE_CACHE_ONDISK);
+    const string base = key(first, "john@contoso.com", false, cacheMask);
+
+    QCOMPARE(key(first, "john@contoso.com", false, cacheMask), base);
+
+    // the requester is compared without case, as by the policy cache
+    QCOMPARE(key(first, "John@Contoso.com", false, cacheMask), base);
+
+    QVERIFY(key(second, "john@contoso.com", false, cacheMask) != base);
+    QVERIFY(key(first, "jane@contoso.com", false, cacheMask) != base);
+    QVERIFY(key(first, "john@contoso.com", true, cacheMask) != base);
+    QVERIFY(key(first, "john@contoso.com", false,
+                ResponseCacheFlags::RESPONSE_CACHE_NOCACHE) != base);
+    QVERIFY(key(first, "john@contoso.com", false,
+                ResponseCacheFlags::RESPONSE_CACHE_INMEMORY) != base);
+}
@@ -0,0 +1,20 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef PROTECTIONPOLICYTEST_H
+#define PROTECTIONPOLICYTEST_H
+#include <QtTest>
+
+class ProtectionPolicyTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_ConcurrentAcquisitionsShareOneRequest();
+    void test_AcquisitionKey();
+};
+#endif // PROTECTIONPOLICYTEST_H
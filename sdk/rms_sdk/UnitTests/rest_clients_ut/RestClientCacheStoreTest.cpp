@@ -0,0 +1,600 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include "RestClientCacheStoreTest.h"
+#include "../../RestClients/RestClientCacheStore.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::restclients;
+
+static RestClientCacheStore::Key MakeKey(const string& hash,
+                                         const string& cacheName = "cache")
+{
+    RestClientCacheStore::Key key = { cacheName, "tag", hash };
+    return key;
+}
+
+static void StoreValue(RestClientCacheStore& store,
+                       const string&         hash,
+                       const string&         value,
+                       const string&         expires = string())
+{
+    store.Store(MakeKey(hash), expires,
+                common::ByteArray(value.begin(), value.end()));
+}
+
+// returns the value of the entry, or "<none>" if there is none
+static string LookupValue(RestClientCacheStore& store, const string& hash)
+{
+    auto values = store.Lookup(MakeKey(hash));
+    return values.empty() ? string("<none>") : values[0];
+}
+
+static string ExpiresIn(int secs)
+{
+    return QDateTime::currentDateTimeUtc().addSecs(secs).toString(
+        Qt::ISODate).toStdString();
+}
+
+static QString LogPath(const QTemporaryDir& dir)
+{
+    return dir.path() + "/RestClientCache.dat";
+}
+
+// overwrites the log at pos, the way a crash or a bad disk would
+static void Overwrite(const QString& path, qint64 pos, const QByteArray& bytes)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(pos));
+    QCOMPARE(file.write(bytes), static_cast<qint64>(bytes.size()));
+}
+
+// zeroes the whole log, only the values kept in memory can still be read
+static void ZeroLog(const QString& path)
+{
+    Overwrite(path, 0, QByteArray(static_cast<int>(QFileInfo(path).size()), '\0'));
+}
+
+static QByteArray ReadLog(const QString& path)
+{
+    QFile file(path);
+    file.open(QIODevice::ReadOnly);
+    return file.readAll();
+}
+
+void RestClientCacheStoreTest::test_StoreLookupOverwrite()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const string path = LogPath(dir).toStdString();
+
+    {
+        RestClientCacheStore store(path, false);
+
+        QCOMPARE(LookupValue(store, "a"), string("<none>"));
+        StoreValue(store, "a", "first");
+        StoreValue(store, "b", "second");
+        StoreValue(store, "a", "third");
+
+        QCOMPARE(LookupValue(store, "a"), string("third"));
+        QCOMPARE(LookupValue(store, "b"), string("second"));
+    }
+
+    // the log is loaded again by a new store
+    RestClientCacheStore store(path, false);
+
+    QCOMPARE(LookupValue(store, "a"), string("third"));
+    QCOMPARE(LookupValue(store, "b"), string("second"));
+    QCOMPARE(store.Lookup(MakeKey("a")).size(), static_cast<size_t>(1));
+}
+
+void RestClientCacheStoreTest::test_PatternLookup()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    RestClientCacheStore store(LogPath(dir).toStdString(), false);
+
+    store.Store(MakeKey("a", "first"), string(), common::ByteArray(1, '1'));
+    store.Store(MakeKey("b", "first"), string(), common::ByteArray(1, '2'));
+    store.Store(MakeKey("a", "second"), string(), common::ByteArray(1, '3'));
+
+    RestClientCacheStore::Key anyHash = { "first", "tag", string() };
+    QCOMPARE(store.Lookup(anyHash).size(), static_cast<size_t>(2));
+
+    RestClientCacheStore::Key anyTag = { "second", string(), "a" };
+    QCOMPARE(store.Lookup(anyTag).size(), static_cast<size_t>(1));
+}
+
+void RestClientCacheStoreTest::test_TombstonesSurviveReload()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const string path = LogPath(dir).toStdString();
+
+    {
+        RestClientCacheStore store(path, false);
+
+        StoreValue(store, "a", "first");
+        StoreValue(store, "b", "second");
+
+        // keeps the most recently stored entry, "a" gets a tombstone
+        store.Cleanup("cache", 1);
+
+        QCOMPARE(LookupValue(store, "a"), string("<none>"));
+        QCOMPARE(LookupValue(store, "b"), string("second"));
+    }
+
+    RestClientCacheStore store(path, false);
+
+    QCOMPARE(LookupValue(store, "a"), string("<none>"));
+    QCOMPARE(LookupValue(store, "b"), string("second"));
+
+    // stored again after its tombstone
+    StoreValue(store, "a", "third");
+    QCOMPARE(LookupValue(store, "a"), string("third"));
+}
+
+void RestClientCacheStoreTest::test_TornTailIsSkipped()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+
+    {
+        RestClientCacheStore store(path.toStdString(), false);
+        StoreValue(store, "a", "first");
+        StoreValue(store, "b", "second");
+    }
+
+    // the last append was torn by a crash
+    const qint64 size = QFileInfo(path).size();
+    QVERIFY(QFile::resize(path, size - 3));
+
+    {
+        RestClientCacheStore store(path.toStdString(), false);
+
+        QCOMPARE(LookupValue(store, "a"), string("first"));
+        QCOMPARE(LookupValue(store, "b"), string("<none>"));
+
+        // the torn bytes stay, the next records go after them
+        StoreValue(store, "c", "third");
+        QVERIFY(QFileInfo(path).size() > size - 3);
+    }
+
+    RestClientCacheStore store(path.toStdString(), false);
+
+    QCOMPARE(LookupValue(store, "a"), string("first"));
+    QCOMPARE(LookupValue(store, "b"), string("<none>"));
+    QCOMPARE(LookupValue(store, "c"), string("third"));
+}
+
+void RestClientCacheStoreTest::test_CorruptRecordInTheMiddleIsSkipped()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+
+    {
+        RestClientCacheStore store(path.toStdString(), false);
+        StoreValue(store, "a", "value-a");
+        StoreValue(store, "b", "value-b");
+        StoreValue(store, "c", "value-c");
+    }
+
+    const qint64 size = QFileInfo(path).size();
+    const int    pos  = ReadLog(path).indexOf("value-b");
+    QVERIFY(pos > 0);
+    Overwrite(path, pos, "VALUE");
+
+    {
+        RestClientCacheStore store(path.toStdString(), false);
+
+        // the records around the corrupted one are still found
+        QCOMPARE(LookupValue(store, "a"), string("value-a"));
+        QCOMPARE(LookupValue(store, "b"), string("<none>"));
+        QCOMPARE(LookupValue(store, "c"), string("value-c"));
+    }
+
+    // nothing was truncated
+    QCOMPARE(QFileInfo(path).size(), size);
+}
+
+void RestClientCacheStoreTest::test_CompactionKeepsLiveRecords()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+    const string  large(8 * 1024, 'x');
+
+    {
+        RestClientCacheStore store(path.toStdString(), false);
+
+        StoreValue(store, "a", "first");
+        for (int i = 0; i < 64; ++i) {
+            StoreValue(store, "b", large + to_string(i));
+        }
+        StoreValue(store, "c", "third");
+        store.Cleanup("cache", 2);
+
+        store.Compact();
+
+        // only the last "b" and "c" are left
+        QVERIFY(QFileInfo(path).size() < 2 * static_cast<qint64>(large.size()));
+        QCOMPARE(LookupValue(store, "a"), string("<none>"));
+        QCOMPARE(LookupValue(store, "b"), large + "63");
+        QCOMPARE(LookupValue(store, "c"), string("third"));
+
+        StoreValue(store, "d", "fourth");
+    }
+
+    RestClientCacheStore store(path.toStdString(), false);
+
+    QCOMPARE(LookupValue(store, "a"), string("<none>"));
+    QCOMPARE(LookupValue(store, "b"), large + "63");
+    QCOMPARE(LookupValue(store, "c"), string("third"));
+    QCOMPARE(LookupValue(store, "d"), string("fourth"));
+}
+
+void RestClientCacheStoreTest::test_MemoryTierKeepsTheLast256Values()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+    RestClientCacheStore store(path.toStdString(), false);
+
+    for (int i = 0; i < 300; ++i) {
+        StoreValue(store, to_string(i), "value-" + to_string(i));
+    }
+    for (int i = 0; i < 300; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), "value-" + to_string(i));
+    }
+
+    ZeroLog(path);
+
+    // the last 256 values read are served from memory, the others were
+    // evicted and can't be read from the zeroed log anymore
+    for (int i = 300 - 256; i < 300; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), "value-" + to_string(i));
+    }
+    for (int i = 0; i < 300 - 256; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), string("<none>"));
+    }
+}
+
+void RestClientCacheStoreTest::test_MemoryTierKeepsAtMost4MB()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+    RestClientCacheStore store(path.toStdString(), false);
+
+    // four of them fit in 4 MB, five don't
+    const size_t valueSize = 900 * 1024;
+
+    for (int i = 0; i < 8; ++i) {
+        StoreValue(store, to_string(i), string(valueSize, 'a' + i));
+    }
+
+    // more than a quarter of the tier is never kept in memory
+    StoreValue(store, "huge", string(1536 * 1024, 'h'));
+
+    for (int i = 0; i < 8; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), string(valueSize, 'a' + i));
+    }
+    QCOMPARE(LookupValue(store, "huge").size(), static_cast<size_t>(1536 * 1024));
+
+    ZeroLog(path);
+
+    for (int i = 4; i < 8; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), string(valueSize, 'a' + i));
+    }
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), string("<none>"));
+    }
+    QCOMPARE(LookupValue(store, "huge"), string("<none>"));
+}
+
+void RestClientCacheStoreTest::test_StoreAndCleanupInvalidateTheMemoryTier()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    RestClientCacheStore store(LogPath(dir).toStdString(), false);
+
+    StoreValue(store, "b", "first");
+    QCOMPARE(LookupValue(store, "b"), string("first"));
+
+    StoreValue(store, "a", "second");
+    QCOMPARE(LookupValue(store, "a"), string("second"));
+
+    // the value in memory is replaced, not served stale
+    StoreValue(store, "a", "third");
+    QCOMPARE(LookupValue(store, "a"), string("third"));
+
+    // "b" is dropped even though its value is in memory
+    store.Cleanup("cache", 1);
+    QCOMPARE(LookupValue(store, "b"), string("<none>"));
+    QCOMPARE(LookupValue(store, "a"), string("third"));
+}
+
+void RestClientCacheStoreTest::test_CleanupKeepsTheMostRecentEntries()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const string path = LogPath(dir).toStdString();
+
+    {
+        RestClientCacheStore store(path, false);
+
+        // several batches of entries to drop
+        for (int i = 0; i < 200; ++i) {
+            StoreValue(store, to_string(i), "value-" + to_string(i));
+        }
+        store.Store(MakeKey("a", "other"), string(), common::ByteArray(1, '1'));
+
+        store.Cleanup("cache", 50);
+
+        for (int i = 0; i < 150; ++i) {
+            QCOMPARE(LookupValue(store, to_string(i)), string("<none>"));
+        }
+        for (int i = 150; i < 200; ++i) {
+            QCOMPARE(LookupValue(store, to_string(i)), "value-" + to_string(i));
+        }
+
+        // the other caches are left alone
+        QCOMPARE(store.Lookup(MakeKey("a", "other")).size(),
+                 static_cast<size_t>(1));
+    }
+
+    RestClientCacheStore store(path, false);
+    RestClientCacheStore::Key anyHash = { "cache", "tag", string() };
+
+    QCOMPARE(store.Lookup(anyHash).size(), static_cast<size_t>(50));
+    QCOMPARE(LookupValue(store, "150"), string("value-150"));
+}
+
+void RestClientCacheStoreTest::test_CleanupDropsExpiredEntriesFirst()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    RestClientCacheStore store(LogPath(dir).toStdString(), false);
+
+    for (int i = 0; i < 3; ++i) {
+        StoreValue(store, "kept" + to_string(i), "value");
+    }
+
+    // stored after the others, but expired by the time of the cleanup
+    for (int i = 0; i < 5; ++i) {
+        StoreValue(store, "expired" + to_string(i), "value", ExpiresIn(1));
+    }
+    this_thread::sleep_for(chrono::milliseconds(2100));
+
+    // the expired entries don't count against the maximum
+    store.Cleanup("cache", 3);
+
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(LookupValue(store, "kept" + to_string(i)), string("value"));
+    }
+    for (int i = 0; i < 5; ++i) {
+        QCOMPARE(LookupValue(store, "expired" + to_string(i)), string("<none>"));
+    }
+}
+
+void RestClientCacheStoreTest::test_StoresDuringCompactionAreKept()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const string path = LogPath(dir).toStdString();
+
+    {
+        RestClientCacheStore store(path, false);
+
+        // enough dead space for the compactions to have something to copy
+        for (int i = 0; i < 100; ++i) {
+            StoreValue(store, "dead" + to_string(i % 10), string(4096, 'x'));
+        }
+
+        thread compaction([&store]() {
+            for (int i = 0; i < 5; ++i) store.Compact();
+        });
+
+        for (int i = 0; i < 200; ++i) {
+            StoreValue(store, to_string(i), "value-" + to_string(i));
+        }
+        compaction.join();
+
+        for (int i = 0; i < 200; ++i) {
+            QCOMPARE(LookupValue(store, to_string(i)), "value-" + to_string(i));
+        }
+    }
+
+    RestClientCacheStore store(path, false);
+
+    for (int i = 0; i < 200; ++i) {
+        QCOMPARE(LookupValue(store, to_string(i)), "value-" + to_string(i));
+    }
+    QCOMPARE(LookupValue(store, "dead9"), string(4096, 'x'));
+}
+
+void RestClientCacheStoreTest::test_EncryptedStoreLookupReopen()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+    const string  large(5000, 'x');
+
+    {
+        RestClientCacheStore store(path.toStdString(), true);
+
+        // "b" goes on into the second block of the log
+        StoreValue(store, "a", "first");
+        StoreValue(store, "b", large);
+        StoreValue(store, "c", "second");
+        StoreValue(store, "a", "third");
+
+        QCOMPARE(LookupValue(store, "a"), string("third"));
+        QCOMPARE(LookupValue(store, "b"), large);
+        QCOMPARE(LookupValue(store, "c"), string("second"));
+    }
+
+    QCOMPARE(ReadLog(path).indexOf("third"), -1);
+
+    // the records appended after a reload are found by the next one
+    {
+        RestClientCacheStore store(path.toStdString(), true);
+
+        QCOMPARE(LookupValue(store, "a"), string("third"));
+        QCOMPARE(LookupValue(store, "b"), large);
+        QCOMPARE(store.Lookup(MakeKey("a")).size(), static_cast<size_t>(1));
+
+        StoreValue(store, "d", "fourth");
+    }
+
+    RestClientCacheStore store(path.toStdString(), true);
+
+    QCOMPARE(LookupValue(store, "a"), string("third"));
+    QCOMPARE(LookupValue(store, "b"), large);
+    QCOMPARE(LookupValue(store, "c"), string("second"));
+    QCOMPARE(LookupValue(store, "d"), string("fourth"));
+}
+
+void RestClientCacheStoreTest::test_EncryptedTombstonesSurviveReload()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const string path = LogPath(dir).toStdString();
+
+    {
+        RestClientCacheStore store(path, true);
+
+        StoreValue(store, "a", "first");
+        StoreValue(store, "b", "second");
+        store.Cleanup("cache", 1);
+
+        QCOMPARE(LookupValue(store, "a"), string("<none>"));
+    }
+
+    {
+        RestClientCacheStore store(path, true);
+
+        QCOMPARE(LookupValue(store, "a"), string("<none>"));
+        QCOMPARE(LookupValue(store, "b"), string("second"));
+
+        // a tombstone appended after a reload
+        StoreValue(store, "c", "third");
+        store.Cleanup("cache", 1);
+    }
+
+    RestClientCacheStore store(path, true);
+
+    QCOMPARE(LookupValue(store, "a"), string("<none>"));
+    QCOMPARE(LookupValue(store, "b"), string("<none>"));
+    QCOMPARE(LookupValue(store, "c"), string("third"));
+}
+
+void RestClientCacheStoreTest::test_EncryptedCompactionKeepsLiveRecords()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+    const string  large(8 * 1024, 'x');
+
+    {
+        RestClientCacheStore store(path.toStdString(), true);
+
+        StoreValue(store, "a", "first");
+        for (int i = 0; i < 64; ++i) {
+            StoreValue(store, "b", large + to_string(i));
+        }
+        StoreValue(store, "c", "third");
+        store.Cleanup("cache", 2);
+
+        store.Compact();
+
+        QVERIFY(QFileInfo(path).size() < 2 * static_cast<qint64>(large.size()));
+        QCOMPARE(LookupValue(store, "a"), string("<none>"));
+        QCOMPARE(LookupValue(store, "b"), large + "63");
+        QCOMPARE(LookupValue(store, "c"), string("third"));
+
+        StoreValue(store, "d", "fourth");
+    }
+
+    QCOMPARE(ReadLog(path).indexOf("fourth"), -1);
+
+    RestClientCacheStore store(path.toStdString(), true);
+
+    QCOMPARE(LookupValue(store, "a"), string("<none>"));
+    QCOMPARE(LookupValue(store, "b"), large + "63");
+    QCOMPARE(LookupValue(store, "c"), string("third"));
+    QCOMPARE(LookupValue(store, "d"), string("fourth"));
+}
+
+void RestClientCacheStoreTest::test_EncryptedTornFinalBlockIsDropped()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = LogPath(dir);
+
+    // "a" ends in the second 4 KB block, "b" goes on into the third
+    {
+        RestClientCacheStore store(path.toStdString(), true);
+        StoreValue(store, "a", string(6000, 'a'));
+        StoreValue(store, "b", string(3000, 'b'));
+    }
+
+    // the last rewrite of the final block was torn by a crash, it can't be
+    // decrypted anymore
+    const qint64 size = QFileInfo(path).size();
+    QVERIFY(QFile::resize(path, size - 3));
+
+    {
+        RestClientCacheStore store(path.toStdString(), true);
+
+        // only the final block is dropped
+        QCOMPARE(LookupValue(store, "a"), string(6000, 'a'));
+        QCOMPARE(LookupValue(store, "b"), string("<none>"));
+        QVERIFY(QFileInfo(path).size() < size - 3);
+
+        StoreValue(store, "c", "third");
+    }
+
+    RestClientCacheStore store(path.toStdString(), true);
+
+    QCOMPARE(LookupValue(store, "a"), string(6000, 'a'));
+    QCOMPARE(LookupValue(store, "b"), string("<none>"));
+    QCOMPARE(LookupValue(store, "c"), string("third"));
+}
+
+void RestClientCacheStoreTest::test_EncryptedLogAppendedByAnotherStore()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const string path = LogPath(dir).toStdString();
+
+    // two stores on one log, like two processes
+    RestClientCacheStore first(path, true);
+    RestClientCacheStore second(path, true);
+
+    StoreValue(first, "a", "value-a");
+    StoreValue(second, "b", "value-b");
+
+    // rewrites the final block the second store has read
+    StoreValue(first, "c", "value-c");
+
+    QCOMPARE(LookupValue(second, "a"), string("value-a"));
+    QCOMPARE(LookupValue(second, "b"), string("value-b"));
+    QCOMPARE(LookupValue(first, "b"), string("value-b"));
+}
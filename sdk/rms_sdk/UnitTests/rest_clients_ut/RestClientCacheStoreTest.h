@@ -0,0 +1,35 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef RESTCLIENTCACHESTORETEST_H
+#define RESTCLIENTCACHESTORETEST_H
+#include <QtTest>
+
+class RestClientCacheStoreTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_StoreLookupOverwrite();
+    void test_PatternLookup();
+    void test_TombstonesSurviveReload();
+    void test_TornTailIsSkipped();
+    void test_CorruptRecordInTheMiddleIsSkipped();
+    void test_CompactionKeepsLiveRecords();
+    void test_MemoryTierKeepsTheLast256Values();
+    void test_MemoryTierKeepsAtMost4MB();
+    void test_StoreAndCleanupInvalidateTheMemoryTier();
+    void test_CleanupKeepsTheMostRecentEntries();
+    void test_CleanupDropsExpiredEntriesFirst();
+    void test_StoresDuringCompactionAreKept();
+    void test_EncryptedStoreLookupReopen();
+    void test_EncryptedTombstonesSurviveReload();
+    void test_EncryptedCompactionKeepsLiveRecords();
+    void test_EncryptedTornFinalBlockIsDropped();
+    void test_EncryptedLogAppendedByAnotherStore();
+};
+#endif // RESTCLIENTCACHESTORETEST_H
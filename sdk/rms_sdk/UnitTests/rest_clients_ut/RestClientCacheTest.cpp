@@ -0,0 +1,103 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <string>
+#include <QDateTime>
+#include <QUuid>
+#include "RestClientCacheTest.h"
+#include "../../RestClients/IRestClientCache.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::restclients;
+
+// the tests share the user's cache, each one uses a domain of its own
+static string UniqueDomain()
+{
+    return QUuid::createUuid().toString().mid(1, 36).toStdString() +
+           ".contoso.com";
+}
+
+static string ExpiresIn(int secs)
+{
+    return QDateTime::currentDateTimeUtc().addSecs(secs).toString(
+        Qt::ISODate).toStdString();
+}
+
+static shared_ptr<ServiceDiscoveryDetails> MakeDetails(const string& domain)
+{
+    auto details = make_shared<ServiceDiscoveryDetails>();
+    details->EndUserLicensesUrl        = "https://" + domain + "/my/v1/enduserlicenses";
+    details->PublishingLicensesUrl     = "https://" + domain + "/my/v1/publishinglicenses";
+    details->TemplatesUrl              = "https://" + domain + "/my/v1/templates";
+    details->CloudDiagnosticsServerUrl = "https://" + domain + "/my/v1/clouddiagnostics";
+    details->PerformanceServerUrl      = "https://" + domain + "/my/v1/performance";
+    details->OriginalInput             = "john@" + domain;
+    return details;
+}
+
+void RestClientCacheTest::test_ServiceDiscoveryDetailsRoundTrip()
+{
+    auto cache   = IRestClientCache::Create(IRestClientCache::CACHE_PLAINDATA);
+    auto domain  = UniqueDomain();
+    auto details = MakeDetails(domain);
+
+    QVERIFY(cache->LookupServiceDiscoveryDetails(domain) == nullptr);
+
+    cache->Store(domain, details, ExpiresIn(3600));
+
+    auto cached = cache->LookupServiceDiscoveryDetails(domain);
+    QVERIFY(cached != nullptr);
+    QCOMPARE(cached->EndUserLicensesUrl, details->EndUserLicensesUrl);
+    QCOMPARE(cached->PublishingLicensesUrl, details->PublishingLicensesUrl);
+    QCOMPARE(cached->TemplatesUrl, details->TemplatesUrl);
+    QCOMPARE(cached->CloudDiagnosticsServerUrl,
+             details->CloudDiagnosticsServerUrl);
+    QCOMPARE(cached->PerformanceServerUrl, details->PerformanceServerUrl);
+    QCOMPARE(cached->OriginalInput, details->OriginalInput);
+
+    // all the urls are in a single entry
+    auto entries = cache->Lookup(domain, string(), nullptr, 0, false);
+    QCOMPARE(entries.size(), static_cast<size_t>(1));
+}
+
+void RestClientCacheTest::test_IncompleteServiceDiscoveryDetailsAreIgnored()
+{
+    auto cache  = IRestClientCache::Create(IRestClientCache::CACHE_PLAINDATA);
+    auto domain = UniqueDomain();
+
+    // an entry without the original input
+    const string json =
+        "{\"END_USER_LICENSES_UR\":\"https://contoso.com/eul\","
+        "\"PUBLISHING_LICENSES_UR\":\"https://contoso.com/pl\","
+        "\"TEMPLATES_UR\":\"https://contoso.com/templates\","
+        "\"CLOUD_DIAGNOSTICS_UR\":\"https://contoso.com/diagnostics\","
+        "\"PERFORMANCE_UR\":\"https://contoso.com/performance\"}";
+
+    cache->Store(domain, "SERVICE_DISCOVERY_DETAILS", nullptr, 0,
+                 ExpiresIn(3600), common::ByteArray(json.begin(), json.end()),
+                 false);
+    QVERIFY(cache->LookupServiceDiscoveryDetails(domain) == nullptr);
+
+    // not json at all
+    const string garbage = "not json";
+
+    cache->Store(domain, "SERVICE_DISCOVERY_DETAILS", nullptr, 0,
+                 ExpiresIn(3600),
+                 common::ByteArray(garbage.begin(), garbage.end()), false);
+    QVERIFY(cache->LookupServiceDiscoveryDetails(domain) == nullptr);
+}
+
+void RestClientCacheTest::test_ExpiredServiceDiscoveryDetailsAreIgnored()
+{
+    auto cache  = IRestClientCache::Create(IRestClientCache::CACHE_PLAINDATA);
+    auto domain = UniqueDomain();
+
+    cache->Store(domain, MakeDetails(domain), ExpiresIn(-60));
+    QVERIFY(cache->LookupServiceDiscoveryDetails(domain) == nullptr);
+}
@@ -0,0 +1,21 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef RESTCLIENTCACHETEST_H
+#define RESTCLIENTCACHETEST_H
+#include <QtTest>
+
+class RestClientCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_ServiceDiscoveryDetailsRoundTrip();
+    void test_IncompleteServiceDiscoveryDetailsAreIgnored();
+    void test_ExpiredServiceDiscoveryDetailsAreIgnored();
+};
+#endif // RESTCLIENTCACHETEST_H
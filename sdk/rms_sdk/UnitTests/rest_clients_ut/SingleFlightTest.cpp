@@ -0,0 +1,126 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <thread>
+#include <vector>
+#include "SingleFlightTest.h"
+#include "HttpStandInServer.h"
+#include "../../Common/SingleFlight.h"
+#include "../../Platform/Http/IHttpClient.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::platform::http;
+
+typedef shared_ptr<common::ByteArray> Body;
+
+static Body FetchBody(const string& url, shared_ptr<atomic<bool> > cancelState)
+{
+    auto pHttpClient = IHttpClient::Create();
+    auto body = make_shared<common::ByteArray>();
+    pHttpClient->Get(url, *body, cancelState);
+    return body;
+}
+
+void SingleFlightTest::test_ConcurrentCallsShareOneRequest()
+{
+    const QByteArray expected("{\"AccessStatus\":\"AccessGranted\"}");
+    HttpStandInServer server(200, expected, 500);
+    QVERIFY(server.Start());
+
+    const string url = server.Url("/my/v1/enduserlicenses").toStdString();
+    common::SingleFlight<Body> singleFlight;
+
+    const int threadCount = 16;
+    vector<Body> results(threadCount);
+    vector<thread> threads;
+
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            results[i] = singleFlight.Do("pl-hash|john@contoso.com", nullptr,
+                                         [&]() { return FetchBody(url, nullptr); });
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    QCOMPARE(server.RequestCount(), 1);
+    QCOMPARE(singleFlight.InFlight(), static_cast<size_t>(0));
+    for (auto& result : results) {
+        QVERIFY(result != nullptr);
+        QCOMPARE(QByteArray(reinterpret_cast<const char *>(result->data()),
+                            static_cast<int>(result->size())), expected);
+    }
+}
+
+void SingleFlightTest::test_DifferentKeysAreNotCoalesced()
+{
+    HttpStandInServer server(200, "{}", 300);
+    QVERIFY(server.Start());
+
+    const string url = server.Url().toStdString();
+    common::SingleFlight<Body> singleFlight;
+
+    thread first([&]() {
+        singleFlight.Do("pl-hash|john@contoso.com", nullptr,
+                        [&]() { return FetchBody(url, nullptr); });
+    });
+    thread second([&]() {
+        singleFlight.Do("pl-hash|jane@contoso.com", nullptr,
+                        [&]() { return FetchBody(url, nullptr); });
+    });
+    first.join();
+    second.join();
+
+    QCOMPARE(server.RequestCount(), 2);
+}
+
+void SingleFlightTest::test_WaiterCancellation()
+{
+    HttpStandInServer server(200, "{}", 1500);
+    QVERIFY(server.Start());
+
+    const string url = server.Url().toStdString();
+    common::SingleFlight<Body> singleFlight;
+    const string key("pl-hash|john@contoso.com");
+
+    Body leaderResult;
+    thread leader([&]() {
+        leaderResult = singleFlight.Do(key, nullptr,
+                                       [&]() { return FetchBody(url, nullptr); });
+    });
+
+    // give the leader time to register itself
+    while (singleFlight.InFlight() == 0) this_thread::yield();
+
+    auto cancelState = make_shared<atomic<bool> >(false);
+    bool cancelled = false;
+    auto started = chrono::steady_clock::now();
+    thread waiter([&]() {
+        try {
+            singleFlight.Do(key, cancelState,
+                            [&]() { return FetchBody(url, cancelState); });
+        } catch (exceptions::RMSNetworkException& e) {
+            cancelled = e.reason() ==
+                        exceptions::RMSNetworkException::CancelledByUser;
+        }
+    });
+
+    this_thread::sleep_for(chrono::milliseconds(100));
+    cancelState->store(true);
+    waiter.join();
+    auto waited = chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - started).count();
+
+    leader.join();
+
+    QVERIFY(cancelled);
+    QVERIFY(waited < 1000);
+    QVERIFY(leaderResult != nullptr);
+    QCOMPARE(server.RequestCount(), 1);
+}
@@ -0,0 +1,21 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef SINGLEFLIGHTTEST_H
+#define SINGLEFLIGHTTEST_H
+#include <QtTest>
+
+class SingleFlightTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_ConcurrentCallsShareOneRequest();
+    void test_DifferentKeysAreNotCoalesced();
+    void test_WaiterCancellation();
+};
+#endif // SINGLEFLIGHTTEST_H
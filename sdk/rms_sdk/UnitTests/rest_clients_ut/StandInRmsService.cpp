@@ -0,0 +1,233 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUuid>
+#include "StandInRmsService.h"
+#include "../../RestClients/IRestClientCache.h"
+
+using namespace std;
+using namespace rmscore::restclients;
+
+// 16 bytes of AES key
+static const QByteArray KEY_VALUE = "MDEyMzQ1Njc4OWFiY2RlZg==";
+static const QByteArray TEMPLATES_ETAG = "\"templates-1\"";
+
+static QByteArray Endpoint(const QByteArray& path)
+{
+    QByteArray endpoint = path.left(path.indexOf('?'));
+    return endpoint.mid(endpoint.lastIndexOf('/') + 1);
+}
+
+// the name given to PublishingLicense(), from a license request
+static QByteArray LicenseName(const QByteArray& body)
+{
+    auto request = QJsonDocument::fromJson(body).object();
+    QByteArray license = QByteArray::fromBase64(
+        request.value("SerializedPublishingLicense").toString().toLatin1());
+    int start = license.indexOf("<NAME>") + 6;
+    int end = license.indexOf("</NAME>");
+    return (start >= 6 && end > start) ? license.mid(start, end - start) : QByteArray();
+}
+
+StandInRmsService::StandInRmsService(int delayMs)
+    : m_server([this](const HttpStandInServer::Request& request) {
+          return Handle(request);
+      })
+    , m_domain(QUuid::createUuid().toString().mid(1, 36).toStdString() +
+               ".contoso.test")
+    , m_delayMs(delayMs)
+    , m_challenges(0)
+    , m_notModified(0)
+    , m_tokensToReject(0)
+    , m_publications(0)
+{}
+
+StandInRmsService::~StandInRmsService()
+{
+    // before the state used by the handler goes away
+    m_server.Stop();
+}
+
+bool StandInRmsService::Start()
+{
+    if (!m_server.Start()) return false;
+
+    SeedDiscovery(m_domain);
+    return true;
+}
+
+string StandInRmsService::AddDomain()
+{
+    string domain = QUuid::createUuid().toString().mid(1, 36).toStdString() +
+                    ".contoso.test";
+    SeedDiscovery(domain);
+    return domain;
+}
+
+void StandInRmsService::SeedDiscovery(const string& domain)
+{
+    QByteArray prefix = Prefix();
+
+    auto details = make_shared<ServiceDiscoveryDetails>();
+    details->EndUserLicensesUrl        = m_server.Url(prefix + "enduserlicenses").toStdString();
+    details->PublishingLicensesUrl     = m_server.Url(prefix + "publishinglicenses").toStdString();
+    details->TemplatesUrl              = m_server.Url(prefix + "templates").toStdString();
+    details->CloudDiagnosticsServerUrl = m_server.Url(prefix + "clientdebuglogs").toStdString();
+    details->PerformanceServerUrl      = m_server.Url(prefix + "clientperformancelogs").toStdString();
+    details->OriginalInput             = "john@" + domain;
+
+    auto expires = QDateTime::currentDateTimeUtc().addSecs(3600).toString(Qt::ISODate);
+    IRestClientCache::Create(IRestClientCache::CACHE_PLAINDATA)->Store(
+        domain, details, expires.toStdString());
+}
+
+string StandInRmsService::Url(const QByteArray& endpoint) const
+{
+    return m_server.Url(Prefix() + endpoint).toStdString();
+}
+
+QByteArray StandInRmsService::Prefix() const
+{
+    // the challenges are cached per path prefix for the process, a server
+    // which gets the port of a previous one must still be challenged
+    return "/" + QByteArray(m_domain.c_str()).left(8) + "/my/v1/";
+}
+
+vector<unsigned char> StandInRmsService::PublishingLicense(const string& name) const
+{
+    return PublishingLicense(name, m_domain);
+}
+
+vector<unsigned char> StandInRmsService::PublishingLicense(const string& name,
+                                                           const string& domain) const
+{
+    const string license =
+        "\xef\xbb\xbf<?xml version=\"1.0\"?>"
+        "<XrML version=\"1.2\" xmlns=\"\"><BODY type=\"Microsoft Rights Label\" version=\"3.0\">"
+        "<ISSUEDPRINCIPALS><PRINCIPAL><PUBLICKEY><ALGORITHM>RSA</ALGORITHM>"
+        "<PARAMETER name=\"modulus\"><VALUE encoding=\"base64\">c3RhbmQtaW4=</VALUE></PARAMETER>"
+        "</PUBLICKEY></PRINCIPAL></ISSUEDPRINCIPALS>"
+        "<DISTRIBUTIONPOINT><OBJECT type=\"Extranet-License-Acquisition-URL\">"
+        "<ADDRESS type=\"URL\">https://" + domain + "/_wmcs/licensing</ADDRESS>"
+        "</OBJECT></DISTRIBUTIONPOINT>"
+        "<NAME>" + name + "</NAME></BODY></XrML>";
+
+    return vector<unsigned char>(license.begin(), license.end());
+}
+
+int StandInRmsService::Requests(const QByteArray& endpoint) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_requests.value(endpoint);
+}
+
+int StandInRmsService::Challenges() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_challenges;
+}
+
+int StandInRmsService::NotModified() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_notModified;
+}
+
+void StandInRmsService::SetStatus(const QByteArray& endpoint, int statusCode)
+{
+    QMutexLocker lock(&m_mutex);
+    m_statuses[endpoint] = statusCode;
+}
+
+void StandInRmsService::RejectTokens(int count)
+{
+    QMutexLocker lock(&m_mutex);
+    m_tokensToReject = count;
+}
+
+QByteArray StandInRmsService::Challenge() const
+{
+    return "Bearer authorization_uri=\"https://login.contoso.test/authorize\", "
+           "realm=\"https://" + QByteArray(m_domain.c_str()) + "/\"";
+}
+
+HttpStandInServer::Reply StandInRmsService::Handle(
+    const HttpStandInServer::Request& request)
+{
+    QMutexLocker lock(&m_mutex);
+    HttpStandInServer::Reply reply = {
+        200, QByteArray(), QList<QPair<QByteArray, QByteArray> >(), m_delayMs.load()
+    };
+    QByteArray endpoint = Endpoint(request.path);
+
+    if (request.Header("authorization").isEmpty()) {
+        ++m_challenges;
+        reply.statusCode = 401;
+        reply.headers.append(qMakePair(QByteArray("WWW-Authenticate"), Challenge()));
+        return reply;
+    }
+
+    ++m_requests[endpoint];
+
+    if (m_tokensToReject > 0) {
+        --m_tokensToReject;
+        reply.statusCode = 401;
+        reply.headers.append(qMakePair(QByteArray("WWW-Authenticate"), Challenge()));
+        return reply;
+    }
+
+    int statusCode = m_statuses.value(endpoint, 200);
+
+    if (statusCode != 200) {
+        reply.statusCode = statusCode;
+        reply.body = "{\"Code\":\"StandIn\",\"Message\":\"failure requested by the test\"}";
+        return reply;
+    }
+
+    QByteArray owner = "owner@" + QByteArray(m_domain.c_str());
+
+    if (endpoint == "enduserlicenses") {
+        QByteArray name = LicenseName(request.body);
+        reply.body =
+            "{\"AccessStatus\":\"AccessGranted\",\"Id\":\"" + name + "\","
+            "\"Name\":\"" + name + "\",\"Description\":\"\",\"Referrer\":\"\","
+            "\"Owner\":\"" + owner + "\",\"IssuedTo\":\"" + owner + "\","
+            "\"ContentId\":\"{" + name + "}\",\"Rights\":[\"VIEW\"],\"Roles\":[],"
+            "\"FromTemplate\":true,\"allowOfflineAccess\":false,"
+            "\"Key\":{\"Algorithm\":\"AES\",\"CipherMode\":\"MICROSOFT.CBC4K\","
+            "\"Value\":\"" + KEY_VALUE + "\"}}";
+    } else if (endpoint == "publishinglicenses") {
+        QByteArray publication = QByteArray::number(++m_publications);
+        auto pl = PublishingLicense(publication.toStdString());
+        QByteArray license(reinterpret_cast<const char *>(pl.data()),
+                           static_cast<int>(pl.size()));
+        reply.body =
+            "{\"SerializedPublishingLicense\":\"" + license.toBase64() + "\","
+            "\"Id\":\"t1\",\"Name\":\"Template 1\",\"Description\":\"\","
+            "\"Referrer\":\"\",\"Owner\":\"" + owner + "\","
+            "\"ContentId\":\"{publication-" + publication + "}\","
+            "\"Key\":{\"Algorithm\":\"AES\",\"CipherMode\":\"MICROSOFT.CBC4K\","
+            "\"Value\":\"" + KEY_VALUE + "\"}}";
+    } else if (endpoint == "templates") {
+        reply.headers.append(qMakePair(QByteArray("ETag"), TEMPLATES_ETAG));
+
+        if (request.Header("if-none-match") == TEMPLATES_ETAG) {
+            ++m_notModified;
+            reply.statusCode = 304;
+        } else {
+            reply.body = "[{\"Id\":\"t1\",\"Name\":\"Template 1\",\"Description\":\"First\"},"
+                         "{\"Id\":\"t2\",\"Name\":\"Template 2\",\"Description\":\"Second\"}]";
+        }
+    } else {
+        reply.statusCode = 404;
+    }
+    return reply;
+}
@@ -0,0 +1,103 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef STANDINRMSSERVICE_H
+#define STANDINRMSSERVICE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include "HttpStandInServer.h"
+#include "../../ModernAPI/IAuthenticationCallback.h"
+
+// The license, publishing and template endpoints of an RMS tenant, served by a
+// HttpStandInServer. Start() points the cached service discovery of a domain
+// of its own at it, so the flows of the SDK run against it unchanged.
+//
+// A request without a token gets a bearer challenge; the others are answered
+// from the request: the license of a publishing license named "x" is named
+// "x" too, each publication gets a new content id and the template list has
+// an ETag, If-None-Match gets a 304.
+class StandInRmsService
+{
+public:
+    explicit StandInRmsService(int delayMs = 0);
+    ~StandInRmsService();
+
+    bool Start();
+
+    std::string Domain() const { return m_domain; }
+    std::string Email() const { return "john@" + m_domain; }
+
+    // another domain whose discovery points at this service, for the flows
+    // which group by license server
+    std::string AddDomain();
+
+    // the URL of an endpoint, as the service discovery gives it
+    std::string Url(const QByteArray& endpoint) const;
+
+    // a UTF-8 publishing license naming the license server of the domain
+    std::vector<unsigned char> PublishingLicense(const std::string& name) const;
+    std::vector<unsigned char> PublishingLicense(const std::string& name,
+                                                 const std::string& domain) const;
+
+    // authorized requests to an endpoint: "enduserlicenses",
+    // "publishinglicenses" or "templates"
+    int Requests(const QByteArray& endpoint) const;
+    int Challenges() const;
+    int NotModified() const;
+    int PeakConcurrentRequests() const { return m_server.PeakConcurrentRequests(); }
+
+    void SetDelay(int delayMs) { m_delayMs = delayMs; }
+
+    // answers the endpoint with the status instead, 200 to undo it
+    void SetStatus(const QByteArray& endpoint, int statusCode);
+
+    // the next count authorized requests get a 401, as with a stale challenge
+    void RejectTokens(int count);
+
+private:
+    HttpStandInServer::Reply Handle(const HttpStandInServer::Request& request);
+    QByteArray Challenge() const;
+    QByteArray Prefix() const;
+    void SeedDiscovery(const std::string& domain);
+
+    HttpStandInServer m_server;
+    std::string m_domain;
+    std::atomic<int> m_delayMs;
+
+    mutable QMutex m_mutex;
+    QMap<QByteArray, int> m_requests;
+    QMap<QByteArray, int> m_statuses;
+    int m_challenges;
+    int m_notModified;
+    int m_tokensToReject;
+    int m_publications;
+};
+
+// hands out a new token on every call and counts them
+class StandInTokenCallback : public rmscore::modernapi::IAuthenticationCallback
+{
+public:
+    StandInTokenCallback() : m_calls(0) {}
+
+    virtual std::string GetToken(
+        std::shared_ptr<rmscore::modernapi::AuthenticationParameters>&) override
+    {
+        return "token" + std::to_string(++m_calls);
+    }
+
+    int Calls() const { return m_calls.load(); }
+
+private:
+    std::atomic<int> m_calls;
+};
+#endif // STANDINRMSSERVICE_H
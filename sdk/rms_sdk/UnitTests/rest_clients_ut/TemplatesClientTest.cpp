@@ -0,0 +1,143 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include "TemplatesClientTest.h"
+#include "StandInRmsService.h"
+#include "../../RestClients/TemplatesClient.h"
+#include "../../ModernAPI/AuthenticationCallbackImpl.h"
+#include "../../Platform/Settings/IRMSEnvironmentImpl.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::modernapi;
+using namespace rmscore::restclients;
+
+static size_t GetTemplates(StandInRmsService& service, StandInTokenCallback& callback)
+{
+    AuthenticationCallbackImpl authCallback(callback, service.Email());
+    auto response = ITemplatesClient::Create()->GetTemplates(authCallback,
+                                                             service.Email(),
+                                                             nullptr);
+    return response.templates.size();
+}
+
+void TemplatesClientTest::init()
+{
+    TemplatesClient::ClearCache();
+}
+
+void TemplatesClientTest::cleanup()
+{
+    auto environment = platform::settings::IRMSEnvironmentImpl::Environment();
+    environment->TemplatesCacheTtl(3600);
+    environment->TemplatesCacheOnDisk(false);
+    TemplatesClient::ClearCache();
+}
+
+void TemplatesClientTest::test_FreshListIsServedFromMemory()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    platform::settings::IRMSEnvironmentImpl::Environment()->TemplatesCacheTtl(60);
+
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(GetTemplates(service, callback), size_t(2));
+    }
+    QCOMPARE(service.Requests("templates"), 1);
+    QCOMPARE(callback.Calls(), 1);
+
+    // no caching at all
+    platform::settings::IRMSEnvironmentImpl::Environment()->TemplatesCacheTtl(0);
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QCOMPARE(service.Requests("templates"), 2);
+}
+
+void TemplatesClientTest::test_StaleListIsRevalidated()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    platform::settings::IRMSEnvironmentImpl::Environment()->TemplatesCacheTtl(1);
+
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    // answered from memory, the If-None-Match request goes in the background
+    // with the token of the first fetch
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QTRY_COMPARE_WITH_TIMEOUT(service.NotModified(), 1, 5000);
+    QCOMPARE(service.Requests("templates"), 2);
+    QCOMPARE(callback.Calls(), 1);
+
+    // the 304 made the list fresh again
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QCOMPARE(service.Requests("templates"), 2);
+}
+
+void TemplatesClientTest::test_ExpiredTokenIsNotRetried()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    platform::settings::IRMSEnvironmentImpl::Environment()->TemplatesCacheTtl(1);
+
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QCOMPARE(service.Challenges(), 1);
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    // the token of the first fetch expired: the background request gets a
+    // 401, which neither renews the challenge nor sends the token again
+    service.RejectTokens(1);
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QTRY_COMPARE_WITH_TIMEOUT(service.Requests("templates"), 2, 5000);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    QCOMPARE(service.Requests("templates"), 2);
+    QCOMPARE(service.Challenges(), 1);
+    QCOMPARE(callback.Calls(), 1);
+
+    // the caller waits for a new token and the If-None-Match request
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QCOMPARE(service.Requests("templates"), 3);
+    QCOMPARE(service.NotModified(), 1);
+    QCOMPARE(service.Challenges(), 1);
+    QCOMPARE(callback.Calls(), 2);
+}
+
+void TemplatesClientTest::test_ListIsKeptOnDisk()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+
+    auto environment = platform::settings::IRMSEnvironmentImpl::Environment();
+    environment->TemplatesCacheTtl(60);
+    environment->TemplatesCacheOnDisk(true);
+
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+
+    // as in a new process
+    TemplatesClient::ClearCache();
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QCOMPARE(service.Requests("templates"), 1);
+
+    // a stale list from the disk has no token to revalidate it with in the
+    // background, the caller waits for the If-None-Match request
+    TemplatesClient::ClearCache();
+    environment->TemplatesCacheTtl(1);
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    QCOMPARE(GetTemplates(service, callback), size_t(2));
+    QCOMPARE(service.Requests("templates"), 2);
+    QCOMPARE(service.NotModified(), 1);
+}
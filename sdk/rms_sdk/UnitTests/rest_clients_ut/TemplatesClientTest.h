@@ -0,0 +1,24 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef TEMPLATESCLIENTTEST_H
+#define TEMPLATESCLIENTTEST_H
+#include <QtTest>
+
+class TemplatesClientTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void test_FreshListIsServedFromMemory();
+    void test_StaleListIsRevalidated();
+    void test_ExpiredTokenIsNotRetried();
+    void test_ListIsKeptOnDisk();
+};
+#endif // TEMPLATESCLIENTTEST_H
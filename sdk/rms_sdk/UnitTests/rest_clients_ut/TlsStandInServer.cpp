@@ -0,0 +1,211 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <functional>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <openssl/evp.h>
+#include <openssl/x509v3.h>
+#include "TlsStandInServer.h"
+
+static const int IO_TIMEOUT_MS = 5000;
+
+static EVP_PKEY *NewKey()
+{
+    EVP_PKEY *key = nullptr;
+    EVP_PKEY_CTX *context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+
+    if (context != nullptr &&
+        EVP_PKEY_keygen_init(context) > 0 &&
+        EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048) > 0) {
+        EVP_PKEY_keygen(context, &key);
+    }
+    EVP_PKEY_CTX_free(context);
+    return key;
+}
+
+static void AddExtension(X509 *certificate, int nid, const char *value)
+{
+    X509V3_CTX context;
+    X509V3_set_ctx_nodb(&context);
+    X509V3_set_ctx(&context, certificate, certificate, nullptr, nullptr, 0);
+
+    X509_EXTENSION *extension = X509V3_EXT_conf_nid(nullptr, &context, nid, value);
+    if (extension != nullptr) {
+        X509_add_ext(certificate, extension, -1);
+        X509_EXTENSION_free(extension);
+    }
+}
+
+// self-signed, so that it's its own CA once trusted
+static X509 *NewCertificate(EVP_PKEY *key)
+{
+    X509 *certificate = X509_new();
+
+    X509_set_version(certificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(certificate), -60);
+    X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+    X509_set_pubkey(certificate, key);
+
+    X509_NAME *name = X509_get_subject_name(certificate);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char *>("RMS stand-in"),
+                               -1, -1, 0);
+    X509_set_issuer_name(certificate, name);
+
+    AddExtension(certificate, NID_basic_constraints, "critical,CA:TRUE");
+    AddExtension(certificate, NID_subject_alt_name, "IP:127.0.0.1");
+
+    X509_sign(certificate, key, EVP_sha256());
+    return certificate;
+}
+
+TlsStandInServer::TlsStandInServer(const QByteArray& body)
+    : m_body(body)
+    , m_key(NewKey())
+    , m_certificate(NewCertificate(m_key))
+    , m_context(SSL_CTX_new(TLS_server_method()))
+    , m_port(0)
+    , m_stop(false)
+    , m_requestCount(0)
+    , m_handshakes(0)
+    , m_resumedHandshakes(0)
+    , m_failedHandshakes(0)
+{
+    static const unsigned char sessionContext[] = "rms-stand-in";
+
+    SSL_CTX_use_certificate(m_context, m_certificate);
+    SSL_CTX_use_PrivateKey(m_context, m_key);
+    SSL_CTX_set_max_proto_version(m_context, TLS1_2_VERSION);
+    SSL_CTX_set_session_cache_mode(m_context, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_session_id_context(m_context, sessionContext,
+                                   sizeof(sessionContext) - 1);
+}
+
+TlsStandInServer::~TlsStandInServer()
+{
+    Stop();
+    SSL_CTX_free(m_context);
+    X509_free(m_certificate);
+    EVP_PKEY_free(m_key);
+}
+
+bool TlsStandInServer::Start()
+{
+    start();
+    m_ready.acquire();
+    return m_port != 0;
+}
+
+void TlsStandInServer::Stop()
+{
+    if (isRunning()) {
+        m_stop = true;
+        wait();
+    }
+}
+
+QByteArray TlsStandInServer::Url(const QByteArray& path) const
+{
+    return "https://127.0.0.1:" + QByteArray::number(m_port) + path;
+}
+
+void TlsStandInServer::run()
+{
+    QTcpServer server;
+
+    if (!server.listen(QHostAddress::LocalHost, 0)) {
+        m_ready.release();
+        return;
+    }
+    m_port = server.serverPort();
+    m_ready.release();
+
+    // one connection at a time, with the blocking API: there is no event loop
+    while (!m_stop) {
+        if (!server.waitForNewConnection(100)) continue;
+
+        while (server.hasPendingConnections()) {
+            QTcpSocket *socket = server.nextPendingConnection();
+            Serve(*socket);
+            delete socket;
+        }
+    }
+}
+
+void TlsStandInServer::Serve(QTcpSocket& socket)
+{
+    // the TLS records go through memory BIOs, the socket carries them
+    SSL *ssl = SSL_new(m_context);
+    BIO *in  = BIO_new(BIO_s_mem());
+    BIO *out = BIO_new(BIO_s_mem());
+    SSL_set_bio(ssl, in, out);
+    SSL_set_accept_state(ssl);
+
+    auto flush = [&]() {
+        char chunk[4096];
+        int  size;
+
+        while ((size = BIO_read(out, chunk, sizeof(chunk))) > 0) {
+            socket.write(chunk, size);
+        }
+        socket.waitForBytesWritten(IO_TIMEOUT_MS);
+    };
+
+    // runs the TLS operation, feeding it what the peer sends until it's done
+    auto drive = [&](std::function<int()> operation) {
+        for (;;) {
+            int result = operation();
+            flush();
+
+            if (result > 0 || SSL_get_error(ssl, result) != SSL_ERROR_WANT_READ) {
+                return result;
+            }
+            if (!socket.waitForReadyRead(IO_TIMEOUT_MS)) return -1;
+
+            QByteArray data = socket.readAll();
+            BIO_write(in, data.constData(), data.size());
+        }
+    };
+
+    if (drive([ssl]() { return SSL_accept(ssl); }) <= 0) {
+        ++m_failedHandshakes;
+    } else {
+        ++m_handshakes;
+        if (SSL_session_reused(ssl)) ++m_resumedHandshakes;
+
+        QByteArray request;
+        char chunk[4096];
+        int headerEnd;
+
+        while ((headerEnd = request.indexOf("\r\n\r\n")) < 0) {
+            int size = drive([&]() { return SSL_read(ssl, chunk, sizeof(chunk)); });
+            if (size <= 0) break;
+            request.append(chunk, size);
+        }
+
+        if (headerEnd >= 0) {
+            ++m_requestCount;
+
+            QByteArray response = "HTTP/1.1 200 StandIn\r\n"
+                                  "Content-Type: application/json\r\n"
+                                  "Content-Length: " + QByteArray::number(m_body.size()) +
+                                  "\r\nConnection: close\r\n\r\n" + m_body;
+            drive([&]() { return SSL_write(ssl, response.constData(), response.size()); });
+            SSL_shutdown(ssl);
+            flush();
+        }
+    }
+
+    SSL_free(ssl);
+    socket.disconnectFromHost();
+    if (socket.state() != QAbstractSocket::UnconnectedState) {
+        socket.waitForDisconnected(IO_TIMEOUT_MS);
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef TLSSTANDINSERVER_H
+#define TLSSTANDINSERVER_H
+
+#include <atomic>
+#include <QByteArray>
+#include <QSemaphore>
+#include <QThread>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+class QTcpSocket;
+
+// HTTPS counterpart of HttpStandInServer, on top of OpenSSL: it answers every
+// request with the same body and closes the connection, so that each request
+// needs a handshake, and counts the handshakes which resumed a TLS session.
+// Its certificate, for 127.0.0.1, is self-signed and made when it's created.
+// TLS 1.2 at most, whose sessions are resumable as soon as the handshake is
+// done.
+class TlsStandInServer : public QThread
+{
+public:
+    explicit TlsStandInServer(const QByteArray& body);
+    ~TlsStandInServer();
+
+    // starts listening and returns once the port is known
+    bool Start();
+    void Stop();
+
+    QByteArray Url(const QByteArray& path = QByteArray("/")) const;
+    X509      *Certificate() const { return m_certificate; }
+
+    int RequestCount() const { return m_requestCount.load(); }
+    int Handshakes() const { return m_handshakes.load(); }
+    int ResumedHandshakes() const { return m_resumedHandshakes.load(); }
+    int FailedHandshakes() const { return m_failedHandshakes.load(); }
+
+protected:
+    void run() override;
+
+private:
+    void Serve(QTcpSocket& socket);
+
+    QByteArray m_body;
+    EVP_PKEY  *m_key;
+    X509      *m_certificate;
+    SSL_CTX   *m_context;
+
+    quint16 m_port;
+    QSemaphore m_ready;
+    std::atomic<bool> m_stop;
+    std::atomic<int> m_requestCount;
+    std::atomic<int> m_handshakes;
+    std::atomic<int> m_resumedHandshakes;
+    std::atomic<int> m_failedHandshakes;
+};
+#endif // TLSSTANDINSERVER_H
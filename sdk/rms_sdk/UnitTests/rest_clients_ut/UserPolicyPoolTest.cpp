@@ -0,0 +1,177 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "UserPolicyPoolTest.h"
+#include "StandInRmsService.h"
+#include "../../ModernAPI/UserPolicyPool.h"
+#include "../../ModernAPI/RMSExceptions.h"
+
+using namespace std;
+using namespace rmscore;
+using namespace rmscore::modernapi;
+
+static shared_ptr<UserPolicy> Lease(UserPolicyPool& pool,
+                                    StandInRmsService& service,
+                                    StandInTokenCallback& callback,
+                                    shared_ptr<atomic<bool> > cancelState = nullptr)
+{
+    return pool.Lease(TemplateDescriptor("t1", "Template 1", "First"),
+                      service.Email(),
+                      callback,
+                      UserPolicyCreationOptions::USER_None,
+                      AppDataHashMap(),
+                      cancelState);
+}
+
+void UserPolicyPoolTest::test_LeasesReuseThePolicyWithinTheBudget()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    UserPolicyPool pool(3, chrono::hours(1));
+
+    auto first = Lease(pool, service, callback);
+    QVERIFY(first != nullptr);
+    QCOMPARE(Lease(pool, service, callback), first);
+    QCOMPARE(Lease(pool, service, callback), first);
+    QCOMPARE(service.Requests("publishinglicenses"), 1);
+}
+
+void UserPolicyPoolTest::test_ConcurrentLeasesShareOnePublication()
+{
+    StandInRmsService service(300);
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    UserPolicyPool pool(100, chrono::hours(1));
+
+    const int threadCount = 8;
+    vector<shared_ptr<UserPolicy> > policies(threadCount);
+    vector<thread> threads;
+
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&, i]() {
+            policies[i] = Lease(pool, service, callback);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    QCOMPARE(service.Requests("publishinglicenses"), 1);
+    for (auto& policy : policies) {
+        QVERIFY(policy != nullptr);
+        QCOMPARE(policy, policies[0]);
+    }
+}
+
+void UserPolicyPoolTest::test_PolicyIsRenewedAfterMaxUses()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    UserPolicyPool pool(2, chrono::hours(1));
+
+    auto first = Lease(pool, service, callback);
+    QCOMPARE(Lease(pool, service, callback), first);
+
+    auto renewed = Lease(pool, service, callback);
+    QVERIFY(renewed != nullptr);
+    QVERIFY(renewed != first);
+    QVERIFY(renewed->ContentId() != first->ContentId());
+    QCOMPARE(service.Requests("publishinglicenses"), 2);
+
+    // the new policy has a budget of its own
+    QCOMPARE(Lease(pool, service, callback), renewed);
+    QCOMPARE(service.Requests("publishinglicenses"), 2);
+}
+
+void UserPolicyPoolTest::test_PolicyIsRenewedAfterMaxAge()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    UserPolicyPool pool(0, chrono::seconds(1));
+
+    auto first = Lease(pool, service, callback);
+    QCOMPARE(Lease(pool, service, callback), first);
+
+    this_thread::sleep_for(chrono::milliseconds(1100));
+
+    auto renewed = Lease(pool, service, callback);
+    QVERIFY(renewed != nullptr);
+    QVERIFY(renewed != first);
+    QCOMPARE(service.Requests("publishinglicenses"), 2);
+}
+
+void UserPolicyPoolTest::test_FailedPublicationIsNotLeased()
+{
+    StandInRmsService service;
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    UserPolicyPool pool(100, chrono::hours(1));
+
+    service.SetStatus("publishinglicenses", 500);
+    bool failed = false;
+    try {
+        Lease(pool, service, callback);
+    } catch (exceptions::RMSException&) {
+        failed = true;
+    }
+    QVERIFY(failed);
+
+    // the next lease publishes again instead of getting the failure
+    service.SetStatus("publishinglicenses", 200);
+    auto policy = Lease(pool, service, callback);
+    QVERIFY(policy != nullptr);
+    QCOMPARE(service.Requests("publishinglicenses"), 2);
+    QCOMPARE(Lease(pool, service, callback), policy);
+    QCOMPARE(service.Requests("publishinglicenses"), 2);
+}
+
+void UserPolicyPoolTest::test_WaiterCancellation()
+{
+    StandInRmsService service(1000);
+    QVERIFY(service.Start());
+    StandInTokenCallback callback;
+    UserPolicyPool pool(100, chrono::hours(1));
+
+    shared_ptr<UserPolicy> published;
+    thread leader([&]() {
+        published = Lease(pool, service, callback);
+    });
+
+    // let the leader start publishing
+    this_thread::sleep_for(chrono::milliseconds(200));
+
+    auto cancelState = make_shared<atomic<bool> >(false);
+    thread canceller([cancelState]() {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        *cancelState = true;
+    });
+
+    auto started = chrono::steady_clock::now();
+    bool cancelled = false;
+    try {
+        Lease(pool, service, callback, cancelState);
+    } catch (exceptions::RMSNetworkException& e) {
+        cancelled = e.reason() == exceptions::RMSNetworkException::CancelledByUser;
+    }
+    auto waited = chrono::steady_clock::now() - started;
+    canceller.join();
+
+    // the waiter gave up long before the publication was done
+    QVERIFY(cancelled);
+    QVERIFY(waited < chrono::milliseconds(700));
+
+    // the leader wasn't affected, and its policy is pooled
+    leader.join();
+    QVERIFY(published != nullptr);
+    QCOMPARE(Lease(pool, service, callback), published);
+    QCOMPARE(service.Requests("publishinglicenses"), 1);
+}
@@ -0,0 +1,24 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef USERPOLICYPOOLTEST_H
+#define USERPOLICYPOOLTEST_H
+#include <QtTest>
+
+class UserPolicyPoolTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_LeasesReuseThePolicyWithinTheBudget();
+    void test_ConcurrentLeasesShareOnePublication();
+    void test_PolicyIsRenewedAfterMaxUses();
+    void test_PolicyIsRenewedAfterMaxAge();
+    void test_FailedPublicationIsNotLeased();
+    void test_WaiterCancellation();
+};
+#endif // USERPOLICYPOOLTEST_H
@@ -0,0 +1,118 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Utf16Test.h"
+#include "LicenseParserTestConstants.h"
+#include "../../Common/Utf16.h"
+
+using namespace std;
+using namespace rmscore::common;
+
+static string Convert(const vector<uint16_t>& units)
+{
+    vector<uint8_t> bytes;
+
+    for (auto unit : units)
+    {
+        bytes.push_back(static_cast<uint8_t>(unit & 0xff));
+        bytes.push_back(static_cast<uint8_t>(unit >> 8));
+    }
+
+    string utf8;
+    AppendUtf16LEAsUtf8(bytes.data(), units.size(), utf8);
+    return utf8;
+}
+
+static string ConvertWithQt(const vector<uint16_t>& units)
+{
+    auto utf8 = QString::fromUtf16(units.data(), static_cast<int>(units.size())).toUtf8();
+    return string(utf8.constData(), utf8.length());
+}
+
+void Utf16Test::test_MatchesQt()
+{
+    mt19937 random(42);
+
+    // mostly ASCII, like a license, with every UTF-8 length mixed in at
+    // every position relative to the vector width
+    for (int i = 0; i < 2000; ++i)
+    {
+        vector<uint16_t> units(random() % 80);
+
+        for (size_t j = 0; j < units.size(); ++j)
+        {
+            switch (random() % 8)
+            {
+            case 0:
+                units[j] = static_cast<uint16_t>(0x80 + random() % 0x780);
+                break;
+            case 1:
+                // below U+FEFF, which Qt would take for a byte order mark
+                units[j] = static_cast<uint16_t>(0xe000 + random() % 0x1000);
+                break;
+            case 2:
+                if (j + 1 < units.size())
+                {
+                    units[j]   = static_cast<uint16_t>(0xd800 + random() % 0x400);
+                    units[++j] = static_cast<uint16_t>(0xdc00 + random() % 0x400);
+                    break;
+                }
+                // falls through
+            default:
+                units[j] = static_cast<uint16_t>(random() % 0x80);
+            }
+        }
+        QCOMPARE(Convert(units), ConvertWithQt(units));
+    }
+}
+
+void Utf16Test::test_UnpairedSurrogates()
+{
+    QCOMPARE(Convert({ 'a', 0xd800, 'b' }), string("a\xef\xbf\xbd" "b"));
+    QCOMPARE(Convert({ 0xdc00, 0xd800 }), string("\xef\xbf\xbd\xef\xbf\xbd"));
+    QCOMPARE(Convert({ 0xd83d, 0xde00 }), string("\xf0\x9f\x98\x80"));
+}
+
+void Utf16Test::test_Unaligned()
+{
+    // the license buffer may start at an odd address
+    vector<uint8_t> bytes(1);
+    string expected;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        bytes.push_back(static_cast<uint8_t>('a' + i % 26));
+        bytes.push_back(0);
+        expected += static_cast<char>('a' + i % 26);
+    }
+
+    string utf8;
+    AppendUtf16LEAsUtf8(bytes.data() + 1, 100, utf8);
+    QCOMPARE(utf8, expected);
+}
+
+void Utf16Test::benchmark_Utf16LEToUtf8()
+{
+    QBENCHMARK {
+        string utf8;
+        AppendUtf16LEAsUtf8(PL_0101right_ECB_xml, PL_0101right_ECB_xml_len / 2, utf8);
+    }
+}
+
+void Utf16Test::benchmark_Utf16LEToUtf8Qt()
+{
+    QBENCHMARK {
+        auto unicode = QString::fromUtf16(reinterpret_cast<const ushort *>(PL_0101right_ECB_xml),
+                                          PL_0101right_ECB_xml_len / 2);
+        auto utf8 = unicode.toUtf8();
+        string utf8String(utf8.constData(), utf8.length());
+    }
+}
@@ -0,0 +1,25 @@
+/*
+ * ======================================================================
+ * Copyright (c) Microsoft Open Technologies, Inc.  All rights reserved.
+ * Licensed under the MIT License.
+ * See LICENSE.md in the project root for license information.
+ * ======================================================================
+*/
+
+#ifndef UTF16TEST_H
+#define UTF16TEST_H
+#include <QtTest>
+
+class Utf16Test : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void test_MatchesQt();
+    void test_UnpairedSurrogates();
+    void test_Unaligned();
+
+    // a UTF-16 publishing license, against QString::fromUtf16().toUtf8()
+    void benchmark_Utf16LEToUtf8();
+    void benchmark_Utf16LEToUtf8Qt();
+};
+#endif // UTF16TEST_H
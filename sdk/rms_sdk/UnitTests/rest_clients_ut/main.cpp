@@ -6,15 +6,54 @@
  * ======================================================================
 */
 
+#include <cstring>
 #include <QCoreApplication>
 #include "LicenseParserTest.h"
+#include "SingleFlightTest.h"
+#include "HttpTransportTest.h"
+#include "HedgedRequestTest.h"
+#include "Utf16Test.h"
+#include "JsonSerializerTest.h"
+#include "RestClientCacheStoreTest.h"
+#include "RestClientCacheTest.h"
+#include "UserPolicyPoolTest.h"
+#include "AcquireManyTest.h"
+#include "ProtectionPolicyTest.h"
+#include "TemplatesClientTest.h"
+#include "ChallengeCacheTest.h"
+#include "DnsLookupClientTest.h"
+#include "PrewarmTest.h"
+#ifdef WITH_CURL
+# include "HttpClientCurlTest.h"
+#endif // WITH_CURL
 
 int main(int argc, char *argv[])
 {
+    if ((argc == 3) && (strcmp(argv[1], HttpTransportTest::NoApplicationArg) == 0)) {
+        return HttpTransportTest::GetWithoutApplication(argv[2]);
+    }
+
     QCoreApplication app(argc, argv);
 
     int res = 0;
     res += QTest::qExec(new LicenseParserTest(), argc, argv);
+    res += QTest::qExec(new SingleFlightTest(), argc, argv);
+    res += QTest::qExec(new HttpTransportTest(), argc, argv);
+    res += QTest::qExec(new HedgedRequestTest(), argc, argv);
+    res += QTest::qExec(new Utf16Test(), argc, argv);
+    res += QTest::qExec(new JsonSerializerTest(), argc, argv);
+    res += QTest::qExec(new RestClientCacheStoreTest(), argc, argv);
+    res += QTest::qExec(new RestClientCacheTest(), argc, argv);
+    res += QTest::qExec(new UserPolicyPoolTest(), argc, argv);
+    res += QTest::qExec(new AcquireManyTest(), argc, argv);
+    res += QTest::qExec(new ProtectionPolicyTest(), argc, argv);
+    res += QTest::qExec(new TemplatesClientTest(), argc, argv);
+    res += QTest::qExec(new ChallengeCacheTest(), argc, argv);
+    res += QTest::qExec(new DnsLookupClientTest(), argc, argv);
+    res += QTest::qExec(new PrewarmTest(), argc, argv);
+#ifdef WITH_CURL
+    res += QTest::qExec(new HttpClientCurlTest(), argc, argv);
+#endif // WITH_CURL
 
     return res;
 }
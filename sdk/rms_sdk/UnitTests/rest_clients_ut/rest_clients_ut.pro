@@ -31,14 +31,57 @@ CONFIG(debug, debug|release) {
 win32:LIBS += -L$$REPO_ROOT/third_party/lib/eay/ -lssleay32 -llibeay32 -lGdi32 -lUser32 -lAdvapi32
 else:LIBS  += -lssl -lcrypto
 
+curl {
+    DEFINES += WITH_CURL
+
+    win32:LIBS    += -L$$REPO_ROOT/third_party/lib/curl/ -llibcurl -lWs2_32 -lWldap32 -lCrypt32
+    else:macx:LIBS += -L/usr/local/opt/curl/lib -lcurl
+    else:LIBS     += -lcurl
+
+    SOURCES += HttpClientCurlTest.cpp TlsStandInServer.cpp
+    HEADERS += HttpClientCurlTest.h TlsStandInServer.h
+}
+
 DEFINES += SRCDIR=\\\"$$PWD/\\\"
 
 SOURCES += \
     main.cpp \
     LicenseParserTest.cpp \
     LicenseParserTestConstants.cpp \
+    HttpStandInServer.cpp \
+    StandInRmsService.cpp \
+    SingleFlightTest.cpp \
+    HttpTransportTest.cpp \
+    HedgedRequestTest.cpp \
+    Utf16Test.cpp \
+    JsonSerializerTest.cpp \
+    RestClientCacheStoreTest.cpp \
+    RestClientCacheTest.cpp \
+    UserPolicyPoolTest.cpp \
+    AcquireManyTest.cpp \
+    ProtectionPolicyTest.cpp \
+    TemplatesClientTest.cpp \
+    ChallengeCacheTest.cpp \
+    DnsLookupClientTest.cpp \
+    PrewarmTest.cpp \
 
 HEADERS += \
     LicenseParserTest.h \
     LicenseParserTestConstants.h \
+    HttpStandInServer.h \
+    StandInRmsService.h \
+    SingleFlightTest.h \
+    HttpTransportTest.h \
+    HedgedRequestTest.h \
+    Utf16Test.h \
+    JsonSerializerTest.h \
+    RestClientCacheStoreTest.h \
+    RestClientCacheTest.h \
+    UserPolicyPoolTest.h \
+    AcquireManyTest.h \
+    ProtectionPolicyTest.h \
+    TemplatesClientTest.h \
+    ChallengeCacheTest.h \
+    DnsLookupClientTest.h \
+    PrewarmTest.h \
     
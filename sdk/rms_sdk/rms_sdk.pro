@@ -9,6 +9,7 @@ SUBDIRS += \
     PFile \
     Platform \
     RestClients \
+    Tools \
     UnitTests
 
 UnitTests.depends   = ModernAPI
@@ -21,6 +21,8 @@
 #include <FileCacheEncrypted.h>
 #include <UserCredential.h>
 #include <ClientCredential.h>
+#include <QFile>
+#include <algorithm>
 
 Q_DECLARE_METATYPE(rmsauth::String)
 
@@ -226,6 +228,282 @@ void NonInteractiveTests::FileCacheEncryptedTest()
   }
 }
 
+void NonInteractiveTests::FileCacheReloadTest_data()
+{
+  CacheTest_data();
+}
+
+void NonInteractiveTests::FileCacheReloadTest()
+{
+  QFETCH(String, clientId);
+  QFETCH(String, redirectUri);
+  QFETCH(String, resource);
+  QFETCH(String, authority);
+  QFETCH(String, authenticationResult);
+
+  qDebug() << "====== NonInteractiveTests::FileCacheReloadTest() ======";
+
+  // two caches on one file, as in two processes
+  String cacheFilePath = String(SRCDIR) + "cacheReload.dat";
+  FileCache writerCache(cacheFilePath);
+  FileCache readerCache(cacheFilePath);
+  TokenCache& writer = writerCache;
+  TokenCache& reader = readerCache;
+
+  writer.clear();
+
+  auto authResPtr  = AuthenticationResult::deserialize(authenticationResult);
+  auto userInfoPtr = authResPtr->userInfo();
+  String uId       = userInfoPtr == nullptr ? "" : userInfoPtr->uniqueId();
+
+  writer.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  writer.storeToCache(authResPtr,
+                      authority,
+                      resource,
+                      clientId,
+                      TokenSubjectType::User,
+                      nullptr);
+  writer.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+
+  // written in the background, by flush() at the latest
+  writerCache.flush();
+  QVERIFY(QFile::exists(QString::fromStdString(cacheFilePath)));
+
+  // the reader sees the new file
+  reader.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  QVERIFY(reader.loadSingleItemFromCache(authority,
+                                         resource,
+                                         clientId,
+                                         TokenSubjectType::User,
+                                         uId,
+                                         nullptr) != nullptr);
+  reader.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+
+  // and that it is gone
+  writer.clear();
+  reader.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  QCOMPARE(reader.count(), 0);
+  reader.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+}
+
+void NonInteractiveTests::FileCacheMergeTest_data()
+{
+  CacheTest_data();
+}
+
+void NonInteractiveTests::FileCacheMergeTest()
+{
+  QFETCH(String, clientId);
+  QFETCH(String, redirectUri);
+  QFETCH(String, resource);
+  QFETCH(String, authority);
+  QFETCH(String, authenticationResult);
+
+  qDebug() << "====== NonInteractiveTests::FileCacheMergeTest() ======";
+
+  // two caches on one file, as in two processes, storing different tokens
+  // before either has seen the file of the other
+  String cacheFilePath = String(SRCDIR) + "cacheMerge.dat";
+  FileCache firstCache(cacheFilePath);
+  FileCache secondCache(cacheFilePath);
+  TokenCache& first  = firstCache;
+  TokenCache& second = secondCache;
+
+  first.clear();
+
+  auto authResPtr  = AuthenticationResult::deserialize(authenticationResult);
+  auto userInfoPtr = authResPtr->userInfo();
+  String uId       = userInfoPtr == nullptr ? "" : userInfoPtr->uniqueId();
+
+  first.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  second.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+
+  first.storeToCache(authResPtr,
+                     authority,
+                     resource + "/first",
+                     clientId,
+                     TokenSubjectType::User,
+                     nullptr);
+  second.storeToCache(authResPtr,
+                      authority,
+                      resource + "/second",
+                      clientId,
+                      TokenSubjectType::User,
+                      nullptr);
+  first.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+  second.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+
+  firstCache.flush();
+  secondCache.flush();
+
+  // the file has both, whichever was written last
+  FileCache thirdCache(cacheFilePath);
+  TokenCache& third = thirdCache;
+
+  third.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  QCOMPARE(third.count(), 2);
+
+  for (auto suffix : { "/first", "/second" })
+  {
+    QVERIFY(third.loadSingleItemFromCache(authority,
+                                          resource + suffix,
+                                          clientId,
+                                          TokenSubjectType::User,
+                                          uId,
+                                          nullptr) != nullptr);
+  }
+  third.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+
+  // and the caches read the token of the other back
+  first.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  QCOMPARE(first.count(), 2);
+  first.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+  second.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  QCOMPARE(second.count(), 2);
+  second.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+
+  first.clear();
+}
+
+void NonInteractiveTests::FileCacheDeleteMergeTest_data()
+{
+  CacheTest_data();
+}
+
+void NonInteractiveTests::FileCacheDeleteMergeTest()
+{
+  QFETCH(String, clientId);
+  QFETCH(String, redirectUri);
+  QFETCH(String, resource);
+  QFETCH(String, authority);
+  QFETCH(String, authenticationResult);
+
+  qDebug() << "====== NonInteractiveTests::FileCacheDeleteMergeTest() ======";
+
+  String cacheFilePath = String(SRCDIR) + "cacheDeleteMerge.dat";
+  FileCache firstCache(cacheFilePath);
+  FileCache secondCache(cacheFilePath);
+  TokenCache& first  = firstCache;
+  TokenCache& second = secondCache;
+
+  first.clear();
+
+  auto authResPtr = AuthenticationResult::deserialize(authenticationResult);
+
+  // the resources of the tokens, readItems() goes through onBeforeAccess()
+  auto resources = [&](TokenCache& cache) {
+    StringArray found;
+    for (auto item : cache.readItems())
+    {
+      found.push_back(item->resource().substr(resource.size()));
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+  };
+  const StringArray merged = { "/added", "/kept" };
+
+  // both caches hold the two tokens of the file
+  first.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  for (auto suffix : { "/deleted", "/kept" })
+  {
+    first.storeToCache(authResPtr,
+                       authority,
+                       resource + suffix,
+                       clientId,
+                       TokenSubjectType::User,
+                       nullptr);
+  }
+  first.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+  firstCache.flush();
+
+  second.onBeforeAccess(TokenCacheNotificationArgs(nullptr));
+  QCOMPARE(second.count(), 2);
+  second.storeToCache(authResPtr,
+                      authority,
+                      resource + "/added",
+                      clientId,
+                      TokenSubjectType::User,
+                      nullptr);
+
+  // the first deletes a token, which is written at the end of the delay as it
+  // has just written; meanwhile the second writes the file with it
+  for (auto item : first.readItems())
+  {
+    if (item->resource() == resource + "/deleted")
+    {
+      first.deleteItem(item);
+    }
+  }
+  second.onAfterAccess(TokenCacheNotificationArgs(nullptr));
+  secondCache.flush();
+
+  // merged while the write is pending: the token of the second comes in,
+  // the deleted one doesn't come back
+  QVERIFY(resources(first) == merged);
+
+  // and merged again when written
+  firstCache.flush();
+
+  FileCache thirdCache(cacheFilePath);
+  TokenCache& third = thirdCache;
+
+  QVERIFY(resources(third) == merged);
+  QVERIFY(resources(second) == merged);
+
+  first.clear();
+}
+
+void NonInteractiveTests::TokenCacheQueryTest()
+{
+  qDebug() << "====== NonInteractiveTests::TokenCacheQueryTest() ======";
+
+  String cacheFilePath = String(SRCDIR) + "cacheQuery.dat";
+  FileCache cache(cacheFilePath);
+
+  cache.clear();
+
+  auto makeResult = [](bool mrrt, const String& refreshToken) {
+                      auto result = make_shared<AuthenticationResult>(
+                        "Bearer", "dummy-at", refreshToken, 4102444800LL);
+                      result->isMultipleResourceRefreshToken(mrrt);
+                      return result;
+                    };
+
+  cache.storeToCache(makeResult(true, "rt1"), "https://Auth", "res1",
+                     "Client", TokenSubjectType::Client, nullptr);
+  cache.storeToCache(makeResult(false, "rt2"), "https://auth", "res2",
+                     "client", TokenSubjectType::Client, nullptr);
+  cache.storeToCache(makeResult(false, "rt3"), "https://auth", "res2",
+                     "other", TokenSubjectType::Client, nullptr);
+  QCOMPARE(cache.count(), 3);
+
+  // the keys compare case-insensitively
+  auto item = cache.loadSingleItemFromCache("https://AUTH", "RES2", "CLIENT",
+                                            TokenSubjectType::Client, "",
+                                            nullptr);
+  QVERIFY(item != nullptr);
+  QCOMPARE(item->refreshToken(), String("rt2"));
+
+  // no token for the resource, the multiple resource refresh token
+  item = cache.loadSingleItemFromCache("https://auth", "res9", "client",
+                                       TokenSubjectType::Client, "", nullptr);
+  QVERIFY(item != nullptr);
+  QCOMPARE(item->refreshToken(), String("rt1"));
+
+  QCOMPARE(cache.queryCache("https://auth", "", TokenSubjectType::Client,
+                            "").size(), static_cast<size_t>(3));
+  QCOMPARE(cache.queryCache("https://auth", "client", TokenSubjectType::Client,
+                            "").size(), static_cast<size_t>(2));
+  QVERIFY(cache.queryCache("https://auth", "client", TokenSubjectType::User,
+                           "").empty());
+
+  cache.deleteItem(item);
+  QVERIFY(cache.loadSingleItemFromCache("https://auth", "res9", "client",
+                                        TokenSubjectType::Client, "",
+                                        nullptr) == nullptr);
+  cache.clear();
+}
+
 void NonInteractiveTests::AcquireTokenNonInteractiveHandlerTest()
 {
   qDebug() <<
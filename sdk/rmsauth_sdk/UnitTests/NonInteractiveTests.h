@@ -30,6 +30,13 @@ private Q_SLOTS:
   void CacheTest();
   void FileCacheEncryptedTest_data();
   void FileCacheEncryptedTest();
+  void FileCacheReloadTest_data();
+  void FileCacheReloadTest();
+  void FileCacheMergeTest_data();
+  void FileCacheMergeTest();
+  void FileCacheDeleteMergeTest_data();
+  void FileCacheDeleteMergeTest();
+  void TokenCacheQueryTest();
 
   void AcquireTokenNonInteractiveHandlerTest();
   void AcquireTokenForClientHandlerTest();
@@ -9,7 +9,6 @@
 #include <Logger.h>
 #include <FileCacheEncrypted.h>
 #include <Constants.h>
-#include <fstream>
 #include "../../rmscrypto_sdk/CryptoAPI/CryptoAPI.h"
 
 using namespace std;
@@ -21,68 +20,30 @@ FileCacheEncrypted::FileCacheEncrypted(const String& filePath)
 {
 }
 
+FileCacheEncrypted::~FileCacheEncrypted()
+{
+    // the pending changes still need encode()
+    flush();
+}
+
 /// throws:
 ///     rmscrypto::exceptions::RMSCryptoException
-void FileCacheEncrypted::readCache()
+ByteArray FileCacheEncrypted::decode(const ByteArray& fileData)
 {
-    Logger::info(Tag(), "readCache");
-    ifstream ifs(cacheFilePath_, ios::binary|ios::ate);
-    if (!ifs.is_open())
-    {
-        Logger::info(Tag(), "Cache file doesn't exist! '%'", cacheFilePath_);
-        return;
-    }
-
-    ifstream::pos_type pos = ifs.tellg();
-    if (pos <= 0)
-    {
-        Logger::info(Tag(), "File is empty! '%'", cacheFilePath_);
-        return;
-    }
-
-    ByteArray cacheData(pos);
-
-    ifs.seekg(0, ios::beg);
-    ifs.read(&cacheData[0], pos);
-
-    // decrypt cacheData;
-    auto inputDataPtr = std::make_shared<std::vector<uint8_t>>(cacheData.begin(), cacheData.end());
+    Logger::info(Tag(), "decrypting cacheData");
+    auto inputDataPtr = std::make_shared<std::vector<uint8_t>>(fileData.begin(), fileData.end());
     auto cacheDataDecryptedPtr = rmscrypto::api::DecryptWithAutoKey(inputDataPtr);
-    ByteArray cacheDataDecrypted(cacheDataDecryptedPtr->begin(), cacheDataDecryptedPtr->end());
-
-    deserialize(cacheDataDecrypted);
-    ifs.close();
+    return ByteArray(cacheDataDecryptedPtr->begin(), cacheDataDecryptedPtr->end());
 }
 
 /// throws:
-///     rmsauth::RmsauthParsingException
 ///     rmscrypto::exceptions::RMSCryptoException
-void FileCacheEncrypted::writeCache()
+ByteArray FileCacheEncrypted::encode(const ByteArray& cacheData)
 {
-    Logger::info(Tag(), "writeCache");
-    ofstream ofs(cacheFilePath_, ios::binary|ios::app);
-    if (!ofs.is_open())
-    {
-        Logger::info(Tag(), "Can't open cache file for writing! '%'", cacheFilePath_);
-        return;
-    }
-
-    auto cacheData = serialize();
-
-    // encrypt cacheData
     Logger::info(Tag(), "encrypting cacheData");
     auto inputDataPtr = std::make_shared<std::vector<uint8_t>>(cacheData.begin(), cacheData.end());
     auto cacheDataEncryptedPtr = rmscrypto::api::EncryptWithAutoKey(inputDataPtr);
-    ByteArray cacheDataEncrypted(cacheDataEncryptedPtr->begin(), cacheDataEncryptedPtr->end());
-
-    Logger::info(Tag(), "writing to the file stream");
-    ofs.write(&cacheDataEncrypted[0], cacheDataEncrypted.size());
-
-    if(-1 == ofs.tellp())
-    {
-        throw RmsauthParsingException("writeCache", "write data error");
-    }
-    ofs.close();
+    return ByteArray(cacheDataEncryptedPtr->begin(), cacheDataEncryptedPtr->end());
 }
 
 } // namespace rmsauth {
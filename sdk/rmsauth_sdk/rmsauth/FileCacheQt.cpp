@@ -12,7 +12,14 @@
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QStandardPaths>
+#include <QDateTime>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+# include <sys/stat.h>
+#endif
 
 using namespace std;
 
@@ -50,46 +57,331 @@ FileCache::FileCache(const String& filePath)
   Logger::info(Tag(), "path: %", cacheFilePath_);
 }
 
+FileCache::~FileCache()
+{
+  flush();
+
+  if (writer_.joinable())
+  {
+    {
+      std::lock_guard<Mutex> lock(writerLock_);
+      stopWriter_ = true;
+    }
+    writerChanged_.notify_all();
+    writer_.join();
+  }
+}
+
+ByteArray FileCache::encode(const ByteArray& cacheData)
+{
+  return cacheData;
+}
+
+ByteArray FileCache::decode(const ByteArray& fileData)
+{
+  return fileData;
+}
+
+FileCache::FileStamp FileCache::fileStamp(int fd) const
+{
+  FileStamp stamp;
+
+#ifdef Q_OS_UNIX
+  // every write renames a new file over the old one, so the inode changes
+  // even when the time and the size don't
+  struct stat st;
+
+  if (((fd >= 0) ? ::fstat(fd, &st) : ::stat(cacheFilePath_.c_str(), &st)) != 0)
+  {
+    return stamp;
+  }
+
+  stamp.exists = true;
+# ifdef Q_OS_MAC
+  stamp.modified = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000 +
+                   st.st_mtimespec.tv_nsec / 1000000;
+# else // ifdef Q_OS_MAC
+  stamp.modified = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000 +
+                   st.st_mtim.tv_nsec / 1000000;
+# endif // ifdef Q_OS_MAC
+  stamp.size  = static_cast<int64_t>(st.st_size);
+  stamp.inode = static_cast<uint64_t>(st.st_ino);
+#else // ifdef Q_OS_UNIX
+  Q_UNUSED(fd);
+  QFileInfo fi(QString::fromStdString(cacheFilePath_));
+
+  if (!fi.exists()) return stamp;
+
+  stamp.exists   = true;
+  stamp.modified = fi.lastModified().toMSecsSinceEpoch();
+  stamp.size     = fi.size();
+#endif // ifdef Q_OS_UNIX
+  return stamp;
+}
+
+/// the decoded content of the file; called under fileLock_
+bool FileCache::readFile(ByteArray& cacheData)
+{
+  QFile file(QString::fromStdString(cacheFilePath_));
+
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    Logger::info(Tag(), "Can't open cache file for reading! '%'", cacheFilePath_);
+    return false;
+  }
+
+  QByteArray fileData = file.readAll();
+  file.close();
+
+  cacheData = fileData.isEmpty()
+              ? ByteArray()
+              : decode(ByteArray(fileData.begin(), fileData.end()));
+  return true;
+}
+
+/// replaces the cache with the file's content, if the file changed since it
+/// was last read or written; called under fileLock_
 void FileCache::readCache()
 {
+  auto stamp = fileStamp();
+
+  if (stamp == stamp_) return;
+
   Logger::info(Tag(), "readCache");
-  ifstream ifs(cacheFilePath_, ios::binary | ios::ate);
 
-  if (!ifs.is_open())
+  if (!stamp.exists)
   {
     Logger::info(Tag(), "Cache file doesn't exist! '%'", cacheFilePath_);
+    deserialize(ByteArray());
+    stamp_ = stamp;
+    mergedStamp_ = FileStamp();
     return;
   }
-  ifstream::pos_type pos = ifs.tellg();
 
-  ByteArray cacheData(pos);
+  ByteArray cacheData;
+
+  if (!readFile(cacheData)) return;
 
-  ifs.seekg(0, ios::beg);
-  ifs.read(&cacheData[0], pos);
+  // deserialize() adds to the entries already there
+  deserialize(ByteArray());
   deserialize(cacheData);
-  ifs.close();
+  stamp_ = stamp;
+  mergedStamp_ = FileStamp();
+
+  // the file is what the cache holds now, removed entries included
+  removedKeys_.clear();
+  {
+    std::lock_guard<Mutex> lock(writerLock_);
+    pendingRemoved_.clear();
+  }
+}
+
+/// adds the entries of the file to the cache, if another writer replaced the
+/// file since it was last read or merged; used instead of readCache() while
+/// a write is pending, whose changes are newer than the file, without the
+/// removed entries. Called under fileLock_
+void FileCache::mergeCache(const HashSet<TokenCacheKey>& removed)
+{
+  auto stamp = fileStamp();
+
+  if (!stamp.exists || (stamp == stamp_) || (stamp == mergedStamp_)) return;
+
+  Logger::info(Tag(), "mergeCache");
+
+  ByteArray cacheData;
+
+  if (!readFile(cacheData) || cacheData.empty()) return;
+
+  // deserialize() keeps the entries already there on the same key
+  deserialize(cacheData, removed);
+
+  // stamp_ is left as it is: the pending write may have been serialized
+  // before the merge, so it has to merge the file again
+  mergedStamp_ = stamp;
 }
 
-void FileCache::writeCache()
+/// writes a temporary file and renames it over the cache file, so readers
+/// never see a partial cache; if another writer replaced the file since it
+/// was last read, its entries are merged in first, but for the removed ones
+void FileCache::writeCache(const ByteArray& cacheData,
+                           const HashSet<TokenCacheKey>& removed)
 {
   Logger::info(Tag(), "writeCache");
-  ofstream ofs(cacheFilePath_, ios::binary | ios::trunc);
+  Lock l(fileLock_);
+
+  ByteArray data  = cacheData;
+  bool    merged  = false;
+  auto    current = fileStamp();
 
-  if (!ofs.is_open())
+  if (current.exists && !(current == stamp_))
+  {
+    try
+    {
+      ByteArray fileData;
+
+      if (readFile(fileData) && !fileData.empty())
+      {
+        // the entries of this cache win on the same key
+        TokenCache merging(cacheData);
+        merging.deserialize(fileData, removed);
+        data   = merging.serialize();
+        merged = true;
+      }
+    }
+    catch (const std::exception& e)
+    {
+      Logger::error(Tag(), "writeCache: can't merge the file, replacing it: %",
+                    e.what());
+    }
+  }
+
+  QSaveFile file(QString::fromStdString(cacheFilePath_));
+
+  if (!file.open(QIODevice::WriteOnly))
   {
     Logger::info(Tag(), "Can't open cache file for writing! '%'", cacheFilePath_);
     return;
   }
 
-  auto cacheData = serialize();
-  ofs.write(&cacheData[0], cacheData.size());
-  ofs.close();
+  ByteArray fileData = encode(data);
+
+  if ((file.write(fileData.data(), fileData.size()) !=
+       static_cast<qint64>(fileData.size())) || !file.flush())
+  {
+    Logger::error(Tag(), "writeCache: Failed to write '%'", cacheFilePath_);
+    return;
+  }
+
+  // the stamp of the file written here, taken from its handle before the
+  // rename: by the time the rename is done another writer may have replaced
+  // it, which the next access must still notice
+  auto written = fileStamp(file.handle());
+
+  if (!file.commit())
+  {
+    Logger::error(Tag(), "writeCache: Failed to write '%'", cacheFilePath_);
+    return;
+  }
+
+#ifndef Q_OS_UNIX
+  written = fileStamp();
+#endif // ifndef Q_OS_UNIX
+
+  // after a merge the cache lacks the entries of the other writer, the next
+  // access reads the file back
+  stamp_       = merged ? FileStamp() : written;
+  mergedStamp_ = FileStamp();
+}
+
+void FileCache::scheduleWrite(ByteArray&& cacheData, HashSet<TokenCacheKey>&& removed)
+{
+  std::lock_guard<Mutex> lock(writerLock_);
+
+  pendingRemoved_.insert(removed.begin(), removed.end());
+
+  // the first change after a write sets the time of the next one: right away
+  // if the last write is old enough, else at the end of the delay, with the
+  // changes made up to then
+  if (!hasPendingWrite_)
+  {
+    writeAt_ = std::max(std::chrono::steady_clock::now(),
+                        lastWriteAt_ + std::chrono::milliseconds(WriteDelayMs));
+  }
+  pendingData_     = std::move(cacheData);
+  hasPendingWrite_ = true;
+
+  if (!writer_.joinable())
+  {
+    writer_ = std::thread([this]() {
+        runWriter();
+      });
+  }
+  writerChanged_.notify_all();
+}
+
+/// called with writerLock_ held, releases it while writing
+void FileCache::writePending(std::unique_lock<Mutex>& lock)
+{
+  auto cacheData = std::move(pendingData_);
+  auto removed   = pendingRemoved_;
+
+  pendingData_.clear();
+  hasPendingWrite_ = false;
+  isWriting_       = true;
+  lock.unlock();
+
+  try
+  {
+    writeCache(cacheData, removed);
+  }
+  catch (const std::exception& e)
+  {
+    Logger::error(Tag(), "writeCache: %", e.what());
+  }
+
+  lock.lock();
+  isWriting_   = false;
+  lastWriteAt_ = std::chrono::steady_clock::now();
+
+  // the file no longer has them; a pending write may still need them
+  if (!hasPendingWrite_)
+  {
+    pendingRemoved_.clear();
+  }
+  writerChanged_.notify_all();
+}
+
+void FileCache::runWriter()
+{
+  std::unique_lock<Mutex> lock(writerLock_);
+
+  while (!stopWriter_)
+  {
+    if (!hasPendingWrite_ || isWriting_)
+    {
+      writerChanged_.wait(lock);
+    }
+    else if (std::chrono::steady_clock::now() < writeAt_)
+    {
+      writerChanged_.wait_until(lock, writeAt_);
+    }
+    else
+    {
+      writePending(lock);
+    }
+  }
+}
+
+void FileCache::flush()
+{
+  std::unique_lock<Mutex> lock(writerLock_);
+
+  writerChanged_.wait(lock, [this]() {
+      return !isWriting_;
+    });
+
+  if (hasPendingWrite_)
+  {
+    writePending(lock);
+  }
 }
 
 void FileCache::clear()
 {
   Logger::info(Tag(), "clear");
   TokenCache::clear();
+
+  // the file is removed rather than written empty
+  {
+    std::unique_lock<Mutex> lock(writerLock_);
+
+    writerChanged_.wait(lock, [this]() {
+        return !isWriting_;
+      });
+    pendingData_.clear();
+    hasPendingWrite_ = false;
+  }
+
   Lock l(fileLock_);
   bool ok = QFile::remove(cacheFilePath_.c_str());
 
@@ -97,6 +389,8 @@ void FileCache::clear()
   {
     Logger::error(Tag(), "clear: Failed to delete a file: ");
   }
+  stamp_       = fileStamp();
+  mergedStamp_ = FileStamp();
 }
 
 void FileCache::onBeforeAccess(const TokenCacheNotificationArgs& /* args*/)
@@ -104,19 +398,35 @@ void FileCache::onBeforeAccess(const TokenCacheNotificationArgs& /* args*/)
   Logger::info(Tag(), "onBeforeAccess");
   Lock l(fileLock_);
 
-  readCache();
+  bool isPending;
+  HashSet<TokenCacheKey> removed(removedKeys_);
+  {
+    std::lock_guard<Mutex> lock(writerLock_);
+    isPending = hasPendingWrite_ || isWriting_;
+    removed.insert(pendingRemoved_.begin(), pendingRemoved_.end());
+  }
+
+  // the changes not written yet are newer than the file, they are kept
+  if (isPending)
+  {
+    mergeCache(removed);
+  }
+  else
+  {
+    readCache();
+  }
 }
 
 void FileCache::onAfterAccess(const TokenCacheNotificationArgs& /* args*/)
 {
   Logger::info(Tag(), "onAfterAccess");
-  Lock l(fileLock_);
 
   // if the access operation resulted in a cache update
   if (hasStateChanged_)
   {
-    writeCache();
     hasStateChanged_ = false;
+    scheduleWrite(serialize(), std::move(removedKeys_));
+    removedKeys_.clear();
   }
 }
 } // namespace rmsauth {
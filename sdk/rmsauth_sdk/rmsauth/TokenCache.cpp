@@ -57,7 +57,8 @@ void TokenCache::deleteItem(TokenCacheItemPtr item)
     onBeforeAccess(args);
     onBeforeWrite(args);
 
-    tokenCacheDictionary_.erase(item->tokenCacheKey());
+    removedKeys_.insert(item->tokenCacheKey());
+    removeEntry(item->tokenCacheKey());
 
     hasStateChanged_ = true;
     onAfterAccess(args);
@@ -70,7 +71,11 @@ void TokenCache::clear()
     TokenCacheNotificationArgs args{ this };
     onBeforeAccess(args);
     onBeforeWrite(args);
-    tokenCacheDictionary_.clear();
+    for (const auto& kvp : tokenCacheDictionary_)
+    {
+        removedKeys_.insert(kvp.first);
+    }
+    clearEntries();
     hasStateChanged_ = true;
     onAfterAccess(args);
 }
@@ -106,7 +111,8 @@ AuthenticationResultPtr TokenCache::loadFromCache(const String& authority, const
 
         if (result->accessToken().empty() && result->refreshToken().empty())
         {
-            tokenCacheDictionary_.erase(cacheKey);
+            removedKeys_.insert(cacheKey);
+            removeEntry(cacheKey);
             Logger::info(Tag(), "An old item was removed from the cache");
             hasStateChanged_ = true;
             result = nullptr;
@@ -136,6 +142,7 @@ void TokenCache::storeToCache(AuthenticationResultPtr result, const String& auth
     onBeforeWrite(args);
 
     TokenCacheKey tokenCacheKey(authority, resource, clientId, subjectType, result->userInfo());
+    removedKeys_.erase(tokenCacheKey);
     auto it = tokenCacheDictionary_.find(tokenCacheKey);
     if(it != tokenCacheDictionary_.end())
     {
@@ -145,7 +152,7 @@ void TokenCache::storeToCache(AuthenticationResultPtr result, const String& auth
     else
     {
         Logger::info(Tag(), "An item was added to the cache");
-        tokenCacheDictionary_.insert(KeyValuePair<TokenCacheKey, AuthenticationResultPtr>(std::move(tokenCacheKey), result));
+        addEntry(std::move(tokenCacheKey), result);
     }
 
     updateCachedMrrtRefreshTokens(result, authority, clientId, subjectType);
@@ -157,50 +164,52 @@ void TokenCache::updateCachedMrrtRefreshTokens(AuthenticationResultPtr result, c
 {
     if (result->userInfo() != nullptr && result->isMultipleResourceRefreshToken())
     {
-        auto list = queryCache(authority, clientId, subjectType, result->userInfo()->uniqueId()/*, result->userInfo()->displayableId()*/);
-        for(TokenCacheItemPtr itemPtr : list)
-        {
-            if(itemPtr->isMultipleResourceRefreshToken())
+        forEachMatch(authority, clientId, subjectType, result->userInfo()->uniqueId()/*, result->userInfo()->displayableId()*/,
+            [&result](Entry& entry)
             {
-                itemPtr->refreshToken(result->refreshToken());
-            }
-        }
+                if(entry.second->isMultipleResourceRefreshToken())
+                {
+                    entry.second->refreshToken(result->refreshToken());
+                }
+            });
     }
 }
 
 TokenCacheItemPtr TokenCache::loadSingleItemFromCache(const String& authority, const String& resource, const String& clientId, TokenSubjectType subjectType, const String& uniqueId, /*const String& displayableId, */CallStatePtr/* callState*/)
 {
-    auto list = queryCache(authority, clientId, subjectType, uniqueId/*, displayableId*/);
-    auto qnty = std::count_if(
-        std::begin(list), std::end(list),
-        [&resource](TokenCacheItemPtr itemPtr)
+    Entry* match = nullptr;
+    Entry* mrrt = nullptr;
+    int qnty = 0;
+
+    forEachMatch(authority, clientId, subjectType, uniqueId/*, displayableId*/,
+        [&](Entry& entry)
         {
-            return StringUtils::equalsIC(itemPtr->resource(), resource);
+            if (StringUtils::equalsIC(entry.first.resource(), resource))
+            {
+                match = &entry;
+                ++qnty;
+            }
+            else if (mrrt == nullptr && entry.second->isMultipleResourceRefreshToken())
+            {
+                mrrt = &entry;
+            }
         });
 
     if (qnty > 1)
     {
-        RmsauthException(Constants::rmsauthError().MultipleTokensMatched);
+        Logger::warning(Tag(), Constants::rmsauthError().MultipleTokensMatched);
+        return nullptr;
     }
 
     if(qnty == 1)
     {
         Logger::info(Tag(), "An item matching the requested resource was found in the cache");
-        return list.front();
+        return std::make_shared<TokenCacheItem>(match->first, match->second);
     }
 
-    if(qnty == 0)
+    if(mrrt != nullptr)
     {
-        auto mrrt = std::find_if(
-            std::begin(list), std::end(list),
-            [&](TokenCacheItemPtr itemPtr)
-            {
-                return itemPtr->isMultipleResourceRefreshToken();
-            });
-        if(mrrt != std::end(list))
-        {
-            return *mrrt;
-        }
+        return std::make_shared<TokenCacheItem>(mrrt->first, mrrt->second);
     }
 
     return nullptr;
@@ -209,20 +218,93 @@ TokenCacheItemPtr TokenCache::loadSingleItemFromCache(const String& authority, c
 List<TokenCacheItemPtr> TokenCache::queryCache(const String& authority, const String& clientId, TokenSubjectType subjectType, const String& uniqueId/*, const String& displayableId*/)
 {
     List<TokenCacheItemPtr> list;
-    for (auto kvp : tokenCacheDictionary_)
+    forEachMatch(authority, clientId, subjectType, uniqueId/*, displayableId*/,
+        [&list](Entry& entry)
+        {
+            list.push_back(std::make_shared<TokenCacheItem>(entry.first, entry.second));
+        });
+
+    return std::move(list);
+}
+
+template<typename F>
+void TokenCache::forEachMatch(const String& authority, const String& clientId, TokenSubjectType subjectType, const String& uniqueId/*, const String& displayableId*/, F f)
+{
+    auto matches = [&](const TokenCacheKey& key)
     {
-        TokenCacheKey key = kvp.first;
-        if (StringUtils::equalsIC(key.authority(), authority)
+        return StringUtils::equalsIC(key.authority(), authority)
                 && (clientId.empty() || StringUtils::equalsIC(key.clientId(), clientId))
                 && (uniqueId.empty() || StringUtils::equalsIC(key.uniqueId(), uniqueId))
 //                && (displayableId.empty() || StringUtils::equalsIC(key.displayableId(), displayableId))
-                && (key.tokenSubjectType() == subjectType))
+                && (key.tokenSubjectType() == subjectType);
+    };
+
+    // any client, the indexes don't help
+    if (clientId.empty())
+    {
+        for (auto& entry : tokenCacheDictionary_)
         {
-            list.push_back(std::make_shared<TokenCacheItem>(kvp.first, kvp.second));
+            if (matches(entry.first)) f(entry);
         }
+        return;
     }
 
-    return std::move(list);
+    auto range = uniqueId.empty()
+        ? clientIndex_.equal_range(TokenCacheKey::getClientHashCode(authority, clientId, subjectType))
+        : userIndex_.equal_range(TokenCacheKey::getUserHashCode(authority, clientId, subjectType, uniqueId));
+
+    // the hashes can collide, the keys are compared still
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (matches(it->second->first)) f(*it->second);
+    }
+}
+
+void TokenCache::addEntry(TokenCacheKey&& key, AuthenticationResultPtr result)
+{
+    auto inserted = tokenCacheDictionary_.insert(std::make_pair(std::move(key), result));
+    if (!inserted.second)
+    {
+        return;
+    }
+
+    Entry* entry = &*inserted.first;
+    userIndex_.insert(std::make_pair(entry->first.getUserHashCode(), entry));
+    clientIndex_.insert(std::make_pair(entry->first.getClientHashCode(), entry));
+}
+
+void TokenCache::removeEntry(const TokenCacheKey& key)
+{
+    auto it = tokenCacheDictionary_.find(key);
+    if (it == tokenCacheDictionary_.end())
+    {
+        return;
+    }
+
+    Entry* entry = &*it;
+    auto unindex = [entry](std::unordered_multimap<std::size_t, Entry*>& index, std::size_t hash)
+    {
+        auto range = index.equal_range(hash);
+        for (auto indexed = range.first; indexed != range.second; ++indexed)
+        {
+            if (indexed->second == entry)
+            {
+                index.erase(indexed);
+                return;
+            }
+        }
+    };
+    unindex(userIndex_, entry->first.getUserHashCode());
+    unindex(clientIndex_, entry->first.getClientHashCode());
+
+    tokenCacheDictionary_.erase(it);
+}
+
+void TokenCache::clearEntries()
+{
+    userIndex_.clear();
+    clientIndex_.clear();
+    tokenCacheDictionary_.clear();
 }
 
 } // namespace rmsauth {
@@ -7,9 +7,29 @@
 */
 
 #include <TokenCacheKey.h>
+#include <cctype>
 
 namespace rmsauth {
 
+namespace {
+
+const size_t FnvOffsetBasis = static_cast<size_t>(14695981039346656037ULL);
+const size_t FnvPrime       = static_cast<size_t>(1099511628211ULL);
+
+// FNV-1a of the lower case characters and a separator, the same for the
+// strings equalsIC finds equal
+size_t hashIC(size_t hash, const String& value)
+{
+    for (auto c : value)
+    {
+        hash ^= static_cast<size_t>(std::tolower(static_cast<unsigned char>(c)));
+        hash *= FnvPrime;
+    }
+    return (hash ^ 0xff) * FnvPrime;
+}
+
+} // namespace
+
 TokenCacheKey::TokenCacheKey(const String& authority, const String& resource, const String& clientId, const TokenSubjectType tokenSubjectType, const UserInfoPtr userInfo)
      : TokenCacheKey{authority, resource, clientId, tokenSubjectType, (userInfo != nullptr) ? userInfo->uniqueId() : ""/*, (userInfo != nullptr) ? userInfo->displayableId() : ""*/}
  {
@@ -42,21 +62,28 @@ bool TokenCacheKey::operator==(const TokenCacheKey &other) const
 
 size_t TokenCacheKey::getHashCode() const
 {
-     const String DELIM = ":::";
-     StringStream ss;
-     ss << StringUtils::toLower(authority_) << DELIM
-        << StringUtils::toLower(resource_) << DELIM
-        << StringUtils::toLower(clientId_) << DELIM
-        << StringUtils::toLower(uniqueId_) << DELIM
-//        << StringUtils::toLower(displayableId_) << DELIM
-        << static_cast<int>(tokenSubjectType_);
-
-    auto hashcode = std::hash<String>()(ss.str());
-    Logger::info(Tag(),
-        "TokenCacheKey::getHashCode(): authority: %; resource: %; clientId: % uniqueId: %; tokenSubjectType_: %; hashcode: %;",
-        authority_, resource_, clientId_, uniqueId_, /*displayableId_, */(int)tokenSubjectType_, hashcode);
-
-    return hashcode;
+    return hashIC(getUserHashCode(), resource_);
+}
+
+size_t TokenCacheKey::getUserHashCode() const
+{
+    return getUserHashCode(authority_, clientId_, tokenSubjectType_, uniqueId_);
+}
+
+size_t TokenCacheKey::getClientHashCode() const
+{
+    return getClientHashCode(authority_, clientId_, tokenSubjectType_);
+}
+
+size_t TokenCacheKey::getUserHashCode(const String& authority, const String& clientId, const TokenSubjectType tokenSubjectType, const String& uniqueId)
+{
+    return hashIC(getClientHashCode(authority, clientId, tokenSubjectType), uniqueId);
+}
+
+size_t TokenCacheKey::getClientHashCode(const String& authority, const String& clientId, const TokenSubjectType tokenSubjectType)
+{
+    size_t hash = hashIC(hashIC(FnvOffsetBasis, authority), clientId);
+    return (hash ^ static_cast<size_t>(tokenSubjectType)) * FnvPrime;
 }
 
 } // namespace rmsauth {
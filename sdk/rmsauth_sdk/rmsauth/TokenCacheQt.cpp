@@ -24,10 +24,10 @@ ByteArray TokenCache::serialize()
 
     qds << SchemaVersion_;
     qds << count();
-    for( auto kvp : tokenCacheDictionary_)
+    for(const auto& kvp : tokenCacheDictionary_)
     {
-        auto tokenCacheKey = kvp.first;
-        AuthenticationResultPtr authenticationResultPtr = kvp.second;
+        const auto& tokenCacheKey = kvp.first;
+        const AuthenticationResultPtr& authenticationResultPtr = kvp.second;
 
         qds << QString::fromStdString(tokenCacheKey.authority());
         qds << QString::fromStdString(tokenCacheKey.resource());
@@ -42,12 +42,17 @@ ByteArray TokenCache::serialize()
 }
 
 void TokenCache::deserialize(const ByteArray& state)
+{
+    deserialize(state, HashSet<TokenCacheKey>());
+}
+
+void TokenCache::deserialize(const ByteArray& state, const HashSet<TokenCacheKey>& skipped)
 {
     Logger::info(Tag(), "deserialize");
 
     if (state.empty())
     {
-       tokenCacheDictionary_.clear();
+       clearEntries();
        return;
     }
 
@@ -93,8 +98,12 @@ void TokenCache::deserialize(const ByteArray& state)
             ,TokenSubjectType(tokenSubjectType)
             ,result->userInfo());
 
+        if (skipped.count(tokenCacheKey) > 0)
+        {
+            continue;
+        }
 
-        tokenCacheDictionary_.insert(std::make_pair(std::move(tokenCacheKey), result));
+        addEntry(std::move(tokenCacheKey), result);
     }
 
     Logger::info(Tag(), "Deserialized % items to token cache.", this->count());
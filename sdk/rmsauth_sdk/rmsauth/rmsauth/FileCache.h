@@ -12,9 +12,23 @@
 #include "types.h"
 #include "TokenCache.h"
 #include "rmsauthExport.h"
+#include <chrono>
+#include <condition_variable>
+#include <thread>
 
 namespace rmsauth {
 
+/// The cache is authoritative in memory: the file is read again only when
+/// another writer has replaced it, and changes reach the file from a
+/// background thread, written to a temporary file renamed over the old one.
+/// A change is written right away unless the previous write is less than
+/// WriteDelayMs old; the changes made meanwhile go together at the end of the
+/// delay, and are what a crash may lose.
+///
+/// The entries another writer put in the file since it was last read are
+/// merged in, both before a write and while one is pending; on the same key
+/// the entries of this cache win, and the entries it removed since it last
+/// read the file stay removed.
 class RMSAUTH_EXPORT FileCache : public TokenCache
 {
 protected:
@@ -23,17 +37,67 @@ protected:
     static Mutex fileLock_;
 
 public:
+    static const int WriteDelayMs = 500;
+
     FileCache(const String& filePath = "");
+    ~FileCache();
     void clear() override;
 
+    /// writes the pending changes now
+    void flush();
+
 protected:
-    virtual void readCache();
-    virtual void writeCache();
+    /// what is stored in the file for the serialized cache, and back;
+    /// classes overriding them must call flush() in their destructor
+    virtual ByteArray encode(const ByteArray& cacheData);
+    virtual ByteArray decode(const ByteArray& fileData);
 
 private:
+    struct FileStamp
+    {
+        bool exists = false;
+        int64_t modified = 0;
+        int64_t size = 0;
+        uint64_t inode = 0;
+
+        bool operator==(const FileStamp& other) const
+        {
+            return exists == other.exists && modified == other.modified &&
+                   size == other.size && inode == other.inode;
+        }
+    };
+
+    /// the stamp of the cache file or, when fd is given, of the file open as fd
+    FileStamp fileStamp(int fd = -1) const;
+    bool readFile(ByteArray& cacheData);
+    void readCache();
+    void mergeCache(const HashSet<TokenCacheKey>& removed);
+    void writeCache(const ByteArray& cacheData, const HashSet<TokenCacheKey>& removed);
+    void scheduleWrite(ByteArray&& cacheData, HashSet<TokenCacheKey>&& removed);
+    void writePending(std::unique_lock<Mutex>& lock);
+    void runWriter();
+
     virtual void onBeforeAccess(const TokenCacheNotificationArgs& args) override;
     virtual void onAfterAccess(const TokenCacheNotificationArgs& args) override;
     virtual const String getCacheName() const override {return FileCache::Tag();}
+
+    // the file as last read or written, and as last merged into the cache
+    // while a write was pending, guarded by fileLock_
+    FileStamp stamp_;
+    FileStamp mergedStamp_;
+
+    // the next write, guarded by writerLock_
+    Mutex writerLock_;
+    std::condition_variable writerChanged_;
+    ByteArray pendingData_;
+    // the keys removed by the changes pending or being written
+    HashSet<TokenCacheKey> pendingRemoved_;
+    bool hasPendingWrite_ = false;
+    bool isWriting_ = false;
+    bool stopWriter_ = false;
+    std::chrono::steady_clock::time_point writeAt_;
+    std::chrono::steady_clock::time_point lastWriteAt_;
+    std::thread writer_;
 };
 
 } // namespace rmsauth {
@@ -21,10 +21,11 @@ class RMSAUTH_EXPORT FileCacheEncrypted : public FileCache
 
 public:
     FileCacheEncrypted(const String& filePath = "");
+    ~FileCacheEncrypted();
 
 protected:
-    virtual void readCache() override;
-    virtual void writeCache() override;
+    virtual ByteArray encode(const ByteArray& cacheData) override;
+    virtual ByteArray decode(const ByteArray& fileData) override;
 
 private:
     virtual const String getCacheName() const override {return FileCacheEncrypted::Tag();}
@@ -28,11 +28,18 @@ class RMSAUTH_EXPORT TokenCache
     const int SchemaVersion_ = 2;
     const String LocalSettingsContainerName_ = "ActiveDirectoryAuthenticationLibrary";
     HashMap<TokenCacheKey, AuthenticationResultPtr> tokenCacheDictionary_;
+    using Entry = HashMap<TokenCacheKey, AuthenticationResultPtr>::value_type;
+    // the dictionary's entries by TokenCacheKey::getUserHashCode() and, for
+    // the queries of any user, by TokenCacheKey::getClientHashCode()
+    std::unordered_multimap<std::size_t, Entry*> userIndex_;
+    std::unordered_multimap<std::size_t, Entry*> clientIndex_;
     // We do not want to return near expiry tokens, this is why we use this hard coded setting to refresh tokens which are close to expiration.
     const int64_t expirationMarginInSeconds_ = 300;
 
 public:
     TokenCache(const ByteArray& state);
+    TokenCache(const TokenCache&) = delete;
+    TokenCache& operator=(const TokenCache&) = delete;
     static TokenCache& defaultShared();
     bool hasStateChanged() const { return hasStateChanged_; }
     void hasStateChanged(const bool val) { hasStateChanged_ = val; }
@@ -40,6 +47,8 @@ public:
     int count() const;
     ByteArray serialize();
     void deserialize(const ByteArray& state);
+    // the same, without the entries whose key is in skipped
+    void deserialize(const ByteArray& state, const HashSet<TokenCacheKey>& skipped);
     virtual List<TokenCacheItemPtr> readItems();
     virtual void deleteItem(TokenCacheItemPtr item);
     virtual void clear();
@@ -58,6 +67,20 @@ public:
 protected:
     TokenCache();
     volatile bool hasStateChanged_ = false;
+    // the keys deleteItem(), clear() and loadFromCache() removed, which a cache
+    // sharing its store with other writers mustn't take back from them;
+    // storeToCache() takes a key out again
+    HashSet<TokenCacheKey> removedKeys_;
+
+private:
+    // the only changes to tokenCacheDictionary_, they keep the indexes
+    void addEntry(TokenCacheKey&& key, AuthenticationResultPtr result);
+    void removeEntry(const TokenCacheKey& key);
+    void clearEntries();
+
+    // calls f(Entry&) for the entries queryCache() returns
+    template<typename F>
+    void forEachMatch(const String& authority, const String& clientId, TokenSubjectType subjectType, const String& uniqueId, F f);
 };
 
 using TokenCachePtr = ptr<TokenCache>;
@@ -47,6 +47,13 @@ public:
     bool equals(const TokenCacheKey& other) const;
     bool operator==(const TokenCacheKey &other) const;
     std::size_t getHashCode() const;
+
+    // case-insensitive hashes of the key without the resource, and without
+    // the resource and the unique id, for the token cache's indexes
+    std::size_t getUserHashCode() const;
+    std::size_t getClientHashCode() const;
+    static std::size_t getUserHashCode(const String& authority, const String& clientId, const TokenSubjectType tokenSubjectType, const String& uniqueId);
+    static std::size_t getClientHashCode(const String& authority, const String& clientId, const TokenSubjectType tokenSubjectType);
 };
 
 } // namespace rmsauth {
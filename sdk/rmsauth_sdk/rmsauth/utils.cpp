@@ -23,9 +23,18 @@ bool StringUtils::endsWith(const String& src, const String& substr)
 }
 int StringUtils::compareIC(const String& src, const String& str)
 {
-    String srcLow = StringUtils::toLower(src);
-    String strLow = StringUtils::toLower(str);
-    return srcLow.compare(strLow);
+    // compares like toLower(src).compare(toLower(str)), without the copies
+    auto length = std::min(src.length(), str.length());
+    for(String::size_type i=0; i<length; ++i)
+    {
+        int srcLow = std::tolower(static_cast<unsigned char>(src[i]));
+        int strLow = std::tolower(static_cast<unsigned char>(str[i]));
+        if (srcLow != strLow)
+        {
+            return srcLow < strLow ? -1 : 1;
+        }
+    }
+    return src.length() == str.length() ? 0 : (src.length() < str.length() ? -1 : 1);
 }
 bool StringUtils::equalsIC(const String& src, const String& str)
 {